@@ -0,0 +1,361 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "em5/fire/component/FireReceiverComponent.h"
+
+#include <qsf/base/GetUninitialized.h>
+
+#include <algorithm>
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace firesimulation
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline FireReceiverRegistry::FireReceiverRegistry(float cellSize) :
+			mCellSize(cellSize),
+			mSynchronizationRun(0),
+			mSelectionRun(0)
+		{
+			// Nothing here
+		}
+
+		inline void FireReceiverRegistry::beginSynchronization()
+		{
+			// A new stamp per synchronization marks the slots still in use
+			++mSynchronizationRun;
+			if (0 == mSynchronizationRun)
+			{
+				std::fill(mSynchronizationStamps.begin(), mSynchronizationStamps.end(), 0);
+				mSynchronizationRun = 1;
+			}
+		}
+
+		inline uint32 FireReceiverRegistry::synchronizeFireReceiver(FireReceiverComponent& fireReceiver)
+		{
+			const uint64 entityId = fireReceiver.getEntityId();
+			const uint32 componentId = fireReceiver.getId();
+			uint32 slot = qsf::getUninitialized<uint32>();
+			const SlotMap::const_iterator iterator = mSlotsByEntityId.find(entityId);
+			if (iterator != mSlotsByEntityId.end())
+			{
+				for (uint32 entitySlot : iterator->second)
+				{
+					if (mComponentIds[entitySlot] == componentId)
+					{
+						slot = entitySlot;
+						break;
+					}
+				}
+			}
+
+			if (qsf::isUninitialized(slot))
+			{
+				slot = addSlot(fireReceiver, entityId, componentId);
+			}
+			else if (mComponentData[slot].mComponent != &fireReceiver)
+			{
+				// The entity got another component instance
+				removeSlot(slot);
+				slot = addSlot(fireReceiver, entityId, componentId);
+			}
+
+			mSynchronizationStamps[slot] = mSynchronizationRun;
+			return slot;
+		}
+
+		inline void FireReceiverRegistry::endSynchronization()
+		{
+			for (uint32 slot = 0; slot < static_cast<uint32>(mComponentData.size()); ++slot)
+			{
+				if (nullptr != mComponentData[slot].mComponent && mSynchronizationStamps[slot] != mSynchronizationRun)
+				{
+					removeSlot(slot);
+				}
+			}
+		}
+
+		inline void FireReceiverRegistry::markDirty(uint64 entityId, uint32 flags)
+		{
+			const SlotMap::const_iterator iterator = mSlotsByEntityId.find(entityId);
+			if (iterator != mSlotsByEntityId.end())
+			{
+				for (uint32 slot : iterator->second)
+				{
+					markSlotDirty(slot, flags);
+				}
+			}
+		}
+
+		inline void FireReceiverRegistry::markSlotDirty(uint32 slot, uint32 flags)
+		{
+			if (0 == mDirtyFlags[slot])
+			{
+				mDirtySlots.push_back(slot);
+			}
+			mDirtyFlags[slot] |= flags;
+		}
+
+		inline void FireReceiverRegistry::markActiveSendersDirty(uint32 flags)
+		{
+			for (uint32 slot : mSenderSlots)
+			{
+				markSlotDirty(slot, flags);
+			}
+		}
+
+		template <typename GatherFunction>
+		uint32 FireReceiverRegistry::updateDirtySlots(const GatherFunction& gatherFunction)
+		{
+			uint32 numberOfGatheredSlots = 0;
+			for (uint32 slot : mDirtySlots)
+			{
+				const uint32 flags = mDirtyFlags[slot];
+				if (0 == flags)
+				{
+					continue;
+				}
+				mDirtyFlags[slot] = 0;
+				++numberOfGatheredSlots;
+
+				ComponentData& componentData = mComponentData[slot];
+				gatherFunction(slot, componentData, flags);
+
+				if (flags & DIRTY_TRANSFORM)
+				{
+					const uint64 cellKey = componentData.mHasPosition ? getCellKey(getCell(componentData.mPosition.x), getCell(componentData.mPosition.z)) : qsf::getUninitialized<uint64>();
+					if (cellKey != mSlotCells[slot])
+					{
+						removeFromCell(slot);
+						if (qsf::isInitialized(cellKey))
+						{
+							mCells[cellKey].push_back(slot);
+							mSlotCells[slot] = cellKey;
+						}
+					}
+				}
+				updateSender(slot);
+			}
+			mDirtySlots.clear();
+			return numberOfGatheredSlots;
+		}
+
+		inline void FireReceiverRegistry::selectSlotsForNextRun(std::vector<uint32>& slots)
+		{
+			slots.clear();
+
+			// A new stamp per run marks the slots already selected
+			++mSelectionRun;
+			if (0 == mSelectionRun)
+			{
+				std::fill(mSelectionStamps.begin(), mSelectionStamps.end(), 0);
+				mSelectionRun = 1;
+			}
+
+			for (uint32 senderSlot : mSenderSlots)
+			{
+				const ComponentData& sender = mComponentData[senderSlot];
+				if (mSelectionStamps[senderSlot] != mSelectionRun)
+				{
+					mSelectionStamps[senderSlot] = mSelectionRun;
+					slots.push_back(senderSlot);
+				}
+
+				// Same test as done by the fire spread kernel
+				const float squaredSoftRadius = sender.mSoftRadius * sender.mSoftRadius;
+				const int32 lastCellX = getCell(sender.mPosition.x + sender.mSoftRadius);
+				const int32 lastCellZ = getCell(sender.mPosition.z + sender.mSoftRadius);
+				for (int32 cellZ = getCell(sender.mPosition.z - sender.mSoftRadius); cellZ <= lastCellZ; ++cellZ)
+				{
+					for (int32 cellX = getCell(sender.mPosition.x - sender.mSoftRadius); cellX <= lastCellX; ++cellX)
+					{
+						const CellMap::const_iterator cell = mCells.find(getCellKey(cellX, cellZ));
+						if (cell == mCells.end())
+						{
+							continue;
+						}
+
+						for (uint32 slot : cell->second)
+						{
+							if (mSelectionStamps[slot] != mSelectionRun)
+							{
+								const ComponentData& receiver = mComponentData[slot];
+								const float deltaX = receiver.mPosition.x - sender.mPosition.x;
+								const float deltaZ = receiver.mPosition.z - sender.mPosition.z;
+								if (deltaX * deltaX + deltaZ * deltaZ <= squaredSoftRadius)
+								{
+									mSelectionStamps[slot] = mSelectionRun;
+									slots.push_back(slot);
+								}
+							}
+						}
+					}
+				}
+			}
+
+			// Keep the order independent of the grid
+			std::sort(slots.begin(), slots.end());
+		}
+
+		inline const ComponentData& FireReceiverRegistry::getComponentData(uint32 slot) const
+		{
+			return mComponentData[slot];
+		}
+
+		inline uint32 FireReceiverRegistry::getNumberOfRegisteredReceivers() const
+		{
+			return static_cast<uint32>(mComponentData.size() - mFreeSlots.size());
+		}
+
+		inline uint32 FireReceiverRegistry::getNumberOfActiveSenders() const
+		{
+			return static_cast<uint32>(mSenderSlots.size());
+		}
+
+		inline void FireReceiverRegistry::clear()
+		{
+			mComponentData.clear();
+			mEntityIds.clear();
+			mComponentIds.clear();
+			mDirtyFlags.clear();
+			mDirtySlots.clear();
+			mFreeSlots.clear();
+			mSlotsByEntityId.clear();
+			mSynchronizationStamps.clear();
+			mSynchronizationRun = 0;
+			mCells.clear();
+			mSlotCells.clear();
+			mSenderSlots.clear();
+			mSelectionStamps.clear();
+			mSelectionRun = 0;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline uint32 FireReceiverRegistry::addSlot(FireReceiverComponent& fireReceiver, uint64 entityId, uint32 componentId)
+		{
+			uint32 slot;
+			if (mFreeSlots.empty())
+			{
+				slot = static_cast<uint32>(mComponentData.size());
+				mComponentData.emplace_back();
+				mEntityIds.push_back(entityId);
+				mComponentIds.push_back(componentId);
+				mDirtyFlags.push_back(0);
+				mSynchronizationStamps.push_back(0);
+				mSlotCells.push_back(qsf::getUninitialized<uint64>());
+				mSelectionStamps.push_back(0);
+			}
+			else
+			{
+				slot = mFreeSlots.back();
+				mFreeSlots.pop_back();
+				mEntityIds[slot] = entityId;
+				mComponentIds[slot] = componentId;
+			}
+
+			// Start without any state, everything is gathered during the next update
+			ComponentData& componentData = mComponentData[slot];
+			componentData = ComponentData();
+			componentData.mComponent = &fireReceiver;
+
+			mSlotsByEntityId[entityId].push_back(slot);
+			markSlotDirty(slot, DIRTY_ALL);
+			return slot;
+		}
+
+		inline void FireReceiverRegistry::removeSlot(uint32 slot)
+		{
+			const SlotMap::iterator iterator = mSlotsByEntityId.find(mEntityIds[slot]);
+			if (iterator != mSlotsByEntityId.end())
+			{
+				std::vector<uint32>& entitySlots = iterator->second;
+				entitySlots.erase(std::remove(entitySlots.begin(), entitySlots.end(), slot), entitySlots.end());
+				if (entitySlots.empty())
+				{
+					mSlotsByEntityId.erase(iterator);
+				}
+			}
+
+			removeFromCell(slot);
+			mComponentData[slot].mComponent = nullptr;
+			updateSender(slot);
+
+			// The slot may still be inside the dirty list, it's skipped there because the flags are cleared
+			mDirtyFlags[slot] = 0;
+			mFreeSlots.push_back(slot);
+		}
+
+		inline uint64 FireReceiverRegistry::getCellKey(int32 cellX, int32 cellZ) const
+		{
+			// Biased so the uninitialized key isn't the valid cell (-1, -1)
+			return (static_cast<uint64>(static_cast<uint32>(cellX) + 0x80000000u) << 32) | static_cast<uint64>(static_cast<uint32>(cellZ) + 0x80000000u);
+		}
+
+		inline int32 FireReceiverRegistry::getCell(float coordinate) const
+		{
+			return static_cast<int32>(std::floor(coordinate / mCellSize));
+		}
+
+		inline void FireReceiverRegistry::removeFromCell(uint32 slot)
+		{
+			const uint64 cellKey = mSlotCells[slot];
+			if (qsf::isInitialized(cellKey))
+			{
+				const CellMap::iterator cell = mCells.find(cellKey);
+				if (cell != mCells.end())
+				{
+					std::vector<uint32>& cellSlots = cell->second;
+					const std::vector<uint32>::iterator iterator = std::find(cellSlots.begin(), cellSlots.end(), slot);
+					if (iterator != cellSlots.end())
+					{
+						*iterator = cellSlots.back();
+						cellSlots.pop_back();
+					}
+					if (cellSlots.empty())
+					{
+						mCells.erase(cell);
+					}
+				}
+				mSlotCells[slot] = qsf::getUninitialized<uint64>();
+			}
+		}
+
+		inline void FireReceiverRegistry::updateSender(uint32 slot)
+		{
+			// Same criteria as used by the fire spread kernel
+			const ComponentData& componentData = mComponentData[slot];
+			const bool isSender = (nullptr != componentData.mComponent && componentData.mIsFireSender && componentData.mHasPosition && componentData.mSoftRadius > 0.0f);
+
+			const std::vector<uint32>::iterator iterator = std::find(mSenderSlots.begin(), mSenderSlots.end(), slot);
+			if (isSender && iterator == mSenderSlots.end())
+			{
+				mSenderSlots.push_back(slot);
+			}
+			else if (!isSender && iterator != mSenderSlots.end())
+			{
+				*iterator = mSenderSlots.back();
+				mSenderSlots.pop_back();
+			}
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // firesimulation
+} // em5
@@ -0,0 +1,214 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "em5/fire/simulation/FireSpreadCalculation.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace firesimulation
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Persistent simulation data of fire receivers, updated incrementally
+		*
+		*  @remarks
+		*    Each fire receiver (or fire component) owns a slot with its simulation data as long as it's part of the registry, slots of removed receivers are reused.
+		*    The receivers are identified by their entity ID together with their component ID, so an entity with both a fire receiver and a fire component
+		*    owns two slots. A slot whose entity now holds another component instance of the same component ID is gathered again completely.
+		*    Instead of gathering the data of all receivers for each run, changes mark the slot dirty and only dirty slots are gathered again.
+		*
+		*    The receivers are binned in a uniform grid on the xz plane, which is only updated for receivers with a changed transform.
+		*    For each run only the active senders and the receivers inside their soft radius are selected,
+		*    all other receivers can't get any fire energy and don't need to be part of the run at all.
+		*
+		*    Only to be used from the main thread, see "em5::firesimulation::FireSpreadMonitor" for the user.
+		*/
+		class FireReceiverRegistry : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			enum DirtyFlags
+			{
+				DIRTY_TRANSFORM		= 1 << 0,	///< Position changed
+				DIRTY_BURNING_STATE	= 1 << 1,	///< Burning or burned state, fire energy or radii changed
+				DIRTY_ALL			= DIRTY_TRANSFORM | DIRTY_BURNING_STATE
+			};
+
+			static const uint32 DEFAULT_CELL_SIZE = 16;	///< Default edge length of a receiver grid cell in world units
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Constructor
+			*
+			*  @param[in] cellSize
+			*    Edge length of a receiver grid cell, should be in the magnitude of the typical soft radius
+			*/
+			inline explicit FireReceiverRegistry(float cellSize = static_cast<float>(DEFAULT_CELL_SIZE));
+
+			/**
+			*  @brief
+			*    Start a synchronization with the current fire receivers, call "synchronizeFireReceiver()" for each of them and "endSynchronization()" afterwards
+			*/
+			inline void beginSynchronization();
+
+			/**
+			*  @brief
+			*    Keep the fire receiver inside the registry, a new slot is added and marked completely dirty if needed
+			*
+			*  @return
+			*    The slot of the fire receiver
+			*/
+			inline uint32 synchronizeFireReceiver(FireReceiverComponent& fireReceiver);
+
+			/**
+			*  @brief
+			*    Remove the slots of all fire receivers not synchronized since "beginSynchronization()"
+			*/
+			inline void endSynchronization();
+
+			/**
+			*  @brief
+			*    Mark data of all fire receivers of an entity to be gathered again during the next update; does nothing if the entity has no slot
+			*
+			*  @param[in] flags
+			*    Combination of "DirtyFlags"
+			*/
+			inline void markDirty(uint64 entityId, uint32 flags);
+			inline void markSlotDirty(uint32 slot, uint32 flags);
+
+			/**
+			*  @brief
+			*    Mark data of all active senders to be gathered again during the next update, e.g. since their fire energy changes while they are burning
+			*/
+			inline void markActiveSendersDirty(uint32 flags);
+
+			/**
+			*  @brief
+			*    Gather the data of all dirty slots and update the grid and the sender list accordingly
+			*
+			*  @param[in] gatherFunction
+			*    Function object filling the simulation data from the fire receiver, signature "void(uint32 slot, ComponentData& componentData, uint32 dirtyFlags)";
+			*    "ComponentData::mComponent" is already set and must not be changed
+			*
+			*  @return
+			*    The number of slots gathered
+			*/
+			template <typename GatherFunction>
+			uint32 updateDirtySlots(const GatherFunction& gatherFunction);
+
+			/**
+			*  @brief
+			*    Select the slots needed for the next run, these are the active senders and all receivers inside their soft radius on the xz plane
+			*
+			*  @param[out] slots
+			*    Receives the selected slots in ascending order, cleared before
+			*/
+			inline void selectSlotsForNextRun(std::vector<uint32>& slots);
+
+			/**
+			*  @brief
+			*    Return the simulation data of a slot
+			*/
+			inline const ComponentData& getComponentData(uint32 slot) const;
+
+			inline uint32 getNumberOfRegisteredReceivers() const;
+			inline uint32 getNumberOfActiveSenders() const;
+
+			/**
+			*  @brief
+			*    Remove all slots
+			*/
+			inline void clear();
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			typedef std::unordered_map<uint64, std::vector<uint32>>	CellMap;	///< Packed cell coordinates as key, slots as value
+			typedef std::unordered_map<uint64, std::vector<uint32>>	SlotMap;	///< Entity ID as key, slots of the fire receivers of the entity as value
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline uint32 addSlot(FireReceiverComponent& fireReceiver, uint64 entityId, uint32 componentId);
+			inline void removeSlot(uint32 slot);
+			inline uint64 getCellKey(int32 cellX, int32 cellZ) const;
+			inline int32 getCell(float coordinate) const;
+			inline void removeFromCell(uint32 slot);
+			inline void updateSender(uint32 slot);
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			const float					mCellSize;
+			std::vector<ComponentData>	mComponentData;		///< Simulation data per slot, "mComponent" is a null pointer for free slots
+			std::vector<uint64>			mEntityIds;			///< Entity ID per slot
+			std::vector<uint32>			mComponentIds;		///< Component ID per slot, e.g. "em5::FireComponent::COMPONENT_ID"
+			std::vector<uint32>			mDirtyFlags;		///< Dirty flags per slot
+			std::vector<uint32>			mDirtySlots;		///< Slots with dirty flags set, a slot may be listed more than once after it was reused
+			std::vector<uint32>			mFreeSlots;
+			SlotMap						mSlotsByEntityId;
+
+			// Synchronization
+			std::vector<uint32>			mSynchronizationStamps;	///< Last synchronization each slot was part of
+			uint32						mSynchronizationRun;
+
+			// Spatial lookup
+			CellMap						mCells;
+			std::vector<uint64>			mSlotCells;			///< Key of the cell containing each slot, uninitialized if the slot has no position
+			std::vector<uint32>			mSenderSlots;		///< Slots of the active senders
+			std::vector<uint32>			mSelectionStamps;	///< Last selection run each slot was selected in, to select every slot only once
+			uint32						mSelectionRun;
+
+
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // firesimulation
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/fire/simulation/FireReceiverRegistry-inl.h"
@@ -0,0 +1,256 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <algorithm>
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace firesimulation
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline FireSpreadKernel::FireSpreadKernel() :
+			mNumberOfSenders(0),
+			mCellSize(1.0f),
+			mMinimumCellX(0),
+			mMinimumCellZ(0),
+			mNumberOfCellsX(0),
+			mNumberOfCellsZ(0),
+			mNumberOfPairs(0)
+		{
+			// Nothing here
+		}
+
+		template <typename PairFunction>
+		void FireSpreadKernel::execute(std::vector<ComponentData>& componentList, const PairFunction& pairFunction, qsf::WorkStealingThreadPool& threadPool)
+		{
+			buildSenderGrid(componentList);
+			mNumberOfPairs = 0;
+
+			mReceiverIndices.clear();
+			for (uint32 index = 0; index < static_cast<uint32>(componentList.size()); ++index)
+			{
+				if (isReceiver(componentList[index]))
+				{
+					mReceiverIndices.push_back(index);
+				}
+			}
+			if (0 == mNumberOfSenders)
+			{
+				// Nothing can spread
+				return;
+			}
+
+			threadPool.parallelFor(0, static_cast<uint32>(mReceiverIndices.size()), RECEIVERS_PER_TASK, [this, &componentList, &pairFunction](uint32 firstReceiver, uint32 lastReceiver)
+			{
+				std::vector<uint32> senderIndices;
+				uint64 numberOfPairs = 0;
+				for (uint32 receiver = firstReceiver; receiver < lastReceiver; ++receiver)
+				{
+					const uint32 receiverIndex = mReceiverIndices[receiver];
+					ComponentData& receiverData = componentList[receiverIndex];
+					getSendersAround(receiverData.mPosition, receiverIndex, senderIndices);
+					for (uint32 senderIndex : senderIndices)
+					{
+						pairFunction(static_cast<const ComponentData&>(componentList[senderIndex]), receiverData);
+					}
+					numberOfPairs += senderIndices.size();
+				}
+
+				// Only one atomic operation per task
+				mNumberOfPairs += numberOfPairs;
+			});
+		}
+
+		inline uint32 FireSpreadKernel::getNumberOfSenders() const
+		{
+			return mNumberOfSenders;
+		}
+
+		inline uint32 FireSpreadKernel::getNumberOfReceivers() const
+		{
+			return static_cast<uint32>(mReceiverIndices.size());
+		}
+
+		inline uint64 FireSpreadKernel::getNumberOfPairs() const
+		{
+			return mNumberOfPairs;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline bool FireSpreadKernel::isSender(const ComponentData& componentData)
+		{
+			return (nullptr != componentData.mComponent && componentData.mIsFireSender && componentData.mHasPosition && componentData.mSoftRadius > 0.0f);
+		}
+
+		inline bool FireSpreadKernel::isReceiver(const ComponentData& componentData)
+		{
+			return (nullptr != componentData.mComponent && componentData.mHasPosition);
+		}
+
+		inline void FireSpreadKernel::buildSenderGrid(const std::vector<ComponentData>& componentList)
+		{
+			// Gather the senders in index order
+			std::vector<uint32> senderIndices;
+			float maximumSoftRadius = 0.0f;
+			for (uint32 index = 0; index < static_cast<uint32>(componentList.size()); ++index)
+			{
+				const ComponentData& componentData = componentList[index];
+				if (isSender(componentData))
+				{
+					senderIndices.push_back(index);
+					maximumSoftRadius = std::max(maximumSoftRadius, componentData.mSoftRadius);
+				}
+			}
+
+			mNumberOfSenders = static_cast<uint32>(senderIndices.size());
+			mSenderX.resize(mNumberOfSenders);
+			mSenderZ.resize(mNumberOfSenders);
+			mSenderSoftRadius.resize(mNumberOfSenders);
+			mSenderIndices.resize(mNumberOfSenders);
+			if (senderIndices.empty())
+			{
+				mNumberOfCellsX = mNumberOfCellsZ = 0;
+				mCellStarts.assign(1, 0);
+				return;
+			}
+
+			// A cell size of at least the largest soft radius ensures all senders reaching a receiver are inside the neighbouring cells,
+			// larger cells are used to keep the grid small if the senders are spread wide
+			mCellSize = std::max(maximumSoftRadius, 1.0f);
+			const int64 maximumNumberOfCells = std::max<int64>(1024, 4 * static_cast<int64>(mNumberOfSenders));
+			for (;;)
+			{
+				const glm::vec3& firstPosition = componentList[senderIndices.front()].mPosition;
+				mMinimumCellX = getCellX(firstPosition.x);
+				mMinimumCellZ = getCellZ(firstPosition.z);
+				int32 maximumCellX = mMinimumCellX;
+				int32 maximumCellZ = mMinimumCellZ;
+				for (uint32 senderIndex : senderIndices)
+				{
+					const glm::vec3& position = componentList[senderIndex].mPosition;
+					const int32 cellX = getCellX(position.x);
+					const int32 cellZ = getCellZ(position.z);
+					mMinimumCellX = std::min(mMinimumCellX, cellX);
+					mMinimumCellZ = std::min(mMinimumCellZ, cellZ);
+					maximumCellX = std::max(maximumCellX, cellX);
+					maximumCellZ = std::max(maximumCellZ, cellZ);
+				}
+
+				mNumberOfCellsX = maximumCellX - mMinimumCellX + 1;
+				mNumberOfCellsZ = maximumCellZ - mMinimumCellZ + 1;
+				if (static_cast<int64>(mNumberOfCellsX) * mNumberOfCellsZ <= maximumNumberOfCells)
+				{
+					break;
+				}
+				mCellSize *= 2.0f;
+			}
+
+			// Counting sort of the senders by cell, stable so the senders of each cell stay in index order
+			mCellStarts.assign(static_cast<size_t>(mNumberOfCellsX * mNumberOfCellsZ) + 1, 0);
+			std::vector<uint32> senderCells(mNumberOfSenders);
+			for (uint32 sender = 0; sender < mNumberOfSenders; ++sender)
+			{
+				const glm::vec3& position = componentList[senderIndices[sender]].mPosition;
+				senderCells[sender] = static_cast<uint32>((getCellZ(position.z) - mMinimumCellZ) * mNumberOfCellsX + (getCellX(position.x) - mMinimumCellX));
+				++mCellStarts[senderCells[sender] + 1];
+			}
+			for (size_t cell = 1; cell < mCellStarts.size(); ++cell)
+			{
+				mCellStarts[cell] += mCellStarts[cell - 1];
+			}
+
+			std::vector<uint32> insertPositions(mCellStarts.begin(), mCellStarts.end() - 1);
+			for (uint32 sender = 0; sender < mNumberOfSenders; ++sender)
+			{
+				const ComponentData& componentData = componentList[senderIndices[sender]];
+				const uint32 slot = insertPositions[senderCells[sender]]++;
+				mSenderX[slot] = componentData.mPosition.x;
+				mSenderZ[slot] = componentData.mPosition.z;
+				mSenderSoftRadius[slot] = componentData.mSoftRadius;
+				mSenderIndices[slot] = senderIndices[sender];
+			}
+		}
+
+		inline int32 FireSpreadKernel::getCellX(float x) const
+		{
+			return static_cast<int32>(std::floor(x / mCellSize));
+		}
+
+		inline int32 FireSpreadKernel::getCellZ(float z) const
+		{
+			return static_cast<int32>(std::floor(z / mCellSize));
+		}
+
+		inline void FireSpreadKernel::getSendersAround(const glm::vec3& position, uint32 ignoredIndex, std::vector<uint32>& senderIndices) const
+		{
+			senderIndices.clear();
+
+			const int32 cellX = getCellX(position.x) - mMinimumCellX;
+			const int32 cellZ = getCellZ(position.z) - mMinimumCellZ;
+			const int32 firstCellX = std::max(cellX - 1, 0);
+			const int32 lastCellX = std::min(cellX + 1, mNumberOfCellsX - 1);
+			for (int32 row = std::max(cellZ - 1, 0); row <= std::min(cellZ + 1, mNumberOfCellsZ - 1) && firstCellX <= lastCellX; ++row)
+			{
+				// The neighbouring cells of a row are one contiguous range of senders
+				uint32 sender = mCellStarts[row * mNumberOfCellsX + firstCellX];
+				const uint32 endSender = mCellStarts[row * mNumberOfCellsX + lastCellX + 1];
+
+				#ifdef EM5_FIRE_SPREAD_SSE
+				{
+					const __m128 receiverX = _mm_set1_ps(position.x);
+					const __m128 receiverZ = _mm_set1_ps(position.z);
+					for (; sender + 4 <= endSender; sender += 4)
+					{
+						const __m128 deltaX = _mm_sub_ps(_mm_loadu_ps(&mSenderX[sender]), receiverX);
+						const __m128 deltaZ = _mm_sub_ps(_mm_loadu_ps(&mSenderZ[sender]), receiverZ);
+						const __m128 squaredDistance = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaZ, deltaZ));
+						const __m128 softRadius = _mm_loadu_ps(&mSenderSoftRadius[sender]);
+						const int insideMask = _mm_movemask_ps(_mm_cmple_ps(squaredDistance, _mm_mul_ps(softRadius, softRadius)));
+						for (uint32 lane = 0; 0 != insideMask && lane < 4; ++lane)
+						{
+							if ((insideMask & (1 << lane)) != 0 && mSenderIndices[sender + lane] != ignoredIndex)
+							{
+								senderIndices.push_back(mSenderIndices[sender + lane]);
+							}
+						}
+					}
+				}
+				#endif
+
+				// Remaining senders, the same test as above
+				for (; sender < endSender; ++sender)
+				{
+					const float deltaX = mSenderX[sender] - position.x;
+					const float deltaZ = mSenderZ[sender] - position.z;
+					if (deltaX * deltaX + deltaZ * deltaZ <= mSenderSoftRadius[sender] * mSenderSoftRadius[sender] && mSenderIndices[sender] != ignoredIndex)
+					{
+						senderIndices.push_back(mSenderIndices[sender]);
+					}
+				}
+			}
+
+			// Cells are sorted by position, not by index
+			std::sort(senderIndices.begin(), senderIndices.end());
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // firesimulation
+} // em5
@@ -0,0 +1,173 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "em5/fire/simulation/FireSpreadCalculation.h"
+
+#include <qsf/worker/WorkStealingThreadPool.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#include <xmmintrin.h>
+	#define EM5_FIRE_SPREAD_SSE
+#endif
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace firesimulation
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Data-parallel kernel finding the fire sender/receiver pairs close enough for fire energy to spread
+		*
+		*  @remarks
+		*    The kernel doesn't know how much energy a sender delivers, this is up to the pair function given by the caller.
+		*    It only replaces the test of all sender/receiver pairs by a uniform grid of the senders on the xz plane:
+		*    the senders are copied into a structure of arrays sorted by grid cell, the cell size is at least the largest soft radius,
+		*    so all senders reaching a receiver are found in the 3x3 cells around it, which are three contiguous ranges of senders.
+		*    A pair is passed on if the horizontal distance is not above the soft radius of the sender; this never drops a pair
+		*    the pair function would accept with a two- or three-dimensional distance test, the pair function does the exact test.
+		*    With SSE four senders are culled at once, the culling is exact so this doesn't change which pairs are passed on.
+		*
+		*    The receivers are processed in parallel on a work stealing thread pool, each receiver is handled by exactly one thread.
+		*    The pairs of a receiver are passed in ascending sender index, so sums built by the pair function are identical to
+		*    the ones of a pairwise loop over the component list, independent of the grid, SSE and the number of threads.
+		*
+		*    Senders are entries with a component, a position and a soft radius above zero which are marked as fire sender,
+		*    receivers are all entries with a component and a position; entries without a position (complex fire components)
+		*    are not handled at all and need to be treated by the caller.
+		*/
+		class FireSpreadKernel : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			static const uint32 RECEIVERS_PER_TASK = 64;	///< Grain size when splitting the receivers across the thread pool
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Default constructor
+			*/
+			inline FireSpreadKernel();
+
+			/**
+			*  @brief
+			*    Call the pair function for all sender/receiver pairs inside the soft radius of the sender
+			*
+			*  @param[in, out] componentList
+			*    Data of all fire senders and receivers, must not be changed by anyone else during the execution
+			*  @param[in] pairFunction
+			*    Function object to call, signature "void(const ComponentData& sender, ComponentData& receiver)"; is called concurrently for different receivers,
+			*    it may only write to the receiver and must not read "ComponentData::mCalculatedSpreadEnergy" and "ComponentData::mSource" of the sender
+			*  @param[in] threadPool
+			*    Thread pool to process the receivers on, usually the one owned by the plugin
+			*/
+			template <typename PairFunction>
+			void execute(std::vector<ComponentData>& componentList, const PairFunction& pairFunction, qsf::WorkStealingThreadPool& threadPool);
+
+			/**
+			*  @brief
+			*    Return the number of senders found during the last execution
+			*/
+			inline uint32 getNumberOfSenders() const;
+
+			/**
+			*  @brief
+			*    Return the number of receivers processed during the last execution
+			*/
+			inline uint32 getNumberOfReceivers() const;
+
+			/**
+			*  @brief
+			*    Return the number of pairs passed to the pair function during the last execution
+			*/
+			inline uint64 getNumberOfPairs() const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline static bool isSender(const ComponentData& componentData);
+			inline static bool isReceiver(const ComponentData& componentData);
+
+			inline void buildSenderGrid(const std::vector<ComponentData>& componentList);
+			inline int32 getCellX(float x) const;
+			inline int32 getCellZ(float z) const;
+
+			/**
+			*  @brief
+			*    Write the component list indices of all senders reaching the position in ascending order, except the given index
+			*/
+			inline void getSendersAround(const glm::vec3& position, uint32 ignoredIndex, std::vector<uint32>& senderIndices) const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			// Senders as structure of arrays, sorted by grid cell and by index inside each cell
+			std::vector<float>	mSenderX;
+			std::vector<float>	mSenderZ;
+			std::vector<float>	mSenderSoftRadius;
+			std::vector<uint32>	mSenderIndices;		///< Index inside the component list
+			uint32				mNumberOfSenders;
+
+			// Uniform grid on the xz plane
+			float				mCellSize;
+			int32				mMinimumCellX;
+			int32				mMinimumCellZ;
+			int32				mNumberOfCellsX;
+			int32				mNumberOfCellsZ;
+			std::vector<uint32>	mCellStarts;		///< Index of the first sender per cell in row major order, with one additional entry at the end
+
+			// Receivers to process
+			std::vector<uint32>	mReceiverIndices;	///< Index inside the component list
+			std::atomic<uint64>	mNumberOfPairs;
+
+
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // firesimulation
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/fire/simulation/FireSpreadKernel-inl.h"
@@ -0,0 +1,231 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "em5/fire/component/FireComponent.h"
+#include "em5/fire/component/FireReceiverComponent.h"
+#include "em5/fire/FireSystem.h"
+#include "em5/plugin/Messages.h"
+#include "em5/EM5Helper.h"
+
+#include <qsf/component/base/TransformComponent.h>
+#include <qsf/debug/request/TextDebugDrawRequest.h>
+#include <qsf/job/JobArguments.h>
+#include <qsf/map/Map.h>
+#include <qsf/map/query/ComponentMapQuery.h>
+#include <qsf/message/MessageConfiguration.h>
+#include <qsf/message/MessageParameters.h>
+#include <qsf/time/HighResolutionStopwatch.h>
+#include <qsf/QsfHelper.h>
+
+#include <boost/bind.hpp>
+
+#include <sstream>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace firesimulation
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline FireSpreadMonitor::FireSpreadMonitor(qsf::Map& map, qsf::WorkStealingThreadPool& threadPool, qsf::Time interval, const qsf::StringHash& jobManagerId) :
+			mMap(map),
+			mThreadPool(threadPool),
+			mInterval(interval)
+		{
+			mJobProxy.registerAt(jobManagerId, boost::bind(&FireSpreadMonitor::updateJob, this, _1));
+			mStartBurningMessageProxy.registerAt(qsf::MessageConfiguration(Messages::EM5_FIRECOMPONENT_START_BURNING), boost::bind(&FireSpreadMonitor::onBurningStateChanged, this, _1));
+			mStopBurningMessageProxy.registerAt(qsf::MessageConfiguration(Messages::EM5_FIRECOMPONENT_STOP_BURNING), boost::bind(&FireSpreadMonitor::onBurningStateChanged, this, _1));
+		}
+
+		inline FireSpreadMonitor::~FireSpreadMonitor()
+		{
+			mJobProxy.unregister();
+			mStartBurningMessageProxy.unregister();
+			mStopBurningMessageProxy.unregister();
+			mDebugDrawProxy.unregister();
+		}
+
+		inline void FireSpreadMonitor::run()
+		{
+			qsf::HighResolutionStopwatch stopwatch;
+
+			// Add new and remove vanished receivers, mark moved ones
+			mRegistry.beginSynchronization();
+			const qsf::ComponentMapQuery componentMapQuery(mMap);
+			for (FireReceiverComponent* fireReceiverComponent : componentMapQuery.getAllInstances<FireReceiverComponent>())
+			{
+				if (fireReceiverComponent->isActive())
+				{
+					synchronizeFireReceiver(*fireReceiverComponent, nullptr);
+				}
+			}
+			for (FireComponent* fireComponent : componentMapQuery.getAllInstances<FireComponent>())
+			{
+				if (fireComponent->isActive())
+				{
+					synchronizeFireReceiver(*fireComponent, fireComponent);
+				}
+			}
+			mRegistry.endSynchronization();
+
+			// The fire energy of burning fire components changes all the time
+			mRegistry.markActiveSendersDirty(FireReceiverRegistry::DIRTY_BURNING_STATE);
+			mStatistics.mNumberOfGatheredReceivers = mRegistry.updateDirtySlots([this](uint32 slot, ComponentData& componentData, uint32 dirtyFlags)
+			{
+				gatherComponentData(slot, componentData, dirtyFlags);
+			});
+
+			// Only the senders and the receivers near them can be reached
+			mRegistry.selectSlotsForNextRun(mSelectedSlots);
+			mComponentData.clear();
+			for (uint32 slot : mSelectedSlots)
+			{
+				mComponentData.push_back(mRegistry.getComponentData(slot));
+			}
+
+			// A receiver is reached by the first sender in index order, the kernel passes the pairs in this order
+			mSpreadKernel.execute(mComponentData, [](const ComponentData& sender, ComponentData& receiver)
+			{
+				if (nullptr == receiver.mSource)
+				{
+					receiver.mSource = &sender;
+				}
+			}, mThreadPool);
+
+			mReachedEntityIds.clear();
+			for (const ComponentData& componentData : mComponentData)
+			{
+				if (nullptr != componentData.mSource && !componentData.mIsBurning && !componentData.mIsDestroyed)
+				{
+					mReachedEntityIds.push_back(componentData.mComponent->getEntityId());
+				}
+			}
+
+			mStatistics.mNumberOfRegisteredReceivers = mRegistry.getNumberOfRegisteredReceivers();
+			mStatistics.mNumberOfSenders = mSpreadKernel.getNumberOfSenders();
+			mStatistics.mNumberOfEvaluatedReceivers = static_cast<uint32>(mComponentData.size());
+			mStatistics.mNumberOfReachedReceivers = static_cast<uint32>(mReachedEntityIds.size());
+			mStatistics.mNumberOfPairs = mSpreadKernel.getNumberOfPairs();
+			mStatistics.mCalculationTime = stopwatch.getElapsed();
+		}
+
+		inline const std::vector<uint64>& FireSpreadMonitor::getReachedEntityIds() const
+		{
+			return mReachedEntityIds;
+		}
+
+		inline const FireSpreadMonitor::Statistics& FireSpreadMonitor::getStatistics() const
+		{
+			return mStatistics;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline void FireSpreadMonitor::updateJob(const qsf::JobArguments& jobArguments)
+		{
+			mTimeSinceLastRun += jobArguments.getTimePassed();
+			if (mTimeSinceLastRun >= mInterval)
+			{
+				mTimeSinceLastRun = qsf::Time::ZERO;
+				run();
+			}
+			updateDebugDraw();
+		}
+
+		inline void FireSpreadMonitor::onBurningStateChanged(const qsf::MessageParameters& parameters)
+		{
+			mRegistry.markDirty(parameters.getFilter(1), FireReceiverRegistry::DIRTY_BURNING_STATE);
+		}
+
+		inline void FireSpreadMonitor::synchronizeFireReceiver(FireReceiverComponent& fireReceiver, FireComponent* fireComponent)
+		{
+			const uint32 slot = mRegistry.synchronizeFireReceiver(fireReceiver);
+			if (slot >= mSlotCaches.size())
+			{
+				mSlotCaches.resize(slot + 1, SlotCache());
+			}
+
+			SlotCache& slotCache = mSlotCaches[slot];
+			slotCache.mFireComponent = fireComponent;
+			if (slotCache.mComponent != &fireReceiver)
+			{
+				slotCache.mComponent = &fireReceiver;
+				slotCache.mTransformComponent = nullptr;
+				mRegistry.markSlotDirty(slot, FireReceiverRegistry::DIRTY_ALL);
+			}
+			else if (nullptr != slotCache.mTransformComponent && slotCache.mTransformComponent->getPosition() != mRegistry.getComponentData(slot).mPosition)
+			{
+				mRegistry.markSlotDirty(slot, FireReceiverRegistry::DIRTY_TRANSFORM);
+			}
+		}
+
+		inline void FireSpreadMonitor::gatherComponentData(uint32 slot, ComponentData& componentData, uint32 dirtyFlags)
+		{
+			SlotCache& slotCache = mSlotCaches[slot];
+			if (dirtyFlags & FireReceiverRegistry::DIRTY_TRANSFORM)
+			{
+				slotCache.mTransformComponent = slotCache.mComponent->getTransformComponent();
+				componentData.mHasPosition = (nullptr != slotCache.mTransformComponent);
+				if (componentData.mHasPosition)
+				{
+					componentData.mPosition = slotCache.mTransformComponent->getPosition();
+				}
+			}
+
+			if (dirtyFlags & FireReceiverRegistry::DIRTY_BURNING_STATE)
+			{
+				componentData.mIsBurning = slotCache.mComponent->isBurning();
+				const FireComponent* fireComponent = slotCache.mFireComponent;
+				if (nullptr != fireComponent)
+				{
+					// Burning fire components are the senders, fire receivers don't send energy
+					componentData.mIsFireSender = componentData.mIsBurning;
+					componentData.mIsDestroyed = fireComponent->isBurned();
+					componentData.mHardRadius = fireComponent->getHardRadius();
+					componentData.mSoftRadius = fireComponent->getSoftRadius();
+					componentData.mFireEnergy = fireComponent->getEnergy();
+					componentData.mFireResistance = fireComponent->getFireResistance();
+				}
+			}
+		}
+
+		inline void FireSpreadMonitor::updateDebugDraw()
+		{
+			if (FireSystem::SimulationVisualisationMode::SHOW_NONE == EM5_FIRE.getFireSpreadSimulationVisualisationMode())
+			{
+				mDebugDrawProxy.unregister();
+				return;
+			}
+
+			if (!mDebugDrawProxy.isValid())
+			{
+				mDebugDrawProxy.registerAt(QSF_DEBUGDRAW);
+			}
+			mDebugDrawProxy.clearRequests();
+
+			std::ostringstream text;
+			text << "Fire spread: " << mStatistics.mNumberOfRegisteredReceivers << " receivers, " << mStatistics.mNumberOfGatheredReceivers << " gathered, "
+				 << mStatistics.mNumberOfSenders << " senders, " << mStatistics.mNumberOfEvaluatedReceivers << " evaluated, "
+				 << mStatistics.mNumberOfPairs << " pairs, " << mStatistics.mNumberOfReachedReceivers << " reached, "
+				 << mStatistics.mCalculationTime.getMicroseconds() << " us";
+			mDebugDrawProxy.addRequest(qsf::TextDebugDrawRequest(text.str(), glm::vec2(10.0f, 100.0f)));
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // firesimulation
+} // em5
@@ -0,0 +1,212 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "em5/fire/simulation/FireReceiverRegistry.h"
+#include "em5/fire/simulation/FireSpreadKernel.h"
+#include "em5/plugin/Jobs.h"
+
+#include <qsf/debug/DebugDrawProxy.h>
+#include <qsf/job/JobProxy.h>
+#include <qsf/message/MessageProxy.h>
+#include <qsf/time/Time.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Map;
+	class JobArguments;
+	class MessageParameters;
+	class TransformComponent;
+}
+namespace em5
+{
+	class FireComponent;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace firesimulation
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Regularly finds the fire receivers inside the soft radius of a burning fire component
+		*
+		*  @remarks
+		*    The monitor keeps the data of all fire receivers and fire components of a map in a fire receiver registry and runs the fire spread kernel on it.
+		*    A receiver is reached if it's inside the soft radius of at least one burning fire component, this is where the fire can spread to next.
+		*    How much energy is delivered is not evaluated, this is done by the fire spread calculation of the fire system which isn't changed by the monitor.
+		*
+		*    The data is kept up to date incrementally, per run only changed data is gathered again:
+		*    - burning state changes are taken from the "EM5_FIRECOMPONENT_START_BURNING" and "EM5_FIRECOMPONENT_STOP_BURNING" messages
+		*    - positions are compared with the cached transform components, only moved receivers are gathered and binned again
+		*    - burning fire components are gathered each run since their fire energy changes all the time
+		*    Only the burning fire components and the receivers inside their soft radius are passed to the kernel.
+		*
+		*    While the fire spread simulation visualisation of the fire system is active, the counters of the last run are shown as debug text.
+		*
+		*    The monitor registers a job on construction, so owning an instance is all that's needed. Usage, e.g. inside a plugin during the simulation:
+		*    @code
+		*      mFireSpreadMonitor.reset(new em5::firesimulation::FireSpreadMonitor(QSF_MAINMAP, *mThreadPool));
+		*      ...
+		*      for (uint64 entityId : mFireSpreadMonitor->getReachedEntityIds())
+		*        ...
+		*    @endcode
+		*/
+		class FireSpreadMonitor : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			// Counters of the last run
+			struct Statistics
+			{
+				uint32		mNumberOfRegisteredReceivers;	///< Active fire receivers and fire components inside the registry
+				uint32		mNumberOfGatheredReceivers;		///< Receivers whose data was gathered again
+				uint32		mNumberOfSenders;				///< Burning fire components
+				uint32		mNumberOfEvaluatedReceivers;	///< Receivers passed to the kernel, these are the senders and the receivers near them
+				uint32		mNumberOfReachedReceivers;		///< Receivers neither burning nor burned inside the soft radius of a sender
+				uint64		mNumberOfPairs;					///< Sender/receiver pairs inside the soft radius
+				qsf::Time	mCalculationTime;				///< Time needed for updating the registry and running the kernel
+
+				inline Statistics() :
+					mNumberOfRegisteredReceivers(0),
+					mNumberOfGatheredReceivers(0),
+					mNumberOfSenders(0),
+					mNumberOfEvaluatedReceivers(0),
+					mNumberOfReachedReceivers(0),
+					mNumberOfPairs(0)
+				{}
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Constructor, registers the monitoring job
+			*
+			*  @param[in] map
+			*    Map to monitor, must stay valid as long as the monitor exists
+			*  @param[in] threadPool
+			*    Thread pool to run the fire spread kernel on, usually the one owned by the plugin; must stay valid as long as the monitor exists
+			*  @param[in] interval
+			*    Time between two runs
+			*  @param[in] jobManagerId
+			*    Job manager to register the monitoring job at
+			*/
+			inline FireSpreadMonitor(qsf::Map& map, qsf::WorkStealingThreadPool& threadPool, qsf::Time interval = qsf::Time::fromSeconds(1.0f), const qsf::StringHash& jobManagerId = Jobs::SIMULATION_FIRE);
+
+			/**
+			*  @brief
+			*    Destructor, the job and the message listeners are unregistered
+			*/
+			inline ~FireSpreadMonitor();
+
+			/**
+			*  @brief
+			*    Update the registry and find the reached receivers right away
+			*/
+			inline void run();
+
+			/**
+			*  @brief
+			*    Return the entity IDs of the receivers reached during the last run, in the order of the gathered components
+			*/
+			inline const std::vector<uint64>& getReachedEntityIds() const;
+
+			/**
+			*  @brief
+			*    Return the counters of the last run
+			*/
+			inline const Statistics& getStatistics() const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			// Component pointers per registry slot, only valid while the slot belongs to the component
+			struct SlotCache
+			{
+				FireReceiverComponent*			mComponent;
+				FireComponent*					mFireComponent;			///< Null pointer for plain fire receivers
+				const qsf::TransformComponent*	mTransformComponent;	///< Refetched each time the transform is gathered
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline void updateJob(const qsf::JobArguments& jobArguments);
+			inline void onBurningStateChanged(const qsf::MessageParameters& parameters);
+			inline void synchronizeFireReceiver(FireReceiverComponent& fireReceiver, FireComponent* fireComponent);
+			inline void gatherComponentData(uint32 slot, ComponentData& componentData, uint32 dirtyFlags);
+			inline void updateDebugDraw();
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			qsf::Map&					mMap;
+			qsf::WorkStealingThreadPool&	mThreadPool;		///< Not owned, runs the fire spread kernel
+			const qsf::Time				mInterval;
+			qsf::Time					mTimeSinceLastRun;
+			FireReceiverRegistry		mRegistry;
+			std::vector<SlotCache>		mSlotCaches;
+			std::vector<uint32>			mSelectedSlots;		///< Registry slots selected for the run, kept to avoid reallocations
+			std::vector<ComponentData>	mComponentData;		///< Data of the selected slots passed to the kernel
+			FireSpreadKernel			mSpreadKernel;
+			std::vector<uint64>			mReachedEntityIds;
+			Statistics					mStatistics;
+			qsf::JobProxy				mJobProxy;			///< Regular job calling "run()" after each interval
+			qsf::MessageProxy			mStartBurningMessageProxy;
+			qsf::MessageProxy			mStopBurningMessageProxy;
+			qsf::DebugDrawProxy			mDebugDrawProxy;	///< Shows the counters during the fire spread simulation visualisation
+
+
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // firesimulation
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/fire/simulation/FireSpreadMonitor-inl.h"
@@ -0,0 +1,121 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/base/GetUninitialized.h>
+#include <qsf/time/HighResolutionStopwatch.h>
+
+#include <algorithm>
+#include <ostream>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline ReplayFastForward::ReplayFastForward(ReplayFileReader& reader, const ApplyRecordCallback& applyRecordCallback) :
+			mReader(reader),
+			mApplyRecordCallback(applyRecordCallback)
+		{
+			// Nothing to do in here
+		}
+
+		inline uint32 ReplayFastForward::run(int64 startTimeInMilliseconds, int64 endTimeInMilliseconds)
+		{
+			mFrameTimings.clear();
+			if (!mReader.isValid() || !mApplyRecordCallback)
+			{
+				return 0;
+			}
+			mFrameTimings.reserve(mReader.getNumberOfRecords());
+
+			// Start at a keyframe, otherwise the cache would receive changes without the state they are based on
+			const uint32 keyframeIndex = mReader.seekToKeyframe(startTimeInMilliseconds);
+			uint32 recordIndex = qsf::isInitialized(keyframeIndex) ? mReader.getKeyframes()[keyframeIndex].mRecordIndex : 0;
+
+			qsf::HighResolutionStopwatch stopwatch(false);
+			while (mReader.readNextRecord(mRecord) && mRecord.mTime <= endTimeInMilliseconds)
+			{
+				if (mRecord.mTime < startTimeInMilliseconds)
+				{
+					// Catch up to the start time without measuring
+					mApplyRecordCallback(mRecord);
+				}
+				else
+				{
+					stopwatch.start();
+					mApplyRecordCallback(mRecord);
+					const FrameTiming frameTiming = { recordIndex, mRecord.mTime, mRecord.mNumberOfBits, stopwatch.stop() };
+					mFrameTimings.push_back(frameTiming);
+				}
+				++recordIndex;
+			}
+
+			return static_cast<uint32>(mFrameTimings.size());
+		}
+
+		inline const std::vector<ReplayFastForward::FrameTiming>& ReplayFastForward::getFrameTimings() const
+		{
+			return mFrameTimings;
+		}
+
+		inline ReplayFastForward::Summary ReplayFastForward::getSummary() const
+		{
+			Summary summary;
+			if (mFrameTimings.empty())
+			{
+				return summary;
+			}
+
+			std::vector<int64> microseconds;
+			microseconds.reserve(mFrameTimings.size());
+			for (const FrameTiming& frameTiming : mFrameTimings)
+			{
+				summary.mNumberOfBits += frameTiming.mNumberOfBits;
+				summary.mTotalTime += frameTiming.mApplyTime;
+				microseconds.push_back(frameTiming.mApplyTime.getMicroseconds());
+			}
+			std::sort(microseconds.begin(), microseconds.end());
+
+			// Nearest rank percentiles
+			const size_t numberOfFrames = microseconds.size();
+			const auto getPercentile = [&microseconds, numberOfFrames](size_t percent)
+			{
+				const size_t rank = (percent * numberOfFrames + 99) / 100;
+				return qsf::Time::fromMicroseconds(microseconds[std::max<size_t>(rank, 1) - 1]);
+			};
+
+			summary.mNumberOfFrames = static_cast<uint32>(numberOfFrames);
+			summary.mAverageTime = qsf::Time::fromMicroseconds(summary.mTotalTime.getMicroseconds() / static_cast<int64>(numberOfFrames));
+			summary.mMedianTime = getPercentile(50);
+			summary.mPercentile95Time = getPercentile(95);
+			summary.mPercentile99Time = getPercentile(99);
+			summary.mMaximumTime = qsf::Time::fromMicroseconds(microseconds.back());
+			return summary;
+		}
+
+		inline void ReplayFastForward::writeCsv(std::ostream& stream) const
+		{
+			stream << "record,time_ms,bits,apply_us\n";
+			for (const FrameTiming& frameTiming : mFrameTimings)
+			{
+				stream << frameTiming.mRecordIndex << ',' << frameTiming.mTime << ',' << frameTiming.mNumberOfBits << ',' << frameTiming.mApplyTime.getMicroseconds() << '\n';
+			}
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
@@ -0,0 +1,157 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "em5/network/multiplayer/ReplayFile.h"
+
+#include <qsf/time/Time.h>
+
+#include <boost/function.hpp>
+
+#include <limits>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Headless replay of a recorded multiplayer session as fast as possible, measuring the time needed per record
+		*
+		*  @remarks
+		*    No job or timer is involved, the records are applied back to back through the callback. The callback is up to the caller,
+		*    "DataPlayer" and the client don't use this class. To benchmark the client side data cache, the callback builds a
+		*    "qsf::game::BitStream" from the record data and hands it to "MapCache::applyChanges()", the same way the client handles a live update.
+		*
+		*    Example:
+		*    @code
+		*    em5::multiplayer::ReplayFileReader reader("session.em5replay");
+		*    em5::multiplayer::ReplayFastForward fastForward(reader, applyRecordCallback);
+		*    fastForward.run();
+		*    fastForward.writeCsv(csvStream);
+		*    @endcode
+		*/
+		class ReplayFastForward : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			typedef boost::function<void(const ReplayRecord& record)> ApplyRecordCallback;
+
+			struct FrameTiming
+			{
+				uint32		mRecordIndex;	///< Index of the record inside the replay file
+				int64		mTime;			///< Recorded time in milliseconds
+				uint32		mNumberOfBits;	///< Size of the record data
+				qsf::Time	mApplyTime;		///< Time needed by the callback
+			};
+
+			struct Summary
+			{
+				uint32		mNumberOfFrames;
+				uint64		mNumberOfBits;
+				qsf::Time	mTotalTime;
+				qsf::Time	mAverageTime;
+				qsf::Time	mMedianTime;
+				qsf::Time	mPercentile95Time;
+				qsf::Time	mPercentile99Time;
+				qsf::Time	mMaximumTime;
+
+				inline Summary() :
+					mNumberOfFrames(0),
+					mNumberOfBits(0)
+				{}
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Constructor
+			*
+			*  @param[in] reader
+			*    The replay to play back, must stay valid as long as this instance exists
+			*  @param[in] applyRecordCallback
+			*    Gets called for each record
+			*/
+			inline ReplayFastForward(ReplayFileReader& reader, const ApplyRecordCallback& applyRecordCallback);
+
+			/**
+			*  @brief
+			*    Apply the records up to the given end time
+			*
+			*  @param[in] startTimeInMilliseconds
+			*    Playback starts at the last keyframe before this time; records between the keyframe and the start time are applied without being measured
+			*  @param[in] endTimeInMilliseconds
+			*    Records after this time are not applied
+			*
+			*  @return
+			*    Number of measured records
+			*
+			*  @note
+			*    - The timings of a previous run are discarded
+			*/
+			inline uint32 run(int64 startTimeInMilliseconds = 0, int64 endTimeInMilliseconds = std::numeric_limits<int64>::max());
+
+			inline const std::vector<FrameTiming>& getFrameTimings() const;
+
+			/**
+			*  @brief
+			*    Return total, average and percentile times of the last run
+			*/
+			inline Summary getSummary() const;
+
+			/**
+			*  @brief
+			*    Write the frame timings of the last run as CSV, one line per record
+			*/
+			inline void writeCsv(std::ostream& stream) const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			ReplayFileReader&			mReader;
+			ApplyRecordCallback			mApplyRecordCallback;
+			ReplayRecord				mRecord;			///< Reused for each record to avoid reallocations
+			std::vector<FrameTiming>	mFrameTimings;
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/network/multiplayer/ReplayFastForward-inl.h"
@@ -0,0 +1,381 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf_game/network/BitStream.h>
+
+#include <qsf/base/GetUninitialized.h>
+#include <qsf/time/Time.h>
+
+#include <algorithm>
+#include <fstream>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+		namespace detail
+		{
+
+
+			//[-------------------------------------------------------]
+			//[ Global functions                                      ]
+			//[-------------------------------------------------------]
+			// Values are stored in the native byte order, replay files are not meant to be exchanged between platforms
+			template<typename T>
+			inline void writeReplayValue(std::ostream& stream, T value)
+			{
+				stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+			}
+
+			template<typename T>
+			inline bool readReplayValue(std::istream& stream, T& value)
+			{
+				stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+				return !stream.fail();
+			}
+
+
+		} // detail
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline ReplayFileWriter::ReplayFileWriter(const std::string& fileName, int64 keyframeIntervalInMilliseconds) :
+			mStream(new std::ofstream(fileName, std::ios::out | std::ios::binary | std::ios::trunc)),
+			mKeyframeInterval(keyframeIntervalInMilliseconds),
+			mLastKeyframeTime(qsf::getUninitialized<int64>()),
+			mLastRecordTime(0),
+			mNumberOfRecords(0)
+		{
+			writeHeader();
+		}
+
+		inline ReplayFileWriter::ReplayFileWriter(std::unique_ptr<std::ostream> stream, int64 keyframeIntervalInMilliseconds) :
+			mStream(std::move(stream)),
+			mKeyframeInterval(keyframeIntervalInMilliseconds),
+			mLastKeyframeTime(qsf::getUninitialized<int64>()),
+			mLastRecordTime(0),
+			mNumberOfRecords(0)
+		{
+			writeHeader();
+		}
+
+		inline ReplayFileWriter::~ReplayFileWriter()
+		{
+			close();
+		}
+
+		inline bool ReplayFileWriter::isValid() const
+		{
+			return (nullptr != mStream && mStream->good());
+		}
+
+		inline bool ReplayFileWriter::isKeyframeDue(int64 timeInMilliseconds) const
+		{
+			return (qsf::isUninitialized(mLastKeyframeTime) || timeInMilliseconds - mLastKeyframeTime >= mKeyframeInterval);
+		}
+
+		inline void ReplayFileWriter::writeRecord(int64 timeInMilliseconds, const uint8* data, uint32 numberOfBits, bool isKeyframe)
+		{
+			if (!isValid())
+			{
+				return;
+			}
+
+			if (isKeyframe)
+			{
+				const ReplayKeyframe keyframe = { timeInMilliseconds, static_cast<uint64>(mStream->tellp()), mNumberOfRecords };
+				mKeyframes.push_back(keyframe);
+				mLastKeyframeTime = timeInMilliseconds;
+			}
+
+			const uint8 flags = (isKeyframe ? RECORD_FLAG_KEYFRAME : 0);
+			detail::writeReplayValue(*mStream, flags);
+			detail::writeReplayValue(*mStream, timeInMilliseconds);
+			detail::writeReplayValue(*mStream, numberOfBits);
+			mStream->write(reinterpret_cast<const char*>(data), (numberOfBits + 7) / 8);
+
+			mLastRecordTime = timeInMilliseconds;
+			++mNumberOfRecords;
+		}
+
+		inline void ReplayFileWriter::recordData(const qsf::Time& timePassedSinceStart, const qsf::game::BitStream& bitStream, bool isKeyframe)
+		{
+			mBuffer.clear();
+			bitStream.serializeToBuffer(mBuffer);
+			writeRecord(timePassedSinceStart.getMilliseconds(), reinterpret_cast<const uint8*>(mBuffer.data()), static_cast<uint32>(bitStream.getBitLength()), isKeyframe);
+		}
+
+		inline void ReplayFileWriter::close()
+		{
+			if (nullptr == mStream)
+			{
+				return;
+			}
+
+			if (mStream->good())
+			{
+				const uint64 indexOffset = static_cast<uint64>(mStream->tellp());
+				detail::writeReplayValue(*mStream, static_cast<uint32>(mKeyframes.size()));
+				for (const ReplayKeyframe& keyframe : mKeyframes)
+				{
+					detail::writeReplayValue(*mStream, keyframe.mTime);
+					detail::writeReplayValue(*mStream, keyframe.mFileOffset);
+					detail::writeReplayValue(*mStream, keyframe.mRecordIndex);
+				}
+				detail::writeReplayValue(*mStream, mNumberOfRecords);
+				detail::writeReplayValue(*mStream, mLastRecordTime);
+				detail::writeReplayValue(*mStream, indexOffset);
+				detail::writeReplayValue(*mStream, INDEX_MAGIC);
+				mStream->flush();
+			}
+			mStream.reset();
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline void ReplayFileWriter::writeHeader()
+		{
+			if (nullptr != mStream)
+			{
+				detail::writeReplayValue(*mStream, FILE_MAGIC);
+				detail::writeReplayValue(*mStream, FORMAT_VERSION);
+			}
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline ReplayFileReader::ReplayFileReader(const std::string& fileName) :
+			mStream(new std::ifstream(fileName, std::ios::in | std::ios::binary)),
+			mValid(false),
+			mFirstRecordOffset(0),
+			mEndOfRecordsOffset(0),
+			mNumberOfRecords(0),
+			mDuration(0)
+		{
+			open();
+		}
+
+		inline ReplayFileReader::ReplayFileReader(std::unique_ptr<std::istream> stream) :
+			mStream(std::move(stream)),
+			mValid(false),
+			mFirstRecordOffset(0),
+			mEndOfRecordsOffset(0),
+			mNumberOfRecords(0),
+			mDuration(0)
+		{
+			open();
+		}
+
+		inline bool ReplayFileReader::isValid() const
+		{
+			return mValid;
+		}
+
+		inline const std::vector<ReplayKeyframe>& ReplayFileReader::getKeyframes() const
+		{
+			return mKeyframes;
+		}
+
+		inline uint32 ReplayFileReader::getNumberOfRecords() const
+		{
+			return mNumberOfRecords;
+		}
+
+		inline int64 ReplayFileReader::getDuration() const
+		{
+			return mDuration;
+		}
+
+		inline bool ReplayFileReader::readNextRecord(ReplayRecord& record)
+		{
+			if (!mValid || mStream->fail() || static_cast<uint64>(mStream->tellg()) >= mEndOfRecordsOffset)
+			{
+				return false;
+			}
+
+			uint8 flags = 0;
+			if (!detail::readReplayValue(*mStream, flags) || !detail::readReplayValue(*mStream, record.mTime) || !detail::readReplayValue(*mStream, record.mNumberOfBits))
+			{
+				return false;
+			}
+			record.mIsKeyframe = (0 != (flags & ReplayFileWriter::RECORD_FLAG_KEYFRAME));
+
+			// The number of bits comes from the file, never allocate more than is left of the records
+			const uint64 numberOfBytes = (static_cast<uint64>(record.mNumberOfBits) + 7) / 8;
+			const uint64 dataOffset = static_cast<uint64>(mStream->tellg());
+			if (dataOffset > mEndOfRecordsOffset || numberOfBytes > mEndOfRecordsOffset - dataOffset)
+			{
+				return false;
+			}
+
+			record.mData.resize(static_cast<size_t>(numberOfBytes));
+			if (!record.mData.empty())
+			{
+				mStream->read(reinterpret_cast<char*>(record.mData.data()), record.mData.size());
+			}
+			return !mStream->fail();
+		}
+
+		inline uint32 ReplayFileReader::seekToKeyframe(int64 timeInMilliseconds)
+		{
+			// Find the last keyframe not after the given time, the keyframes are sorted by time
+			const auto iterator = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), timeInMilliseconds,
+				[](int64 time, const ReplayKeyframe& keyframe) { return time < keyframe.mTime; });
+
+			if (iterator == mKeyframes.begin())
+			{
+				rewind();
+				return qsf::getUninitialized<uint32>();
+			}
+
+			const ReplayKeyframe& keyframe = *(iterator - 1);
+			mStream->clear();
+			mStream->seekg(static_cast<std::streamoff>(keyframe.mFileOffset));
+			return static_cast<uint32>(iterator - 1 - mKeyframes.begin());
+		}
+
+		inline void ReplayFileReader::rewind()
+		{
+			if (mValid)
+			{
+				mStream->clear();
+				mStream->seekg(static_cast<std::streamoff>(mFirstRecordOffset));
+			}
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline void ReplayFileReader::open()
+		{
+			if (nullptr == mStream || !mStream->good())
+			{
+				return;
+			}
+
+			uint32 magic = 0;
+			uint32 version = 0;
+			if (!detail::readReplayValue(*mStream, magic) || !detail::readReplayValue(*mStream, version) ||
+				ReplayFileWriter::FILE_MAGIC != magic || version > ReplayFileWriter::FORMAT_VERSION)
+			{
+				return;
+			}
+			mFirstRecordOffset = static_cast<uint64>(mStream->tellg());
+			mValid = true;
+
+			if (!readIndex())
+			{
+				// The index is missing or broken, e.g. the recording wasn't closed properly
+				rebuildIndex();
+			}
+			rewind();
+		}
+
+		inline bool ReplayFileReader::readIndex()
+		{
+			// The trailer is the index offset followed by the index magic
+			const std::streamoff trailerSize = sizeof(uint64) + sizeof(uint32);
+			mStream->clear();
+			mStream->seekg(0, std::ios::end);
+			const std::streamoff fileSize = mStream->tellg();
+			if (fileSize < static_cast<std::streamoff>(mFirstRecordOffset) + trailerSize)
+			{
+				return false;
+			}
+
+			uint64 indexOffset = 0;
+			uint32 magic = 0;
+			mStream->seekg(fileSize - trailerSize);
+			if (!detail::readReplayValue(*mStream, indexOffset) || !detail::readReplayValue(*mStream, magic) ||
+				ReplayFileWriter::INDEX_MAGIC != magic || indexOffset < mFirstRecordOffset || indexOffset > static_cast<uint64>(fileSize - trailerSize))
+			{
+				return false;
+			}
+
+			mStream->seekg(static_cast<std::streamoff>(indexOffset));
+			uint32 numberOfKeyframes = 0;
+			if (!detail::readReplayValue(*mStream, numberOfKeyframes))
+			{
+				return false;
+			}
+
+			// Don't trust a count whose entries don't fit between the count and the record counter, duration and trailer behind them
+			const uint64 keyframeSize = sizeof(ReplayKeyframe::mTime) + sizeof(ReplayKeyframe::mFileOffset) + sizeof(ReplayKeyframe::mRecordIndex);
+			const uint64 countersSize = sizeof(mNumberOfRecords) + sizeof(mDuration);
+			const uint64 keyframesOffset = static_cast<uint64>(mStream->tellg());
+			const uint64 trailerOffset = static_cast<uint64>(fileSize - trailerSize);
+			if (keyframesOffset + countersSize > trailerOffset || static_cast<uint64>(numberOfKeyframes) * keyframeSize > trailerOffset - countersSize - keyframesOffset)
+			{
+				return false;
+			}
+
+			mKeyframes.resize(numberOfKeyframes);
+			for (ReplayKeyframe& keyframe : mKeyframes)
+			{
+				if (!detail::readReplayValue(*mStream, keyframe.mTime) || !detail::readReplayValue(*mStream, keyframe.mFileOffset) || !detail::readReplayValue(*mStream, keyframe.mRecordIndex))
+				{
+					mKeyframes.clear();
+					return false;
+				}
+			}
+			if (!detail::readReplayValue(*mStream, mNumberOfRecords) || !detail::readReplayValue(*mStream, mDuration))
+			{
+				mKeyframes.clear();
+				return false;
+			}
+
+			mEndOfRecordsOffset = indexOffset;
+			return true;
+		}
+
+		inline void ReplayFileReader::rebuildIndex()
+		{
+			mKeyframes.clear();
+			mNumberOfRecords = 0;
+			mDuration = 0;
+
+			// The records end at the end of the file at the latest
+			mStream->clear();
+			mStream->seekg(0, std::ios::end);
+			mEndOfRecordsOffset = static_cast<uint64>(mStream->tellg());
+
+			mStream->clear();
+			mStream->seekg(static_cast<std::streamoff>(mFirstRecordOffset));
+
+			// Scan until the first incomplete record, a crashed recording may end in the middle of one
+			ReplayRecord record;
+			uint64 recordOffset = mFirstRecordOffset;
+			while (readNextRecord(record))
+			{
+				if (record.mIsKeyframe)
+				{
+					const ReplayKeyframe keyframe = { record.mTime, recordOffset, mNumberOfRecords };
+					mKeyframes.push_back(keyframe);
+				}
+				mDuration = record.mTime;
+				++mNumberOfRecords;
+				recordOffset = static_cast<uint64>(mStream->tellg());
+			}
+			mEndOfRecordsOffset = recordOffset;
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
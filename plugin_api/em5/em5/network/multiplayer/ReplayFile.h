@@ -0,0 +1,282 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <iosfwd> // For the forward declarations of iostreams
+#include <memory> // For std::unique_ptr
+#include <string>
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Time;
+	namespace game
+	{
+		class BitStream;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Structures                                            ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    A single recorded data update
+		*/
+		struct ReplayRecord
+		{
+			int64				mTime;			///< The time, in milliseconds, when the data was recorded
+			bool				mIsKeyframe;	///< "true" if the data contains the full state (e.g. a forced map cache update), playback can start here
+			uint32				mNumberOfBits;	///< Number of valid bits inside the data
+			std::vector<uint8>	mData;			///< The recorded data
+
+			inline ReplayRecord() :
+				mTime(0),
+				mIsKeyframe(false),
+				mNumberOfBits(0)
+			{}
+		};
+
+		/**
+		*  @brief
+		*    Index entry of a keyframe
+		*/
+		struct ReplayKeyframe
+		{
+			int64	mTime;			///< The time, in milliseconds, of the keyframe record
+			uint64	mFileOffset;	///< Position of the keyframe record inside the file
+			uint32	mRecordIndex;	///< Number of records before the keyframe
+		};
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    EMERGENCY 5 multiplayer indexed replay file writer
+		*
+		*  @remarks
+		*    Unlike the plain "DataRecorder" stream, the replay file contains a keyframe index, so playback can seek.
+		*    Layout:
+		*    - Header: magic and format version
+		*    - Records: flags, time in milliseconds, number of bits, data bytes
+		*    - Index written on close: keyframe count and entries, record count, duration, index offset and an end magic
+		*
+		*    A keyframe is a record holding the full state. The recording side asks "isKeyframeDue()" before writing an update,
+		*    and if a keyframe is due it forces a full update (e.g. "DataCacheBase::updateData()" with force set) and marks the record as keyframe.
+		*
+		*  @note
+		*    - Standalone format, neither "DataRecorder" nor "DataPlayer" use it; whoever owns the update stream has to feed the writer
+		*/
+		class ReplayFileWriter : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			static const uint32 FILE_MAGIC = 0x52354d45;		///< "EM5R"
+			static const uint32 INDEX_MAGIC = 0x49354d45;		///< "EM5I"
+			static const uint32 FORMAT_VERSION = 1;
+			static const uint32 DEFAULT_KEYFRAME_INTERVAL = 30000;	///< Milliseconds between two keyframes
+
+			enum RecordFlags
+			{
+				RECORD_FLAG_KEYFRAME = 1 << 0
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Constructor opening the file for writing, any existing file is replaced
+			*/
+			inline explicit ReplayFileWriter(const std::string& fileName, int64 keyframeIntervalInMilliseconds = DEFAULT_KEYFRAME_INTERVAL);
+
+			/**
+			*  @brief
+			*    Constructor writing into the given binary stream
+			*/
+			inline explicit ReplayFileWriter(std::unique_ptr<std::ostream> stream, int64 keyframeIntervalInMilliseconds = DEFAULT_KEYFRAME_INTERVAL);
+
+			/**
+			*  @brief
+			*    Destructor, writes the index if not done yet
+			*/
+			inline ~ReplayFileWriter();
+
+			inline bool isValid() const;
+
+			/**
+			*  @brief
+			*    Return whether the next record should be a keyframe, this is the case for the first record and after each keyframe interval
+			*/
+			inline bool isKeyframeDue(int64 timeInMilliseconds) const;
+
+			/**
+			*  @brief
+			*    Append a record
+			*/
+			inline void writeRecord(int64 timeInMilliseconds, const uint8* data, uint32 numberOfBits, bool isKeyframe);
+
+			/**
+			*  @brief
+			*    Append the content of a bit stream as record, like "DataRecorder::recordData()" does
+			*/
+			inline void recordData(const qsf::Time& timePassedSinceStart, const qsf::game::BitStream& bitStream, bool isKeyframe);
+
+			/**
+			*  @brief
+			*    Write the index and flush the stream, no records can be added afterwards
+			*/
+			inline void close();
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline void writeHeader();
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			std::unique_ptr<std::ostream>	mStream;			///< The (file)stream to which the data is written, null pointer after closing
+			int64							mKeyframeInterval;	///< In milliseconds
+			int64							mLastKeyframeTime;	///< In milliseconds, uninitialized before the first keyframe
+			int64							mLastRecordTime;	///< In milliseconds
+			uint32							mNumberOfRecords;
+			std::vector<ReplayKeyframe>		mKeyframes;
+			std::vector<char>				mBuffer;			///< Only used inside "recordData()", kept to avoid reallocations
+
+
+		};
+
+
+		/**
+		*  @brief
+		*    EMERGENCY 5 multiplayer indexed replay file reader
+		*
+		*  @remarks
+		*    If the index is missing, e.g. because the recording session crashed, it's rebuilt by scanning the records once.
+		*/
+		class ReplayFileReader : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			inline explicit ReplayFileReader(const std::string& fileName);
+			inline explicit ReplayFileReader(std::unique_ptr<std::istream> stream);
+
+			/**
+			*  @brief
+			*    Return whether the file could be opened and has a valid header
+			*/
+			inline bool isValid() const;
+
+			inline const std::vector<ReplayKeyframe>& getKeyframes() const;
+			inline uint32 getNumberOfRecords() const;
+
+			/**
+			*  @brief
+			*    Return the time of the last record in milliseconds
+			*/
+			inline int64 getDuration() const;
+
+			/**
+			*  @brief
+			*    Read the next record
+			*
+			*  @return
+			*    "false" at the end of the records or on a read error
+			*/
+			inline bool readNextRecord(ReplayRecord& record);
+
+			/**
+			*  @brief
+			*    Continue reading at the last keyframe not after the given time
+			*
+			*  @return
+			*    Index of the keyframe inside "getKeyframes()", uninitialized if there's no keyframe before the time; the read position is at the start then
+			*/
+			inline uint32 seekToKeyframe(int64 timeInMilliseconds);
+
+			/**
+			*  @brief
+			*    Continue reading at the first record
+			*/
+			inline void rewind();
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline void open();
+			inline bool readIndex();
+			inline void rebuildIndex();
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			std::unique_ptr<std::istream>	mStream;
+			bool							mValid;
+			uint64							mFirstRecordOffset;
+			uint64							mEndOfRecordsOffset;	///< Start of the index or end of the file
+			uint32							mNumberOfRecords;
+			int64							mDuration;
+			std::vector<ReplayKeyframe>		mKeyframes;
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/network/multiplayer/ReplayFile-inl.h"
@@ -0,0 +1,322 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf_game/network/BitStream.h>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+		namespace quantization
+		{
+
+
+			//[-------------------------------------------------------]
+			//[ Definitions                                           ]
+			//[-------------------------------------------------------]
+			static const uint32 ROTATION_COMPONENT_BITS = 10;	///< Bits per quaternion component with the smallest three encoding, 2 + 3 * 10 = 32 bits per rotation
+			static const uint32 SMALL_DELTA_BITS = 8;			///< Bits of a delta to the baseline which is written in the short form
+
+
+			//[-------------------------------------------------------]
+			//[ Structures                                            ]
+			//[-------------------------------------------------------]
+			/**
+			*  @brief
+			*    Describes how positions inside a bounding box are mapped to fixed point values
+			*
+			*  @remarks
+			*    Host and client need to use the same quantization, e.g. both derive it from the map boundaries
+			*/
+			struct PositionQuantization
+			{
+				glm::vec3	mMinimum;		///< Position mapped to zero
+				float		mPrecision;		///< Size of one quantization step in world units
+				uint32		mBitsPerAxis[3];	///< Bits needed to cover the extent of the bounding box per axis, at most 32
+
+				inline PositionQuantization() :
+					mPrecision(0.01f)
+				{
+					mBitsPerAxis[0] = mBitsPerAxis[1] = mBitsPerAxis[2] = 32;
+				}
+
+				/**
+				*  @brief
+				*    Create a quantization for the bounding box given, positions outside are clamped
+				*/
+				inline static PositionQuantization create(const glm::vec3& minimum, const glm::vec3& maximum, float precision)
+				{
+					PositionQuantization positionQuantization;
+					positionQuantization.mMinimum = minimum;
+					positionQuantization.mPrecision = precision;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						const double numberOfSteps = std::ceil(static_cast<double>(maximum[axis] - minimum[axis]) / precision) + 1.0;
+						uint32 bits = 1;
+						while (bits < 32 && static_cast<double>(uint64(1) << bits) < numberOfSteps)
+						{
+							++bits;
+						}
+						positionQuantization.mBitsPerAxis[axis] = bits;
+					}
+					return positionQuantization;
+				}
+			};
+
+			// Quantized position, one fixed point value per axis
+			struct QuantizedPosition
+			{
+				uint32 mValue[3];
+
+				inline bool operator==(const QuantizedPosition& other) const
+				{
+					return (mValue[0] == other.mValue[0] && mValue[1] == other.mValue[1] && mValue[2] == other.mValue[2]);
+				}
+
+				inline bool operator!=(const QuantizedPosition& other) const
+				{
+					return !operator==(other);
+				}
+			};
+
+
+			//[-------------------------------------------------------]
+			//[ Methods                                               ]
+			//[-------------------------------------------------------]
+			inline uint32 getMaximumValue(uint32 bits)
+			{
+				return (bits >= 32) ? 0xffffffffu : ((1u << bits) - 1u);
+			}
+
+			inline QuantizedPosition quantizePosition(const glm::vec3& position, const PositionQuantization& positionQuantization)
+			{
+				QuantizedPosition quantizedPosition;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					const double steps = std::floor(static_cast<double>(position[axis] - positionQuantization.mMinimum[axis]) / positionQuantization.mPrecision + 0.5);
+					quantizedPosition.mValue[axis] = static_cast<uint32>(glm::clamp(steps, 0.0, static_cast<double>(getMaximumValue(positionQuantization.mBitsPerAxis[axis]))));
+				}
+				return quantizedPosition;
+			}
+
+			inline glm::vec3 dequantizePosition(const QuantizedPosition& quantizedPosition, const PositionQuantization& positionQuantization)
+			{
+				glm::vec3 position;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					position[axis] = positionQuantization.mMinimum[axis] + static_cast<float>(static_cast<double>(quantizedPosition.mValue[axis]) * positionQuantization.mPrecision);
+				}
+				return position;
+			}
+
+			/**
+			*  @brief
+			*    Encode a unit quaternion with the smallest three method into 32 bits
+			*
+			*  @remarks
+			*    The component with the largest magnitude is left out and restored from the unit length, its index is stored in the upper two bits.
+			*    Since "q" and "-q" are the same rotation, the sign is chosen so the left out component is positive.
+			*    The other three components lie inside [-1/sqrt(2), 1/sqrt(2)] and are stored with "ROTATION_COMPONENT_BITS" each.
+			*/
+			inline uint32 quantizeRotation(const glm::quat& rotation)
+			{
+				const float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+				uint32 largestIndex = 0;
+				for (uint32 index = 1; index < 4; ++index)
+				{
+					if (std::abs(components[index]) > std::abs(components[largestIndex]))
+					{
+						largestIndex = index;
+					}
+				}
+
+				const float sign = (components[largestIndex] < 0.0f) ? -1.0f : 1.0f;
+				const float range = 1.0f / std::sqrt(2.0f);
+				const float maximumValue = static_cast<float>(getMaximumValue(ROTATION_COMPONENT_BITS));
+				uint32 packed = largestIndex;
+				for (uint32 index = 0; index < 4; ++index)
+				{
+					if (index != largestIndex)
+					{
+						const float normalized = glm::clamp((components[index] * sign + range) / (2.0f * range), 0.0f, 1.0f);
+						packed = (packed << ROTATION_COMPONENT_BITS) | static_cast<uint32>(normalized * maximumValue + 0.5f);
+					}
+				}
+				return packed;
+			}
+
+			inline glm::quat dequantizeRotation(uint32 packed)
+			{
+				const float range = 1.0f / std::sqrt(2.0f);
+				const float maximumValue = static_cast<float>(getMaximumValue(ROTATION_COMPONENT_BITS));
+				const uint32 largestIndex = packed >> (3 * ROTATION_COMPONENT_BITS);
+
+				float components[4];
+				float squaredSum = 0.0f;
+				int shift = 2 * ROTATION_COMPONENT_BITS;
+				for (uint32 index = 0; index < 4; ++index)
+				{
+					if (index != largestIndex)
+					{
+						const uint32 value = (packed >> shift) & getMaximumValue(ROTATION_COMPONENT_BITS);
+						components[index] = (static_cast<float>(value) / maximumValue) * 2.0f * range - range;
+						squaredSum += components[index] * components[index];
+						shift -= ROTATION_COMPONENT_BITS;
+					}
+				}
+				components[largestIndex] = std::sqrt(std::max(1.0f - squaredSum, 0.0f));
+
+				// glm stores the quaternion as (w, x, y, z) in the constructor
+				return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+			}
+
+			/**
+			*  @brief
+			*    Map an angle in radians to the given number of bits, the full circle is covered
+			*/
+			inline uint32 quantizeAngle(float angle, uint32 bits)
+			{
+				const float fullCircle = glm::pi<float>() * 2.0f;
+				float normalized = std::fmod(angle, fullCircle) / fullCircle;
+				if (normalized < 0.0f)
+				{
+					normalized += 1.0f;
+				}
+				const double steps = static_cast<double>(getMaximumValue(bits)) + 1.0;
+				return static_cast<uint32>(static_cast<uint64>(std::floor(normalized * steps + 0.5)) & getMaximumValue(bits));
+			}
+
+			inline float dequantizeAngle(uint32 value, uint32 bits)
+			{
+				const double steps = static_cast<double>(getMaximumValue(bits)) + 1.0;
+				const float angle = static_cast<float>(value / steps) * glm::pi<float>() * 2.0f;
+				return (angle > glm::pi<float>()) ? (angle - glm::pi<float>() * 2.0f) : angle;
+			}
+
+			/**
+			*  @brief
+			*    Write a quantized value relative to the baseline value the receiver already has
+			*
+			*  @remarks
+			*    Small changes, which are the common case for moving entities, are written with "SMALL_DELTA_BITS" bits plus a flag.
+			*    Otherwise the full value is written.
+			*/
+			inline void writeDelta(uint32 value, uint32 baselineValue, uint32 bits, qsf::game::BitStream& bitStream)
+			{
+				const int64 delta = static_cast<int64>(value) - static_cast<int64>(baselineValue);
+				const int64 smallDeltaLimit = int64(1) << (SMALL_DELTA_BITS - 1);
+				const bool isSmallDelta = (bits > SMALL_DELTA_BITS && delta >= -smallDeltaLimit && delta < smallDeltaLimit);
+				bitStream.write(isSmallDelta);
+				if (isSmallDelta)
+				{
+					bitStream.write(static_cast<uint32>(delta) & getMaximumValue(SMALL_DELTA_BITS), SMALL_DELTA_BITS);
+				}
+				else
+				{
+					bitStream.write(value, bits);
+				}
+			}
+
+			inline bool readDelta(const qsf::game::BitStream& bitStream, uint32 baselineValue, uint32 bits, uint32& value)
+			{
+				bool isSmallDelta = false;
+				if (!bitStream.read(isSmallDelta))
+				{
+					return false;
+				}
+
+				if (isSmallDelta)
+				{
+					uint32 packedDelta = 0;
+					if (!bitStream.read(packedDelta, SMALL_DELTA_BITS))
+					{
+						return false;
+					}
+
+					// Sign extend
+					int32 delta = static_cast<int32>(packedDelta);
+					if (packedDelta & (1u << (SMALL_DELTA_BITS - 1)))
+					{
+						delta -= static_cast<int32>(1u << SMALL_DELTA_BITS);
+					}
+					value = static_cast<uint32>(static_cast<int64>(baselineValue) + delta);
+					return true;
+				}
+
+				value = 0;
+				return bitStream.read(value, bits);
+			}
+
+			inline void writePosition(const QuantizedPosition& position, const QuantizedPosition* baselinePosition, const PositionQuantization& positionQuantization, qsf::game::BitStream& bitStream)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					if (nullptr != baselinePosition)
+					{
+						writeDelta(position.mValue[axis], baselinePosition->mValue[axis], positionQuantization.mBitsPerAxis[axis], bitStream);
+					}
+					else
+					{
+						bitStream.write(position.mValue[axis], positionQuantization.mBitsPerAxis[axis]);
+					}
+				}
+			}
+
+			inline bool readPosition(const qsf::game::BitStream& bitStream, const QuantizedPosition* baselinePosition, const PositionQuantization& positionQuantization, QuantizedPosition& position)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					position.mValue[axis] = 0;
+					const bool result = (nullptr != baselinePosition) ?
+						readDelta(bitStream, baselinePosition->mValue[axis], positionQuantization.mBitsPerAxis[axis], position.mValue[axis]) :
+						bitStream.read(position.mValue[axis], positionQuantization.mBitsPerAxis[axis]);
+					if (!result)
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+
+			inline void writeRotation(const glm::quat& rotation, qsf::game::BitStream& bitStream)
+			{
+				bitStream.write(quantizeRotation(rotation));
+			}
+
+			inline bool readRotation(const qsf::game::BitStream& bitStream, glm::quat& rotation)
+			{
+				uint32 packed = 0;
+				if (!bitStream.read(packed))
+				{
+					return false;
+				}
+				rotation = dequantizeRotation(packed);
+				return true;
+			}
+
+
+		//[-------------------------------------------------------]
+		//[ Namespace                                             ]
+		//[-------------------------------------------------------]
+		} // quantization
+	} // multiplayer
+} // em5
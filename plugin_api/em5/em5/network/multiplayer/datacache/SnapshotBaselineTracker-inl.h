@@ -0,0 +1,151 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/base/GetUninitialized.h>
+
+#include <algorithm>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline SnapshotBaselineTracker::SnapshotBaselineTracker(int32 maximumBaselineAge) :
+			mMaximumBaselineAge(maximumBaselineAge)
+		{
+			// Nothing to do in here
+		}
+
+		inline void SnapshotBaselineTracker::addClient(uint32 playerIndex)
+		{
+			mBaselineTickCounts.emplace(playerIndex, qsf::getUninitialized<int32>());
+		}
+
+		inline void SnapshotBaselineTracker::removeClient(uint32 playerIndex)
+		{
+			mBaselineTickCounts.erase(playerIndex);
+		}
+
+		inline void SnapshotBaselineTracker::onUpdateAcknowledged(uint32 playerIndex, int32 tickCount)
+		{
+			auto iterator = mBaselineTickCounts.find(playerIndex);
+			if (iterator != mBaselineTickCounts.end() && (qsf::isUninitialized(iterator->second) || tickCount > iterator->second))
+			{
+				iterator->second = tickCount;
+			}
+		}
+
+		inline int32 SnapshotBaselineTracker::getBaselineTickCount(uint32 playerIndex, int32 currentTickCount) const
+		{
+			auto iterator = mBaselineTickCounts.find(playerIndex);
+			if (iterator == mBaselineTickCounts.end() || qsf::isUninitialized(iterator->second) || currentTickCount - iterator->second > mMaximumBaselineAge)
+			{
+				// Full update needed
+				return qsf::getUninitialized<int32>();
+			}
+			return iterator->second;
+		}
+
+		inline int32 SnapshotBaselineTracker::getOldestBaselineTickCount(int32 currentTickCount) const
+		{
+			int32 oldestTickCount = qsf::getUninitialized<int32>();
+			for (const auto& entry : mBaselineTickCounts)
+			{
+				const int32 tickCount = getBaselineTickCount(entry.first, currentTickCount);
+				if (qsf::isInitialized(tickCount) && (qsf::isUninitialized(oldestTickCount) || tickCount < oldestTickCount))
+				{
+					oldestTickCount = tickCount;
+				}
+			}
+			return oldestTickCount;
+		}
+
+		inline void SnapshotBaselineTracker::onDataChanged(uint64 entityId, uint8 componentId, int32 tickCount)
+		{
+			mChangeTickCounts[entityId][componentId] = tickCount;
+		}
+
+		inline bool SnapshotBaselineTracker::needsUpdate(uint32 playerIndex, uint64 entityId, uint8 componentId, int32 currentTickCount) const
+		{
+			const int32 baselineTickCount = getBaselineTickCount(playerIndex, currentTickCount);
+			if (qsf::isUninitialized(baselineTickCount))
+			{
+				return true;
+			}
+
+			auto entityIterator = mChangeTickCounts.find(entityId);
+			if (entityIterator == mChangeTickCounts.end())
+			{
+				// Never changed since it was added
+				return false;
+			}
+
+			auto componentIterator = entityIterator->second.find(componentId);
+			return (componentIterator != entityIterator->second.end() && componentIterator->second > baselineTickCount);
+		}
+
+		inline void SnapshotBaselineTracker::removeEntity(uint64 entityId)
+		{
+			mChangeTickCounts.erase(entityId);
+		}
+
+		template<typename T>
+		inline void SnapshotBaselineHistory<T>::addValue(int32 tickCount, const T& value)
+		{
+			if (!mValues.empty() && mValues.back().first == tickCount)
+			{
+				mValues.back().second = value;
+			}
+			else
+			{
+				mValues.emplace_back(tickCount, value);
+			}
+		}
+
+		template<typename T>
+		inline bool SnapshotBaselineHistory<T>::tryGetValue(int32 tickCount, T& value) const
+		{
+			// Last entry with a tick count not after the given one
+			auto iterator = std::upper_bound(mValues.begin(), mValues.end(), tickCount, [](int32 left, const std::pair<int32, T>& right) { return left < right.first; });
+			if (iterator == mValues.begin())
+			{
+				return false;
+			}
+
+			value = (iterator - 1)->second;
+			return true;
+		}
+
+		template<typename T>
+		inline void SnapshotBaselineHistory<T>::removeValuesBefore(int32 tickCount)
+		{
+			// Keep the last value before the tick, it's still the current value at that tick
+			while (mValues.size() > 1 && mValues[1].first <= tickCount)
+			{
+				mValues.pop_front();
+			}
+		}
+
+		template<typename T>
+		inline bool SnapshotBaselineHistory<T>::isEmpty() const
+		{
+			return mValues.empty();
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
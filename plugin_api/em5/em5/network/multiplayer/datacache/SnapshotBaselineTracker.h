@@ -0,0 +1,216 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <unordered_map>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Host side bookkeeping of the data each client has acknowledged, as base for per client delta encoding
+		*
+		*  @remarks
+		*    The data cache items only write what changed since the previous update, which assumes every update reaches every client.
+		*    With the baseline tracker the host remembers in which tick each data cache item of an entity changed
+		*    and which tick each client acknowledged last, its baseline.
+		*    An item needs to be sent to a client as long as it changed after the client's baseline,
+		*    so lost or deferred updates are repaired by the next one and entities can be skipped for a tick without losing changes.
+		*
+		*    A client without baseline, or with a baseline older than the history kept, needs the full state.
+		*
+		*    The tracker is not part of "em5::multiplayer::MapCache", it's meant for data streams of their own, together with the
+		*    "em5::multiplayer::UpdatePriorityScheduler", the codecs of "DataCacheQuantization.h" and the "em5::multiplayer::EntityTypeBitStatistics".
+		*    Per host tick, e.g.:
+		*    @code
+		*      tracker.onDataChanged(entityId, componentId, tickCount);	// For each changed item
+		*      if (tracker.needsUpdate(playerIndex, entityId, componentId, tickCount))
+		*        scheduler.accumulate(entityId, distance, isVisible, changeMagnitude, estimatedBits);
+		*      scheduler.selectForBudget(budgetInBytes, selectedEntityIds);
+		*      // Write the selected entities, delta encoded against "tracker.getBaselineTickCount(playerIndex, tickCount)",
+		*      // and call "tracker.onUpdateAcknowledged()" as soon as the client acknowledged the tick
+		*    @endcode
+		*/
+		class SnapshotBaselineTracker : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			static const int32 DEFAULT_MAXIMUM_BASELINE_AGE = 64;	///< Default number of ticks a baseline can be used for delta encoding
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Constructor
+			*
+			*  @param[in] maximumBaselineAge
+			*    Number of ticks a baseline stays usable, older baselines require a full update
+			*/
+			inline explicit SnapshotBaselineTracker(int32 maximumBaselineAge = DEFAULT_MAXIMUM_BASELINE_AGE);
+
+			//[-------------------------------------------------------]
+			//[ Clients                                               ]
+			//[-------------------------------------------------------]
+			/**
+			*  @brief
+			*    Add a client without baseline, e.g. after it finished loading the map; does nothing if the client is known already
+			*/
+			inline void addClient(uint32 playerIndex);
+
+			inline void removeClient(uint32 playerIndex);
+
+			/**
+			*  @brief
+			*    Called when a client acknowledged the update of the given tick, older or duplicate acknowledges are ignored
+			*/
+			inline void onUpdateAcknowledged(uint32 playerIndex, int32 tickCount);
+
+			/**
+			*  @brief
+			*    Return the tick the client acknowledged last, uninitialized if the client needs a full update
+			*
+			*  @param[in] currentTickCount
+			*    Current host tick, needed to detect outdated baselines
+			*/
+			inline int32 getBaselineTickCount(uint32 playerIndex, int32 currentTickCount) const;
+
+			/**
+			*  @brief
+			*    Return the oldest baseline still in use by any client, data cache items can drop older history; uninitialized if no client has a baseline
+			*/
+			inline int32 getOldestBaselineTickCount(int32 currentTickCount) const;
+
+			//[-------------------------------------------------------]
+			//[ Data cache items                                      ]
+			//[-------------------------------------------------------]
+			/**
+			*  @brief
+			*    Remember that a data cache item of the entity changed in the given tick
+			*/
+			inline void onDataChanged(uint64 entityId, uint8 componentId, int32 tickCount);
+
+			/**
+			*  @brief
+			*    Return whether the data cache item needs to be sent to the client, because it changed after the client's baseline
+			*/
+			inline bool needsUpdate(uint32 playerIndex, uint64 entityId, uint8 componentId, int32 currentTickCount) const;
+
+			/**
+			*  @brief
+			*    Forget all data of an entity which was removed from the map cache
+			*/
+			inline void removeEntity(uint64 entityId);
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			typedef boost::container::flat_map<uint8, int32> ChangeTickMap;	///< Component id as key, tick count of the last change as value
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			int32										mMaximumBaselineAge;
+			boost::container::flat_map<uint32, int32>	mBaselineTickCounts;	///< Player index as key, acknowledged tick count as value (uninitialized without baseline)
+			std::unordered_map<uint64, ChangeTickMap>	mChangeTickCounts;		///< Entity id as key
+
+
+		};
+
+
+		/**
+		*  @brief
+		*    History of the values sent for a single data cache item, to encode new values relative to the client's baseline
+		*
+		*  @note
+		*    - The values are expected to be added with increasing tick counts
+		*/
+		template<typename T>
+		class SnapshotBaselineHistory
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Remember the value sent in the given tick, replaces a value of the same tick
+			*/
+			inline void addValue(int32 tickCount, const T& value);
+
+			/**
+			*  @brief
+			*    Return the value which was current in the given tick, that is the last value added up to this tick
+			*
+			*  @return
+			*    "false" if there's no value for this tick anymore
+			*/
+			inline bool tryGetValue(int32 tickCount, T& value) const;
+
+			/**
+			*  @brief
+			*    Drop values which aren't needed for a baseline at the given tick or later
+			*/
+			inline void removeValuesBefore(int32 tickCount);
+
+			inline bool isEmpty() const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			std::deque<std::pair<int32, T>>	mValues;	///< Tick count and value, ascending by tick count
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/network/multiplayer/datacache/SnapshotBaselineTracker-inl.h"
@@ -0,0 +1,112 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <algorithm>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline UpdatePriorityScheduler::UpdatePriorityScheduler()
+		{
+			// Nothing to do in here
+		}
+
+		inline const UpdatePriorityScheduler::Weights& UpdatePriorityScheduler::getWeights() const
+		{
+			return mWeights;
+		}
+
+		inline void UpdatePriorityScheduler::setWeights(const Weights& weights)
+		{
+			mWeights = weights;
+		}
+
+		inline void UpdatePriorityScheduler::accumulate(uint64 entityId, float distance, bool isVisible, float changeMagnitude, uint32 estimatedBits)
+		{
+			float priority = mWeights.mBasePriority + mWeights.mChangeMagnitudeFactor * std::max(changeMagnitude, 0.0f);
+			if (isVisible)
+			{
+				priority += mWeights.mVisiblePriority;
+			}
+			priority /= 1.0f + std::max(distance, 0.0f) * mWeights.mDistanceFalloff;
+
+			auto result = mEntries.emplace(entityId, Entry());
+			Entry& entry = result.first->second;
+			if (result.second)
+			{
+				entry.mPriority = 0.0f;
+			}
+			entry.mPriority += priority;
+			entry.mEstimatedBits = estimatedBits;
+		}
+
+		inline void UpdatePriorityScheduler::selectForBudget(uint32 budgetInBytes, std::vector<uint64>& selectedEntityIds)
+		{
+			selectedEntityIds.clear();
+
+			mCandidates.clear();
+			mCandidates.reserve(mEntries.size());
+			for (const auto& entry : mEntries)
+			{
+				const Candidate candidate = { entry.first, entry.second.mPriority, entry.second.mEstimatedBits };
+				mCandidates.push_back(candidate);
+			}
+
+			// Highest priority first, the entity ID makes the order independent of the hash map
+			std::sort(mCandidates.begin(), mCandidates.end(), [](const Candidate& left, const Candidate& right)
+			{
+				return (left.mPriority != right.mPriority) ? (left.mPriority > right.mPriority) : (left.mEntityId < right.mEntityId);
+			});
+
+			// Fill the budget greedily, smaller updates further down the list may still fit after a large one didn't
+			const uint64 budgetInBits = static_cast<uint64>(budgetInBytes) * 8;
+			uint64 usedBits = 0;
+			for (const Candidate& candidate : mCandidates)
+			{
+				if (usedBits + candidate.mEstimatedBits <= budgetInBits || selectedEntityIds.empty())
+				{
+					usedBits += candidate.mEstimatedBits;
+					selectedEntityIds.push_back(candidate.mEntityId);
+					mEntries.erase(candidate.mEntityId);
+					if (usedBits >= budgetInBits)
+					{
+						break;
+					}
+				}
+			}
+		}
+
+		inline void UpdatePriorityScheduler::removeEntity(uint64 entityId)
+		{
+			mEntries.erase(entityId);
+		}
+
+		inline void UpdatePriorityScheduler::clear()
+		{
+			mEntries.clear();
+		}
+
+		inline size_t UpdatePriorityScheduler::getNumberOfPendingEntities() const
+		{
+			return mEntries.size();
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
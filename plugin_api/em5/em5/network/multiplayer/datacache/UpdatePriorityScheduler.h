@@ -0,0 +1,157 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Decides per client which entities are updated in a tick, so an update stays inside a byte budget
+		*
+		*  @remarks
+		*    Every tick each entity with pending changes accumulates priority, depending on its distance to the client's view,
+		*    its visibility and the magnitude of its changes. The entities with the highest accumulated priority are selected
+		*    until the budget is used up, and their priority is reset. Entities left out keep accumulating, so nothing starves.
+		*
+		*    The size of an entity update is estimated from the size of its last update, e.g. taken from the map cache statistics.
+		*/
+		class UpdatePriorityScheduler : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			struct Weights
+			{
+				float mBasePriority;			///< Added every tick for pending changes
+				float mVisiblePriority;			///< Added every tick if the entity is visible to the client
+				float mChangeMagnitudeFactor;	///< Multiplied with the change magnitude, e.g. the distance moved since the client's baseline
+				float mDistanceFalloff;			///< The sum is divided by "1 + distance * mDistanceFalloff"
+
+				inline Weights() :
+					mBasePriority(1.0f),
+					mVisiblePriority(4.0f),
+					mChangeMagnitudeFactor(1.0f),
+					mDistanceFalloff(0.01f)
+				{}
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			inline UpdatePriorityScheduler();
+
+			inline const Weights& getWeights() const;
+			inline void setWeights(const Weights& weights);
+
+			/**
+			*  @brief
+			*    Add the priority of this tick for an entity with pending changes
+			*
+			*  @param[in] distance
+			*    Distance of the entity to the client's camera or units
+			*  @param[in] isVisible
+			*    "true" if the entity is visible to the client
+			*  @param[in] changeMagnitude
+			*    Non-negative measure how much the entity changed since the client's baseline
+			*  @param[in] estimatedBits
+			*    Estimated size of the entity update in bits
+			*/
+			inline void accumulate(uint64 entityId, float distance, bool isVisible, float changeMagnitude, uint32 estimatedBits);
+
+			/**
+			*  @brief
+			*    Select the entities to update in this tick, by descending priority as long as they fit into the budget
+			*
+			*  @param[in] budgetInBytes
+			*    Byte budget of this tick; the entity with the highest priority is always selected, even if it exceeds the budget alone
+			*  @param[out] selectedEntityIds
+			*    Receives the selected entity IDs, cleared before
+			*
+			*  @note
+			*    - The priority of the selected entities is reset, all others keep their accumulated priority
+			*/
+			inline void selectForBudget(uint32 budgetInBytes, std::vector<uint64>& selectedEntityIds);
+
+			/**
+			*  @brief
+			*    Forget the accumulated priority of an entity, e.g. it was sent anyway or removed from the map cache
+			*/
+			inline void removeEntity(uint64 entityId);
+
+			inline void clear();
+
+			inline size_t getNumberOfPendingEntities() const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			struct Entry
+			{
+				float	mPriority;
+				uint32	mEstimatedBits;
+			};
+
+			struct Candidate
+			{
+				uint64	mEntityId;
+				float	mPriority;
+				uint32	mEstimatedBits;
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			Weights								mWeights;
+			std::unordered_map<uint64, Entry>	mEntries;		///< Entity id as key
+			std::vector<Candidate>				mCandidates;	///< Only used inside "selectForBudget()", kept to avoid reallocations
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/network/multiplayer/datacache/UpdatePriorityScheduler-inl.h"
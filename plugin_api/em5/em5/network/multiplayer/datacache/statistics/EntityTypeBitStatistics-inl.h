@@ -0,0 +1,52 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline void EntityTypeBitStatistics::addUpdate(const std::string& entityType, uint64 bits)
+		{
+			Entry& entry = mEntries[entityType];
+			if (0 == entry.mNumberOfUpdates || bits < entry.mLowestBits)
+			{
+				entry.mLowestBits = bits;
+			}
+			if (bits > entry.mPeakBits)
+			{
+				entry.mPeakBits = bits;
+			}
+			entry.mTotalBits += bits;
+			++entry.mNumberOfUpdates;
+		}
+
+		inline uint64 EntityTypeBitStatistics::getAverageBitsPerUpdate(const std::string& entityType) const
+		{
+			EntryMap::const_iterator iterator = mEntries.find(entityType);
+			return (iterator != mEntries.end() && iterator->second.mNumberOfUpdates > 0) ? iterator->second.mTotalBits / iterator->second.mNumberOfUpdates : 0;
+		}
+
+		inline const EntityTypeBitStatistics::EntryMap& EntityTypeBitStatistics::getEntries() const
+		{
+			return mEntries;
+		}
+
+		inline void EntityTypeBitStatistics::reset()
+		{
+			mEntries.clear();
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
@@ -0,0 +1,115 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <string>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace em5
+{
+	namespace multiplayer
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    EMERGENCY 5 multiplayer bits written per entity type
+		*
+		*  @remarks
+		*    The entity type is a free name chosen by the code writing the updates, e.g. the unit type or the category of the entity
+		*/
+		class EntityTypeBitStatistics : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			struct Entry
+			{
+				uint64 mTotalBits;			///< Bits written for entities of this type since the last reset
+				uint64 mNumberOfUpdates;	///< Number of entity updates written since the last reset
+				uint64 mPeakBits;			///< Largest single entity update
+				uint64 mLowestBits;			///< Smallest single entity update
+
+				inline Entry() :
+					mTotalBits(0),
+					mNumberOfUpdates(0),
+					mPeakBits(0),
+					mLowestBits(0)
+				{}
+			};
+			typedef boost::container::flat_map<std::string, Entry> EntryMap;
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Adds the size of one entity update
+			*
+			*  @param[in] entityType
+			*    The name of the entity type
+			*  @param[in] bits
+			*    The number of bits written for the entity, including all of its components
+			*/
+			inline void addUpdate(const std::string& entityType, uint64 bits);
+
+			/**
+			*  @brief
+			*    Returns the average size of an update of an entity of the given type in bits, zero if unknown
+			*/
+			inline uint64 getAverageBitsPerUpdate(const std::string& entityType) const;
+
+			/**
+			*  @brief
+			*    Returns the stored per entity type statistics
+			*/
+			inline const EntryMap& getEntries() const;
+
+			inline void reset();
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			EntryMap mEntries;	///< Entity type name as key
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // multiplayer
+} // em5
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "em5/network/multiplayer/datacache/statistics/EntityTypeBitStatistics-inl.h"
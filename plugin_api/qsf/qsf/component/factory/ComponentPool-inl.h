@@ -0,0 +1,238 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/prototype/Prototype.h"
+#include "qsf/base/error/ErrorHandling.h"
+
+#include <cstdlib>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public qsf::ComponentPool::DenseView methods          ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	inline ComponentPool<COMPONENT>::DenseView::iterator::iterator(const ComponentPool& componentPool, const BasePrototypeManager* owner, uint32 slot) :
+		mComponentPool(&componentPool),
+		mOwner(owner),
+		mSlot(slot)
+	{
+		skipForeignSlots();
+	}
+
+	template<typename COMPONENT>
+	inline typename ComponentPool<COMPONENT>::DenseView::iterator& ComponentPool<COMPONENT>::DenseView::iterator::operator++()
+	{
+		++mSlot;
+		skipForeignSlots();
+		return *this;
+	}
+
+	template<typename COMPONENT>
+	inline COMPONENT* ComponentPool<COMPONENT>::DenseView::iterator::operator*() const
+	{
+		return &mComponentPool->getComponentAtSlot(mSlot);
+	}
+
+	template<typename COMPONENT>
+	inline void ComponentPool<COMPONENT>::DenseView::iterator::skipForeignSlots()
+	{
+		// Only the tightly packed owner array is touched here, not the components
+		const std::vector<const BasePrototypeManager*>& owners = mComponentPool->mOwners;
+		const uint32 numberOfSlots = static_cast<uint32>(owners.size());
+		while (mSlot < numberOfSlots && owners[mSlot] != mOwner)
+		{
+			++mSlot;
+		}
+	}
+
+	template<typename COMPONENT>
+	inline bool ComponentPool<COMPONENT>::DenseView::empty() const
+	{
+		return (0 == mComponentPool.getNumberOfComponents(mOwner));
+	}
+
+	template<typename COMPONENT>
+	inline size_t ComponentPool<COMPONENT>::DenseView::size() const
+	{
+		return mComponentPool.getNumberOfComponents(mOwner);
+	}
+
+	template<typename COMPONENT>
+	inline typename ComponentPool<COMPONENT>::DenseView::iterator ComponentPool<COMPONENT>::DenseView::begin() const
+	{
+		return iterator(mComponentPool, &mOwner, 0);
+	}
+
+	template<typename COMPONENT>
+	inline typename ComponentPool<COMPONENT>::DenseView::iterator ComponentPool<COMPONENT>::DenseView::end() const
+	{
+		return iterator(mComponentPool, &mOwner, mComponentPool.getCapacity());
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	inline ComponentPool<COMPONENT>::ComponentPool(uint32 pageSize) :
+		mPageSize(pageSize),
+		mNumberOfComponents(0)
+	{
+		QSF_CHECK(mPageSize > 0, "The component pool page size must not be zero", QSF_REACT_THROW);
+	}
+
+	template<typename COMPONENT>
+	inline ComponentPool<COMPONENT>::~ComponentPool()
+	{
+		QSF_ASSERT(0 == mNumberOfComponents, "There are still components inside the pool that will get invalidated because their memory is freed", QSF_REACT_NONE);
+
+		// Free all pages
+		for (COMPONENT* page : mPages)
+		{
+			::free(page);
+		}
+	}
+
+	template<typename COMPONENT>
+	inline bool ComponentPool<COMPONENT>::empty() const
+	{
+		return (0 == mNumberOfComponents);
+	}
+
+	template<typename COMPONENT>
+	inline uint32 ComponentPool<COMPONENT>::getNumberOfComponents() const
+	{
+		return mNumberOfComponents;
+	}
+
+	template<typename COMPONENT>
+	inline uint32 ComponentPool<COMPONENT>::getNumberOfComponents(const BasePrototypeManager& owner) const
+	{
+		const typename ComponentCountMap::const_iterator iterator = mComponentCounts.find(&owner);
+		return (iterator != mComponentCounts.cend()) ? iterator->second : 0;
+	}
+
+	template<typename COMPONENT>
+	inline uint32 ComponentPool<COMPONENT>::getCapacity() const
+	{
+		return static_cast<uint32>(mOwners.size());
+	}
+
+	template<typename COMPONENT>
+	inline COMPONENT* ComponentPool<COMPONENT>::create(Prototype& prototype)
+	{
+		// Is there still a free slot?
+		if (mFreeSlots.empty())
+		{
+			// Create a new page
+			COMPONENT* page = static_cast<COMPONENT*>(::malloc(sizeof(COMPONENT) * mPageSize));
+			QSF_CHECK(nullptr != page, "Component pool page could not be created", QSF_REACT_THROW);
+			mPages.push_back(page);
+
+			// Add the new slots so the lowest one gets used first, this keeps the components tightly packed at the start of the pool
+			const uint32 firstSlot = static_cast<uint32>(mOwners.size());
+			mOwners.resize(firstSlot + mPageSize, nullptr);
+			mGenerations.resize(firstSlot + mPageSize, 0);
+			for (uint32 slot = firstSlot + mPageSize; slot > firstSlot; --slot)
+			{
+				mFreeSlots.push_back(slot - 1);
+			}
+		}
+
+		// Get the next free slot and call the component constructor
+		const uint32 slot = mFreeSlots.back();
+		COMPONENT* component = new (static_cast<void*>(&getComponentAtSlot(slot))) COMPONENT(&prototype);
+		mFreeSlots.pop_back();
+
+		// Bookkeeping
+		BasePrototypeManager* owner = &prototype.getPrototypeManager();
+		mOwners[slot] = owner;
+		++mComponentCounts[owner];
+		++mNumberOfComponents;
+
+		// Done
+		return component;
+	}
+
+	template<typename COMPONENT>
+	inline void ComponentPool<COMPONENT>::destroy(COMPONENT& component)
+	{
+		const uint32 slot = getSlotOfComponent(component);
+		QSF_CHECK(isInitialized(slot) && nullptr != mOwners[slot], "Tried to destroy a component not created by this component pool", QSF_REACT_THROW);
+
+		// Call the component destructor
+		component.~COMPONENT();
+
+		// Bookkeeping, the new generation invalidates all existing handles to the slot
+		const typename ComponentCountMap::iterator iterator = mComponentCounts.find(mOwners[slot]);
+		if (0 == --iterator->second)
+		{
+			mComponentCounts.erase(iterator);
+		}
+		mOwners[slot] = nullptr;
+		++mGenerations[slot];
+		--mNumberOfComponents;
+		mFreeSlots.push_back(slot);
+	}
+
+	template<typename COMPONENT>
+	inline ComponentPoolHandle ComponentPool<COMPONENT>::getHandle(const COMPONENT& component) const
+	{
+		const uint32 slot = getSlotOfComponent(component);
+		return (isInitialized(slot) && nullptr != mOwners[slot]) ? ComponentPoolHandle(slot, mGenerations[slot]) : ComponentPoolHandle();
+	}
+
+	template<typename COMPONENT>
+	inline COMPONENT* ComponentPool<COMPONENT>::tryGetComponent(const ComponentPoolHandle& handle) const
+	{
+		const uint32 slot = handle.mSlot;
+		return (slot < mOwners.size() && nullptr != mOwners[slot] && mGenerations[slot] == handle.mGeneration) ? &getComponentAtSlot(slot) : nullptr;
+	}
+
+	template<typename COMPONENT>
+	inline typename ComponentPool<COMPONENT>::DenseView ComponentPool<COMPONENT>::getDenseView(const BasePrototypeManager& owner) const
+	{
+		return DenseView(*this, owner);
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	inline COMPONENT& ComponentPool<COMPONENT>::getComponentAtSlot(uint32 slot) const
+	{
+		return mPages[slot / mPageSize][slot % mPageSize];
+	}
+
+	template<typename COMPONENT>
+	inline uint32 ComponentPool<COMPONENT>::getSlotOfComponent(const COMPONENT& component) const
+	{
+		// There are usually only a few pages, so a linear search is fine
+		const uint32 numberOfPages = static_cast<uint32>(mPages.size());
+		for (uint32 pageIndex = 0; pageIndex < numberOfPages; ++pageIndex)
+		{
+			const COMPONENT* page = mPages[pageIndex];
+			if (&component >= page && &component < page + mPageSize)
+			{
+				return pageIndex * mPageSize + static_cast<uint32>(&component - page);
+			}
+		}
+		return getUninitialized<uint32>();
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
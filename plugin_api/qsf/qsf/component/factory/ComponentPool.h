@@ -0,0 +1,253 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+#include "qsf/base/GetUninitialized.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/container/flat_map.hpp>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Prototype;
+	class BasePrototypeManager;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Stable handle to a component inside a component pool
+	*
+	*  @remarks
+	*    Unlike a component pointer, a handle can be checked for validity: as soon as the component is destroyed,
+	*    the handle no longer resolves, even if the memory slot gets reused by a new component.
+	*/
+	struct ComponentPoolHandle
+	{
+		uint32 mSlot;		///< Index of the memory slot inside the pool, uninitialized for an invalid handle
+		uint32 mGeneration;	///< Generation of the slot at the time the handle was created
+
+		inline ComponentPoolHandle() : mSlot(getUninitialized<uint32>()), mGeneration(0) {}
+		inline ComponentPoolHandle(uint32 slot, uint32 generation) : mSlot(slot), mGeneration(generation) {}
+		inline bool isValid() const { return isInitialized(mSlot); }
+		inline bool operator==(const ComponentPoolHandle& other) const { return (mSlot == other.mSlot && mGeneration == other.mGeneration); }
+		inline bool operator!=(const ComponentPoolHandle& other) const { return (mSlot != other.mSlot || mGeneration != other.mGeneration); }
+	};
+
+
+	/**
+	*  @brief
+	*    Dense component pool class template
+	*
+	*  @remarks
+	*    Storage backend of "qsf::PooledComponentFactory". Components are allocated in pages of contiguous memory. Per memory slot, the pool
+	*    additionally keeps the owning prototype manager (the map for entity components, null pointer for unused slots) and a generation
+	*    counter in separate tightly packed arrays.
+	*
+	*    The dense view walks the pages in memory order and only touches the small owner array for skipping unused slots and components of
+	*    other maps. Compared to iterating a "qsf::ComponentCollection", which chases one pointer per component to a random heap address,
+	*    this keeps the hardware prefetcher busy instead of causing a cache miss per component.
+	*
+	*  @note
+	*    - Not thread-safe, components are created and destroyed by the main thread only
+	*    - Components of derived component types are not part of the pool, they have factories of their own
+	*/
+	template<typename COMPONENT>
+	class ComponentPool : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Iterable view of all components of one owner, in memory order
+		*/
+		class DenseView
+		{
+		public:
+			class iterator
+			{
+			public:
+				inline iterator(const ComponentPool& componentPool, const BasePrototypeManager* owner, uint32 slot);
+				inline bool operator==(const iterator& other) const	{ return (mSlot == other.mSlot); }
+				inline bool operator!=(const iterator& other) const	{ return (mSlot != other.mSlot); }
+				inline iterator& operator++();
+				inline COMPONENT* operator*() const;
+
+			private:
+				inline void skipForeignSlots();
+
+			private:
+				const ComponentPool*		mComponentPool;
+				const BasePrototypeManager* mOwner;
+				uint32						mSlot;
+			};
+
+		public:
+			inline DenseView(const ComponentPool& componentPool, const BasePrototypeManager& owner) : mComponentPool(componentPool), mOwner(owner) {}
+			inline bool empty() const;
+			inline size_t size() const;
+			inline iterator begin() const;
+			inline iterator end() const;
+
+		private:
+			const ComponentPool&		mComponentPool;
+			const BasePrototypeManager&	mOwner;
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] pageSize
+		*    Number of components to be stored in the same chunk of memory
+		*/
+		inline explicit ComponentPool(uint32 pageSize);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline ~ComponentPool();
+
+		/**
+		*  @brief
+		*    Return whether or not there are no components inside the pool
+		*/
+		inline bool empty() const;
+
+		/**
+		*  @brief
+		*    Return the number of components inside the pool
+		*/
+		inline uint32 getNumberOfComponents() const;
+
+		/**
+		*  @brief
+		*    Return the number of components owned by the given prototype manager
+		*/
+		inline uint32 getNumberOfComponents(const BasePrototypeManager& owner) const;
+
+		/**
+		*  @brief
+		*    Return the number of memory slots, including the unused ones
+		*/
+		inline uint32 getCapacity() const;
+
+		/**
+		*  @brief
+		*    Create a new component
+		*
+		*  @param[in] prototype
+		*    Prototype to pass to the component constructor
+		*
+		*  @return
+		*    The new component, always valid
+		*/
+		inline COMPONENT* create(Prototype& prototype);
+
+		/**
+		*  @brief
+		*    Destroy a component created by this pool
+		*/
+		inline void destroy(COMPONENT& component);
+
+		/**
+		*  @brief
+		*    Return a stable handle to the given component, an invalid handle if the component is not managed by this pool
+		*/
+		inline ComponentPoolHandle getHandle(const COMPONENT& component) const;
+
+		/**
+		*  @brief
+		*    Resolve a handle
+		*
+		*  @return
+		*    The component, null pointer if the handle is invalid or the component was destroyed in the meantime
+		*/
+		inline COMPONENT* tryGetComponent(const ComponentPoolHandle& handle) const;
+
+		/**
+		*  @brief
+		*    Return a dense view of all components owned by the given prototype manager
+		*
+		*  @note
+		*    - The view must not be used across creation or destruction of components of this type
+		*/
+		inline DenseView getDenseView(const BasePrototypeManager& owner) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		typedef boost::container::flat_map<const BasePrototypeManager*, uint32> ComponentCountMap;
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		inline COMPONENT& getComponentAtSlot(uint32 slot) const;
+		inline uint32 getSlotOfComponent(const COMPONENT& component) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		const uint32							 mPageSize;				///< Number of components per page; set by the constructor and must not be changed afterwards
+		std::vector<COMPONENT*>					 mPages;				///< Raw memory of the pages, each holding "mPageSize" components, we're responsible for freeing the memory
+		std::vector<const BasePrototypeManager*> mOwners;				///< Owner per slot, null pointer for unused slots
+		std::vector<uint32>						 mGenerations;			///< Generation per slot, incremented whenever a component gets destroyed
+		std::vector<uint32>						 mFreeSlots;			///< Unused slots, the next one to use is at the back
+		ComponentCountMap						 mComponentCounts;		///< Number of components per owner
+		uint32									 mNumberOfComponents;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/component/factory/ComponentPool-inl.h"
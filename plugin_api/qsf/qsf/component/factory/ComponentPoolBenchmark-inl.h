@@ -0,0 +1,102 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/map/Map.h"
+#include "qsf/map/query/ComponentMapQuery.h"
+#include "qsf/prototype/Prototype.h"
+#include "qsf/time/HighResolutionStopwatch.h"
+
+#include <algorithm>
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	inline typename ComponentPoolBenchmark<COMPONENT>::Result ComponentPoolBenchmark<COMPONENT>::run(Map& map, Prototype& scratchPrototype, uint32 numberOfRepetitions)
+	{
+		Result result;
+		const ComponentCollection::ComponentList<COMPONENT>& components = ComponentMapQuery(map).getAllInstances<COMPONENT>();
+		result.mNumberOfComponents = static_cast<uint32>(components.size());
+
+		// Collection side, the pointer list of the map
+		uint64 collectionChecksum = 0;
+		uint32 numberOfActiveCollectionComponents = 0;
+		{
+			HighResolutionStopwatch stopwatch;
+			for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+			{
+				for (const COMPONENT* component : components)
+				{
+					visitComponent(*component, collectionChecksum, numberOfActiveCollectionComponents);
+				}
+			}
+			result.mCollectionTime = stopwatch.getElapsed();
+		}
+
+		// Pool side, the same number of components in a temporary pool
+		uint64 poolChecksum = 0;
+		uint32 numberOfActivePoolComponents = 0;
+		{
+			ComponentPool<COMPONENT> componentPool(256);
+			std::vector<COMPONENT*> pooledComponents;
+			pooledComponents.reserve(result.mNumberOfComponents);
+			for (uint32 i = 0; i < result.mNumberOfComponents; ++i)
+			{
+				pooledComponents.push_back(componentPool.create(scratchPrototype));
+			}
+
+			const typename ComponentPool<COMPONENT>::DenseView denseView = componentPool.getDenseView(scratchPrototype.getPrototypeManager());
+			HighResolutionStopwatch stopwatch;
+			for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+			{
+				for (const COMPONENT* component : denseView)
+				{
+					visitComponent(*component, poolChecksum, numberOfActivePoolComponents);
+				}
+			}
+			result.mPoolTime = stopwatch.getElapsed();
+
+			for (COMPONENT* component : pooledComponents)
+			{
+				componentPool.destroy(*component);
+			}
+		}
+
+		result.mNumberOfActiveComponents = numberOfActiveCollectionComponents / std::max(numberOfRepetitions, 1u);
+		result.mResultsMatch = (collectionChecksum == poolChecksum);
+
+		return result;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	inline void ComponentPoolBenchmark<COMPONENT>::visitComponent(const COMPONENT& component, uint64& checksum, uint32& numberOfActiveComponents)
+	{
+		// Systems usually look at the active state first, it's counted but kept out of the checksum since the pooled components aren't started
+		if (component.isActive())
+		{
+			++numberOfActiveComponents;
+		}
+		checksum = checksum * 31 + component.getId();
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,124 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/component/factory/ComponentPool.h"
+#include "qsf/time/Time.h"
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Map;
+	class Prototype;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Benchmark of iterating the component collection of a map against iterating the dense view of a "qsf::ComponentPool"
+	*
+	*  @remarks
+	*    The collection side walks the component pointer list of the map exactly like "qsf::ai::StandardSystem" does.
+	*    The pool side creates the same number of components of the same type inside a temporary pool, owned by the scratch prototype
+	*    passed, and walks its dense view. Both sides do the same work per component, they read the active state and the component ID.
+	*    Engine component types like "qsf::ai::NavigationComponent" and the sensor components can't be registered with a
+	*    "qsf::PooledComponentFactory" by a plugin, the pooled copies are therefore only constructed: they are never registered at the
+	*    scratch prototype nor started. The component type has to be concrete, "qsf::ai::SensorComponent" is measured through
+	*    "qsf::ai::SingleSensorComponent" and "qsf::ai::MultipleSensorsComponent". Usage, e.g. from a debug command of a plugin inside a loaded map:
+	*    @code
+	*      qsf::Entity* scratchEntity = QSF_MAINMAP.createEntity();
+	*      const qsf::ComponentPoolBenchmark<qsf::ai::NavigationComponent>::Result navigationResult = qsf::ComponentPoolBenchmark<qsf::ai::NavigationComponent>::run(QSF_MAINMAP, *scratchEntity, 1000);
+	*      const qsf::ComponentPoolBenchmark<qsf::ai::SingleSensorComponent>::Result sensorResult = qsf::ComponentPoolBenchmark<qsf::ai::SingleSensorComponent>::run(QSF_MAINMAP, *scratchEntity, 1000);
+	*      QSF_MAINMAP.destroyEntityById(scratchEntity->getId());
+	*      QSF_LOG_PRINTS(INFO, "Navigation: " << navigationResult.mCollectionTime.getMilliseconds() << " ms collection, " << navigationResult.mPoolTime.getMilliseconds() << " ms pool");
+	*    @endcode
+	*/
+	template<typename COMPONENT>
+	class ComponentPoolBenchmark
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		struct Result
+		{
+			Time   mCollectionTime;				///< Time needed for all repetitions by iterating the component collection of the map
+			Time   mPoolTime;					///< Time needed for all repetitions by iterating the dense view of the pool
+			uint32 mNumberOfComponents;			///< Number of components of the map, the pool holds the same number
+			uint32 mNumberOfActiveComponents;	///< Number of active components of the map
+			bool   mResultsMatch;				///< "true" if both sides visited the same number of components with the same component IDs, else "false"
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Run the benchmark
+		*
+		*  @param[in] map
+		*    Map to take the component collection from, usually with a typical scene loaded
+		*  @param[in] scratchPrototype
+		*    Prototype the pooled components are constructed on, must not be destroyed during the call
+		*  @param[in] numberOfRepetitions
+		*    Number of times each side is iterated
+		*
+		*  @return
+		*    The measured times
+		*
+		*  @note
+		*    - Component collections of a type with derived component types contain the derived components as well,
+		*      the results then don't match since the pool only holds components of exactly this type
+		*/
+		inline static Result run(Map& map, Prototype& scratchPrototype, uint32 numberOfRepetitions);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Work done per component on both sides
+		*/
+		inline static void visitComponent(const COMPONENT& component, uint64& checksum, uint32& numberOfActiveComponents);
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/component/factory/ComponentPoolBenchmark-inl.h"
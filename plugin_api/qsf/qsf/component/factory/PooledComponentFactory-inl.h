@@ -0,0 +1,64 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	PooledComponentFactory<COMPONENT>::PooledComponentFactory(size_t pageSize) :
+		ComponentFactory(COMPONENT::COMPONENT_ID),
+		mComponentPool(static_cast<uint32>(pageSize))
+	{
+		// Nothing here
+	}
+
+	template<typename COMPONENT>
+	PooledComponentFactory<COMPONENT>::~PooledComponentFactory()
+	{
+		// The factory must not be destroyed while there are still managed components
+		QSF_ASSERT(mComponentPool.empty(), "There are still components using this factory that will get invalidated because their memory is freed!", QSF_REACT_NONE);
+	}
+
+	template<typename COMPONENT>
+	PooledComponentFactory<COMPONENT>& PooledComponentFactory<COMPONENT>::createInstance(size_t pageSize)
+	{
+		return *(new PooledComponentFactory<COMPONENT>(pageSize));
+	}
+
+	template<typename COMPONENT>
+	inline const ComponentPool<COMPONENT>& PooledComponentFactory<COMPONENT>::getComponentPool() const
+	{
+		return mComponentPool;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual qsf::ComponentFactory methods          ]
+	//[-------------------------------------------------------]
+	template<typename COMPONENT>
+	Component* PooledComponentFactory<COMPONENT>::createComponent(Prototype& prototype)
+	{
+		// Let the pool create a new component and pass the prototype to the constructor
+		return incExisting(mComponentPool.create(prototype));
+	}
+
+	template<typename COMPONENT>
+	void PooledComponentFactory<COMPONENT>::destroyComponent(Component& component)
+	{
+		// Let the pool destroy the component
+		mComponentPool.destroy(static_cast<COMPONENT&>(component));
+		decExisting();
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
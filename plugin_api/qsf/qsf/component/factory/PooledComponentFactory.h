@@ -0,0 +1,132 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/component/factory/ComponentFactory.h"
+#include "qsf/component/factory/ComponentPool.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Pooled component factory class template
+	*
+	*  @remarks
+	*    Alternative to "qsf::PagedComponentFactory" allocating the components inside a "qsf::ComponentPool".
+	*    Meant for component types of a plugin which are iterated a lot by a system of the same plugin. The plugin keeps the
+	*    factory reference returned by "qsf::PooledComponentFactory::createInstance()" and hands the factory to the component system:
+	*    @code
+	*      PooledComponentFactory<MyComponent>& factory = PooledComponentFactory<MyComponent>::createInstance(256);
+	*      QSF_COMPONENT.registerComponentFactory(factory);
+	*      ...
+	*      for (MyComponent* myComponent : factory.getComponentPool().getDenseView(map))
+	*    @endcode
+	*    The dense view only covers components of exactly this type, a component type with derived component types should keep using
+	*    its component collection. Stable handles to the components are available through the pool as well.
+	*/
+	template<typename COMPONENT>
+	class PooledComponentFactory : public ComponentFactory
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param pageSize
+		*    Number of components to be stored in the same chunk of memory
+		*
+		*  @note
+		*    - Unlike the ComponentFactory constructor, there's no need to pass the component ID for it is already defined by the template parameter
+		*/
+		PooledComponentFactory(size_t pageSize);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		virtual ~PooledComponentFactory();
+
+		/**
+		*  @brief
+		*    Static factory method
+		*
+		*  @param pageSize
+		*    Number of components to be stored in the same chunk of memory
+		*
+		*  @note
+		*    - In contrast to "qsf::PagedComponentFactory::createInstance()", the concrete type is returned for access to the pool
+		*/
+		static PooledComponentFactory& createInstance(size_t pageSize);
+
+		/**
+		*  @brief
+		*    Return the component pool holding the components created by this factory
+		*/
+		inline const ComponentPool<COMPONENT>& getComponentPool() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual qsf::ComponentFactory methods          ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Create a component instance
+		*
+		*  @return
+		*    Create a component instance, null pointer on error, you're responsible for destroying the instance in case you no longer need it
+		*/
+		virtual Component* createComponent(Prototype& prototype) override;
+
+		/**
+		*  @brief
+		*    Destroy a component instance
+		*
+		*  @param[in] component
+		*    Component instance to destroy, after this method call this instance is considered to be no longer valid
+		*/
+		virtual void destroyComponent(Component& component) override;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		ComponentPool<COMPONENT> mComponentPool;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/component/factory/PooledComponentFactory-inl.h"
@@ -0,0 +1,362 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialPartition2D.h"
+#include "qsf/base/GetUninitialized.h"
+
+#include <glm/glm.hpp>
+
+#include <boost/container/flat_map.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    2D loose grid spatial partition implementation
+	*
+	*  @remarks
+	*    Optimized for many moving items: Each item is stored with fattened bounds, which are its bounds enlarged by a margin, and
+	*    belongs to exactly one grid cell, the one containing the center of its fattened bounds. As long as an item moves inside its
+	*    fattened bounds, "update()" only refreshes the cached bounds, there's no relinking at all. Only when an item leaves its fattened
+	*    bounds, they are recomputed and the item moves to another cell if needed, which is a constant time operation as well.
+	*
+	*    Since items are sorted into cells by their center, a cell is "loose": its content may stick out of the cell. Lookups therefore
+	*    visit all cells within the query bounds enlarged by the largest fattened item extent and reject cells by the union of the
+	*    fattened bounds of their items. Items outside of the world bounds are clamped into the border cells.
+	*
+	*    The ItemTraits requirements are the same as for "qsf::SpatialPartition2DQuadtree", additionally "ItemTraits::Bounds" must
+	*    have "glm::vec2 min" and "glm::vec2 max" members.
+	*
+	*    "qsf::SpatialPartitionManagerComponent" always uses quadtrees, the loose grid is meant to be owned by the code which keeps the
+	*    items up-to-date, e.g. a plugin system with "qsf::SpatialComponentPartition2D::ComponentItem" items for its partition ID.
+	*    See "qsf::SpatialPartitionBenchmark" for a comparison with the quadtree.
+	*
+	*  @note
+	*    - Choose the cell size in the order of the typical query size, and the margin in the order of the distance an item moves within a few updates
+	*/
+	template<class ItemType, class SpatialItemTraits>
+	class SpatialPartition2DLooseGrid : public SpatialPartition2D<ItemType, SpatialItemTraits>
+	{
+	public:
+		typedef typename SpatialPartition2D<ItemType, SpatialItemTraits>::Item Item;
+		typedef typename SpatialPartition2D<ItemType, SpatialItemTraits>::ItemIdentity ItemIdentity;
+		typedef typename SpatialPartition2D<ItemType, SpatialItemTraits>::ItemBounds ItemBounds;
+		typedef typename SpatialPartition2D<ItemType, SpatialItemTraits>::ItemSet ItemSet;
+		typedef typename SpatialPartition2D<ItemType, SpatialItemTraits>::ItemTraits ItemTraits;
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] worldBounds
+		*    Bounds covered by the grid cells; items outside are still supported, but end up in the border cells
+		*  @param[in] cellSize
+		*    Edge length of a grid cell
+		*  @param[in] margin
+		*    Distance the item bounds are enlarged by on each side to get the fattened bounds
+		*/
+		SpatialPartition2DLooseGrid(const ItemBounds& worldBounds, float cellSize = 32.0f, float margin = 2.0f) :
+			mWorldMin(worldBounds.min),
+			mInverseCellSize(1.0f / cellSize),
+			mMargin(margin),
+			mMaxFattenedHalfExtent(0.0f, 0.0f)
+		{
+			const glm::vec2 worldSize = worldBounds.max - worldBounds.min;
+			mNumberOfCellsX = std::max(static_cast<uint32>(std::ceil(worldSize.x * mInverseCellSize)), 1u);
+			mNumberOfCellsY = std::max(static_cast<uint32>(std::ceil(worldSize.y * mInverseCellSize)), 1u);
+			mCells.resize(mNumberOfCellsX * mNumberOfCellsY);
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Public virtual SpatialPartition2D<> methods           ]
+	//[-------------------------------------------------------]
+	public:
+		virtual bool add(const Item& item) override
+		{
+			std::pair<typename EntryIndexMap::iterator, bool> insertResult = mEntryIndices.emplace(this->getItemIdentity(item), getUninitialized<uint32>());
+			if (insertResult.second)
+			{
+				uint32 entryIndex;
+				if (mFreeEntries.empty())
+				{
+					entryIndex = static_cast<uint32>(mEntries.size());
+					mEntries.push_back(Entry());
+				}
+				else
+				{
+					entryIndex = mFreeEntries.back();
+					mFreeEntries.pop_back();
+				}
+				insertResult.first->second = entryIndex;
+
+				Entry& entry = mEntries[entryIndex];
+				entry.item = item;
+				entry.bounds = this->getItemBounds(item);
+				fattenBounds(entry);
+				linkEntryIntoCell(entryIndex, getCellIndex(entry.fattenedBounds));
+
+				return true;
+			}
+
+			return false;
+		}
+
+		virtual bool remove(const ItemIdentity& itemIdentity) override
+		{
+			typename EntryIndexMap::iterator found = mEntryIndices.find(itemIdentity);
+			if (found != mEntryIndices.end())
+			{
+				const uint32 entryIndex = found->second;
+				mEntryIndices.erase(found);
+				unlinkEntryFromCell(entryIndex);
+				mFreeEntries.push_back(entryIndex);
+
+				return true;
+			}
+
+			return false;
+		}
+
+		virtual void update(const ItemIdentity& itemIdentity) override
+		{
+			typename EntryIndexMap::iterator found = mEntryIndices.find(itemIdentity);
+			if (found == mEntryIndices.end())
+			{
+				return;
+			}
+
+			const uint32 entryIndex = found->second;
+			Entry& entry = mEntries[entryIndex];
+			entry.bounds = this->getItemBounds(entry.item);
+
+			// Nothing else to do as long as the item stays inside its fattened bounds
+			if (!isBoxInsideBox(entry.fattenedBounds, entry.bounds))
+			{
+				fattenBounds(entry);
+
+				const uint32 cellIndex = getCellIndex(entry.fattenedBounds);
+				if (cellIndex != entry.cellIndex)
+				{
+					unlinkEntryFromCell(entryIndex);
+					linkEntryIntoCell(entryIndex, cellIndex);
+				}
+				else
+				{
+					growBox(mCells[cellIndex].looseBounds, entry.fattenedBounds);
+				}
+			}
+		}
+
+		virtual void lookUpElementsInRange(const ItemBounds& bounds, ItemSet& outFoundObjects) override
+		{
+			forEachCandidateEntry(bounds.min, bounds.max, [&](const Entry& entry)
+			{
+				if (SpatialPartition2D<ItemType, SpatialItemTraits>::doBoundsOverlap(entry.bounds, bounds))
+				{
+					outFoundObjects.insert(entry.item);
+				}
+			});
+		}
+
+		/**
+		*  @brief
+		*    Looks up all elements overlapping the given bounds of any type supported by "ItemTraits::doBoundsOverlap()"
+		*
+		*  @param[in] enclosingMin
+		*    Minimum of an axis aligned box enclosing the bounds
+		*  @param[in] enclosingMax
+		*    Maximum of an axis aligned box enclosing the bounds
+		*/
+		template<typename AnyBounds>
+		void lookUpElementsInAnyRange(const AnyBounds& bounds, const glm::vec2& enclosingMin, const glm::vec2& enclosingMax, ItemSet& outFoundObjects)
+		{
+			forEachCandidateEntry(enclosingMin, enclosingMax, [&](const Entry& entry)
+			{
+				if (SpatialPartition2D<ItemType, SpatialItemTraits>::doBoundsOverlap(entry.bounds, bounds))
+				{
+					outFoundObjects.insert(entry.item);
+				}
+			});
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Per item data
+		*/
+		struct Entry
+		{
+			Item item;					///< Storage for the generic item data
+			ItemBounds bounds;			///< Cached bounds for item
+			ItemBounds fattenedBounds;	///< Item bounds enlarged by the margin, defines the cell
+			uint32 cellIndex;			///< Index of the cell the item is in
+			uint32 indexInCell;			///< Index of the item inside the entry list of its cell
+		};
+
+		/**
+		*  @brief
+		*    Grid cell
+		*/
+		struct Cell
+		{
+			std::vector<uint32> entryIndices;	///< Indices of the entries inside this cell
+			ItemBounds looseBounds;				///< Union of the fattened bounds of the items inside this cell, only valid if there are items
+		};
+
+		/**
+		*  @brief
+		*    Custom map type which can quickly look up the entry index based on the item identity
+		*/
+		typedef boost::container::flat_map<ItemIdentity, uint32> EntryIndexMap;
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		void fattenBounds(Entry& entry)
+		{
+			entry.fattenedBounds.min = entry.bounds.min - mMargin;
+			entry.fattenedBounds.max = entry.bounds.max + mMargin;
+
+			const glm::vec2 halfExtent = (entry.fattenedBounds.max - entry.fattenedBounds.min) * 0.5f;
+			mMaxFattenedHalfExtent = glm::max(mMaxFattenedHalfExtent, halfExtent);
+		}
+
+		uint32 getCellIndex(const ItemBounds& fattenedBounds) const
+		{
+			const glm::vec2 center = (fattenedBounds.min + fattenedBounds.max) * 0.5f;
+			return getCellY(center.y) * mNumberOfCellsX + getCellX(center.x);
+		}
+
+		uint32 getCellX(float x) const
+		{
+			return static_cast<uint32>(glm::clamp((x - mWorldMin.x) * mInverseCellSize, 0.0f, static_cast<float>(mNumberOfCellsX - 1)));
+		}
+
+		uint32 getCellY(float y) const
+		{
+			return static_cast<uint32>(glm::clamp((y - mWorldMin.y) * mInverseCellSize, 0.0f, static_cast<float>(mNumberOfCellsY - 1)));
+		}
+
+		void linkEntryIntoCell(uint32 entryIndex, uint32 cellIndex)
+		{
+			Entry& entry = mEntries[entryIndex];
+			Cell& cell = mCells[cellIndex];
+			if (cell.entryIndices.empty())
+			{
+				cell.looseBounds = entry.fattenedBounds;
+			}
+			else
+			{
+				growBox(cell.looseBounds, entry.fattenedBounds);
+			}
+
+			entry.cellIndex = cellIndex;
+			entry.indexInCell = static_cast<uint32>(cell.entryIndices.size());
+			cell.entryIndices.push_back(entryIndex);
+		}
+
+		void unlinkEntryFromCell(uint32 entryIndex)
+		{
+			// Swap with the last entry of the cell, the loose bounds are only reset as soon as the cell gets empty
+			const Entry& entry = mEntries[entryIndex];
+			std::vector<uint32>& entryIndices = mCells[entry.cellIndex].entryIndices;
+			const uint32 lastEntryIndex = entryIndices.back();
+			entryIndices[entry.indexInCell] = lastEntryIndex;
+			mEntries[lastEntryIndex].indexInCell = entry.indexInCell;
+			entryIndices.pop_back();
+		}
+
+		template<typename Function>
+		void forEachCandidateEntry(const glm::vec2& queryMin, const glm::vec2& queryMax, const Function& function) const
+		{
+			// Items may stick out of their cell by up to the largest fattened half extent
+			const uint32 firstCellX = getCellX(queryMin.x - mMaxFattenedHalfExtent.x);
+			const uint32 lastCellX = getCellX(queryMax.x + mMaxFattenedHalfExtent.x);
+			const uint32 firstCellY = getCellY(queryMin.y - mMaxFattenedHalfExtent.y);
+			const uint32 lastCellY = getCellY(queryMax.y + mMaxFattenedHalfExtent.y);
+
+			for (uint32 cellY = firstCellY; cellY <= lastCellY; ++cellY)
+			{
+				for (uint32 cellX = firstCellX; cellX <= lastCellX; ++cellX)
+				{
+					const Cell& cell = mCells[cellY * mNumberOfCellsX + cellX];
+					if (!cell.entryIndices.empty() && !(cell.looseBounds.max.x < queryMin.x || cell.looseBounds.min.x > queryMax.x || cell.looseBounds.max.y < queryMin.y || cell.looseBounds.min.y > queryMax.y))
+					{
+						for (uint32 entryIndex : cell.entryIndices)
+						{
+							function(mEntries[entryIndex]);
+						}
+					}
+				}
+			}
+		}
+
+		static bool isBoxInsideBox(const ItemBounds& outerBounds, const ItemBounds& innerBounds)
+		{
+			return (innerBounds.min.x >= outerBounds.min.x && innerBounds.min.y >= outerBounds.min.y && innerBounds.max.x <= outerBounds.max.x && innerBounds.max.y <= outerBounds.max.y);
+		}
+
+		static void growBox(ItemBounds& bounds, const ItemBounds& otherBounds)
+		{
+			bounds.min = glm::min(bounds.min, otherBounds.min);
+			bounds.max = glm::max(bounds.max, otherBounds.max);
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		glm::vec2 mWorldMin;				///< Minimum of the world bounds, origin of the grid
+		float mInverseCellSize;				///< One divided by the cell edge length
+		float mMargin;						///< Distance the item bounds are enlarged by on each side
+		uint32 mNumberOfCellsX;				///< Number of cells along the x axis
+		uint32 mNumberOfCellsY;				///< Number of cells along the y axis
+		glm::vec2 mMaxFattenedHalfExtent;	///< Largest half extent of any fattened bounds so far, never shrinks
+		std::vector<Cell> mCells;			///< Grid cells, row by row
+		std::vector<Entry> mEntries;		///< Data of all items, including unused entries
+		std::vector<uint32> mFreeEntries;	///< Indices of unused entries
+		EntryIndexMap mEntryIndices;		///< Map of all items registered in the grid
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
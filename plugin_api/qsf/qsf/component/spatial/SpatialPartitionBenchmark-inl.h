@@ -0,0 +1,204 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/time/HighResolutionStopwatch.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline SpatialPartitionBenchmark::Settings::Settings() :
+		mNumberOfStaticItems(5000),
+		mNumberOfVehicles(300),
+		mNumberOfPedestrians(500),
+		mNumberOfTicks(300),
+		mTimePassed(1.0f / 30.0f),
+		mWorldSize(2048.0f),
+		mQueryRadius(15.0f),
+		mLooseGridCellSize(32.0f),
+		mLooseGridMargin(2.0f)
+	{
+		// Nothing here
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	inline SpatialPartitionBenchmark::Result SpatialPartitionBenchmark::run(const Settings& settings)
+	{
+		Item::Bounds worldBounds;
+		worldBounds.min = glm::vec2(-0.5f * settings.mWorldSize);
+		worldBounds.max = glm::vec2(0.5f * settings.mWorldSize);
+
+		Result result;
+		uint64 numberOfLooseGridFoundItems = 0;
+		uint64 quadtreeChecksum = 0;
+		uint64 looseGridChecksum = 0;
+		{
+			SpatialPartition2DQuadtree<Item, Item> quadtree(worldBounds);
+			quadtreeChecksum = replay(settings, quadtree, result.mNumberOfFoundItems, result.mQuadtreeTime);
+		}
+		{
+			SpatialPartition2DLooseGrid<Item, Item> looseGrid(worldBounds, settings.mLooseGridCellSize, settings.mLooseGridMargin);
+			looseGridChecksum = replay(settings, looseGrid, numberOfLooseGridFoundItems, result.mLooseGridTime);
+		}
+		result.mResultsMatch = (quadtreeChecksum == looseGridChecksum && result.mNumberOfFoundItems == numberOfLooseGridFoundItems);
+
+		return result;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	inline void SpatialPartitionBenchmark::createScene(const Settings& settings, Scene& scene)
+	{
+		const float halfWorldSize = 0.5f * settings.mWorldSize;
+		const uint32 numberOfMovers = settings.mNumberOfVehicles + settings.mNumberOfPedestrians;
+		const uint32 numberOfItems = settings.mNumberOfStaticItems + numberOfMovers;
+		scene.randomState = 12345;
+		scene.bounds.resize(numberOfItems);
+		scene.movers.resize(numberOfMovers);
+
+		for (uint32 itemIndex = 0; itemIndex < numberOfItems; ++itemIndex)
+		{
+			// Movers come first: vehicles, then pedestrians
+			const bool isVehicle = (itemIndex < settings.mNumberOfVehicles);
+			const bool isPedestrian = (!isVehicle && itemIndex < numberOfMovers);
+			const float halfSize = isPedestrian ? 0.3f : (isVehicle ? 2.5f : getRandomFloat(scene, 0.5f, 10.0f));
+			const glm::vec2 center(getRandomFloat(scene, -halfWorldSize, halfWorldSize), getRandomFloat(scene, -halfWorldSize, halfWorldSize));
+			scene.bounds[itemIndex].min = center - halfSize;
+			scene.bounds[itemIndex].max = center + halfSize;
+
+			if (itemIndex < numberOfMovers)
+			{
+				Mover& mover = scene.movers[itemIndex];
+				mover.itemIndex = itemIndex;
+				if (isVehicle)
+				{
+					// Drive along an axis aligned lane
+					const float speed = getRandomFloat(scene, 8.0f, 14.0f) * ((itemIndex & 2) ? 1.0f : -1.0f);
+					mover.velocity = (itemIndex & 1) ? glm::vec2(speed, 0.0f) : glm::vec2(0.0f, speed);
+					mover.timeUntilTurn = -1.0f;
+				}
+				else
+				{
+					mover.velocity = glm::vec2(0.0f, 0.0f);
+					mover.timeUntilTurn = 0.0f;
+				}
+			}
+		}
+	}
+
+	inline void SpatialPartitionBenchmark::moveScene(const Settings& settings, Scene& scene)
+	{
+		const float halfWorldSize = 0.5f * settings.mWorldSize;
+		for (Mover& mover : scene.movers)
+		{
+			if (mover.timeUntilTurn >= 0.0f)
+			{
+				mover.timeUntilTurn -= settings.mTimePassed;
+				if (mover.timeUntilTurn < 0.0f)
+				{
+					// Pedestrian picks a new walking direction
+					const float angle = getRandomFloat(scene, 0.0f, glm::two_pi<float>());
+					const float speed = getRandomFloat(scene, 1.0f, 1.5f);
+					mover.velocity = glm::vec2(std::cos(angle), std::sin(angle)) * speed;
+					mover.timeUntilTurn = getRandomFloat(scene, 2.0f, 8.0f);
+				}
+			}
+
+			Item::Bounds& bounds = scene.bounds[mover.itemIndex];
+			const glm::vec2 movement = mover.velocity * settings.mTimePassed;
+			bounds.min += movement;
+			bounds.max += movement;
+
+			// Turn around at the world border
+			const glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+			if (std::abs(center.x) > halfWorldSize)
+			{
+				mover.velocity.x = (center.x > 0.0f) ? -std::abs(mover.velocity.x) : std::abs(mover.velocity.x);
+			}
+			if (std::abs(center.y) > halfWorldSize)
+			{
+				mover.velocity.y = (center.y > 0.0f) ? -std::abs(mover.velocity.y) : std::abs(mover.velocity.y);
+			}
+		}
+	}
+
+	inline float SpatialPartitionBenchmark::getRandomFloat(Scene& scene, float minimum, float maximum)
+	{
+		// Simple linear congruential generator, only needs to be deterministic
+		scene.randomState = scene.randomState * 1664525u + 1013904223u;
+		return minimum + (maximum - minimum) * (static_cast<float>(scene.randomState >> 8) / 16777216.0f);
+	}
+
+	inline uint64 SpatialPartitionBenchmark::replay(const Settings& settings, SpatialPartition2D<Item, Item>& partition, uint64& outNumberOfFoundItems, Time& outTime)
+	{
+		Scene scene;
+		createScene(settings, scene);
+
+		SpatialPartition2D<Item, Item>::ItemSet foundItems;
+		uint64 checksum = 0;
+		outNumberOfFoundItems = 0;
+
+		HighResolutionStopwatch stopwatch;
+		for (uint32 itemIndex = 0; itemIndex < scene.bounds.size(); ++itemIndex)
+		{
+			Item item;
+			item.id = itemIndex;
+			item.bounds = &scene.bounds[itemIndex];
+			partition.add(item);
+		}
+
+		for (uint32 tick = 0; tick < settings.mNumberOfTicks; ++tick)
+		{
+			moveScene(settings, scene);
+			for (const Mover& mover : scene.movers)
+			{
+				partition.update(mover.itemIndex);
+			}
+
+			// Each moving item looks up its surroundings
+			for (const Mover& mover : scene.movers)
+			{
+				const Item::Bounds& bounds = scene.bounds[mover.itemIndex];
+				const glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+				Item::Bounds queryBounds;
+				queryBounds.min = center - settings.mQueryRadius;
+				queryBounds.max = center + settings.mQueryRadius;
+
+				foundItems.clear();
+				partition.lookUpElementsInRange(queryBounds, foundItems);
+				outNumberOfFoundItems += foundItems.size();
+				for (const Item& foundItem : foundItems)
+				{
+					checksum = checksum * 31 + foundItem.id;
+				}
+			}
+		}
+		outTime = stopwatch.getElapsed();
+
+		return checksum;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,187 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialPartition2DQuadtree.h"
+#include "qsf/component/spatial/SpatialPartition2DLooseGrid.h"
+#include "qsf/time/Time.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Benchmark of "qsf::SpatialPartition2DLooseGrid" against "qsf::SpatialPartition2DQuadtree" replaying typical EM5 movement
+	*
+	*  @remarks
+	*    Both partitions get the same scene and the same movement, driven by a fixed random seed:
+	*    - Static items like parked vehicles, props and buildings, which are never updated
+	*    - Vehicles driving along straight axis aligned lanes at 8 to 14 m/s, turning around at the world border
+	*    - Pedestrians walking at 1 to 1.5 m/s and changing their direction every few seconds
+	*    Each tick all moving items are updated, then each moving item looks up its surroundings like a perception query does.
+	*    Usage, e.g. from a debug command of a plugin:
+	*    @code
+	*      qsf::SpatialPartitionBenchmark::Settings settings;
+	*      const qsf::SpatialPartitionBenchmark::Result result = qsf::SpatialPartitionBenchmark::run(settings);
+	*      QSF_LOG_PRINTS(INFO, "Quadtree: " << result.mQuadtreeTime.getMilliseconds() << " ms, loose grid: " << result.mLooseGridTime.getMilliseconds() << " ms");
+	*    @endcode
+	*/
+	class SpatialPartitionBenchmark
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		struct Settings
+		{
+			uint32 mNumberOfStaticItems;	///< Number of items which never move
+			uint32 mNumberOfVehicles;		///< Number of driving vehicles
+			uint32 mNumberOfPedestrians;	///< Number of walking pedestrians
+			uint32 mNumberOfTicks;			///< Number of simulated ticks
+			float  mTimePassed;				///< Simulated time per tick in seconds
+			float  mWorldSize;				///< Edge length of the square world, centered at the origin
+			float  mQueryRadius;			///< Half edge length of the box each moving item looks up per tick
+			float  mLooseGridCellSize;		///< Cell size of the loose grid
+			float  mLooseGridMargin;		///< Margin of the loose grid
+
+			inline Settings();
+		};
+
+		struct Result
+		{
+			Time   mQuadtreeTime;		///< Time needed by "qsf::SpatialPartition2DQuadtree" for all ticks
+			Time   mLooseGridTime;		///< Time needed by "qsf::SpatialPartition2DLooseGrid" for all ticks
+			uint64 mNumberOfFoundItems;	///< Summed up number of items found by all lookups
+			bool   mResultsMatch;		///< "true" if both partitions found the same items, else "false"
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Run the benchmark
+		*
+		*  @param[in] settings
+		*    Scene and movement settings
+		*
+		*  @return
+		*    The measured times
+		*/
+		inline static Result run(const Settings& settings);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Benchmark item, also serves as the implementation of the SpatialPartition2D::ItemTraits policy
+		*/
+		struct Item
+		{
+			typedef uint32 Identity;
+			struct Bounds
+			{
+				glm::vec2 min;
+				glm::vec2 max;
+			};
+
+			uint32		  id;
+			const Bounds* bounds;	///< Current bounds, owned by the benchmark
+
+			inline static Bounds getBounds(const Item& item) { return *item.bounds; }
+			inline static const Identity& getIdentity(const Item& item) { return item.id; }
+			inline static bool doBoundsOverlap(const Bounds& a, const Bounds& b) { return !(a.max.x < b.min.x || a.min.x > b.max.x || a.max.y < b.min.y || a.min.y > b.max.y); }
+			inline static bool areBoundsEncompassingBounds(const Bounds& outerBounds, const Bounds& innerBounds) { return (outerBounds.max.x > innerBounds.max.x && outerBounds.max.y > innerBounds.max.y && outerBounds.min.x < innerBounds.min.x && outerBounds.min.y < innerBounds.min.y); }
+			inline static void splitBoundsQuadrant(const Bounds& bounds, uint32 quadrant, Bounds& outQuadrantBounds)
+			{
+				const glm::vec2 halfSize = (bounds.max - bounds.min) * 0.5f;
+				outQuadrantBounds.min.x = bounds.min.x + ((quadrant & 1) ? halfSize.x : 0.0f);
+				outQuadrantBounds.min.y = bounds.min.y + ((quadrant & 2) ? halfSize.y : 0.0f);
+				outQuadrantBounds.max = outQuadrantBounds.min + halfSize;
+			}
+
+			inline bool operator == (const Item& other) const { return (id == other.id); }
+			inline bool operator < (const Item& other) const { return (id < other.id); }
+		};
+
+		/**
+		*  @brief
+		*    Moving item
+		*/
+		struct Mover
+		{
+			uint32	  itemIndex;
+			glm::vec2 velocity;
+			float	  timeUntilTurn;	///< Pedestrians only, negative for vehicles
+		};
+
+		/**
+		*  @brief
+		*    Scene state, the movement is deterministic for the same seed
+		*/
+		struct Scene
+		{
+			std::vector<Item::Bounds> bounds;
+			std::vector<Mover>		  movers;
+			uint32					  randomState;
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		inline static void createScene(const Settings& settings, Scene& scene);
+		inline static void moveScene(const Settings& settings, Scene& scene);
+		inline static float getRandomFloat(Scene& scene, float minimum, float maximum);
+
+		/**
+		*  @brief
+		*    Replay the movement using the given partition
+		*
+		*  @return
+		*    Checksum of the found items
+		*/
+		inline static uint64 replay(const Settings& settings, SpatialPartition2D<Item, Item>& partition, uint64& outNumberOfFoundItems, Time& outTime);
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialPartitionBenchmark-inl.h"
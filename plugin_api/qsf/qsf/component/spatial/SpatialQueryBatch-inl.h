@@ -0,0 +1,118 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/base/error/ErrorHandling.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline SpatialQueryBatch::SpatialQueryBatch()
+	{
+		// Nothing here
+	}
+
+	inline SpatialQueryBatch::~SpatialQueryBatch()
+	{
+		// Nothing here
+	}
+
+	inline void SpatialQueryBatch::clear()
+	{
+		mQueryShapes.clear();
+		mResults.clear();
+		mResultOffsets.clear();
+	}
+
+	inline uint32 SpatialQueryBatch::addCircleQuery(const glm::vec2& center, float radius)
+	{
+		SpatialQueryShape queryShape;
+		queryShape.mMin = queryShape.mMax = center;
+		queryShape.mCenter = center;
+		queryShape.mSquaredRadius = radius * radius;
+		mQueryShapes.push_back(queryShape);
+
+		// Results are outdated now
+		mResultOffsets.clear();
+		return static_cast<uint32>(mQueryShapes.size() - 1);
+	}
+
+	inline uint32 SpatialQueryBatch::addBoundsQuery(const glm::vec2& min, const glm::vec2& max)
+	{
+		SpatialQueryShape queryShape;
+		queryShape.mMin = min;
+		queryShape.mMax = max;
+		queryShape.mCenter = (min + max) * 0.5f;
+		queryShape.mSquaredRadius = -1.0f;
+		mQueryShapes.push_back(queryShape);
+
+		// Results are outdated now
+		mResultOffsets.clear();
+		return static_cast<uint32>(mQueryShapes.size() - 1);
+	}
+
+	inline uint32 SpatialQueryBatch::getNumberOfQueries() const
+	{
+		return static_cast<uint32>(mQueryShapes.size());
+	}
+
+	inline const SpatialQueryShape& SpatialQueryBatch::getQueryShape(uint32 queryIndex) const
+	{
+		QSF_ASSERT(queryIndex < mQueryShapes.size(), "Invalid spatial query index " << queryIndex, QSF_REACT_THROW);
+		return mQueryShapes[queryIndex];
+	}
+
+	inline bool SpatialQueryBatch::hasResults() const
+	{
+		return (mResultOffsets.size() == mQueryShapes.size() + 1);
+	}
+
+	inline SpatialQueryBatch::ResultRange SpatialQueryBatch::getResults(uint32 queryIndex) const
+	{
+		QSF_ASSERT(hasResults(), "The spatial query batch was not executed yet", QSF_REACT_THROW);
+		QSF_ASSERT(queryIndex < mQueryShapes.size(), "Invalid spatial query index " << queryIndex, QSF_REACT_THROW);
+
+		ResultRange resultRange;
+		resultRange.mBegin = mResults.data() + mResultOffsets[queryIndex];
+		resultRange.mEnd = mResults.data() + mResultOffsets[queryIndex + 1];
+		return resultRange;
+	}
+
+	inline uint32 SpatialQueryBatch::getTotalNumberOfResults() const
+	{
+		return static_cast<uint32>(mResults.size());
+	}
+
+	inline void SpatialQueryBatch::beginResults()
+	{
+		mResults.clear();
+		mResultOffsets.clear();
+		mResultOffsets.reserve(mQueryShapes.size() + 1);
+		mResultOffsets.push_back(0);
+	}
+
+	inline void SpatialQueryBatch::addResult(Component& component)
+	{
+		mResults.push_back(&component);
+	}
+
+	inline void SpatialQueryBatch::endQueryResults()
+	{
+		mResultOffsets.push_back(static_cast<uint32>(mResults.size()));
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
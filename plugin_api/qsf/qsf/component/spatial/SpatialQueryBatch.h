@@ -0,0 +1,214 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Component;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Shape of a single spatial partition query, either an axis aligned box or a circle
+	*/
+	struct SpatialQueryShape
+	{
+		glm::vec2 mMin;				///< Minimum of the box, only used for box queries
+		glm::vec2 mMax;				///< Maximum of the box, only used for box queries
+		glm::vec2 mCenter;			///< Center of the circle, only used for circle queries
+		float	  mSquaredRadius;	///< Squared radius of the circle, negative for box queries
+
+		inline bool isCircle() const { return (mSquaredRadius >= 0.0f); }
+
+		/**
+		*  @brief
+		*    Return whether or not the given axis aligned box overlaps the query shape; same semantics as the "doBoundsOverlap()" item traits of the spatial partitions
+		*/
+		inline bool isOverlappingBox(float minX, float minY, float maxX, float maxY) const
+		{
+			if (isCircle())
+			{
+				// Squared distance from the circle center to the box
+				const float distanceX = std::max(std::max(minX - mCenter.x, mCenter.x - maxX), 0.0f);
+				const float distanceY = std::max(std::max(minY - mCenter.y, mCenter.y - maxY), 0.0f);
+				return (distanceX * distanceX + distanceY * distanceY < mSquaredRadius);
+			}
+			else
+			{
+				return !(maxX < mMin.x || minX > mMax.x || maxY < mMin.y || minY > mMax.y);
+			}
+		}
+	};
+
+
+	/**
+	*  @brief
+	*    Batch of spatial partition queries with a flat result buffer
+	*
+	*  @remarks
+	*    Collect the query shapes, let "qsf::SpatialQuerySnapshot2D::executeBatch()" answer all of them at once,
+	*    then read the result range of each query. The results of all queries are stored in a single buffer which keeps its memory when
+	*    the batch is cleared, so a batch reused each tick doesn't allocate memory once it reached its working size.
+	*
+	*  @note
+	*    - Unlike the single queries of "qsf::SpatialPartitionManagerComponent", the order of the components inside a result range is unspecified
+	*/
+	class SpatialQueryBatch : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Found components of a single query, valid until the batch is modified or executed again
+		*/
+		struct ResultRange
+		{
+			Component* const* mBegin;
+			Component* const* mEnd;
+
+			inline Component* const* begin() const { return mBegin; }
+			inline Component* const* end() const { return mEnd; }
+			inline bool empty() const { return (mBegin == mEnd); }
+			inline size_t size() const { return static_cast<size_t>(mEnd - mBegin); }
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		inline SpatialQueryBatch();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline ~SpatialQueryBatch();
+
+		/**
+		*  @brief
+		*    Remove all queries and results, the memory is kept for reuse
+		*/
+		inline void clear();
+
+		/**
+		*  @brief
+		*    Add a query for all components inside the given circle
+		*
+		*  @return
+		*    Index of the query
+		*/
+		inline uint32 addCircleQuery(const glm::vec2& center, float radius);
+
+		/**
+		*  @brief
+		*    Add a query for all components inside the given axis aligned box
+		*
+		*  @return
+		*    Index of the query
+		*/
+		inline uint32 addBoundsQuery(const glm::vec2& min, const glm::vec2& max);
+
+		/**
+		*  @brief
+		*    Return the number of queries
+		*/
+		inline uint32 getNumberOfQueries() const;
+
+		/**
+		*  @brief
+		*    Return the shape of the given query
+		*/
+		inline const SpatialQueryShape& getQueryShape(uint32 queryIndex) const;
+
+		/**
+		*  @brief
+		*    Return whether or not the batch was executed since the last change of the queries
+		*/
+		inline bool hasResults() const;
+
+		/**
+		*  @brief
+		*    Return the components found by the given query
+		*
+		*  @note
+		*    - Only valid after the batch was executed
+		*/
+		inline ResultRange getResults(uint32 queryIndex) const;
+
+		/**
+		*  @brief
+		*    Return the summed up number of components found by all queries
+		*/
+		inline uint32 getTotalNumberOfResults() const;
+
+		//[-------------------------------------------------------]
+		//[ Internal, used by "qsf::SpatialQuerySnapshot2D"      ]
+		//[-------------------------------------------------------]
+		inline void beginResults();
+		inline void addResult(Component& component);
+		inline void endQueryResults();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		std::vector<SpatialQueryShape> mQueryShapes;
+		std::vector<Component*>		   mResults;		///< Found components of all queries, one range per query
+		std::vector<uint32>			   mResultOffsets;	///< Begin of each query's range inside "mResults" plus the end of the last range, empty if there are no results
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialQueryBatch-inl.h"
@@ -0,0 +1,286 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialPartitionManagerComponent.h"
+#include "qsf/component/spatial/SpatialPartitionMemberComponent.h"
+#include "qsf/map/Entity.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline SpatialQuerySnapshot2D::SpatialQuerySnapshot2D(float cellSize) :
+		mCellSize(std::max(cellSize, 0.001f)),
+		mOrigin(0.0f, 0.0f),
+		mNumberOfCellsX(0),
+		mNumberOfCellsY(0),
+		mFirstLargeItem(0)
+	{
+		// Nothing here
+	}
+
+	inline SpatialQuerySnapshot2D::~SpatialQuerySnapshot2D()
+	{
+		// Nothing here
+	}
+
+	inline bool SpatialQuerySnapshot2D::build(const SpatialPartitionManagerComponent& spatialPartitionManagerComponent, uint32 partitionId)
+	{
+		// Fetch all members of the partition using a query covering everything
+		const float maximum = std::numeric_limits<float>::max();
+		mFoundComponents.clear();
+		if (!spatialPartitionManagerComponent.findComponentsInBounds(partitionId, glm::vec2(-maximum, -maximum), glm::vec2(maximum, maximum), mFoundComponents))
+		{
+			clear();
+			return false;
+		}
+
+		build(mFoundComponents);
+		return true;
+	}
+
+	inline void SpatialQuerySnapshot2D::build(const std::vector<Component*>& components)
+	{
+		// Gather the bounds
+		mScratchComponents.clear();
+		mScratchBounds.clear();
+		for (Component* component : components)
+		{
+			const SpatialPartitionMemberComponent* spatialPartitionMemberComponent = component->getEntity().getComponent<SpatialPartitionMemberComponent>();
+			if (nullptr != spatialPartitionMemberComponent)
+			{
+				const std::pair<glm::vec3, glm::vec3>& bounds = spatialPartitionMemberComponent->getBounds();
+				mScratchComponents.push_back(component);
+				mScratchBounds.emplace_back(bounds.first.x, bounds.first.z, bounds.second.x, bounds.second.z);
+			}
+		}
+
+		buildGrid();
+	}
+
+	inline void SpatialQuerySnapshot2D::clear()
+	{
+		mOrigin = glm::vec2(0.0f, 0.0f);
+		mNumberOfCellsX = 0;
+		mNumberOfCellsY = 0;
+		mCellOffsets.clear();
+		mFirstLargeItem = 0;
+		mComponents.clear();
+		mItemMinX.clear();
+		mItemMinY.clear();
+		mItemMaxX.clear();
+		mItemMaxY.clear();
+	}
+
+	inline uint32 SpatialQuerySnapshot2D::getNumberOfItems() const
+	{
+		return static_cast<uint32>(mComponents.size());
+	}
+
+	inline void SpatialQuerySnapshot2D::executeBatch(SpatialQueryBatch& queryBatch) const
+	{
+		queryBatch.beginResults();
+
+		const uint32 numberOfQueries = queryBatch.getNumberOfQueries();
+		for (uint32 queryIndex = 0; queryIndex < numberOfQueries; ++queryIndex)
+		{
+			forEachComponentInShape(queryBatch.getQueryShape(queryIndex), [&queryBatch](Component& component) { queryBatch.addResult(component); });
+			queryBatch.endQueryResults();
+		}
+	}
+
+	template<typename Function>
+	void SpatialQuerySnapshot2D::forEachComponentInShape(const SpatialQueryShape& queryShape, const Function& function) const
+	{
+		if (mComponents.empty())
+		{
+			return;
+		}
+
+		// Bounding box of the query shape
+		glm::vec2 queryMin = queryShape.mMin;
+		glm::vec2 queryMax = queryShape.mMax;
+		if (queryShape.isCircle())
+		{
+			const float radius = std::sqrt(queryShape.mSquaredRadius);
+			queryMin = queryShape.mCenter - radius;
+			queryMax = queryShape.mCenter + radius;
+		}
+
+		// Grid items are sorted by the cell of their minimum and are at most one cell large, so look one cell further back
+		const uint32 firstCellX = getCellIndexX(queryMin.x - mCellSize);
+		const uint32 firstCellY = getCellIndexY(queryMin.y - mCellSize);
+		const uint32 lastCellX = getCellIndexX(queryMax.x);
+		const uint32 lastCellY = getCellIndexY(queryMax.y);
+		if (queryMax.x >= mOrigin.x && queryMax.y >= mOrigin.y)
+		{
+			for (uint32 cellY = firstCellY; cellY <= lastCellY; ++cellY)
+			{
+				// The items of the touched cells of a row are a single consecutive range
+				const uint32 rowCellIndex = cellY * mNumberOfCellsX;
+				testItemsInShape(mCellOffsets[rowCellIndex + firstCellX], mCellOffsets[rowCellIndex + lastCellX + 1], queryShape, function);
+			}
+		}
+
+		// Large items
+		testItemsInShape(mFirstLargeItem, static_cast<uint32>(mComponents.size()), queryShape, function);
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	inline void SpatialQuerySnapshot2D::buildGrid()
+	{
+		clear();
+		const uint32 numberOfItems = static_cast<uint32>(mScratchComponents.size());
+		if (numberOfItems > 0)
+		{
+			// The grid covers the minimums of all item bounds
+			glm::vec2 gridMin(std::numeric_limits<float>::max());
+			glm::vec2 gridMax(-std::numeric_limits<float>::max());
+			for (const glm::vec4& bounds : mScratchBounds)
+			{
+				gridMin = glm::min(gridMin, glm::vec2(bounds.x, bounds.y));
+				gridMax = glm::max(gridMax, glm::vec2(bounds.x, bounds.y));
+			}
+
+			const uint32 maximumNumberOfCellsPerAxis = MAX_CELLS_PER_AXIS;
+			mOrigin = gridMin;
+			mNumberOfCellsX = std::min(static_cast<uint32>((gridMax.x - gridMin.x) / mCellSize) + 1, maximumNumberOfCellsPerAxis);
+			mNumberOfCellsY = std::min(static_cast<uint32>((gridMax.y - gridMin.y) / mCellSize) + 1, maximumNumberOfCellsPerAxis);
+			const uint32 numberOfCells = mNumberOfCellsX * mNumberOfCellsY;
+
+			// Counting sort by cell, items larger than a cell go behind the grid items so a query only has to look one cell back
+			const uint32 largeItemCellIndex = numberOfCells;
+			mCellOffsets.assign(numberOfCells + 2, 0);
+			mScratchCellIndices.resize(numberOfItems);
+			for (uint32 itemIndex = 0; itemIndex < numberOfItems; ++itemIndex)
+			{
+				const glm::vec4& bounds = mScratchBounds[itemIndex];
+				const bool isLarge = (bounds.z - bounds.x > mCellSize || bounds.w - bounds.y > mCellSize);
+				const uint32 cellIndex = isLarge ? largeItemCellIndex : (getCellIndexY(bounds.y) * mNumberOfCellsX + getCellIndexX(bounds.x));
+				mScratchCellIndices[itemIndex] = cellIndex;
+				++mCellOffsets[cellIndex + 1];
+			}
+			for (uint32 cellIndex = 0; cellIndex <= numberOfCells; ++cellIndex)
+			{
+				mCellOffsets[cellIndex + 1] += mCellOffsets[cellIndex];
+			}
+			mFirstLargeItem = mCellOffsets[largeItemCellIndex];
+
+			// Scatter, use the offsets as insertion cursors and restore them afterwards
+			mComponents.resize(numberOfItems);
+			mItemMinX.resize(numberOfItems + 3, 0.0f);
+			mItemMinY.resize(numberOfItems + 3, 0.0f);
+			mItemMaxX.resize(numberOfItems + 3, 0.0f);
+			mItemMaxY.resize(numberOfItems + 3, 0.0f);
+			for (uint32 itemIndex = 0; itemIndex < numberOfItems; ++itemIndex)
+			{
+				const uint32 sortedIndex = mCellOffsets[mScratchCellIndices[itemIndex]]++;
+				const glm::vec4& bounds = mScratchBounds[itemIndex];
+				mComponents[sortedIndex] = mScratchComponents[itemIndex];
+				mItemMinX[sortedIndex] = bounds.x;
+				mItemMinY[sortedIndex] = bounds.y;
+				mItemMaxX[sortedIndex] = bounds.z;
+				mItemMaxY[sortedIndex] = bounds.w;
+			}
+			for (uint32 cellIndex = numberOfCells + 1; cellIndex > 0; --cellIndex)
+			{
+				mCellOffsets[cellIndex] = mCellOffsets[cellIndex - 1];
+			}
+			mCellOffsets[0] = 0;
+		}
+	}
+
+	inline uint32 SpatialQuerySnapshot2D::getCellIndexX(float x) const
+	{
+		const float cell = (x - mOrigin.x) / mCellSize;
+		return (cell <= 0.0f) ? 0 : std::min(static_cast<uint32>(std::min(cell, static_cast<float>(mNumberOfCellsX))), mNumberOfCellsX - 1);
+	}
+
+	inline uint32 SpatialQuerySnapshot2D::getCellIndexY(float y) const
+	{
+		const float cell = (y - mOrigin.y) / mCellSize;
+		return (cell <= 0.0f) ? 0 : std::min(static_cast<uint32>(std::min(cell, static_cast<float>(mNumberOfCellsY))), mNumberOfCellsY - 1);
+	}
+
+	template<typename Function>
+	void SpatialQuerySnapshot2D::testItemsInShape(uint32 firstItem, uint32 lastItem, const SpatialQueryShape& queryShape, const Function& function) const
+	{
+		#ifdef QSF_SPATIAL_QUERY_SNAPSHOT_SSE
+			// Four items at once, the arrays are padded so loading behind the last item is fine
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 queryMinX = _mm_set1_ps(queryShape.mMin.x);
+			const __m128 queryMinY = _mm_set1_ps(queryShape.mMin.y);
+			const __m128 queryMaxX = _mm_set1_ps(queryShape.mMax.x);
+			const __m128 queryMaxY = _mm_set1_ps(queryShape.mMax.y);
+			const __m128 centerX = _mm_set1_ps(queryShape.mCenter.x);
+			const __m128 centerY = _mm_set1_ps(queryShape.mCenter.y);
+			const __m128 squaredRadius = _mm_set1_ps(queryShape.mSquaredRadius);
+			const bool isCircle = queryShape.isCircle();
+
+			for (uint32 itemIndex = firstItem; itemIndex < lastItem; itemIndex += 4)
+			{
+				const __m128 itemMinX = _mm_loadu_ps(&mItemMinX[itemIndex]);
+				const __m128 itemMinY = _mm_loadu_ps(&mItemMinY[itemIndex]);
+				const __m128 itemMaxX = _mm_loadu_ps(&mItemMaxX[itemIndex]);
+				const __m128 itemMaxY = _mm_loadu_ps(&mItemMaxY[itemIndex]);
+
+				__m128 overlap;
+				if (isCircle)
+				{
+					const __m128 distanceX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(itemMinX, centerX), _mm_sub_ps(centerX, itemMaxX)), zero);
+					const __m128 distanceY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(itemMinY, centerY), _mm_sub_ps(centerY, itemMaxY)), zero);
+					overlap = _mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX), _mm_mul_ps(distanceY, distanceY)), squaredRadius);
+				}
+				else
+				{
+					overlap = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(itemMaxX, queryMinX), _mm_cmple_ps(itemMinX, queryMaxX)),
+										 _mm_and_ps(_mm_cmpge_ps(itemMaxY, queryMinY), _mm_cmple_ps(itemMinY, queryMaxY)));
+				}
+
+				// Mask out the lanes behind the last item of the range
+				int overlapMask = _mm_movemask_ps(overlap);
+				if (lastItem - itemIndex < 4)
+				{
+					overlapMask &= (1 << (lastItem - itemIndex)) - 1;
+				}
+				for (uint32 lane = 0; overlapMask != 0; ++lane, overlapMask >>= 1)
+				{
+					if (overlapMask & 1)
+					{
+						function(*mComponents[itemIndex + lane]);
+					}
+				}
+			}
+		#else
+			for (uint32 itemIndex = firstItem; itemIndex < lastItem; ++itemIndex)
+			{
+				if (queryShape.isOverlappingBox(mItemMinX[itemIndex], mItemMinY[itemIndex], mItemMaxX[itemIndex], mItemMaxY[itemIndex]))
+				{
+					function(*mComponents[itemIndex]);
+				}
+			}
+		#endif
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
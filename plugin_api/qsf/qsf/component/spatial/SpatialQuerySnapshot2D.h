@@ -0,0 +1,207 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialQueryBatch.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#include <xmmintrin.h>
+	#define QSF_SPATIAL_QUERY_SNAPSHOT_SSE
+#endif
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Component;
+	class SpatialPartitionManagerComponent;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Flat, read-only copy of a spatial partition for answering many queries at once
+	*
+	*  @remarks
+	*    The snapshot copies the components of a "qsf::SpatialPartitionManagerComponent" partition together with their bounds into
+	*    a uniform grid. Items are sorted by the cell containing their bounds minimum and their bounds are stored as structure of arrays,
+	*    so the items of a cell row touched by a query are one consecutive range which is tested four items at once using SSE.
+	*
+	*    The snapshot is built explicitly by its owner, e.g. once per tick from a job, and is never modified by queries. So any number
+	*    of threads can query it at the same time, each with its own "qsf::SpatialQueryBatch". It doesn't follow changes of the partition,
+	*    build it again when the members moved.
+	*
+	*    Usage, e.g. from a plugin job:
+	*    @code
+	*      mSnapshot.build(spatialPartitionManagerComponent, PersonComponent::COMPONENT_ID);
+	*      mQueryBatch.clear();
+	*      for (...)
+	*        mQueryBatch.addCircleQuery(glm::vec2(position.x, position.z), radius);
+	*      mSnapshot.executeBatch(mQueryBatch);
+	*    @endcode
+	*
+	*  @note
+	*    - Like the spatial partitions, the snapshot uses the x and z coordinates of the member bounds
+	*/
+	class SpatialQuerySnapshot2D : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const uint32 MAX_CELLS_PER_AXIS = 1024;
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] cellSize
+		*    Edge length of a grid cell in world units, should be about the size of typical queries
+		*/
+		inline explicit SpatialQuerySnapshot2D(float cellSize = 16.0f);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline ~SpatialQuerySnapshot2D();
+
+		/**
+		*  @brief
+		*    Rebuild the snapshot from all members of the given spatial partition
+		*
+		*  @return
+		*    "true" if all went fine, "false" if there's no such partition; the snapshot is empty in this case
+		*/
+		inline bool build(const SpatialPartitionManagerComponent& spatialPartitionManagerComponent, uint32 partitionId);
+
+		/**
+		*  @brief
+		*    Rebuild the snapshot from the given components, their bounds are read from their entity's "qsf::SpatialPartitionMemberComponent"
+		*
+		*  @note
+		*    - Components whose entity has no spatial partition member component are ignored
+		*/
+		inline void build(const std::vector<Component*>& components);
+
+		/**
+		*  @brief
+		*    Remove all items, the memory is kept for reuse
+		*/
+		inline void clear();
+
+		/**
+		*  @brief
+		*    Return the number of items inside the snapshot
+		*/
+		inline uint32 getNumberOfItems() const;
+
+		/**
+		*  @brief
+		*    Answer all queries of the given batch
+		*
+		*  @note
+		*    - The order of the components inside a result range is unspecified
+		*/
+		inline void executeBatch(SpatialQueryBatch& queryBatch) const;
+
+		/**
+		*  @brief
+		*    Call the given function for all components overlapping the given query shape
+		*
+		*  @note
+		*    - The function signature is "void(Component&)", the order of the components is unspecified
+		*/
+		template<typename Function>
+		void forEachComponentInShape(const SpatialQueryShape& queryShape, const Function& function) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Sort the gathered scratch items into the grid
+		*/
+		inline void buildGrid();
+
+		inline uint32 getCellIndexX(float x) const;
+		inline uint32 getCellIndexY(float y) const;
+
+		/**
+		*  @brief
+		*    Test the given range of items against the query shape and call the function for the overlapping ones
+		*/
+		template<typename Function>
+		void testItemsInShape(uint32 firstItem, uint32 lastItem, const SpatialQueryShape& queryShape, const Function& function) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		float					mCellSize;
+		glm::vec2				mOrigin;			///< Minimum of the grid
+		uint32					mNumberOfCellsX;
+		uint32					mNumberOfCellsY;
+		std::vector<uint32>		mCellOffsets;		///< Begin of each cell's item range, row by row, plus the end of the last range
+		uint32					mFirstLargeItem;	///< Items larger than a cell are stored behind the grid items and tested by every query
+		std::vector<Component*> mComponents;		///< Components of all items, grid items sorted by cell
+		std::vector<float>		mItemMinX;			///< Item bounds as structure of arrays, same order as "mComponents" plus padding
+		std::vector<float>		mItemMinY;
+		std::vector<float>		mItemMaxX;
+		std::vector<float>		mItemMaxY;
+		// Build scratch data, kept to avoid allocations
+		std::vector<Component*> mFoundComponents;
+		std::vector<Component*> mScratchComponents;
+		std::vector<glm::vec4>	mScratchBounds;
+		std::vector<uint32>		mScratchCellIndices;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/component/spatial/SpatialQuerySnapshot2D-inl.h"
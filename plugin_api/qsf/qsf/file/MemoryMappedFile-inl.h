@@ -0,0 +1,84 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/base/error/ErrorHandling.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline MemoryMappedFile::MemoryMappedFile()
+	{
+		// Nothing here
+	}
+
+	inline MemoryMappedFile::~MemoryMappedFile()
+	{
+		// Nothing here, the members unmap the file
+	}
+
+	inline bool MemoryMappedFile::open(const std::string& absoluteFilename)
+	{
+		close();
+
+		try
+		{
+			boost::interprocess::file_mapping fileMapping(absoluteFilename.c_str(), boost::interprocess::read_only);
+			boost::interprocess::mapped_region mappedRegion(fileMapping, boost::interprocess::read_only);
+
+			// Windows can't map empty files in the first place, so don't allow it on other platforms either
+			if (0 == mappedRegion.get_size())
+			{
+				return false;
+			}
+
+			// Only take over the mapping as a whole
+			mFileMapping.swap(fileMapping);
+			mMappedRegion.swap(mappedRegion);
+		}
+		catch (const boost::interprocess::interprocess_exception& exception)
+		{
+			QSF_WARN("Failed to map the file \"" << absoluteFilename << "\" into memory: " << exception.what(), QSF_REACT_NONE);
+			return false;
+		}
+
+		// Done
+		return true;
+	}
+
+	inline void MemoryMappedFile::close()
+	{
+		boost::interprocess::mapped_region().swap(mMappedRegion);
+		boost::interprocess::file_mapping().swap(mFileMapping);
+	}
+
+	inline bool MemoryMappedFile::isOpen() const
+	{
+		return (nullptr != mMappedRegion.get_address());
+	}
+
+	inline const uint8* MemoryMappedFile::getData() const
+	{
+		return static_cast<const uint8*>(mMappedRegion.get_address());
+	}
+
+	inline uint64 MemoryMappedFile::getSize() const
+	{
+		return static_cast<uint64>(mMappedRegion.get_size());
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,124 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <string>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Read-only memory mapped file
+	*
+	*  @remarks
+	*    The whole file is mapped into the address space of the process, the operating system pages in the file contents on access.
+	*    In combination with "qsf::MemoryInputStream", binary serializers can read files without any intermediate copy.
+	*
+	*  @note
+	*    - Works on files of the native file system only, files inside of archives mounted into the virtual file system can't be mapped
+	*    - The filename must be absolute, use "qsf::FileSystem" to resolve virtual filenames
+	*/
+	class MemoryMappedFile : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		inline MemoryMappedFile();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline ~MemoryMappedFile();
+
+		/**
+		*  @brief
+		*    Map a file for reading, a previously mapped file gets unmapped
+		*
+		*  @param[in] absoluteFilename
+		*    Absolute UTF-8 filename in platform-dependent notation
+		*
+		*  @return
+		*    "true" if all went fine, else "false" (e.g. the file doesn't exist or is empty)
+		*/
+		inline bool open(const std::string& absoluteFilename);
+
+		/**
+		*  @brief
+		*    Unmap the file, all pointers to the file contents get invalid
+		*/
+		inline void close();
+
+		/**
+		*  @brief
+		*    Return whether or not a file is mapped
+		*/
+		inline bool isOpen() const;
+
+		/**
+		*  @brief
+		*    Return the mapped file contents
+		*
+		*  @return
+		*    The file contents, null pointer if no file is mapped, do not destroy the memory
+		*/
+		inline const uint8* getData() const;
+
+		/**
+		*  @brief
+		*    Return the size of the mapped file contents in bytes
+		*/
+		inline uint64 getSize() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		boost::interprocess::file_mapping  mFileMapping;
+		boost::interprocess::mapped_region mMappedRegion;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/file/MemoryMappedFile-inl.h"
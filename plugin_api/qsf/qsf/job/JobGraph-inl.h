@@ -0,0 +1,267 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingThreadPool.h"
+#include "qsf/base/error/ErrorHandling.h"
+
+#include <algorithm>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace jobs
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline ParallelJobConfiguration::ParallelJobConfiguration() :
+			mParallelExecution(false)
+		{
+			// Nothing here
+		}
+
+		inline ParallelJobConfiguration& ParallelJobConfiguration::readsResource(const StringHash& resourceId)
+		{
+			mReadResources.push_back(resourceId);
+			mParallelExecution = true;
+			return *this;
+		}
+
+		inline ParallelJobConfiguration& ParallelJobConfiguration::writesResource(const StringHash& resourceId)
+		{
+			mWriteResources.push_back(resourceId);
+			mParallelExecution = true;
+			return *this;
+		}
+
+		inline ParallelJobConfiguration& ParallelJobConfiguration::dependsOn(uint32 jobIndex)
+		{
+			mDependencies.push_back(jobIndex);
+			mParallelExecution = true;
+			return *this;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline JobGraph::JobGraph() :
+			mRemainingPredecessorsCapacity(0),
+			mNumberOfUnfinishedNodes(0),
+			mFailed(false)
+		{
+			// Nothing here
+		}
+
+		inline JobGraph::~JobGraph()
+		{
+			// Nothing here
+		}
+
+		inline uint32 JobGraph::addJob(const JobFunctionBinding& function, const ParallelJobConfiguration& configuration)
+		{
+			QSF_CHECK(!function.empty(), "The job function of a job graph must be valid", QSF_REACT_THROW);
+
+			// Start a new segment for each job which must be executed exclusively and after such a job
+			if (!configuration.mParallelExecution || mSegments.empty() || !mSegments.back().mParallel)
+			{
+				beginSegment(configuration.mParallelExecution);
+			}
+
+			const uint32 nodeIndex = static_cast<uint32>(mNodes.size());
+			mNodes.push_back(Node());
+			Node& node = mNodes.back();
+			node.mFunction = function;
+			node.mNumberOfPredecessors = 0;
+			node.mSegmentIndex = static_cast<uint32>(mSegments.size() - 1);
+			++mSegments.back().mNumberOfNodes;
+
+			if (configuration.mParallelExecution)
+			{
+				// Readers depend on the last writer
+				for (uint32 resourceId : configuration.mReadResources)
+				{
+					ResourceState& resourceState = mResourceStates[resourceId];
+					if (isInitialized(resourceState.mLastWriter))
+					{
+						addEdge(resourceState.mLastWriter, nodeIndex);
+					}
+					resourceState.mReadersSinceWrite.push_back(nodeIndex);
+				}
+
+				// Writers depend on the last writer and on all readers since then
+				for (uint32 resourceId : configuration.mWriteResources)
+				{
+					ResourceState& resourceState = mResourceStates[resourceId];
+					if (isInitialized(resourceState.mLastWriter))
+					{
+						addEdge(resourceState.mLastWriter, nodeIndex);
+					}
+					for (uint32 readerNodeIndex : resourceState.mReadersSinceWrite)
+					{
+						// A job both reading and writing a resource doesn't depend on itself
+						if (readerNodeIndex != nodeIndex)
+						{
+							addEdge(readerNodeIndex, nodeIndex);
+						}
+					}
+					resourceState.mLastWriter = nodeIndex;
+					resourceState.mReadersSinceWrite.clear();
+				}
+
+				// Explicit dependencies, dependencies on earlier segments are fulfilled anyway
+				for (uint32 dependencyNodeIndex : configuration.mDependencies)
+				{
+					QSF_CHECK(dependencyNodeIndex < nodeIndex, "A job of a job graph can only depend on jobs added before", QSF_REACT_THROW);
+					if (mNodes[dependencyNodeIndex].mSegmentIndex == node.mSegmentIndex)
+					{
+						addEdge(dependencyNodeIndex, nodeIndex);
+					}
+				}
+			}
+
+			// Prepare the execution state
+			if (mRemainingPredecessorsCapacity < mNodes.size())
+			{
+				mRemainingPredecessorsCapacity = std::max(static_cast<uint32>(mNodes.size()), mRemainingPredecessorsCapacity * 2);
+				mRemainingPredecessors.reset(new std::atomic<uint32>[mRemainingPredecessorsCapacity]);
+			}
+
+			return nodeIndex;
+		}
+
+		inline void JobGraph::clear()
+		{
+			mNodes.clear();
+			mSegments.clear();
+			mResourceStates.clear();
+		}
+
+		inline uint32 JobGraph::getNumberOfJobs() const
+		{
+			return static_cast<uint32>(mNodes.size());
+		}
+
+		inline uint32 JobGraph::getNumberOfSegments() const
+		{
+			return static_cast<uint32>(mSegments.size());
+		}
+
+		inline void JobGraph::execute(WorkStealingThreadPool& threadPool, const JobArguments& jobArguments)
+		{
+			for (const Segment& segment : mSegments)
+			{
+				if (!segment.mParallel || 1 == segment.mNumberOfNodes)
+				{
+					// Call the job directly on the calling thread, just as in serial execution
+					for (uint32 nodeIndex = segment.mFirstNode; nodeIndex < segment.mFirstNode + segment.mNumberOfNodes; ++nodeIndex)
+					{
+						mNodes[nodeIndex].mFunction(jobArguments);
+					}
+				}
+				else
+				{
+					// Reset the execution state of the segment
+					for (uint32 nodeIndex = segment.mFirstNode; nodeIndex < segment.mFirstNode + segment.mNumberOfNodes; ++nodeIndex)
+					{
+						mRemainingPredecessors[nodeIndex] = mNodes[nodeIndex].mNumberOfPredecessors;
+					}
+					mNumberOfUnfinishedNodes = segment.mNumberOfNodes;
+					mFailed = false;
+
+					// Kick off all jobs without predecessors, the others are submitted as soon as their last predecessor is finished
+					for (uint32 nodeIndex = segment.mFirstNode; nodeIndex < segment.mFirstNode + segment.mNumberOfNodes; ++nodeIndex)
+					{
+						if (0 == mNodes[nodeIndex].mNumberOfPredecessors)
+						{
+							threadPool.submit([this, &threadPool, &jobArguments, nodeIndex] { executeNode(threadPool, jobArguments, nodeIndex); });
+						}
+					}
+
+					// Help executing until the whole segment is done
+					threadPool.waitForCounter(mNumberOfUnfinishedNodes);
+
+					// All jobs of the segment are finished or skipped now, so nothing touches the exception anymore
+					if (mFailed)
+					{
+						std::exception_ptr exception;
+						exception.swap(mFirstException);
+						std::rethrow_exception(exception);
+					}
+				}
+			}
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline void JobGraph::beginSegment(bool parallel)
+		{
+			Segment segment;
+			segment.mFirstNode = static_cast<uint32>(mNodes.size());
+			segment.mNumberOfNodes = 0;
+			segment.mParallel = parallel;
+			mSegments.push_back(segment);
+
+			// Dependencies never cross segment boundaries
+			mResourceStates.clear();
+		}
+
+		inline void JobGraph::addEdge(uint32 fromNodeIndex, uint32 toNodeIndex)
+		{
+			std::vector<uint32>& successors = mNodes[fromNodeIndex].mSuccessors;
+			if (std::find(successors.cbegin(), successors.cend(), toNodeIndex) == successors.cend())
+			{
+				successors.push_back(toNodeIndex);
+				++mNodes[toNodeIndex].mNumberOfPredecessors;
+			}
+		}
+
+		inline void JobGraph::executeNode(WorkStealingThreadPool& threadPool, const JobArguments& jobArguments, uint32 nodeIndex)
+		{
+			const Node& node = mNodes[nodeIndex];
+
+			// Skip the job after another one of the segment failed, its successors are released anyway so the segment finishes
+			if (!mFailed)
+			{
+				try
+				{
+					node.mFunction(jobArguments);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(mExceptionMutex);
+					if (!mFirstException)
+					{
+						mFirstException = std::current_exception();
+					}
+					mFailed = true;
+				}
+			}
+
+			// Release the successors before this node counts as finished, so the segment can't be considered done too early
+			for (uint32 successorNodeIndex : node.mSuccessors)
+			{
+				if (0 == --mRemainingPredecessors[successorNodeIndex])
+				{
+					threadPool.submit([this, &threadPool, &jobArguments, successorNodeIndex] { executeNode(threadPool, jobArguments, successorNodeIndex); });
+				}
+			}
+			--mNumberOfUnfinishedNodes;
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // jobs
+} // qsf
@@ -0,0 +1,246 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/job/JobDefinitions.h"
+#include "qsf/base/StringHash.h"
+#include "qsf/base/GetUninitialized.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/container/flat_map.hpp>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class WorkStealingThreadPool;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace jobs
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Structures                                            ]
+		//[-------------------------------------------------------]
+		/** Declared accesses of a job inside a job graph, see "qsf::jobs::JobGraph::addJob()" */
+		struct ParallelJobConfiguration
+		{
+			bool				mParallelExecution;		///< If "true", the job may be called from a worker thread concurrently to other jobs it has no declared conflicts with; set by each declaration, "false" means the job is called exclusively by the thread executing the graph
+			std::vector<uint32> mReadResources;			///< IDs of resources the job reads (e.g. "qsf::StringHash("qsf::ai::NavigationMap")"), jobs may read the same resource concurrently
+			std::vector<uint32> mWriteResources;		///< IDs of resources the job modifies, a written resource is never accessed concurrently by other jobs
+			std::vector<uint32> mDependencies;			///< Indices of jobs added before to the same graph which must be finished before this job is called
+
+			inline ParallelJobConfiguration();
+
+			/**
+			*  @brief
+			*    Declare a resource the job reads; this also allows parallel execution of the job
+			*/
+			inline ParallelJobConfiguration& readsResource(const StringHash& resourceId);
+
+			/**
+			*  @brief
+			*    Declare a resource the job modifies; this also allows parallel execution of the job
+			*/
+			inline ParallelJobConfiguration& writesResource(const StringHash& resourceId);
+
+			/**
+			*  @brief
+			*    Declare a job which must be finished before this job is called; this also allows parallel execution of the job
+			*
+			*  @param[in] jobIndex
+			*    Index returned by "qsf::jobs::JobGraph::addJob()" for a job added before
+			*/
+			inline ParallelJobConfiguration& dependsOn(uint32 jobIndex);
+		};
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Job dependency graph for calling a group of jobs in parallel
+		*
+		*  @remarks
+		*    The graph is not known to any job manager. The owner registers a single ordinary job and executes the graph inside of it,
+		*    so all jobs of the graph are called at the point in time of that job and are finished when it returns.
+		*    The thread pool is the one the plugin creates and shuts down itself, see "qsf::WorkStealingThreadPool::shutdown()":
+		*    @code
+		*      mJobGraph.addJob(boost::bind(&MySystem::updateTraffic, this, _1), qsf::jobs::ParallelJobConfiguration().writesResource(TRAFFIC));
+		*      mJobGraph.addJob(boost::bind(&MySystem::updateCrowd, this, _1), qsf::jobs::ParallelJobConfiguration().readsResource(TRAFFIC));
+		*      mJobProxy.registerAt(qsf::QsfJobs::SIMULATION, boost::bind(&qsf::jobs::JobGraph::execute, &mJobGraph, boost::ref(*mThreadPool), _1));
+		*    @endcode
+		*
+		*    The jobs are split into segments which are executed one after another:
+		*      - Jobs without "qsf::jobs::ParallelJobConfiguration::mParallelExecution" form a segment of their own and are called on the executing thread
+		*      - Consecutive jobs allowing parallel execution form a parallel segment
+		*    Inside a parallel segment, a job depends on previous jobs writing a resource it reads or writes, on previous jobs reading a resource
+		*    it writes, and on its explicitly declared dependencies. Jobs without dependencies between them run concurrently on the thread pool.
+		*    In serial execution, the jobs would be called in the order they were added, so the result is the same as long as the declarations are complete.
+		*
+		*    If a job of a parallel segment throws, the jobs of the segment not started yet are skipped, the segment is finished anyway
+		*    and the first exception is rethrown by "qsf::jobs::JobGraph::execute()"; the following segments are not executed.
+		*/
+		class JobGraph : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Default constructor
+			*/
+			inline JobGraph();
+
+			/**
+			*  @brief
+			*    Destructor
+			*/
+			inline ~JobGraph();
+
+			/**
+			*  @brief
+			*    Add a job to the graph
+			*
+			*  @param[in] function
+			*    Function to call on each execution of the graph; must be thread-safe in case the configuration allows parallel execution
+			*  @param[in] configuration
+			*    Declared accesses of the job
+			*
+			*  @return
+			*    Index of the job, to be used for "qsf::jobs::ParallelJobConfiguration::dependsOn()"
+			*
+			*  @note
+			*    - Must not be called while the graph is executed
+			*/
+			inline uint32 addJob(const JobFunctionBinding& function, const ParallelJobConfiguration& configuration = ParallelJobConfiguration());
+
+			/**
+			*  @brief
+			*    Remove all jobs
+			*/
+			inline void clear();
+
+			/**
+			*  @brief
+			*    Return the number of jobs in the graph
+			*/
+			inline uint32 getNumberOfJobs() const;
+
+			/**
+			*  @brief
+			*    Return the number of segments, which is the number of synchronization points during execution
+			*/
+			inline uint32 getNumberOfSegments() const;
+
+			/**
+			*  @brief
+			*    Call all jobs of the graph, returns when all of them are finished
+			*
+			*  @param[in] threadPool
+			*    Thread pool to call the jobs of parallel segments on, the calling thread helps executing them
+			*  @param[in] jobArguments
+			*    Job arguments passed to each job, usually the ones of the job executing the graph
+			*
+			*  @note
+			*    - Must not be called concurrently for the same graph
+			*    - Rethrows the first exception thrown by a job, after all running jobs of its segment are finished
+			*/
+			inline void execute(WorkStealingThreadPool& threadPool, const JobArguments& jobArguments);
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			struct Node
+			{
+				JobFunctionBinding	mFunction;				///< Function to call, always valid
+				std::vector<uint32> mSuccessors;			///< Indices of the nodes depending on this node
+				uint32				mNumberOfPredecessors;	///< Number of nodes this node depends on
+				uint32				mSegmentIndex;			///< Index of the segment the node belongs to
+			};
+
+			struct Segment
+			{
+				uint32 mFirstNode;		///< Index of the first node of the segment
+				uint32 mNumberOfNodes;	///< Number of nodes inside the segment
+				bool   mParallel;		///< "true" if the nodes of the segment may be executed in parallel, else "false"
+			};
+
+			struct ResourceState
+			{
+				uint32				mLastWriter;			///< Node index of the last job writing the resource, uninitialized if there's none
+				std::vector<uint32> mReadersSinceWrite;		///< Node indices of the jobs reading the resource since the last write
+
+				inline ResourceState() : mLastWriter(getUninitialized<uint32>()) {}
+			};
+
+			typedef boost::container::flat_map<uint32, ResourceState> ResourceStateMap;
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline void beginSegment(bool parallel);
+			inline void addEdge(uint32 fromNodeIndex, uint32 toNodeIndex);
+			inline void executeNode(WorkStealingThreadPool& threadPool, const JobArguments& jobArguments, uint32 nodeIndex);
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			std::vector<Node>						mNodes;
+			std::vector<Segment>					mSegments;
+			ResourceStateMap						mResourceStates;				///< Resource accesses inside the last segment, needed for adding further jobs
+			std::unique_ptr<std::atomic<uint32>[]>	mRemainingPredecessors;			///< Per node execution state, holds "mRemainingPredecessorsCapacity" entries
+			uint32									mRemainingPredecessorsCapacity;
+			std::atomic<uint32>						mNumberOfUnfinishedNodes;		///< Number of unfinished nodes of the currently executed segment
+			std::atomic<bool>						mFailed;						///< "true" as soon as a job of the currently executed segment threw, the remaining jobs are skipped then
+			std::exception_ptr						mFirstException;				///< First exception thrown by a job of the currently executed segment, protected by "mExceptionMutex"
+			std::mutex								mExceptionMutex;
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // jobs
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/job/JobGraph-inl.h"
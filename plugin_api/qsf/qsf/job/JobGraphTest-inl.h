@@ -0,0 +1,90 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/job/JobArguments.h"
+#include "qsf/base/StringHash.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace jobs
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline bool JobGraphTest::Result::isSuccess() const
+		{
+			return (mExceptionRethrown && mSuccessorSkipped && mFollowingSegmentSkipped && mGraphReusable);
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Public static methods                                 ]
+		//[-------------------------------------------------------]
+		inline JobGraphTest::Result JobGraphTest::runThrowingJob(WorkStealingThreadPool& threadPool)
+		{
+			static const char* ERROR_MESSAGE = "JobGraphTest: intended failure";
+
+			bool throwException = true;
+			std::atomic<uint32> numberOfIndependentCalls(0);
+			std::atomic<uint32> numberOfSuccessorCalls(0);
+			uint32 numberOfFollowingCalls = 0;
+
+			JobGraph jobGraph;
+			const uint32 throwingJob = jobGraph.addJob([&throwException](const JobArguments&)
+			{
+				if (throwException)
+				{
+					throw std::runtime_error(ERROR_MESSAGE);
+				}
+			}, ParallelJobConfiguration().writesResource("JobGraphTest::Resource"));
+			jobGraph.addJob([&numberOfSuccessorCalls](const JobArguments&) { ++numberOfSuccessorCalls; }, ParallelJobConfiguration().dependsOn(throwingJob));
+			jobGraph.addJob([&numberOfIndependentCalls](const JobArguments&) { ++numberOfIndependentCalls; }, ParallelJobConfiguration().readsResource("JobGraphTest::OtherResource"));
+			jobGraph.addJob([&numberOfFollowingCalls](const JobArguments&) { ++numberOfFollowingCalls; });
+
+			Result result;
+			const JobArguments jobArguments;
+			try
+			{
+				jobGraph.execute(threadPool, jobArguments);
+				result.mExceptionRethrown = false;
+			}
+			catch (const std::runtime_error& exception)
+			{
+				result.mExceptionRethrown = (std::string(exception.what()) == ERROR_MESSAGE);
+			}
+			result.mSuccessorSkipped = (0 == numberOfSuccessorCalls);
+			result.mFollowingSegmentSkipped = (0 == numberOfFollowingCalls);
+
+			throwException = false;
+			try
+			{
+				jobGraph.execute(threadPool, jobArguments);
+				result.mGraphReusable = (1 == numberOfSuccessorCalls && 1 == numberOfFollowingCalls && numberOfIndependentCalls >= 1);
+			}
+			catch (const std::exception&)
+			{
+				result.mGraphReusable = false;
+			}
+
+			return result;
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // jobs
+} // qsf
@@ -0,0 +1,87 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/job/JobGraph.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace jobs
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Self test of the error handling of "qsf::jobs::JobGraph"
+		*
+		*  @remarks
+		*    Executes a parallel segment where one job throws while an independent job and a successor of the throwing job are part of the same segment.
+		*    The independent job may or may not be skipped in the failed execution, depending on whether it was started before the exception.
+		*    Usage, e.g. from a debug command of a plugin:
+		*    @code
+		*      const qsf::jobs::JobGraphTest::Result result = qsf::jobs::JobGraphTest::runThrowingJob(workStealingThreadPool);
+		*      QSF_LOG_PRINTS(INFO, "Job graph test " << (result.isSuccess() ? "passed" : "failed"));
+		*    @endcode
+		*/
+		class JobGraphTest
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			struct Result
+			{
+				bool mExceptionRethrown;		///< "true" if "qsf::jobs::JobGraph::execute()" returned with the exception of the throwing job, else "false"
+				bool mSuccessorSkipped;			///< "true" if the job depending on the throwing job was not called, else "false"
+				bool mFollowingSegmentSkipped;	///< "true" if the segment behind the failed one was not executed, else "false"
+				bool mGraphReusable;			///< "true" if the graph executed all jobs in a following execution without exception, else "false"
+
+				inline bool isSuccess() const;
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public static methods                                 ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Run the test, returns instead of hanging if the segment is finished despite the exception
+			*
+			*  @param[in] threadPool
+			*    Thread pool to execute the graph on
+			*/
+			inline static Result runThrowingJob(WorkStealingThreadPool& threadPool);
+
+
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // jobs
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/job/JobGraphTest-inl.h"
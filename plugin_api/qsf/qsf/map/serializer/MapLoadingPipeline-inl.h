@@ -0,0 +1,225 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingThreadPool.h"
+
+#include <algorithm>
+#include <thread>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	template <typename STAGING>
+	MapLoadingPipeline<STAGING>::MapLoadingPipeline(WorkStealingThreadPool& threadPool, uint32 maximumNumberOfBlocksInFlight) :
+		mThreadPool(threadPool),
+		mSlots(new Slot[std::max<uint32>(maximumNumberOfBlocksInFlight, 1)]),
+		mNumberOfSlots(std::max<uint32>(maximumNumberOfBlocksInFlight, 1)),
+		mNumberOfCommittedBlocks(0),
+		mNumberOfPendingParses(0),
+		mParseTimeInMicroseconds(0),
+		mAborted(false)
+	{
+		// Nothing here
+	}
+
+	template <typename STAGING>
+	MapLoadingPipeline<STAGING>::~MapLoadingPipeline()
+	{
+		// Nothing here, "qsf::MapLoadingPipeline::execute()" doesn't return before all threads are finished
+	}
+
+	template <typename STAGING>
+	template <typename ReadFunction, typename ParseFunction, typename CommitFunction>
+	void MapLoadingPipeline<STAGING>::execute(uint32 numberOfBlocks, const ReadFunction& readFunction, const ParseFunction& parseFunction, const CommitFunction& commitFunction, const boost::function<void(float)>& progressCallback)
+	{
+		const Time startTime = Time::highResolutionNow();
+		mTimings = MapLoadingTimings();
+		mNumberOfCommittedBlocks = 0;
+		mNumberOfPendingParses = 0;
+		mParseTimeInMicroseconds = 0;
+		mAborted = false;
+		mException = nullptr;
+
+		// Read and decompress on a thread of its own, this is mostly waiting for the file system anyway
+		std::thread readerThread([this, numberOfBlocks, &readFunction, &parseFunction] { readerThreadMain(numberOfBlocks, readFunction, parseFunction); });
+
+		// Commit in block order, don't report the progress more often than necessary
+		const uint32 progressInterval = std::max<uint32>(numberOfBlocks / 100, 1);
+		for (uint32 blockIndex = 0; blockIndex < numberOfBlocks; ++blockIndex)
+		{
+			Slot& slot = mSlots[blockIndex % mNumberOfSlots];
+
+			// Help parsing until the next block is ready
+			const Time waitStartTime = Time::highResolutionNow();
+			while (SLOT_STATE_PARSED != slot.mState.load(std::memory_order_acquire) && !isAborted())
+			{
+				if (!mThreadPool.tryExecuteTask())
+				{
+					std::this_thread::yield();
+				}
+			}
+			const Time commitStartTime = Time::highResolutionNow();
+			mTimings.mWaitTime += commitStartTime - waitStartTime;
+			if (isAborted())
+			{
+				break;
+			}
+
+			try
+			{
+				commitFunction(blockIndex, slot.mStaging);
+			}
+			catch (...)
+			{
+				abort(std::current_exception());
+				break;
+			}
+
+			// Hand the slot back to the reader thread
+			slot.mStaging = STAGING();
+			slot.mState.store(SLOT_STATE_FREE, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				++mNumberOfCommittedBlocks;
+			}
+			mSlotCommitted.notify_one();
+			mTimings.mCommitTime += Time::highResolutionNow() - commitStartTime;
+
+			if (progressCallback && (0 == (blockIndex + 1) % progressInterval || blockIndex + 1 == numberOfBlocks))
+			{
+				progressCallback(static_cast<float>(blockIndex + 1) / static_cast<float>(numberOfBlocks));
+			}
+		}
+
+		// In case of an error, the reader thread and the parse tasks are still running
+		readerThread.join();
+		mThreadPool.waitForCounter(mNumberOfPendingParses);
+		for (uint32 slotIndex = 0; slotIndex < mNumberOfSlots; ++slotIndex)
+		{
+			Slot& slot = mSlots[slotIndex];
+			if (SLOT_STATE_FREE != slot.mState.load(std::memory_order_relaxed))
+			{
+				slot.mStaging = STAGING();
+				slot.mState.store(SLOT_STATE_FREE, std::memory_order_relaxed);
+			}
+		}
+
+		mTimings.mParseTime = Time::fromMicroseconds(mParseTimeInMicroseconds.load());
+		mTimings.mTotalTime = Time::highResolutionNow() - startTime;
+		mTimings.mNumberOfBlocks = mNumberOfCommittedBlocks.load();
+
+		if (nullptr != mException)
+		{
+			std::rethrow_exception(mException);
+		}
+	}
+
+	template <typename STAGING>
+	const MapLoadingTimings& MapLoadingPipeline<STAGING>::getTimings() const
+	{
+		return mTimings;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	template <typename STAGING>
+	template <typename ReadFunction, typename ParseFunction>
+	void MapLoadingPipeline<STAGING>::readerThreadMain(uint32 numberOfBlocks, const ReadFunction& readFunction, const ParseFunction& parseFunction)
+	{
+		Time readTime = Time::ZERO;
+		for (uint32 blockIndex = 0; blockIndex < numberOfBlocks; ++blockIndex)
+		{
+			// Wait until the block which used the slot before is committed
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mSlotCommitted.wait(lock, [this, blockIndex] { return (isAborted() || blockIndex - mNumberOfCommittedBlocks.load() < mNumberOfSlots); });
+			}
+			if (isAborted())
+			{
+				break;
+			}
+
+			Slot& slot = mSlots[blockIndex % mNumberOfSlots];
+			const Time readStartTime = Time::highResolutionNow();
+			try
+			{
+				slot.mData.clear();
+				readFunction(blockIndex, slot.mData);
+			}
+			catch (...)
+			{
+				abort(std::current_exception());
+				break;
+			}
+			readTime += Time::highResolutionNow() - readStartTime;
+
+			slot.mState.store(SLOT_STATE_PARSING, std::memory_order_relaxed);
+			++mNumberOfPendingParses;
+			Slot* slotToParse = &slot;
+			mThreadPool.submit([this, slotToParse, &parseFunction] { parseSlot(*slotToParse, parseFunction); });
+		}
+		mTimings.mReadTime = readTime;
+	}
+
+	template <typename STAGING>
+	template <typename ParseFunction>
+	void MapLoadingPipeline<STAGING>::parseSlot(Slot& slot, const ParseFunction& parseFunction)
+	{
+		// Once aborted, the remaining blocks are not parsed any longer but the slots still have to be released
+		if (!isAborted())
+		{
+			const Time parseStartTime = Time::highResolutionNow();
+			try
+			{
+				parseFunction(slot.mData.data(), static_cast<uint32>(slot.mData.size()), slot.mStaging);
+			}
+			catch (...)
+			{
+				abort(std::current_exception());
+			}
+			mParseTimeInMicroseconds += (Time::highResolutionNow() - parseStartTime).getMicroseconds();
+		}
+
+		// The aborted flag is set before the slot is released, so the committing thread never commits a block whose parsing failed
+		slot.mState.store(SLOT_STATE_PARSED, std::memory_order_release);
+		--mNumberOfPendingParses;
+	}
+
+	template <typename STAGING>
+	void MapLoadingPipeline<STAGING>::abort(const std::exception_ptr& exception)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (nullptr == mException)
+			{
+				mException = exception;
+			}
+			mAborted = true;
+		}
+		mSlotCommitted.notify_all();
+	}
+
+	template <typename STAGING>
+	bool MapLoadingPipeline<STAGING>::isAborted() const
+	{
+		return mAborted.load(std::memory_order_acquire);
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,205 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/time/Time.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class WorkStealingThreadPool;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Timings of the phases of a pipelined map load
+	*/
+	struct MapLoadingTimings
+	{
+		Time   mReadTime;		///< Time the reader thread spent reading and decompressing blocks, without waiting for free slots
+		Time   mParseTime;		///< Accumulated time of all threads parsing blocks, can be more than the total time
+		Time   mCommitTime;		///< Time the calling thread spent committing parsed blocks
+		Time   mWaitTime;		///< Time the calling thread waited for the next block to be parsed, including the time it helped parsing
+		Time   mTotalTime;		///< Wall clock time of the whole pipeline
+		uint32 mNumberOfBlocks;	///< Number of committed blocks
+
+		inline MapLoadingTimings() : mNumberOfBlocks(0) {}
+	};
+
+
+	/**
+	*  @brief
+	*    Pipelined loader for block based map data
+	*
+	*  @remarks
+	*    The loading is split into three phases which run concurrently:
+	*      1. A reader thread reads and decompresses one block after another into memory
+	*      2. Each block read is parsed on the thread pool into a staging object, blocks are parsed in parallel
+	*      3. The calling thread commits the staging objects in block order, e.g. creates and starts up the entities,
+	*         since this requires the main thread; while waiting for the next block, it helps parsing
+	*    The number of blocks in flight is limited, so the memory usage doesn't depend on the map size.
+	*
+	*  @note
+	*    - "STAGING" must be default constructible and move assignable, staging objects are reused for later blocks after being committed
+	*    - An exception thrown by any of the functions stops the pipeline, it's rethrown on the calling thread when all threads are finished
+	*/
+	template <typename STAGING>
+	class MapLoadingPipeline : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		typedef STAGING Staging;
+
+		static const uint32 DEFAULT_MAXIMUM_NUMBER_OF_BLOCKS_IN_FLIGHT = 256;	///< Default maximum number of blocks which were read but not yet committed
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] threadPool
+		*    Thread pool to parse the blocks on, must stay valid as long as the pipeline instance exists
+		*  @param[in] maximumNumberOfBlocksInFlight
+		*    Maximum number of blocks which were read but not yet committed, at least one
+		*/
+		inline explicit MapLoadingPipeline(WorkStealingThreadPool& threadPool, uint32 maximumNumberOfBlocksInFlight = DEFAULT_MAXIMUM_NUMBER_OF_BLOCKS_IN_FLIGHT);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline ~MapLoadingPipeline();
+
+		/**
+		*  @brief
+		*    Execute the pipeline, returns when all blocks are committed
+		*
+		*  @param[in] numberOfBlocks
+		*    Number of blocks to load
+		*  @param[in] readFunction
+		*    Function reading and decompressing a block, signature "void(uint32 blockIndex, std::vector<uint8>& data)"; is called on the reader thread in ascending block order
+		*  @param[in] parseFunction
+		*    Function parsing a block into a staging object, signature "void(const uint8* data, uint32 size, STAGING& staging)"; is called concurrently
+		*  @param[in] commitFunction
+		*    Function committing a staging object, signature "void(uint32 blockIndex, STAGING& staging)"; is called on the calling thread in ascending block order
+		*  @param[in] progressCallback
+		*    Optional progress callback (0...1 -> start...finished), called on the calling thread
+		*
+		*  @exception
+		*    Rethrows the first exception thrown by one of the functions
+		*/
+		template <typename ReadFunction, typename ParseFunction, typename CommitFunction>
+		void execute(uint32 numberOfBlocks, const ReadFunction& readFunction, const ParseFunction& parseFunction, const CommitFunction& commitFunction, const boost::function<void(float)>& progressCallback = boost::function<void(float)>());
+
+		/**
+		*  @brief
+		*    Return the timings of the last execution
+		*/
+		inline const MapLoadingTimings& getTimings() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		enum SlotState
+		{
+			SLOT_STATE_FREE = 0,	///< The slot can be used for the next block to read
+			SLOT_STATE_PARSING,		///< The block was read and gets parsed
+			SLOT_STATE_PARSED		///< The block was parsed and can be committed
+		};
+
+		struct Slot
+		{
+			std::vector<uint8>	mData;		///< Block data, kept for the next block to reuse the allocated memory
+			STAGING				mStaging;
+			std::atomic<uint32>	mState;		///< See "SlotState"
+
+			inline Slot() : mState(SLOT_STATE_FREE) {}
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		template <typename ReadFunction, typename ParseFunction>
+		void readerThreadMain(uint32 numberOfBlocks, const ReadFunction& readFunction, const ParseFunction& parseFunction);
+
+		template <typename ParseFunction>
+		void parseSlot(Slot& slot, const ParseFunction& parseFunction);
+
+		inline void abort(const std::exception_ptr& exception);
+		inline bool isAborted() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		WorkStealingThreadPool&	 mThreadPool;
+		std::unique_ptr<Slot[]>	 mSlots;						///< Ring buffer of "mNumberOfSlots" slots, block "n" uses slot "n % mNumberOfSlots"
+		const uint32			 mNumberOfSlots;
+		std::atomic<uint32>		 mNumberOfCommittedBlocks;		///< The reader thread may reuse the slots of committed blocks
+		std::atomic<uint32>		 mNumberOfPendingParses;		///< Number of submitted parse tasks which are not yet finished
+		std::atomic<int64>		 mParseTimeInMicroseconds;		///< Accumulated by all threads parsing blocks
+		std::atomic<bool>		 mAborted;
+		std::exception_ptr		 mException;					///< First exception which occurred, guarded by "mMutex"
+		std::mutex				 mMutex;
+		std::condition_variable	 mSlotCommitted;				///< Wakes up the reader thread waiting for a free slot
+		MapLoadingTimings		 mTimings;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/map/serializer/MapLoadingPipeline-inl.h"
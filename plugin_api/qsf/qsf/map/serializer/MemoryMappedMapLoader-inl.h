@@ -0,0 +1,112 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/map/serializer/BinaryMapSerializationHelper.h"
+#include "qsf/serialization/binary/MemoryMappedBinaryInput.h"
+#include "qsf/file/FileSystem.h"
+#include "qsf/time/HighResolutionStopwatch.h"
+#include "qsf/base/error/ErrorHandling.h"
+#include "qsf/QsfHelper.h"
+
+#include <exception>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	inline bool MemoryMappedMapLoader::loadByFilename(Map& map, const std::string& filename, const Map::SerializationOptions& serializationOptions, GlobalAssetId globalAssetId, MapLoadingTimings* timings)
+	{
+		HighResolutionStopwatch totalStopwatch;
+		MapLoadingTimings localTimings;
+		bool result = tryLoadMemoryMapped(map, filename, serializationOptions, globalAssetId, localTimings);
+		if (!result)
+		{
+			// Reading and deserializing can't be told apart in here
+			HighResolutionStopwatch commitStopwatch;
+			result = map.loadByFilename(filename, serializationOptions, globalAssetId);
+			localTimings.mCommitTime += commitStopwatch.getElapsed();
+			localTimings.mNumberOfBlocks = result ? 1 : 0;
+		}
+		localTimings.mTotalTime = totalStopwatch.getElapsed();
+
+		if (nullptr != timings)
+		{
+			*timings = localTimings;
+		}
+		return result;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	inline bool MemoryMappedMapLoader::tryLoadMemoryMapped(Map& map, const std::string& filename, const Map::SerializationOptions& serializationOptions, GlobalAssetId globalAssetId, MapLoadingTimings& timings)
+	{
+		HighResolutionStopwatch readStopwatch;
+
+		// Files inside of mounted archives have no absolute filename and can't be mapped
+		std::string absoluteFilename;
+		if (!QSF_FILE.virtualToAbsoluteFilename(filename, absoluteFilename))
+		{
+			return false;
+		}
+
+		MemoryMappedBinaryInput memoryMappedBinaryInput;
+		try
+		{
+			if (!memoryMappedBinaryInput.open(absoluteFilename))
+			{
+				return false;
+			}
+		}
+		catch (const std::exception&)
+		{
+			// Not a binary file at all, e.g. a JSON map
+			return false;
+		}
+		if (memoryMappedBinaryInput.getSerializer().getFormatType() != BinaryMapSerializationHelper::FORMAT_TYPE)
+		{
+			return false;
+		}
+		timings.mReadTime = readStopwatch.getElapsed();
+
+		// Same as the binary map serializer does, but without the file stream in between
+		HighResolutionStopwatch commitStopwatch;
+		map.clear();
+		try
+		{
+			BinaryMapSerializationHelper binaryMapSerializationHelper;
+			if (!binaryMapSerializationHelper.serializeMap(memoryMappedBinaryInput.getSerializer(), map, serializationOptions))
+			{
+				return false;
+			}
+		}
+		catch (const std::exception& exception)
+		{
+			QSF_ERROR("Failed to load the memory mapped map \"" << filename << "\": " << exception.what(), QSF_REACT_NONE);
+			map.clear();
+			return false;
+		}
+		map.setGlobalAssetId(globalAssetId);
+		timings.mCommitTime = commitStopwatch.getElapsed();
+		timings.mNumberOfBlocks = 1;
+
+		// Done
+		return true;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,98 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/map/Map.h"
+#include "qsf/map/serializer/MapLoadingPipeline.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Static helper loading binary maps from memory mapped files
+	*
+	*  @remarks
+	*    Drop-in replacement for "qsf::Map::loadByFilename()": Binary maps of the native file system are mapped into memory and
+	*    deserialized by "qsf::BinaryMapSerializationHelper" through a "qsf::MemoryMappedBinaryInput", without the file stream
+	*    and paged memory buffer copying layers. Everything else, e.g. JSON maps or maps inside of mounted archives, is loaded
+	*    by "qsf::Map::loadByFilename()" as before.
+	*
+	*    The phases of the load can be timed with "qsf::MapLoadingTimings": mapping the file and checking its header is the read time,
+	*    deserializing the map including the creation of the entities is the commit time. The deserialization is a single sequential pass
+	*    inside of the engine library without block boundaries, so it can't be split into parse and commit or run through "qsf::MapLoadingPipeline";
+	*    the parse and wait times stay zero. For maps loaded by "qsf::Map::loadByFilename()" reading and deserializing can't be told apart,
+	*    everything is commit time.
+	*/
+	class MemoryMappedMapLoader
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Load a map by using a given filename, see "qsf::Map::loadByFilename()"
+		*
+		*  @param[in] map
+		*    Map instance to fill, its current content gets lost
+		*  @param[in] filename
+		*    Virtual UTF-8 filename in platform-independent notation of the map to load
+		*  @param[in] serializationOptions
+		*    Configuration for the serialization
+		*  @param[in] globalAssetId
+		*    Global asset ID of the map to load (only stored internally, not really used for loading)
+		*  @param[out] timings
+		*    Optional timings of the load, overwritten; one block means the map was loaded
+		*
+		*  @return
+		*    "true" if all went fine, else "false"
+		*/
+		inline static bool loadByFilename(Map& map, const std::string& filename, const Map::SerializationOptions& serializationOptions, GlobalAssetId globalAssetId, MapLoadingTimings* timings = nullptr);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Try to load a binary map from a memory mapped file
+		*
+		*  @return
+		*    "true" if the map was loaded, "false" if the file can't be mapped or isn't a binary map (the map is not touched then)
+		*/
+		inline static bool tryLoadMemoryMapped(Map& map, const std::string& filename, const Map::SerializationOptions& serializationOptions, GlobalAssetId globalAssetId, MapLoadingTimings& timings);
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/map/serializer/MemoryMappedMapLoader-inl.h"
@@ -0,0 +1,212 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessageSystem.h"
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline DeferredMessageQueue::DeferredMessageQueue() :
+		mQueueId(generateQueueId()),
+		mFlushJobMessageSystem(nullptr)
+	{
+		// Nothing here
+	}
+
+	inline DeferredMessageQueue::~DeferredMessageQueue()
+	{
+		// Stop the automatic flush before anything is destroyed, cached thread local buffer pointers are invalidated by the unique queue ID
+		mFlushJobProxy.unregister();
+	}
+
+	inline void DeferredMessageQueue::push(const MessageConfiguration& message)
+	{
+		push(message, MessageParameters());
+	}
+
+	inline void DeferredMessageQueue::push(const MessageConfiguration& message, const MessageParameters& parameters)
+	{
+		ThreadBuffer& threadBuffer = getThreadBufferOfCallingThread();
+		std::lock_guard<std::mutex> threadBufferLock(threadBuffer.mMutex);
+		threadBuffer.mMessages.emplace_back(message, parameters);
+	}
+
+	inline void DeferredMessageQueue::registerBatchListener(const StringHash& messageId, const BatchListener& batchListener)
+	{
+		mBatchListeners[messageId].push_back(batchListener);
+	}
+
+	inline void DeferredMessageQueue::unregisterBatchListeners(const StringHash& messageId)
+	{
+		mBatchListeners.erase(messageId);
+	}
+
+	inline uint32 DeferredMessageQueue::flush(MessageSystem* messageSystem)
+	{
+		std::lock_guard<std::mutex> flushLock(mFlushMutex);
+
+		// Thread buffers are never destroyed before the queue, so the pointers stay valid without holding the queue mutex
+		{
+			std::lock_guard<std::mutex> threadBuffersLock(mThreadBuffersMutex);
+			mFlushedThreadBuffers.clear();
+			for (const std::unique_ptr<ThreadBuffer>& threadBuffer : mThreadBuffers)
+			{
+				mFlushedThreadBuffers.push_back(threadBuffer.get());
+			}
+		}
+
+		// Take over the messages of all threads, messages pushed meanwhile go into the emptied buffers
+		mSortedMessages.clear();
+		for (ThreadBuffer* threadBuffer : mFlushedThreadBuffers)
+		{
+			{
+				std::lock_guard<std::mutex> threadBufferLock(threadBuffer->mMutex);
+				threadBuffer->mFlushedMessages.swap(threadBuffer->mMessages);
+			}
+			for (DeferredMessage& deferredMessage : threadBuffer->mFlushedMessages)
+			{
+				mSortedMessages.push_back(&deferredMessage);
+			}
+		}
+
+		// Stable sort to keep the order of messages with the same configuration
+		std::stable_sort(mSortedMessages.begin(), mSortedMessages.end(), [](const DeferredMessage* left, const DeferredMessage* right) { return isOrderedBefore(left->mConfiguration, right->mConfiguration); });
+
+		// Dispatch batch by batch
+		const size_t numberOfMessages = mSortedMessages.size();
+		size_t batchBegin = 0;
+		while (batchBegin < numberOfMessages)
+		{
+			const MessageConfiguration& configuration = mSortedMessages[batchBegin]->mConfiguration;
+			size_t batchEnd = batchBegin + 1;
+			while (batchEnd < numberOfMessages && mSortedMessages[batchEnd]->mConfiguration == configuration)
+			{
+				++batchEnd;
+			}
+
+			// Look up the batch listeners once for the whole batch
+			const BatchListenerMap::const_iterator iterator = mBatchListeners.find(configuration.getFilter<uint32>(0));
+			if (iterator != mBatchListeners.cend())
+			{
+				mBatchParameters.clear();
+				for (size_t messageIndex = batchBegin; messageIndex < batchEnd; ++messageIndex)
+				{
+					mBatchParameters.push_back(&mSortedMessages[messageIndex]->mParameters);
+				}
+				for (const BatchListener& batchListener : iterator->second)
+				{
+					batchListener(configuration, mBatchParameters);
+				}
+			}
+
+			if (nullptr != messageSystem)
+			{
+				for (size_t messageIndex = batchBegin; messageIndex < batchEnd; ++messageIndex)
+				{
+					messageSystem->emitMessage(configuration, mSortedMessages[messageIndex]->mParameters);
+				}
+			}
+
+			batchBegin = batchEnd;
+		}
+		mSortedMessages.clear();
+		mBatchParameters.clear();
+
+		// The flushed messages are only touched by the flush, so no thread buffer lock is needed
+		for (ThreadBuffer* threadBuffer : mFlushedThreadBuffers)
+		{
+			threadBuffer->mFlushedMessages.clear();
+		}
+		return static_cast<uint32>(numberOfMessages);
+	}
+
+	inline void DeferredMessageQueue::startAutomaticFlush(const StringHash& jobManagerId, MessageSystem* messageSystem)
+	{
+		mFlushJobMessageSystem = messageSystem;
+		mFlushJobProxy.registerAt(jobManagerId, boost::bind(&DeferredMessageQueue::updateFlushJob, this, _1));
+	}
+
+	inline void DeferredMessageQueue::stopAutomaticFlush()
+	{
+		mFlushJobProxy.unregister();
+		mFlushJobMessageSystem = nullptr;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	inline DeferredMessageQueue::ThreadBuffer& DeferredMessageQueue::getThreadBufferOfCallingThread()
+	{
+		ThreadLocalBuffer& threadLocalBuffer = getThreadLocalBuffer();
+		if (threadLocalBuffer.mQueue != this || threadLocalBuffer.mQueueId != mQueueId)
+		{
+			// Slow path, only taken the first time a thread pushes into this queue or after it pushed into another queue
+			std::lock_guard<std::mutex> threadBuffersLock(mThreadBuffersMutex);
+			ThreadBuffer*& threadBuffer = mThreadBufferByThreadId[std::this_thread::get_id()];
+			if (nullptr == threadBuffer)
+			{
+				mThreadBuffers.emplace_back(new ThreadBuffer());
+				threadBuffer = mThreadBuffers.back().get();
+			}
+			threadLocalBuffer.mQueue = this;
+			threadLocalBuffer.mQueueId = mQueueId;
+			threadLocalBuffer.mThreadBuffer = threadBuffer;
+		}
+		return *threadLocalBuffer.mThreadBuffer;
+	}
+
+	inline void DeferredMessageQueue::updateFlushJob(const JobArguments&)
+	{
+		flush(mFlushJobMessageSystem);
+	}
+
+	inline bool DeferredMessageQueue::isOrderedBefore(const MessageConfiguration& left, const MessageConfiguration& right)
+	{
+		const uint32 numberOfCommonFilters = std::min(left.getNumberOfFilters(), right.getNumberOfFilters());
+		for (uint32 index = 0; index < numberOfCommonFilters; ++index)
+		{
+			const uint64 leftFilter = left.getFilter<uint64>(index);
+			const uint64 rightFilter = right.getFilter<uint64>(index);
+			if (leftFilter != rightFilter)
+			{
+				return (leftFilter < rightFilter);
+			}
+		}
+		return (left.getNumberOfFilters() < right.getNumberOfFilters());
+	}
+
+	inline uint64 DeferredMessageQueue::generateQueueId()
+	{
+		static std::atomic<uint64> nextQueueId(1);
+		return nextQueueId.fetch_add(1);
+	}
+
+	inline DeferredMessageQueue::ThreadLocalBuffer& DeferredMessageQueue::getThreadLocalBuffer()
+	{
+		// The generated queue IDs are per module as well as this slot, the queue address tells queues of different modules apart
+		static thread_local ThreadLocalBuffer threadLocalBuffer = { nullptr, 0, nullptr };
+		return threadLocalBuffer;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,257 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessageParameters.h"
+#include "qsf/message/MessageConfiguration.h"
+#include "qsf/job/JobProxy.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/container/flat_map.hpp>
+
+#include <thread>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class MessageSystem;
+	class JobArguments;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Queue of deferred messages, which are dispatched later on in batches
+	*
+	*  @remarks
+	*    Each thread pushing messages gets a buffer of its own, guarded by a mutex of its own. Pushing only locks the buffer of the
+	*    calling thread, which is uncontended except for the moment the flush swaps the buffer, so worker threads don't block each other.
+	*    The queue mutex is only locked once per thread for creating its buffer.
+	*
+	*    On flush, the messages of all threads are sorted by their message configuration and dispatched as one batch per configuration:
+	*    - Batch listeners (see "registerBatchListener()") are looked up once per batch and get all messages of the batch in a single call
+	*    - If a message system is given, each message is emitted there as well, for the listeners registered via "qsf::MessageProxy"
+	*    Messages of the same configuration keep the order they were pushed in by a thread.
+	*
+	*    The queue is owned by the code using it, e.g. a plugin. To flush automatically, let it register a job at a job manager which
+	*    is updated on the main thread, e.g. "qsf::QsfJobs::SIMULATION_GENERAL", see "startAutomaticFlush()".
+	*
+	*  @note
+	*    - Messages pushed while flushing, e.g. by listeners, are dispatched by the next flush
+	*    - Deferred messages can't have responses
+	*/
+	class DeferredMessageQueue : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		typedef std::vector<const MessageParameters*> ParametersArray;
+		typedef boost::function<void(const MessageConfiguration&, const ParametersArray&)> BatchListener;
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		inline DeferredMessageQueue();
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - Messages which were not flushed are discarded
+		*/
+		inline ~DeferredMessageQueue();
+
+		/**
+		*  @brief
+		*    Push a message into the buffer of the calling thread; may be called from any thread
+		*
+		*  @param[in] message
+		*    The message to dispatch later on
+		*/
+		inline void push(const MessageConfiguration& message);
+
+		/**
+		*  @brief
+		*    Push a message into the buffer of the calling thread; may be called from any thread
+		*
+		*  @param[in] message
+		*    The message to dispatch later on
+		*  @param[in] parameters
+		*    Message parameters to pass to the listeners, are copied
+		*/
+		inline void push(const MessageConfiguration& message, const MessageParameters& parameters);
+
+		/**
+		*  @brief
+		*    Register a listener getting all messages with the given message ID as batches, one call per message configuration
+		*
+		*  @note
+		*    - Must not be called while flushing, e.g. by listeners
+		*/
+		inline void registerBatchListener(const StringHash& messageId, const BatchListener& batchListener);
+
+		/**
+		*  @brief
+		*    Remove all batch listeners of the given message ID
+		*
+		*  @note
+		*    - Must not be called while flushing, e.g. by listeners
+		*/
+		inline void unregisterBatchListeners(const StringHash& messageId);
+
+		/**
+		*  @brief
+		*    Dispatch all pushed messages
+		*
+		*  @param[in] messageSystem
+		*    Message system to emit each message at, can be a null pointer to only call the batch listeners
+		*
+		*  @return
+		*    The number of dispatched messages
+		*
+		*  @note
+		*    - May be called while other threads push messages; flushes are serialized
+		*    - Must not be called by listeners
+		*/
+		inline uint32 flush(MessageSystem* messageSystem);
+
+		/**
+		*  @brief
+		*    Flush each time the given job manager is updated
+		*
+		*  @param[in] jobManagerId
+		*    ID of the job manager to register the flush job at, should be one updated on the main thread
+		*  @param[in] messageSystem
+		*    Message system to emit the messages at, see "flush()"; must stay valid until "stopAutomaticFlush()" or the queue destruction
+		*/
+		inline void startAutomaticFlush(const StringHash& jobManagerId, MessageSystem* messageSystem);
+
+		/**
+		*  @brief
+		*    Stop flushing automatically
+		*/
+		inline void stopAutomaticFlush();
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		struct DeferredMessage
+		{
+			MessageConfiguration mConfiguration;
+			MessageParameters	 mParameters;
+
+			inline DeferredMessage(const MessageConfiguration& configuration, const MessageParameters& parameters) : mConfiguration(configuration), mParameters(parameters) {}
+		};
+		typedef std::vector<DeferredMessage> DeferredMessageArray;
+
+		struct ThreadBuffer
+		{
+			std::mutex			 mMutex;			///< Guards "mMessages", only contended while the flush swaps the buffers
+			DeferredMessageArray mMessages;			///< Messages pushed by the owning thread
+			DeferredMessageArray mFlushedMessages;	///< Messages currently being flushed, only touched by the flush, kept as member to reuse the allocated memory
+		};
+		typedef std::vector<std::unique_ptr<ThreadBuffer>>				   ThreadBuffers;
+		typedef boost::container::flat_map<std::thread::id, ThreadBuffer*> ThreadBufferMap;
+		typedef boost::container::flat_map<uint32, std::vector<BatchListener>> BatchListenerMap;
+
+		struct ThreadLocalBuffer
+		{
+			const DeferredMessageQueue* mQueue;			///< Queue the calling thread used last
+			uint64						mQueueId;		///< ID of this queue, so a new queue at the same address isn't mistaken for it
+			ThreadBuffer*				mThreadBuffer;	///< Buffer of the calling thread inside this queue
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		inline ThreadBuffer& getThreadBufferOfCallingThread();
+		inline void updateFlushJob(const JobArguments& jobArguments);
+
+		/**
+		*  @brief
+		*    Strict weak ordering of message configurations, by message ID first
+		*/
+		inline static bool isOrderedBefore(const MessageConfiguration& left, const MessageConfiguration& right);
+
+		/**
+		*  @brief
+		*    Return the process wide unique ID of the next queue instance
+		*/
+		inline static uint64 generateQueueId();
+
+		/**
+		*  @brief
+		*    Return the per thread slot caching the queue the calling thread used last and its buffer inside this queue
+		*/
+		inline static ThreadLocalBuffer& getThreadLocalBuffer();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		const uint64				  mQueueId;					///< Unique queue ID, unlike the instance address it's never reused
+		ThreadBuffers				  mThreadBuffers;			///< One buffer per thread which ever pushed a message, guarded by "mThreadBuffersMutex"
+		ThreadBufferMap				  mThreadBufferByThreadId;	///< Guarded by "mThreadBuffersMutex"
+		std::mutex					  mThreadBuffersMutex;
+		std::mutex					  mFlushMutex;				///< Serializes flushes, guards the data below
+		std::vector<ThreadBuffer*>	  mFlushedThreadBuffers;	///< Only used during flush, kept as member to reuse the allocated memory
+		std::vector<DeferredMessage*> mSortedMessages;			///< Only used during flush, kept as member to reuse the allocated memory
+		ParametersArray				  mBatchParameters;			///< Only used during flush, kept as member to reuse the allocated memory
+		BatchListenerMap			  mBatchListeners;			///< Batch listeners by message ID
+		JobProxy					  mFlushJobProxy;			///< Regular job calling "qsf::DeferredMessageQueue::updateFlushJob()"
+		MessageSystem*				  mFlushJobMessageSystem;	///< Message system of the automatic flush, can be a null pointer
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/message/DeferredMessageQueue-inl.h"
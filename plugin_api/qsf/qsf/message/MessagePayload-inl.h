@@ -0,0 +1,107 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessageSystem.h"
+#include "qsf/base/error/ErrorHandling.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	template<typename T>
+	MessagePayload::Scope::Scope(const MessageParameters& parameters, const T& payload) :
+		mPushed(false)
+	{
+		SideTable& sideTable = getSideTableOfCallingThread();
+		QSF_CHECK(sideTable.numberOfEntries < MAX_NESTING_DEPTH, "Too many nested message emissions with payload, the payload is not passed to the listeners", return);
+
+		Entry& entry = sideTable.entries[sideTable.numberOfEntries];
+		entry.parameters = &parameters;
+		entry.type = &typeid(T);
+		entry.payload = &payload;
+		++sideTable.numberOfEntries;
+		mPushed = true;
+	}
+
+	inline MessagePayload::Scope::~Scope()
+	{
+		if (mPushed)
+		{
+			--getSideTableOfCallingThread().numberOfEntries;
+		}
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	template<typename T>
+	void MessagePayload::emitMessage(MessageSystem& messageSystem, const MessageConfiguration& message, const T& payload)
+	{
+		MessageParameters parameters;
+		emitMessage(messageSystem, message, payload, parameters);
+	}
+
+	template<typename T>
+	void MessagePayload::emitMessage(MessageSystem& messageSystem, const MessageConfiguration& message, const T& payload, MessageParameters& parameters)
+	{
+		// The message system passes the given parameters instance to the listeners, that's what the payload is linked to
+		Scope scope(parameters, payload);
+		messageSystem.emitMessage(message, parameters);
+	}
+
+	template<typename T>
+	const T* MessagePayload::tryGet(const MessageParameters& parameters)
+	{
+		return static_cast<const T*>(find(parameters, typeid(T)));
+	}
+
+	template<typename T>
+	const T& MessagePayload::getSafe(const MessageParameters& parameters)
+	{
+		const T* payload = tryGet<T>(parameters);
+		QSF_CHECK(nullptr != payload, "The message has no payload of type " << typeid(T).name(), QSF_REACT_THROW);
+		return *payload;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	inline MessagePayload::SideTable& MessagePayload::getSideTableOfCallingThread()
+	{
+		static thread_local SideTable sideTable = {};
+		return sideTable;
+	}
+
+	inline const void* MessagePayload::find(const MessageParameters& parameters, const std::type_info& type)
+	{
+		// Innermost emission first, there are hardly ever more than one or two entries
+		const SideTable& sideTable = getSideTableOfCallingThread();
+		for (uint32 entryIndex = sideTable.numberOfEntries; entryIndex > 0; --entryIndex)
+		{
+			const Entry& entry = sideTable.entries[entryIndex - 1];
+			if (entry.parameters == &parameters)
+			{
+				// Comparing the type information instances instead of their addresses works across module boundaries as well
+				return (*entry.type == type) ? entry.payload : nullptr;
+			}
+		}
+		return nullptr;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
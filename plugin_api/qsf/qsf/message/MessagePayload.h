@@ -0,0 +1,177 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessageParameters.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <typeinfo>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class MessageSystem;
+	class MessageConfiguration;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Typed message payload, passed to the listeners along with the message parameters
+	*
+	*  @remarks
+	*    Named message parameters are stored as CAMP values inside a dictionary, so each of them costs a memory allocation and a
+	*    conversion. A payload is a struct of the emitter which is handed to the listeners by reference instead: while the message
+	*    is emitted, a per thread side table links the message parameters instance to the payload, and listeners look it up by the
+	*    message parameters they got. Neither emitting nor reading a payload allocates memory or involves CAMP.
+	*
+	*    Message parameters itself are untouched, so named parameters keep working, e.g. for scripts, and both can be combined.
+	*
+	*  @code
+	*    struct HealthChangedPayload { uint64 mEntityId; float mHealth; };
+	*
+	*    // Emitter
+	*    HealthChangedPayload payload = { entityId, health };
+	*    qsf::MessagePayload::emitMessage(QSF_MESSAGE, qsf::MessageConfiguration(Messages::HEALTH_CHANGED, entityId), payload);
+	*
+	*    // Listener
+	*    const HealthChangedPayload* payload = qsf::MessagePayload::tryGet<HealthChangedPayload>(parameters);
+	*  @endcode
+	*
+	*  @note
+	*    - Listeners are called synchronously on the emitting thread, so the payload is only valid during the listener call
+	*    - The side table is per module, so emitter and listener must be part of the same module, e.g. the same plugin
+	*    - Deferred messages can't carry a payload
+	*/
+	class MessagePayload
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const uint32 MAX_NESTING_DEPTH = 16;	///< Maximum number of nested emissions with payload per thread
+
+		/**
+		*  @brief
+		*    Links a payload to message parameters for the lifetime of the scope
+		*/
+		class Scope : public boost::noncopyable
+		{
+		public:
+			template<typename T>
+			Scope(const MessageParameters& parameters, const T& payload);
+			inline ~Scope();
+		private:
+			bool mPushed;
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Emit a message with a payload
+		*
+		*  @param[in] messageSystem
+		*    Message system to use, usually "QSF_MESSAGE"
+		*  @param[in] message
+		*    The message to emit, consisting of a message identifier and optional filters
+		*  @param[in] payload
+		*    The payload to pass to the listeners
+		*/
+		template<typename T>
+		static void emitMessage(MessageSystem& messageSystem, const MessageConfiguration& message, const T& payload);
+
+		/**
+		*  @brief
+		*    Emit a message with a payload and named message parameters
+		*/
+		template<typename T>
+		static void emitMessage(MessageSystem& messageSystem, const MessageConfiguration& message, const T& payload, MessageParameters& parameters);
+
+		/**
+		*  @brief
+		*    Return the payload of the message currently emitted with the given parameters
+		*
+		*  @return
+		*    The payload, null pointer if there's no payload or the payload is of another type, do not destroy the instance
+		*/
+		template<typename T>
+		static const T* tryGet(const MessageParameters& parameters);
+
+		/**
+		*  @brief
+		*    Return the payload of the message currently emitted with the given parameters
+		*
+		*  @note
+		*    - Throws an exception in case there's no payload of the given type
+		*/
+		template<typename T>
+		static const T& getSafe(const MessageParameters& parameters);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		struct Entry
+		{
+			const MessageParameters* parameters;
+			const std::type_info*	 type;
+			const void*				 payload;
+		};
+
+		struct SideTable
+		{
+			Entry  entries[MAX_NESTING_DEPTH];	///< Innermost emission last
+			uint32 numberOfEntries;
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		inline static SideTable& getSideTableOfCallingThread();
+		inline static const void* find(const MessageParameters& parameters, const std::type_info& type);
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessagePayload-inl.h"
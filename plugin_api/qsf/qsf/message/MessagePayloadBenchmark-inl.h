@@ -0,0 +1,89 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/time/HighResolutionStopwatch.h"
+
+#include <boost/bind.hpp>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	inline MessagePayloadBenchmark::Result MessagePayloadBenchmark::run(MessageSystem& messageSystem, uint32 numberOfListeners, uint32 numberOfMessages)
+	{
+		const StringHash namedParametersMessageId("qsf::MessagePayloadBenchmark::NamedParameters");
+		const StringHash payloadMessageId("qsf::MessagePayloadBenchmark::Payload");
+		const StringHash entityIdParameter("EntityId");
+		const StringHash valueParameter("Value");
+
+		Result result;
+		result.mNumberOfListenerCalls = static_cast<uint64>(numberOfListeners) * numberOfMessages;
+		double namedParametersSum = 0.0;
+		double payloadSum = 0.0;
+		{
+			std::vector<MessageProxy> messageProxies(numberOfListeners * 2);
+			for (uint32 listenerIndex = 0; listenerIndex < numberOfListeners; ++listenerIndex)
+			{
+				messageProxies[listenerIndex * 2].registerAt(MessageConfiguration(namedParametersMessageId), boost::bind(&MessagePayloadBenchmark::onNamedParametersMessage, _1, boost::ref(namedParametersSum)));
+				messageProxies[listenerIndex * 2 + 1].registerAt(MessageConfiguration(payloadMessageId), boost::bind(&MessagePayloadBenchmark::onPayloadMessage, _1, boost::ref(payloadSum)));
+			}
+
+			{ // Named parameters
+				HighResolutionStopwatch stopwatch;
+				for (uint32 messageIndex = 0; messageIndex < numberOfMessages; ++messageIndex)
+				{
+					MessageParameters parameters;
+					parameters.setParameter(entityIdParameter, static_cast<uint64>(messageIndex));
+					parameters.setParameter(valueParameter, static_cast<float>(messageIndex % 100));
+					messageSystem.emitMessage(MessageConfiguration(namedParametersMessageId), parameters);
+				}
+				result.mNamedParametersTime = stopwatch.getElapsed();
+			}
+
+			{ // Payload
+				HighResolutionStopwatch stopwatch;
+				for (uint32 messageIndex = 0; messageIndex < numberOfMessages; ++messageIndex)
+				{
+					const Payload payload = { static_cast<uint64>(messageIndex), static_cast<float>(messageIndex % 100) };
+					MessagePayload::emitMessage(messageSystem, MessageConfiguration(payloadMessageId), payload);
+				}
+				result.mPayloadTime = stopwatch.getElapsed();
+			}
+		}
+		result.mResultsMatch = (namedParametersSum == payloadSum);
+
+		return result;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	inline void MessagePayloadBenchmark::onNamedParametersMessage(const MessageParameters& parameters, double& sum)
+	{
+		sum += static_cast<double>(parameters.getParameterSafe<uint64>("EntityId")) + parameters.getParameterSafe<float>("Value");
+	}
+
+	inline void MessagePayloadBenchmark::onPayloadMessage(const MessageParameters& parameters, double& sum)
+	{
+		const Payload& payload = MessagePayload::getSafe<Payload>(parameters);
+		sum += static_cast<double>(payload.mEntityId) + payload.mValue;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,113 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessagePayload.h"
+#include "qsf/message/MessageProxy.h"
+#include "qsf/time/Time.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Benchmark of emitting a message to many listeners with a "qsf::MessagePayload" against named message parameters
+	*
+	*  @remarks
+	*    Registers the given number of listeners at a message only used by the benchmark and emits it the given number of times,
+	*    once carrying an entity ID and a value as named parameters, once as payload. Each listener reads both values.
+	*    Usage, e.g. from a debug command of a plugin:
+	*    @code
+	*      const qsf::MessagePayloadBenchmark::Result result = qsf::MessagePayloadBenchmark::run(QSF_MESSAGE, 50, 10000);
+	*      QSF_LOG_PRINTS(INFO, "Named parameters: " << result.mNamedParametersTime.getMilliseconds() << " ms, payload: " << result.mPayloadTime.getMilliseconds() << " ms");
+	*    @endcode
+	*
+	*  @note
+	*    - The listeners register at the global message system, so pass "QSF_MESSAGE"
+	*/
+	class MessagePayloadBenchmark
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		struct Result
+		{
+			Time   mNamedParametersTime;	///< Time needed for all emissions with named parameters
+			Time   mPayloadTime;			///< Time needed for all emissions with payload
+			uint64 mNumberOfListenerCalls;	///< Number of listener calls per variant
+			bool   mResultsMatch;			///< "true" if the listeners read the same values in both variants, else "false"
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Run the benchmark
+		*
+		*  @param[in] messageSystem
+		*    Message system to emit at, the one the message proxies register at
+		*  @param[in] numberOfListeners
+		*    Number of listeners registered at the benchmark message
+		*  @param[in] numberOfMessages
+		*    Number of emissions per variant
+		*
+		*  @return
+		*    The measured times
+		*/
+		inline static Result run(MessageSystem& messageSystem, uint32 numberOfListeners, uint32 numberOfMessages);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		struct Payload
+		{
+			uint64 mEntityId;
+			float  mValue;
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		inline static void onNamedParametersMessage(const MessageParameters& parameters, double& sum);
+		inline static void onPayloadMessage(const MessageParameters& parameters, double& sum);
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/message/MessagePayloadBenchmark-inl.h"
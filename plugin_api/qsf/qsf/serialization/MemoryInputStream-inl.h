@@ -0,0 +1,92 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline MemoryStreamBuffer::MemoryStreamBuffer(const uint8* data, uint64 size)
+	{
+		// The get area is never written to, the const cast is only required by the "std::streambuf" interface
+		char* begin = reinterpret_cast<char*>(const_cast<uint8*>(data));
+		setg(begin, begin, begin + size);
+	}
+
+	inline const uint8* MemoryStreamBuffer::consume(uint64 bytes)
+	{
+		if (bytes > getNumberOfRemainingBytes())
+		{
+			return nullptr;
+		}
+
+		const uint8* address = reinterpret_cast<const uint8*>(gptr());
+
+		// "std::streambuf::gbump()" only takes an int
+		setg(eback(), gptr() + bytes, egptr());
+		return address;
+	}
+
+	inline uint64 MemoryStreamBuffer::getNumberOfRemainingBytes() const
+	{
+		return static_cast<uint64>(egptr() - gptr());
+	}
+
+	inline MemoryInputStream::MemoryInputStream(const uint8* data, uint64 size) :
+		std::istream(nullptr),
+		mMemoryStreamBuffer(data, size)
+	{
+		// The stream buffer member is constructed after the base class, so connect it now
+		rdbuf(&mMemoryStreamBuffer);
+	}
+
+	inline MemoryStreamBuffer& MemoryInputStream::getMemoryStreamBuffer()
+	{
+		return mMemoryStreamBuffer;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual std::streambuf methods              ]
+	//[-------------------------------------------------------]
+	inline MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode)
+	{
+		if (0 == (mode & std::ios_base::in))
+		{
+			return pos_type(off_type(-1));
+		}
+
+		off_type position = offset;
+		if (std::ios_base::cur == direction)
+		{
+			position += gptr() - eback();
+		}
+		else if (std::ios_base::end == direction)
+		{
+			position += egptr() - eback();
+		}
+		return seekpos(pos_type(position), mode);
+	}
+
+	inline MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type position, std::ios_base::openmode mode)
+	{
+		const off_type offset = off_type(position);
+		if (0 == (mode & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+		{
+			return pos_type(off_type(-1));
+		}
+
+		setg(eback(), eback() + offset, egptr());
+		return position;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
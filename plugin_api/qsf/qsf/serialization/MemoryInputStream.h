@@ -0,0 +1,143 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+
+#include <streambuf>
+#include <istream>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Stream buffer reading directly from a memory block, e.g. a memory mapped file
+	*
+	*  @remarks
+	*    Unlike "qsf::PagedMemoryBuffer" connected via "boost::iostreams::stream", there's no intermediate buffer:
+	*    The whole memory block is the get area, so stream reads are plain memory copies and "consume()" can even
+	*    hand out pointers into the memory block without copying at all.
+	*
+	*  @note
+	*    - The memory block is not copied and must stay valid as long as the stream buffer is used
+	*/
+	class MemoryStreamBuffer : public std::streambuf
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] data
+		*    Memory block to read from, do not destroy the memory while the stream buffer is used
+		*  @param[in] size
+		*    Size of the memory block in bytes
+		*/
+		inline MemoryStreamBuffer(const uint8* data, uint64 size);
+
+		/**
+		*  @brief
+		*    Return the current read address and move the read position behind the given number of bytes
+		*
+		*  @param[in] bytes
+		*    Number of bytes to consume
+		*
+		*  @return
+		*    Address of the consumed bytes inside the memory block, null pointer if there are not enough bytes left (the read position is not changed then)
+		*/
+		inline const uint8* consume(uint64 bytes);
+
+		/**
+		*  @brief
+		*    Return the number of bytes left to read
+		*/
+		inline uint64 getNumberOfRemainingBytes() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual std::streambuf methods              ]
+	//[-------------------------------------------------------]
+	protected:
+		inline virtual pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode = std::ios_base::in) override;
+		inline virtual pos_type seekpos(pos_type position, std::ios_base::openmode mode = std::ios_base::in) override;
+
+
+	};
+
+
+	/**
+	*  @brief
+	*    Input stream reading directly from a memory block, e.g. a memory mapped file
+	*
+	*  @remarks
+	*    A binary serializer reading from a memory input stream shares its read position, so raw blocks
+	*    can be taken over without copying, see "qsf::MemoryMappedBinaryInput"
+	*/
+	class MemoryInputStream : public std::istream
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] data
+		*    Memory block to read from, do not destroy the memory while the stream is used
+		*  @param[in] size
+		*    Size of the memory block in bytes
+		*/
+		inline MemoryInputStream(const uint8* data, uint64 size);
+
+		/**
+		*  @brief
+		*    Return the stream buffer
+		*/
+		inline MemoryStreamBuffer& getMemoryStreamBuffer();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		MemoryStreamBuffer mMemoryStreamBuffer;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/serialization/MemoryInputStream-inl.h"
@@ -0,0 +1,120 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/base/error/ErrorHandling.h"
+
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline MemoryMappedBinaryInput::MemoryMappedBinaryInput()
+	{
+		// Nothing here
+	}
+
+	inline MemoryMappedBinaryInput::~MemoryMappedBinaryInput()
+	{
+		// The serializer and the stream must be gone before the file is unmapped
+		close();
+	}
+
+	inline bool MemoryMappedBinaryInput::open(const std::string& absoluteFilename)
+	{
+		close();
+		if (!mMemoryMappedFile.open(absoluteFilename))
+		{
+			return false;
+		}
+
+		// The binary serializer constructor reads the file header, in case it throws the file remains closed
+		std::unique_ptr<MemoryInputStream> memoryInputStream(new MemoryInputStream(mMemoryMappedFile.getData(), mMemoryMappedFile.getSize()));
+		try
+		{
+			mBinarySerializer.reset(new BinarySerializer(*memoryInputStream));
+		}
+		catch (...)
+		{
+			mMemoryMappedFile.close();
+			throw;
+		}
+		mMemoryInputStream = std::move(memoryInputStream);
+
+		// Done
+		return true;
+	}
+
+	inline void MemoryMappedBinaryInput::close()
+	{
+		mBinarySerializer.reset();
+		mMemoryInputStream.reset();
+		mMemoryMappedFile.close();
+	}
+
+	inline bool MemoryMappedBinaryInput::isOpen() const
+	{
+		return (nullptr != mBinarySerializer);
+	}
+
+	inline BinarySerializer& MemoryMappedBinaryInput::getSerializer() const
+	{
+		QSF_CHECK(nullptr != mBinarySerializer, "No file opened for the memory mapped binary input", QSF_REACT_THROW);
+		return *mBinarySerializer;
+	}
+
+	inline uint64 MemoryMappedBinaryInput::getNumberOfRemainingBytes() const
+	{
+		return (nullptr != mMemoryInputStream) ? mMemoryInputStream->getMemoryStreamBuffer().getNumberOfRemainingBytes() : 0;
+	}
+
+	inline const uint8* MemoryMappedBinaryInput::tryReadRawBlockInPlace(uint32 bytes)
+	{
+		return (nullptr != mMemoryInputStream) ? mMemoryInputStream->getMemoryStreamBuffer().consume(bytes) : nullptr;
+	}
+
+	template<typename T>
+	void MemoryMappedBinaryInput::readUntokenizedArray(T* values, uint32 numberOfValues)
+	{
+		// Booleans can't be copied since any non-zero byte is "true"
+		static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "Only arrays of basic types can be read as a whole");
+
+		const uint32 bytes = numberOfValues * static_cast<uint32>(sizeof(T));
+		const uint8* address = tryReadRawBlockInPlace(bytes);
+		QSF_CHECK(nullptr != address, "Memory mapped binary input can't read " << bytes << " bytes, only " << getNumberOfRemainingBytes() << " bytes are left", QSF_REACT_THROW);
+		memcpy(values, address, bytes);
+
+		// The data is stored in default endianness
+		if (std::is_integral<T>::value && sizeof(T) > 1 && isLittleEndianMachine() == BinarySerializer::DEFAULT_IS_BIG_ENDIAN)
+		{
+			std::for_each(values, values + numberOfValues, [](T& value) { uint8* valueBytes = reinterpret_cast<uint8*>(&value); std::reverse(valueBytes, valueBytes + sizeof(T)); });
+		}
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	inline bool MemoryMappedBinaryInput::isLittleEndianMachine()
+	{
+		const uint16 value = 1;
+		return (1 == *reinterpret_cast<const uint8*>(&value));
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
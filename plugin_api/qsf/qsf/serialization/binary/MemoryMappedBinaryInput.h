@@ -0,0 +1,179 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/serialization/binary/BinarySerializer.h"
+#include "qsf/serialization/MemoryInputStream.h"
+#include "qsf/file/MemoryMappedFile.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Binary serializer input reading from a memory mapped file
+	*
+	*  @remarks
+	*    Bundles a memory mapped file, a memory input stream on top of it and a binary serializer reading from that stream.
+	*    The serializer itself is the regular "qsf::BinarySerializer", so everything with a "serialize(BinarySerializer&)"
+	*    method can be loaded this way, but there's no "qsf::PagedMemoryBuffer" or file stream copying layer in between.
+	*
+	*    Since the serializer reads through the memory input stream, both share the read position. This allows for
+	*    reads the serializer itself can't offer:
+	*    - "tryReadRawBlockInPlace()" hands out a pointer into the mapped file instead of copying the raw block
+	*    - "readUntokenizedArray()" reads an array of basic type values written with "qsf::BinarySerializer::TOKEN_FLAG_NONE"
+	*      by a single memory copy, instead of one serializer call and token check per value
+	*
+	*  @note
+	*    - Works on files of the native file system only, see "qsf::MemoryMappedFile"
+	*/
+	class MemoryMappedBinaryInput : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		inline MemoryMappedBinaryInput();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline ~MemoryMappedBinaryInput();
+
+		/**
+		*  @brief
+		*    Map a file and open the binary serializer for reading it, a previously opened file gets closed
+		*
+		*  @param[in] absoluteFilename
+		*    Absolute UTF-8 filename in platform-dependent notation
+		*
+		*  @return
+		*    "true" if all went fine, else "false" (e.g. the file can't be mapped)
+		*
+		*  @note
+		*    - Like the binary serializer constructor, this throws an exception in case the file header is invalid
+		*/
+		inline bool open(const std::string& absoluteFilename);
+
+		/**
+		*  @brief
+		*    Close the file, all pointers into the file contents get invalid
+		*/
+		inline void close();
+
+		/**
+		*  @brief
+		*    Return whether or not a file is opened
+		*/
+		inline bool isOpen() const;
+
+		/**
+		*  @brief
+		*    Return the binary serializer reading the file
+		*
+		*  @note
+		*    - Only valid while a file is opened
+		*/
+		inline BinarySerializer& getSerializer() const;
+
+		/**
+		*  @brief
+		*    Return the number of bytes left to read
+		*/
+		inline uint64 getNumberOfRemainingBytes() const;
+
+		/**
+		*  @brief
+		*    Deserialize a raw block without copying it, the counterpart to "qsf::BinarySerializer::writeRawBlock()"
+		*
+		*  @param[in] bytes
+		*    Number of bytes to read
+		*
+		*  @return
+		*    Address of the raw block inside the mapped file, valid until the file is closed, do not destroy the memory;
+		*    null pointer if there are not enough bytes left (nothing is read then)
+		*
+		*  @note
+		*    - There's no alignment guarantee for the returned address and the byte order is not changed
+		*/
+		inline const uint8* tryReadRawBlockInPlace(uint32 bytes);
+
+		/**
+		*  @brief
+		*    Deserialize an array of basic type values by a single memory copy
+		*
+		*  @param[out] values
+		*    Array to read the values to, must hold at least "numberOfValues" values
+		*  @param[in] numberOfValues
+		*    Number of values to read
+		*
+		*  @remarks
+		*    With "qsf::BinarySerializer::TOKEN_FLAG_NONE", serializing the values one by one writes a tightly packed array,
+		*    so it can be read as a whole. Floating point values and single bytes are stored without respecting the byte
+		*    order (see "qsf/serialization/binary/BasicTypeSerialization.h"), the other integral types are fixed up if needed.
+		*
+		*  @note
+		*    - Only valid for data written with "qsf::BinarySerializer::TOKEN_FLAG_NONE", the serializer doesn't tell its token mode,
+		*      so the caller has to know its format
+		*    - Throws an exception in case there are not enough bytes left to read
+		*/
+		template<typename T>
+		void readUntokenizedArray(T* values, uint32 numberOfValues);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		inline static bool isLittleEndianMachine();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		MemoryMappedFile				   mMemoryMappedFile;
+		std::unique_ptr<MemoryInputStream> mMemoryInputStream;	///< Reads from the mapped file, null pointer if no file is opened
+		std::unique_ptr<BinarySerializer>  mBinarySerializer;	///< Reads from the memory input stream, null pointer if no file is opened
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/serialization/binary/MemoryMappedBinaryInput-inl.h"
@@ -0,0 +1,153 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/base/error/ErrorHandling.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	template <typename T>
+	BoundedMpmcQueue<T>::BoundedMpmcQueue(uint32 capacity) :
+		mCells(new Cell[capacity]),
+		mIndexMask(capacity - 1),
+		mPushPosition(0),
+		mPopPosition(0)
+	{
+		QSF_CHECK(capacity >= 2 && 0 == (capacity & (capacity - 1)), "The bounded MPMC queue capacity must be a power of two", QSF_REACT_THROW);
+
+		for (size_t i = 0; i < capacity; ++i)
+		{
+			mCells[i].mSequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template <typename T>
+	BoundedMpmcQueue<T>::~BoundedMpmcQueue()
+	{
+		// Nothing here
+	}
+
+	template <typename T>
+	uint32 BoundedMpmcQueue<T>::getCapacity() const
+	{
+		return static_cast<uint32>(mIndexMask + 1);
+	}
+
+	template <typename T>
+	uint32 BoundedMpmcQueue<T>::getApproximateSize() const
+	{
+		const size_t pushPosition = mPushPosition.load(std::memory_order_relaxed);
+		const size_t popPosition = mPopPosition.load(std::memory_order_relaxed);
+		return (pushPosition > popPosition) ? static_cast<uint32>(pushPosition - popPosition) : 0;
+	}
+
+	template <typename T>
+	bool BoundedMpmcQueue<T>::tryPush(const T& element)
+	{
+		size_t position = 0;
+		Cell* cell = reserveCellForPush(position);
+		if (nullptr == cell)
+		{
+			return false;
+		}
+		cell->mElement = element;
+		cell->mSequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename T>
+	bool BoundedMpmcQueue<T>::tryPush(T&& element)
+	{
+		size_t position = 0;
+		Cell* cell = reserveCellForPush(position);
+		if (nullptr == cell)
+		{
+			return false;
+		}
+		cell->mElement = std::move(element);
+		cell->mSequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename T>
+	bool BoundedMpmcQueue<T>::tryPop(T& element)
+	{
+		size_t position = mPopPosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = mCells[position & mIndexMask];
+			const size_t sequence = cell.mSequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+			if (0 == difference)
+			{
+				// The cell is filled for this lap, try to claim it
+				if (mPopPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					element = std::move(cell.mElement);
+					cell.mSequence.store(position + mIndexMask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				// Empty
+				return false;
+			}
+			else
+			{
+				// Another consumer was faster
+				position = mPopPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	template <typename T>
+	typename BoundedMpmcQueue<T>::Cell* BoundedMpmcQueue<T>::reserveCellForPush(size_t& position)
+	{
+		position = mPushPosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = mCells[position & mIndexMask];
+			const size_t sequence = cell.mSequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (0 == difference)
+			{
+				// The cell is free for this lap, try to claim it
+				if (mPushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					return &cell;
+				}
+			}
+			else if (difference < 0)
+			{
+				// Full
+				return nullptr;
+			}
+			else
+			{
+				// Another producer was faster
+				position = mPushPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,147 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <memory>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Lock-free bounded multi-producer multi-consumer FIFO queue
+	*
+	*  @remarks
+	*    Implementation of Dmitry Vyukov's bounded MPMC queue (http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue).
+	*    Each cell carries a sequence number telling producers and consumers whether the cell is free or filled for the current lap,
+	*    so enqueue and dequeue cost a single compare-and-swap each in the uncontended case and never block.
+	*
+	*  @note
+	*    - The capacity must be a power of two, "tryPush()" fails if the queue is full
+	*/
+	template <typename T>
+	class BoundedMpmcQueue : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] capacity
+		*    Maximum number of elements inside the queue, must be a power of two
+		*/
+		explicit BoundedMpmcQueue(uint32 capacity);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~BoundedMpmcQueue();
+
+		/**
+		*  @brief
+		*    Return the capacity of the queue
+		*/
+		uint32 getCapacity() const;
+
+		/**
+		*  @brief
+		*    Return the approximate number of elements inside the queue; the result may already be outdated when it's returned
+		*/
+		uint32 getApproximateSize() const;
+
+		/**
+		*  @brief
+		*    Enqueue an element
+		*
+		*  @return
+		*    "true" if all went fine, "false" if the queue is full
+		*/
+		bool tryPush(const T& element);
+		bool tryPush(T&& element);
+
+		/**
+		*  @brief
+		*    Dequeue the oldest element
+		*
+		*  @return
+		*    "true" if an element was dequeued, "false" if the queue is empty
+		*/
+		bool tryPop(T& element);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> mSequence;
+			T					mElement;
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Reserve a cell for writing, return a null pointer if the queue is full
+		*/
+		Cell* reserveCellForPush(size_t& position);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		std::unique_ptr<Cell[]> mCells;
+		size_t					mIndexMask;
+		// Producers and consumers write different positions, keep them on different cache lines
+		uint8					mPadding0[64];
+		std::atomic<size_t>		mPushPosition;
+		uint8					mPadding1[64 - sizeof(std::atomic<size_t>)];
+		std::atomic<size_t>		mPopPosition;
+		uint8					mPadding2[64 - sizeof(std::atomic<size_t>)];
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/BoundedMpmcQueue-inl.h"
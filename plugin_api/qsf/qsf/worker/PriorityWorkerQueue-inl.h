@@ -0,0 +1,197 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingThreadPool.h"
+#ifdef QSF_PROFILING
+	#include "qsf/time/profiling/ManagedProfilingElement.h"
+	#include "qsf/plugin/QsfJobs.h"
+
+	#include <boost/bind.hpp>
+#endif
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline PriorityWorkerQueue::PriorityWorkerQueue(const std::string& name, WorkStealingThreadPool& threadPool, uint32 capacityPerPriority) :
+		mName(name),
+		mThreadPool(threadPool),
+		mNumberOfQueuedTasks(0),
+		mNumberOfPendingTasks(0)
+	{
+		for (std::unique_ptr<TaskQueue>& taskQueue : mTaskQueues)
+		{
+			taskQueue.reset(new TaskQueue(capacityPerPriority));
+		}
+
+		#ifdef QSF_PROFILING
+			mWaitTimeProfilingElement = new ManagedProfilingElement(name + " wait time", "Worker queues");
+			mRunTimeProfilingElement = new ManagedProfilingElement(name + " run time", "Worker queues");
+			mProfilingJobProxy.registerAt(QsfJobs::REALTIME_GENERAL, boost::bind(&PriorityWorkerQueue::updateProfilingJob, this, _1));
+		#endif
+	}
+
+	inline PriorityWorkerQueue::~PriorityWorkerQueue()
+	{
+		// The thread pool still references us until all tasks are finished
+		waitUntilIdle();
+
+		#ifdef QSF_PROFILING
+			mProfilingJobProxy.unregister();
+			delete mWaitTimeProfilingElement;
+			delete mRunTimeProfilingElement;
+		#endif
+	}
+
+	inline const std::string& PriorityWorkerQueue::getName() const
+	{
+		return mName;
+	}
+
+	inline bool PriorityWorkerQueue::scheduleTask(PriorityWorkerTask& task)
+	{
+		// Claim the task, this fails in case it's still scheduled or executing
+		uint32 status = task.mStatus.load();
+		do
+		{
+			if (PriorityWorkerTask::STATUS_SCHEDULED == status || PriorityWorkerTask::STATUS_EXECUTING == status)
+			{
+				return false;
+			}
+		} while (!task.mStatus.compare_exchange_weak(status, PriorityWorkerTask::STATUS_SCHEDULED));
+		const Time previousScheduleTime = task.mScheduleTime;
+		task.mScheduleTime = Time::highResolutionNow();
+
+		++mNumberOfPendingTasks;
+		if (!mTaskQueues[task.getPriority()]->tryPush(&task))
+		{
+			// Full, hand the task back as it was, no other thread can have touched it since it was claimed
+			task.mScheduleTime = previousScheduleTime;
+			task.mStatus = status;
+			--mNumberOfPendingTasks;
+			return false;
+		}
+		++mNumberOfQueuedTasks;
+		mStatistics.onTaskScheduled();
+
+		// Every scheduled task gets exactly one execution slot inside the thread pool, the slot takes whatever task has the highest priority then
+		mThreadPool.submit([this] { executeNextTask(); });
+		return true;
+	}
+
+	inline bool PriorityWorkerQueue::isTaskPending() const
+	{
+		return (mNumberOfPendingTasks.load() > 0);
+	}
+
+	inline void PriorityWorkerQueue::waitForTask(const PriorityWorkerTask& task)
+	{
+		while (!task.isFinished())
+		{
+			if (!mThreadPool.tryExecuteTask())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	inline void PriorityWorkerQueue::waitUntilIdle()
+	{
+		mThreadPool.waitForCounter(mNumberOfPendingTasks);
+	}
+
+	inline const WorkerQueueStatistics& PriorityWorkerQueue::getStatistics() const
+	{
+		return mStatistics;
+	}
+
+	inline WorkerQueueStatistics& PriorityWorkerQueue::getStatistics()
+	{
+		return mStatistics;
+	}
+
+	inline uint32 PriorityWorkerQueue::getApproximateQueueDepth(PriorityWorkerTask::Priority priority) const
+	{
+		return mTaskQueues[priority]->getApproximateSize();
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	inline void PriorityWorkerQueue::executeNextTask()
+	{
+		PriorityWorkerTask* task = nullptr;
+		for (;;)
+		{
+			for (const std::unique_ptr<TaskQueue>& taskQueue : mTaskQueues)
+			{
+				if (taskQueue->tryPop(task))
+				{
+					break;
+				}
+			}
+			if (nullptr != task)
+			{
+				break;
+			}
+
+			// A queue may look empty while a concurrent push is only half done, in case there's still a queued task it's ours
+			if (0 == mNumberOfQueuedTasks.load())
+			{
+				// Another execution slot already took the task
+				return;
+			}
+			std::this_thread::yield();
+		}
+		--mNumberOfQueuedTasks;
+
+		// Check the deadline
+		const Time startTime = Time::highResolutionNow();
+		const bool deadlineMissed = (startTime > task->mDeadline);
+		const bool expired = (deadlineMissed && task->mDiscardWhenExpired);
+		mStatistics.onTaskDequeued(startTime - task->mScheduleTime, deadlineMissed, expired);
+
+		if (expired)
+		{
+			task->mStatus = PriorityWorkerTask::STATUS_EXPIRED;
+		}
+		else
+		{
+			task->mStatus = PriorityWorkerTask::STATUS_EXECUTING;
+			task->executeImpl();
+			mStatistics.onTaskExecuted(Time::highResolutionNow() - startTime);
+
+			// From here on, the task may be destroyed or rescheduled by its owner
+			task->mStatus = PriorityWorkerTask::STATUS_DONE;
+		}
+		--mNumberOfPendingTasks;
+	}
+
+	#ifdef QSF_PROFILING
+		inline void PriorityWorkerQueue::updateProfilingJob(const JobArguments&)
+		{
+			if (mStatistics.getNumberOfExecutedTasks() > 0)
+			{
+				mWaitTimeProfilingElement->registerUpdate(mStatistics.getAverageWaitTime(), 0);
+				mRunTimeProfilingElement->registerUpdate(mStatistics.getAverageRunTime(), 0);
+				mStatistics.reset();
+			}
+		}
+	#endif
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,224 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/worker/PriorityWorkerTask.h"
+#include "qsf/worker/WorkerQueueStatistics.h"
+#include "qsf/worker/BoundedMpmcQueue.h"
+
+#ifdef QSF_PROFILING
+	#include "qsf/job/JobProxy.h"
+#endif
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <string>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class WorkStealingThreadPool;
+	class JobArguments;
+	#ifdef QSF_PROFILING
+		class ManagedProfilingElement;
+	#endif
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Priority worker queue
+	*
+	*  @remarks
+	*    Lock-free alternative to "qsf::WorkerQueue" for task-parallel use-cases with latency requirements:
+	*      - Scheduling a task is a lock-free push into one bounded MPMC queue per priority, no mutex is involved on either side
+	*      - The tasks are executed by a work-stealing thread pool, so any number of worker threads consume the queue concurrently;
+	*        whenever a worker picks up work from this queue, it takes the task of the highest priority
+	*      - Tasks are intrusive, see "qsf::PriorityWorkerTask"
+	*      - Tasks can have deadlines, missed deadlines are counted and expired tasks can be discarded
+	*      - Queue depth, wait times and run times are tracked in "qsf::WorkerQueueStatistics"
+	*
+	*  @note
+	*    - Meant for task-parallel use-cases
+	*    - Tasks of the same priority are started in scheduling order, but several of them may run concurrently
+	*    - "qsf::WorkerQueue" and the worker threads of "qsf::WorkerSystem" live in the engine library and keep their mutexes,
+	*      only tasks moved over to a priority worker queue stay clear of them
+	*    - With "QSF_PROFILING", the average wait and run times are registered at the profiler once a frame by a job of the job manager "Realtime.General"
+	*/
+	class PriorityWorkerQueue : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const uint32 DEFAULT_CAPACITY_PER_PRIORITY = 1024;
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] name
+		*    Name of the queue, used for profiling
+		*  @param[in] threadPool
+		*    Thread pool executing the tasks, usually the one owned by the plugin; the instance must outlive the queue
+		*  @param[in] capacityPerPriority
+		*    Maximum number of scheduled tasks per priority, must be a power of two
+		*/
+		inline PriorityWorkerQueue(const std::string& name, WorkStealingThreadPool& threadPool, uint32 capacityPerPriority = DEFAULT_CAPACITY_PER_PRIORITY);
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - Waits until all scheduled tasks are finished
+		*/
+		inline ~PriorityWorkerQueue();
+
+		/**
+		*  @brief
+		*    Return the name of the queue
+		*/
+		inline const std::string& getName() const;
+
+		/**
+		*  @brief
+		*    Schedule a task for execution
+		*
+		*  @param[in] task
+		*    Task to schedule, must be finished (see "qsf::PriorityWorkerTask::isFinished()") and must stay alive until it's finished again
+		*
+		*  @return
+		*    "true" if all went fine, "false" if the task is still scheduled or the queue of the task's priority is full;
+		*    a task rejected because of a full queue keeps its previous status, e.g. "qsf::PriorityWorkerTask::STATUS_DONE"
+		*
+		*  @note
+		*    - May be called from any thread
+		*/
+		inline bool scheduleTask(PriorityWorkerTask& task);
+
+		/**
+		*  @brief
+		*    Return whether or not there are scheduled or executing tasks
+		*/
+		inline bool isTaskPending() const;
+
+		/**
+		*  @brief
+		*    Wait until the given task is finished; the calling thread helps executing pending tasks in the meantime
+		*/
+		inline void waitForTask(const PriorityWorkerTask& task);
+
+		/**
+		*  @brief
+		*    Wait until all scheduled tasks are finished; the calling thread helps executing pending tasks in the meantime
+		*/
+		inline void waitUntilIdle();
+
+		/**
+		*  @brief
+		*    Return the statistics
+		*/
+		inline const WorkerQueueStatistics& getStatistics() const;
+
+		/**
+		*  @brief
+		*    Return the statistics
+		*/
+		inline WorkerQueueStatistics& getStatistics();
+
+		/**
+		*  @brief
+		*    Return the approximate number of scheduled tasks of the given priority; the result may already be outdated when it's returned
+		*/
+		inline uint32 getApproximateQueueDepth(PriorityWorkerTask::Priority priority) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		typedef BoundedMpmcQueue<PriorityWorkerTask*> TaskQueue;
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Execute the scheduled task of the highest priority; called by the thread pool once per scheduled task
+		*/
+		inline void executeNextTask();
+
+		#ifdef QSF_PROFILING
+			/**
+			*  @brief
+			*    Register the average wait and run times since the last call at the profiler and reset the statistics
+			*
+			*  @note
+			*    - Job called once a frame by the main thread, the profiling elements themselves aren't thread-safe
+			*/
+			inline void updateProfilingJob(const JobArguments& jobArguments);
+		#endif
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		std::string				   mName;
+		WorkStealingThreadPool&	   mThreadPool;
+		std::unique_ptr<TaskQueue> mTaskQueues[PriorityWorkerTask::_NUM_PRIORITIES];	///< One queue per priority, index is the priority
+		std::atomic<uint32>		   mNumberOfQueuedTasks;		///< Number of tasks inside the task queues
+		std::atomic<uint32>		   mNumberOfPendingTasks;		///< Number of scheduled or executing tasks
+		WorkerQueueStatistics	   mStatistics;
+		#ifdef QSF_PROFILING
+			ManagedProfilingElement* mWaitTimeProfilingElement;	///< Always valid, we're responsible for destroying the instance
+			ManagedProfilingElement* mRunTimeProfilingElement;	///< Always valid, we're responsible for destroying the instance
+			JobProxy				 mProfilingJobProxy;		///< Regular job calling "qsf::PriorityWorkerQueue::updateProfilingJob()"
+		#endif
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/PriorityWorkerQueue-inl.h"
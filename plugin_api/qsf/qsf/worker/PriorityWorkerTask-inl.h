@@ -0,0 +1,70 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/base/error/ErrorHandling.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline PriorityWorkerTask::PriorityWorkerTask(Priority priority) :
+		mStatus(STATUS_NEW),
+		mPriority(priority),
+		mDeadline(Time::MAX),
+		mDiscardWhenExpired(false)
+	{
+		// Nothing here
+	}
+
+	inline PriorityWorkerTask::~PriorityWorkerTask()
+	{
+		QSF_ASSERT(isFinished(), "QSF priority worker task destroyed while it's still scheduled or executing", QSF_REACT_NONE);
+	}
+
+	inline PriorityWorkerTask::Priority PriorityWorkerTask::getPriority() const
+	{
+		return mPriority;
+	}
+
+	inline void PriorityWorkerTask::setPriority(Priority priority)
+	{
+		mPriority = priority;
+	}
+
+	inline const Time& PriorityWorkerTask::getDeadline() const
+	{
+		return mDeadline;
+	}
+
+	inline void PriorityWorkerTask::setDeadline(const Time& deadline, bool discardWhenExpired)
+	{
+		mDeadline = deadline;
+		mDiscardWhenExpired = discardWhenExpired;
+	}
+
+	inline PriorityWorkerTask::Status PriorityWorkerTask::getStatus() const
+	{
+		return static_cast<Status>(mStatus.load(std::memory_order_acquire));
+	}
+
+	inline bool PriorityWorkerTask::isFinished() const
+	{
+		const Status status = getStatus();
+		return (STATUS_SCHEDULED != status && STATUS_EXECUTING != status);
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
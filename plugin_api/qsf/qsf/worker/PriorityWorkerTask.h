@@ -0,0 +1,180 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/time/Time.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class PriorityWorkerQueue;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Abstract task of a priority worker queue
+	*
+	*  @remarks
+	*    In contrast to "qsf::WorkerTask", tasks are intrusive: The priority worker queue only stores a pointer to the task,
+	*    the owner is responsible for keeping the instance alive until it's finished. Usually the task is a member of the
+	*    object requesting the work and is reused for each request, so there's neither an allocation nor reference counting.
+	*
+	*  @note
+	*    - Don't destroy or reschedule a task before it's finished, see "qsf::PriorityWorkerTask::isFinished()"
+	*/
+	class PriorityWorkerTask : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Friend classes                                        ]
+	//[-------------------------------------------------------]
+		friend PriorityWorkerQueue;
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		enum Priority
+		{
+			PRIORITY_CRITICAL = 0,	///< Work someone is waiting for right now, e.g. requested by the player
+			PRIORITY_HIGH,			///< Work which should be done soon
+			PRIORITY_NORMAL,		///< Default priority
+			PRIORITY_BACKGROUND,	///< Work without any latency requirements
+			_NUM_PRIORITIES
+		};
+
+		enum Status
+		{
+			STATUS_NEW,				///< Never scheduled
+			STATUS_SCHEDULED,		///< Waiting for execution inside a priority worker queue
+			STATUS_EXECUTING,		///< Currently executing
+			STATUS_DONE,			///< Executed
+			STATUS_EXPIRED			///< Not executed because the deadline was missed, see "qsf::PriorityWorkerTask::setDeadline()"
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] priority
+		*    Priority of the task
+		*/
+		inline explicit PriorityWorkerTask(Priority priority = PRIORITY_NORMAL);
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		inline virtual ~PriorityWorkerTask();
+
+		/**
+		*  @brief
+		*    Return the priority
+		*/
+		inline Priority getPriority() const;
+
+		/**
+		*  @brief
+		*    Set the priority, only has an effect the next time the task is scheduled
+		*/
+		inline void setPriority(Priority priority);
+
+		/**
+		*  @brief
+		*    Return the deadline, "qsf::Time::MAX" if there's none
+		*/
+		inline const Time& getDeadline() const;
+
+		/**
+		*  @brief
+		*    Set the deadline
+		*
+		*  @param[in] deadline
+		*    Point in time (in "qsf::Time::highResolutionNow()" time) the execution should have started at, "qsf::Time::MAX" for no deadline
+		*  @param[in] discardWhenExpired
+		*    If "true", the task is not executed at all when the deadline was missed and finishes with "qsf::PriorityWorkerTask::STATUS_EXPIRED",
+		*    useful for results which are worthless when they're late; if "false", a missed deadline is only counted in the queue statistics
+		*/
+		inline void setDeadline(const Time& deadline, bool discardWhenExpired = false);
+
+		/**
+		*  @brief
+		*    Return the status; is updated concurrently by the executing thread
+		*/
+		inline Status getStatus() const;
+
+		/**
+		*  @brief
+		*    Return whether or not the task is finished, meaning it's either new, done or expired
+		*/
+		inline bool isFinished() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Protected virtual qsf::PriorityWorkerTask methods     ]
+	//[-------------------------------------------------------]
+	protected:
+		/**
+		*  @brief
+		*    Execute the task; called by a worker thread
+		*/
+		virtual void executeImpl() = 0;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		std::atomic<uint32>	mStatus;				///< Current "qsf::PriorityWorkerTask::Status"
+		Priority			mPriority;
+		Time				mDeadline;
+		bool				mDiscardWhenExpired;
+		Time				mScheduleTime;			///< Point in time the task was scheduled at, for the queue statistics
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/PriorityWorkerTask-inl.h"
@@ -13,6 +13,7 @@
 #include <vector>
 #include <future>
 #include <functional>
+#include <cmath>
 
 
 //[-------------------------------------------------------]
@@ -32,6 +33,8 @@ namespace qsf
 	*  @note
 	*    - Meant for data-parallel use-cases
 	*    - Implementation from https://github.com/netromdk/threadpool
+	*    - Each task is a heap allocated "std::function" and each processing step starts "std::async" calls and collects "std::future" instances,
+	*      for new code prefer "qsf::WorkStealingThreadPool::parallelFor()" which doesn't allocate and doesn't need a hand-made split
 	*/
 	template <typename RetType> ///< Return type of tasks
 	class ThreadPool
@@ -0,0 +1,135 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <cstring>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	template <typename T, uint32 CAPACITY>
+	WorkStealingDeque<T, CAPACITY>::WorkStealingDeque() :
+		mTop(0),
+		mBottom(0),
+		mSlots(new Slot[CAPACITY])
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Work-stealing deque elements must be trivially copyable");
+		static_assert(0 == sizeof(T) % sizeof(uint64), "The size of work-stealing deque elements must be a multiple of 8 bytes");
+		static_assert(CAPACITY > 0 && 0 == (CAPACITY & (CAPACITY - 1)), "The work-stealing deque capacity must be a power of two");
+	}
+
+	template <typename T, uint32 CAPACITY>
+	WorkStealingDeque<T, CAPACITY>::~WorkStealingDeque()
+	{
+		// Nothing here
+	}
+
+	template <typename T, uint32 CAPACITY>
+	bool WorkStealingDeque<T, CAPACITY>::push(const T& element)
+	{
+		const int64 bottom = mBottom.load(std::memory_order_relaxed);
+		const int64 top = mTop.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64>(CAPACITY))
+		{
+			// Full
+			return false;
+		}
+
+		writeSlot(bottom, element);
+		std::atomic_thread_fence(std::memory_order_release);
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	template <typename T, uint32 CAPACITY>
+	bool WorkStealingDeque<T, CAPACITY>::pop(T& element)
+	{
+		const int64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		mBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64 top = mTop.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty, restore the bottom
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		readSlot(bottom, element);
+		if (top == bottom)
+		{
+			// Last element, race against thieves for it
+			const bool won = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	template <typename T, uint32 CAPACITY>
+	bool WorkStealingDeque<T, CAPACITY>::steal(T& element)
+	{
+		int64 top = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 bottom = mBottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			// Empty
+			return false;
+		}
+
+		// The slot might be overwritten concurrently in case the owner popped and pushed in the meantime, the compare-and-swap detects this
+		readSlot(top, element);
+		return mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	template <typename T, uint32 CAPACITY>
+	bool WorkStealingDeque<T, CAPACITY>::isEmpty() const
+	{
+		return (mTop.load(std::memory_order_relaxed) >= mBottom.load(std::memory_order_relaxed));
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	template <typename T, uint32 CAPACITY>
+	void WorkStealingDeque<T, CAPACITY>::writeSlot(int64 index, const T& element)
+	{
+		uint64 words[NUMBER_OF_WORDS];
+		memcpy(words, &element, sizeof(T));
+		Slot& slot = mSlots[index & INDEX_MASK];
+		for (uint32 i = 0; i < NUMBER_OF_WORDS; ++i)
+		{
+			slot.mWords[i].store(words[i], std::memory_order_relaxed);
+		}
+	}
+
+	template <typename T, uint32 CAPACITY>
+	void WorkStealingDeque<T, CAPACITY>::readSlot(int64 index, T& element) const
+	{
+		uint64 words[NUMBER_OF_WORDS];
+		const Slot& slot = mSlots[index & INDEX_MASK];
+		for (uint32 i = 0; i < NUMBER_OF_WORDS; ++i)
+		{
+			words[i] = slot.mWords[i].load(std::memory_order_relaxed);
+		}
+		memcpy(&element, words, sizeof(T));
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,149 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <type_traits>
+#include <atomic>
+#include <memory>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Lock-free work-stealing deque with fixed capacity
+	*
+	*  @remarks
+	*    Implementation of the Chase-Lev deque using the C++11 memory model mapping from
+	*    "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli; PPoPP 2013).
+	*    The owner thread pushes and pops at the bottom end without atomic read-modify-write operations in the common case,
+	*    any number of thief threads steal from the top end.
+	*
+	*    Elements are stored word by word using relaxed atomics, so a thief reading an element which is overwritten
+	*    at the same time is no data race; the result of such a read is discarded because its compare-and-swap fails.
+	*
+	*  @note
+	*    - "T" must be trivially copyable and its size must be a multiple of 8 bytes
+	*    - The capacity is fixed to avoid the buffer lifetime issues of growing lock-free deques, "push()" fails if the deque is full
+	*/
+	template <typename T, uint32 CAPACITY>
+	class WorkStealingDeque : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor
+		*/
+		WorkStealingDeque();
+
+		/**
+		*  @brief
+		*    Destructor
+		*/
+		~WorkStealingDeque();
+
+		/**
+		*  @brief
+		*    Push an element at the bottom end; must only be called by the owner thread
+		*
+		*  @return
+		*    "true" if all went fine, "false" if the deque is full
+		*/
+		bool push(const T& element);
+
+		/**
+		*  @brief
+		*    Pop the most recently pushed element from the bottom end; must only be called by the owner thread
+		*
+		*  @return
+		*    "true" if an element was popped, else "false"
+		*/
+		bool pop(T& element);
+
+		/**
+		*  @brief
+		*    Steal the oldest element from the top end; may be called by any thread
+		*
+		*  @return
+		*    "true" if an element was stolen, "false" if the deque was empty or another thread was faster
+		*/
+		bool steal(T& element);
+
+		/**
+		*  @brief
+		*    Return whether or not the deque looks empty; the result may already be outdated when it's returned
+		*/
+		bool isEmpty() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		static const uint32 NUMBER_OF_WORDS = sizeof(T) / sizeof(uint64);
+		static const int64  INDEX_MASK = static_cast<int64>(CAPACITY) - 1;
+
+		struct Slot
+		{
+			std::atomic<uint64> mWords[NUMBER_OF_WORDS];
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		void writeSlot(int64 index, const T& element);
+		void readSlot(int64 index, T& element) const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		// Top and bottom are written by different threads, keep them on different cache lines
+		std::atomic<int64>		mTop;
+		uint8					mPadding0[64 - sizeof(std::atomic<int64>)];
+		std::atomic<int64>		mBottom;
+		uint8					mPadding1[64 - sizeof(std::atomic<int64>)];
+		std::unique_ptr<Slot[]>	mSlots;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingDeque-inl.h"
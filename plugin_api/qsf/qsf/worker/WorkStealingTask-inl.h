@@ -0,0 +1,61 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <cstring>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline WorkStealingTask::WorkStealingTask() :
+		mInvoker(nullptr),
+		mAlignment(0)
+	{
+		// Nothing here
+	}
+
+	template <typename Function>
+	WorkStealingTask::WorkStealingTask(const Function& function) :
+		mInvoker(&WorkStealingTask::invoke<Function>)
+	{
+		static_assert(sizeof(Function) <= STORAGE_SIZE, "The function object is too large for a work-stealing task, capture by reference instead");
+		static_assert(std::alignment_of<Function>::value <= std::alignment_of<uint64>::value, "The function object needs a stronger alignment than a work-stealing task offers");
+		static_assert(std::is_trivially_copyable<Function>::value, "The function object of a work-stealing task must be trivially copyable");
+		memcpy(mStorage, &function, sizeof(Function));
+	}
+
+	inline bool WorkStealingTask::isValid() const
+	{
+		return (nullptr != mInvoker);
+	}
+
+	inline void WorkStealingTask::operator()() const
+	{
+		mInvoker(mStorage);
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	template <typename Function>
+	void WorkStealingTask::invoke(const void* storage)
+	{
+		(*static_cast<const Function*>(storage))();
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,122 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/platform/PlatformTypes.h"
+
+#include <type_traits>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Task of the work-stealing thread pool
+	*
+	*  @remarks
+	*    The task stores the function object to call inline, there's no heap allocation involved. In exchange, the function object
+	*    must be trivially copyable and fit into "qsf::WorkStealingTask::STORAGE_SIZE" bytes, which is the case for lambdas capturing
+	*    a few pointers, references and plain values. Capture larger state by reference and make sure it outlives the task.
+	*
+	*    The size of a task is exactly one cache line.
+	*/
+	class WorkStealingTask
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		static const uint32 STORAGE_SIZE = 56;	///< Maximum size in bytes of a function object stored inside a task
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Default constructor, creates an invalid task
+		*/
+		inline WorkStealingTask();
+
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] function
+		*    Function object to call, signature "void()"; is copied into the task
+		*/
+		template <typename Function>
+		explicit WorkStealingTask(const Function& function);
+
+		/**
+		*  @brief
+		*    Return whether or not the task holds a function object
+		*/
+		inline bool isValid() const;
+
+		/**
+		*  @brief
+		*    Call the function object; the task must be valid
+		*/
+		inline void operator()() const;
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		typedef void(*Invoker)(const void* storage);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		template <typename Function>
+		static void invoke(const void* storage);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		Invoker mInvoker;				///< Type erased call of the stored function object, null pointer for invalid tasks
+		union
+		{
+			uint64 mAlignment;			///< Only there to align the storage
+			uint8  mStorage[STORAGE_SIZE];
+		};
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingTask-inl.h"
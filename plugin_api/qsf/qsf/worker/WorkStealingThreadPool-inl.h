@@ -0,0 +1,267 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <algorithm>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline WorkStealingThreadPool::WorkStealingThreadPool(uint32 numberOfWorkerThreads) :
+		mInjectionQueue(INJECTION_QUEUE_CAPACITY),
+		mNumberOfQueuedTasks(0),
+		mNumberOfSleepingWorkers(0),
+		mShutdown(false)
+	{
+		if (isUninitialized(numberOfWorkerThreads))
+		{
+			const uint32 hardwareConcurrency = static_cast<uint32>(std::thread::hardware_concurrency());
+			numberOfWorkerThreads = (hardwareConcurrency > 1) ? (hardwareConcurrency - 1) : 1;
+		}
+
+		mWorkerDeques.reserve(numberOfWorkerThreads);
+		for (uint32 i = 0; i < numberOfWorkerThreads; ++i)
+		{
+			mWorkerDeques.emplace_back(new TaskDeque());
+		}
+
+		// Start the worker threads not before all deques are in place
+		mWorkerThreads.reserve(numberOfWorkerThreads);
+		for (uint32 i = 0; i < numberOfWorkerThreads; ++i)
+		{
+			mWorkerThreads.emplace_back(&WorkStealingThreadPool::workerThreadMain, this, i);
+		}
+	}
+
+	inline WorkStealingThreadPool::~WorkStealingThreadPool()
+	{
+		shutdown();
+	}
+
+	inline void WorkStealingThreadPool::shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> sleepLock(mSleepMutex);
+			mShutdown = true;
+		}
+		mSleepCondition.notify_all();
+
+		for (std::thread& workerThread : mWorkerThreads)
+		{
+			if (workerThread.joinable())
+			{
+				workerThread.join();
+			}
+		}
+	}
+
+	inline uint32 WorkStealingThreadPool::getNumberOfWorkerThreads() const
+	{
+		return static_cast<uint32>(mWorkerThreads.size());
+	}
+
+	inline bool WorkStealingThreadPool::isWorkerThread() const
+	{
+		return isInitialized(getWorkerIndexOfCallingThread());
+	}
+
+	inline void WorkStealingThreadPool::submit(const Task& task)
+	{
+		// Count the task before publishing it, else a thread taking it right away would decrement the counter below zero.
+		// Sequentially consistent counterpart to the sleeping worker check inside "qsf::WorkStealingThreadPool::workerThreadMain()":
+		// Either we see the sleeping worker here, or the worker sees the queued task before going to sleep
+		mNumberOfQueuedTasks.fetch_add(1);
+
+		const uint32 workerIndex = getWorkerIndexOfCallingThread();
+		const bool queued = isInitialized(workerIndex) ? mWorkerDeques[workerIndex]->push(task) : mInjectionQueue.tryPush(task);
+		if (!queued)
+		{
+			// Full, executing the task right away is always correct since nobody waits for a specific thread
+			mNumberOfQueuedTasks.fetch_sub(1);
+			task();
+			return;
+		}
+
+		if (mNumberOfSleepingWorkers.load() > 0)
+		{
+			std::lock_guard<std::mutex> sleepLock(mSleepMutex);
+			mSleepCondition.notify_one();
+		}
+	}
+
+	template <typename Function>
+	void WorkStealingThreadPool::submit(const Function& function)
+	{
+		submit(Task(function));
+	}
+
+	inline bool WorkStealingThreadPool::tryExecuteTask()
+	{
+		Task task;
+		if (tryGetTask(getWorkerIndexOfCallingThread(), task))
+		{
+			task();
+			return true;
+		}
+		return false;
+	}
+
+	inline void WorkStealingThreadPool::waitForCounter(const std::atomic<uint32>& counter)
+	{
+		while (counter.load() > 0)
+		{
+			if (!tryExecuteTask())
+			{
+				// The remaining work is currently being executed by other threads
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	template <typename Function>
+	void WorkStealingThreadPool::parallelFor(uint32 first, uint32 last, uint32 grainSize, const Function& function)
+	{
+		if (first >= last)
+		{
+			return;
+		}
+		grainSize = std::max<uint32>(grainSize, 1);
+
+		if (last - first <= grainSize || mWorkerThreads.empty())
+		{
+			// Not worth the overhead
+			function(first, last);
+		}
+		else
+		{
+			std::atomic<uint32> numberOfRemainingIndices(last - first);
+			executeRange(first, last, grainSize, function, numberOfRemainingIndices);
+			waitForCounter(numberOfRemainingIndices);
+		}
+	}
+
+	template <typename Result, typename MapFunction, typename ReduceFunction>
+	Result WorkStealingThreadPool::parallelReduce(uint32 first, uint32 last, uint32 grainSize, const Result& identity, const MapFunction& mapFunction, const ReduceFunction& reduceFunction)
+	{
+		if (first >= last)
+		{
+			return identity;
+		}
+		grainSize = std::max<uint32>(grainSize, 1);
+
+		// One result slot per subrange, each slot is written by exactly one thread
+		const uint32 numberOfSubranges = (last - first + grainSize - 1) / grainSize;
+		std::vector<Result> subrangeResults(numberOfSubranges, identity);
+		parallelFor(0, numberOfSubranges, 1, [&](uint32 firstSubrange, uint32 lastSubrange)
+		{
+			for (uint32 subrange = firstSubrange; subrange < lastSubrange; ++subrange)
+			{
+				const uint32 subrangeFirst = first + subrange * grainSize;
+				subrangeResults[subrange] = mapFunction(subrangeFirst, std::min(subrangeFirst + grainSize, last));
+			}
+		});
+
+		// Reduce in a fixed order for deterministic results
+		Result result = identity;
+		for (const Result& subrangeResult : subrangeResults)
+		{
+			result = reduceFunction(result, subrangeResult);
+		}
+		return result;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	inline void WorkStealingThreadPool::workerThreadMain(uint32 workerIndex)
+	{
+		getThreadLocalWorker() = std::make_pair(this, workerIndex);
+
+		while (!mShutdown.load(std::memory_order_relaxed))
+		{
+			Task task;
+			if (tryGetTask(workerIndex, task))
+			{
+				task();
+			}
+			else
+			{
+				std::unique_lock<std::mutex> sleepLock(mSleepMutex);
+				++mNumberOfSleepingWorkers;
+				mSleepCondition.wait(sleepLock, [this] { return (mShutdown.load() || mNumberOfQueuedTasks.load() > 0); });
+				--mNumberOfSleepingWorkers;
+			}
+		}
+
+		getThreadLocalWorker() = std::make_pair(nullptr, getUninitialized<uint32>());
+	}
+
+	inline bool WorkStealingThreadPool::tryGetTask(uint32 workerIndex, Task& task)
+	{
+		const bool isWorker = isInitialized(workerIndex);
+
+		// Own tasks first, their data is most likely still in the cache, then tasks from outside the pool
+		if ((isWorker && mWorkerDeques[workerIndex]->pop(task)) || mInjectionQueue.tryPop(task))
+		{
+			--mNumberOfQueuedTasks;
+			return true;
+		}
+
+		// Steal, starting with the neighbour deque so not all thieves hammer the same victim
+		const uint32 numberOfWorkerDeques = static_cast<uint32>(mWorkerDeques.size());
+		const uint32 firstVictim = isWorker ? (workerIndex + 1) : 0;
+		for (uint32 i = 0; i < numberOfWorkerDeques; ++i)
+		{
+			const uint32 victimIndex = (firstVictim + i) % numberOfWorkerDeques;
+			if (victimIndex != workerIndex && mWorkerDeques[victimIndex]->steal(task))
+			{
+				--mNumberOfQueuedTasks;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline uint32 WorkStealingThreadPool::getWorkerIndexOfCallingThread() const
+	{
+		const std::pair<const WorkStealingThreadPool*, uint32>& threadLocalWorker = getThreadLocalWorker();
+		return (threadLocalWorker.first == this) ? threadLocalWorker.second : getUninitialized<uint32>();
+	}
+
+	template <typename Function>
+	void WorkStealingThreadPool::executeRange(uint32 first, uint32 last, uint32 grainSize, const Function& function, std::atomic<uint32>& numberOfRemainingIndices)
+	{
+		// Split off the upper halves as tasks for other threads and keep the lower half, so the largest pieces are the first ones to get stolen
+		while (last - first > grainSize)
+		{
+			const uint32 middle = first + (last - first) / 2;
+			submit([this, middle, last, grainSize, &function, &numberOfRemainingIndices] { executeRange(middle, last, grainSize, function, numberOfRemainingIndices); });
+			last = middle;
+		}
+
+		function(first, last);
+		numberOfRemainingIndices.fetch_sub(last - first);
+	}
+
+	inline std::pair<const WorkStealingThreadPool*, uint32>& WorkStealingThreadPool::getThreadLocalWorker()
+	{
+		static thread_local std::pair<const WorkStealingThreadPool*, uint32> threadLocalWorker(nullptr, getUninitialized<uint32>());
+		return threadLocalWorker;
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
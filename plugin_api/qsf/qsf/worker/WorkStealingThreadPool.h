@@ -0,0 +1,270 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingTask.h"
+#include "qsf/worker/WorkStealingDeque.h"
+#include "qsf/worker/BoundedMpmcQueue.h"
+#include "qsf/base/GetUninitialized.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Lock-free work-stealing thread pool
+	*
+	*  @remarks
+	*    Each worker thread owns a lock-free Chase-Lev deque. Tasks submitted from inside a worker thread are pushed onto the worker's own deque
+	*    and popped in LIFO order for cache locality, idle workers steal the oldest tasks of other workers in FIFO order.
+	*    Tasks submitted from outside the pool (e.g. the main thread) go into a lock-free bounded MPMC injection queue.
+	*    Tasks are stored inline (see "qsf::WorkStealingTask"), so submitting a task doesn't allocate memory.
+	*
+	*    Threads waiting for a batch of tasks (see "qsf::WorkStealingThreadPool::waitForCounter()") don't block but help
+	*    executing pending tasks, so the calling thread is always an additional worker and nested waits can't deadlock.
+	*
+	*    Data-parallel loops should use "qsf::WorkStealingThreadPool::parallelFor()" and "qsf::WorkStealingThreadPool::parallelReduce()"
+	*    instead of splitting the work by hand, the range is split recursively so idle threads always find work to steal.
+	*
+	*  @note
+	*    - Meant for fine grained task-parallel and data-parallel use-cases, e.g. the parallel jobs of a "qsf::jobs::JobGraph"
+	*    - The pool is not part of the worker system. Each plugin using it owns its instance, creates it inside "qsf::Plugin::onStartup()" and shuts it
+	*      down inside "qsf::Plugin::onShutdown()"; never keep a pool in a static variable, joining the worker threads while the module is unloaded
+	*      happens under the loader lock of the operating system and deadlocks
+	*    - Tasks must not throw exceptions
+	*    - If a deque or the injection queue is full, the task is executed directly on the submitting thread
+	*/
+	class WorkStealingThreadPool : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		typedef WorkStealingTask Task;
+
+		static const uint32 WORKER_DEQUE_CAPACITY   = 1024;	///< Maximum number of queued tasks per worker thread
+		static const uint32 INJECTION_QUEUE_CAPACITY = 4096;	///< Maximum number of queued tasks submitted from outside the pool
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @param[in] numberOfWorkerThreads
+		*    Number of worker threads to create, "qsf::getUninitialized<uint32>()" to use one less than there are hardware threads (the calling thread helps as well)
+		*/
+		inline explicit WorkStealingThreadPool(uint32 numberOfWorkerThreads = getUninitialized<uint32>());
+
+		/**
+		*  @brief
+		*    Destructor
+		*
+		*  @note
+		*    - Calls "qsf::WorkStealingThreadPool::shutdown()"
+		*/
+		inline ~WorkStealingThreadPool();
+
+		/**
+		*  @brief
+		*    Stop and join the worker threads
+		*
+		*  @remarks
+		*    Usage inside a plugin owning the pool:
+		*    @code
+		*      bool MyPlugin::onStartup()
+		*      {
+		*        mThreadPool.reset(new qsf::WorkStealingThreadPool());
+		*        ...
+		*      }
+		*
+		*      void MyPlugin::onShutdown()
+		*      {
+		*        ... // Destroy everything using the pool first
+		*        mThreadPool->shutdown();
+		*        mThreadPool.reset();
+		*      }
+		*    @endcode
+		*
+		*  @note
+		*    - Waits until all worker threads are finished, tasks not started until then are only executed by threads waiting for them
+		*    - Must not be called by a worker thread or while another thread is using the pool, calling it more than once is fine
+		*/
+		inline void shutdown();
+
+		/**
+		*  @brief
+		*    Return the number of worker threads, the calling thread is not included
+		*/
+		inline uint32 getNumberOfWorkerThreads() const;
+
+		/**
+		*  @brief
+		*    Return whether or not the calling thread is one of the worker threads of this pool
+		*/
+		inline bool isWorkerThread() const;
+
+		/**
+		*  @brief
+		*    Submit a task for asynchronous execution
+		*
+		*  @param[in] task
+		*    Task to execute, must be valid
+		*/
+		inline void submit(const Task& task);
+
+		/**
+		*  @brief
+		*    Submit a function object for asynchronous execution
+		*
+		*  @param[in] function
+		*    Function object to call, signature "void()", see "qsf::WorkStealingTask" for the requirements
+		*/
+		template <typename Function>
+		void submit(const Function& function);
+
+		/**
+		*  @brief
+		*    Try to execute a single pending task on the calling thread
+		*
+		*  @return
+		*    "true" if a task was executed, else "false"
+		*/
+		inline bool tryExecuteTask();
+
+		/**
+		*  @brief
+		*    Help executing pending tasks until the given counter reached zero
+		*
+		*  @param[in] counter
+		*    Counter of outstanding work, usually decremented by the tasks themselves
+		*/
+		inline void waitForCounter(const std::atomic<uint32>& counter);
+
+		/**
+		*  @brief
+		*    Call a function for all subranges of a range in parallel, returns when all calls are finished
+		*
+		*  @param[in] first
+		*    First index of the range
+		*  @param[in] last
+		*    Index behind the last index of the range
+		*  @param[in] grainSize
+		*    Maximum size of a subrange, choose it so the work per subrange is clearly above the task overhead (a few microseconds)
+		*  @param[in] function
+		*    Function object to call, signature "void(uint32 subrangeFirst, uint32 subrangeLast)"; is called concurrently
+		*/
+		template <typename Function>
+		void parallelFor(uint32 first, uint32 last, uint32 grainSize, const Function& function);
+
+		/**
+		*  @brief
+		*    Map subranges of a range to results in parallel and reduce them to a single result
+		*
+		*  @param[in] first
+		*    First index of the range
+		*  @param[in] last
+		*    Index behind the last index of the range
+		*  @param[in] grainSize
+		*    Size of a subrange
+		*  @param[in] identity
+		*    Identity element of the reduction, also the result for empty ranges
+		*  @param[in] mapFunction
+		*    Function object to call, signature "Result(uint32 subrangeFirst, uint32 subrangeLast)"; is called concurrently
+		*  @param[in] reduceFunction
+		*    Function object combining two results, signature "Result(const Result&, const Result&)"
+		*
+		*  @return
+		*    The reduced result
+		*
+		*  @note
+		*    - The subranges are determined by the grain size only and reduced in ascending order on the calling thread,
+		*      so the result is deterministic even for non-associative operations like floating point additions
+		*/
+		template <typename Result, typename MapFunction, typename ReduceFunction>
+		Result parallelReduce(uint32 first, uint32 last, uint32 grainSize, const Result& identity, const MapFunction& mapFunction, const ReduceFunction& reduceFunction);
+
+
+	//[-------------------------------------------------------]
+	//[ Private definitions                                   ]
+	//[-------------------------------------------------------]
+	private:
+		typedef WorkStealingDeque<Task, WORKER_DEQUE_CAPACITY> TaskDeque;
+		typedef std::vector<std::unique_ptr<TaskDeque>>		   TaskDeques;
+
+
+	//[-------------------------------------------------------]
+	//[ Private methods                                       ]
+	//[-------------------------------------------------------]
+	private:
+		inline void workerThreadMain(uint32 workerIndex);
+		inline bool tryGetTask(uint32 workerIndex, Task& task);
+		inline uint32 getWorkerIndexOfCallingThread() const;
+
+		template <typename Function>
+		void executeRange(uint32 first, uint32 last, uint32 grainSize, const Function& function, std::atomic<uint32>& numberOfRemainingIndices);
+
+		/**
+		*  @brief
+		*    Return the per thread slot holding the pool the calling thread is a worker of and its worker index
+		*/
+		inline static std::pair<const WorkStealingThreadPool*, uint32>& getThreadLocalWorker();
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		TaskDeques						 mWorkerDeques;				///< One deque per worker thread
+		BoundedMpmcQueue<Task>			 mInjectionQueue;			///< Tasks submitted from outside the pool
+		std::vector<std::thread>		 mWorkerThreads;
+		std::atomic<uint32>				 mNumberOfQueuedTasks;		///< Number of submitted tasks which were not yet picked up by a thread
+		std::atomic<uint32>				 mNumberOfSleepingWorkers;	///< Submitting threads only need to wake up workers if there are sleeping ones
+		std::mutex						 mSleepMutex;
+		std::condition_variable			 mSleepCondition;
+		std::atomic<bool>				 mShutdown;
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingThreadPool-inl.h"
@@ -0,0 +1,93 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/time/HighResolutionStopwatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	inline WorkStealingThreadPoolBenchmark::Result WorkStealingThreadPoolBenchmark::run(ThreadPool<void>& threadPool, WorkStealingThreadPool& workStealingThreadPool, uint32 numberOfItems, uint32 grainSize, uint32 numberOfRepetitions)
+	{
+		grainSize = std::max<uint32>(grainSize, 1);
+
+		std::vector<float> input(numberOfItems);
+		for (uint32 i = 0; i < numberOfItems; ++i)
+		{
+			input[i] = static_cast<float>(i % 1000) * 0.01f;
+		}
+		std::vector<float> threadPoolOutput(numberOfItems, 0.0f);
+		std::vector<float> workStealingThreadPoolOutput(numberOfItems, 0.0f);
+
+		Result result;
+		result.mNumberOfTasks = (numberOfItems + grainSize - 1) / grainSize;
+
+		{ // Current pool, one task per split
+			HighResolutionStopwatch stopwatch;
+			for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+			{
+				size_t splitCount = grainSize;
+				const size_t threadCount = threadPool.getThreadCountAndSplitCount(numberOfItems, splitCount);
+				for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+				{
+					const uint32 first = static_cast<uint32>(threadIndex * splitCount);
+					const uint32 last = (threadIndex + 1 == threadCount) ? numberOfItems : static_cast<uint32>((threadIndex + 1) * splitCount);
+					threadPool.queueTask([&input, &threadPoolOutput, first, last] { processItems(input.data(), threadPoolOutput.data(), first, last); });
+				}
+				threadPool.process();
+			}
+			result.mThreadPoolTime = stopwatch.getElapsed();
+		}
+
+		{ // Work-stealing pool
+			HighResolutionStopwatch stopwatch;
+			for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+			{
+				workStealingThreadPool.parallelFor(0, numberOfItems, grainSize, [&input, &workStealingThreadPoolOutput](uint32 first, uint32 last)
+				{
+					processItems(input.data(), workStealingThreadPoolOutput.data(), first, last);
+				});
+			}
+			result.mWorkStealingThreadPoolTime = stopwatch.getElapsed();
+		}
+
+		result.mResultsMatch = (threadPoolOutput == workStealingThreadPoolOutput);
+		return result;
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	inline void WorkStealingThreadPoolBenchmark::processItems(const float* input, float* output, uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+		{
+			float value = input[i];
+			for (int iteration = 0; iteration < 32; ++iteration)
+			{
+				value = std::sqrt(value * value + 1.0f) * 0.5f;
+			}
+			output[i] = value;
+		}
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
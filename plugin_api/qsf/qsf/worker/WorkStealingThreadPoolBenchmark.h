@@ -0,0 +1,106 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/worker/ThreadPool.h"
+#include "qsf/worker/WorkStealingThreadPool.h"
+#include "qsf/time/Time.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Microbenchmark of "qsf::WorkStealingThreadPool::parallelFor()" against "qsf::ThreadPool" for a data-parallel loop
+	*
+	*  @remarks
+	*    Both pools process the same items with the same per item work. "qsf::ThreadPool" is driven the way data-parallel engine code uses it:
+	*    one queued task per split from "qsf::ThreadPool::getThreadCountAndSplitCount()", then a blocking "qsf::ThreadPool::process()".
+	*    Usage, e.g. from a debug command of a plugin:
+	*    @code
+	*      const qsf::WorkStealingThreadPoolBenchmark::Result result = qsf::WorkStealingThreadPoolBenchmark::run(QSF_WORKER.getDataParallelThreadPool(), *mThreadPool, 100000, 1000, 100);
+	*      QSF_LOG_PRINTS(INFO, "ThreadPool: " << result.mThreadPoolTime.getMilliseconds() << " ms, work-stealing: " << result.mWorkStealingThreadPoolTime.getMilliseconds() << " ms");
+	*    @endcode
+	*/
+	class WorkStealingThreadPoolBenchmark
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		struct Result
+		{
+			Time   mThreadPoolTime;				///< Time needed by "qsf::ThreadPool" for all repetitions
+			Time   mWorkStealingThreadPoolTime;	///< Time needed by "qsf::WorkStealingThreadPool::parallelFor()" for all repetitions
+			uint32 mNumberOfTasks;				///< Number of tasks submitted to the work-stealing pool per repetition, the other pool gets one per split
+			bool   mResultsMatch;				///< "true" if both pools computed the same output, else "false"
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Public static methods                                 ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Run the benchmark
+		*
+		*  @param[in] threadPool
+		*    Thread pool to compare against, usually "qsf::WorkerSystem::getDataParallelThreadPool()"
+		*  @param[in] workStealingThreadPool
+		*    Work-stealing thread pool to measure
+		*  @param[in] numberOfItems
+		*    Number of items processed per repetition
+		*  @param[in] grainSize
+		*    Number of items per task, used as split count for "qsf::ThreadPool" as well
+		*  @param[in] numberOfRepetitions
+		*    Number of repetitions per pool
+		*
+		*  @return
+		*    The measured times
+		*/
+		inline static Result run(ThreadPool<void>& threadPool, WorkStealingThreadPool& workStealingThreadPool, uint32 numberOfItems, uint32 grainSize, uint32 numberOfRepetitions);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		/**
+		*  @brief
+		*    Per item work, a few hundred nanoseconds like a typical component update
+		*/
+		inline static void processItems(const float* input, float* output, uint32 first, uint32 last);
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkStealingThreadPoolBenchmark-inl.h"
@@ -0,0 +1,143 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	inline WorkerQueueStatistics::WorkerQueueStatistics() :
+		mQueueDepth(0)
+	{
+		reset();
+	}
+
+	inline WorkerQueueStatistics::~WorkerQueueStatistics()
+	{
+		// Nothing here
+	}
+
+	inline void WorkerQueueStatistics::reset()
+	{
+		mPeakQueueDepth = mQueueDepth.load();
+		mNumberOfScheduledTasks = 0;
+		mNumberOfDequeuedTasks = 0;
+		mNumberOfExecutedTasks = 0;
+		mNumberOfMissedDeadlines = 0;
+		mNumberOfExpiredTasks = 0;
+		mTotalWaitTime = 0;
+		mPeakWaitTime = 0;
+		mTotalRunTime = 0;
+		mPeakRunTime = 0;
+	}
+
+	inline uint32 WorkerQueueStatistics::getQueueDepth() const
+	{
+		return mQueueDepth.load(std::memory_order_relaxed);
+	}
+
+	inline uint32 WorkerQueueStatistics::getPeakQueueDepth() const
+	{
+		return mPeakQueueDepth.load(std::memory_order_relaxed);
+	}
+
+	inline uint32 WorkerQueueStatistics::getNumberOfScheduledTasks() const
+	{
+		return mNumberOfScheduledTasks.load(std::memory_order_relaxed);
+	}
+
+	inline uint32 WorkerQueueStatistics::getNumberOfExecutedTasks() const
+	{
+		return mNumberOfExecutedTasks.load(std::memory_order_relaxed);
+	}
+
+	inline uint32 WorkerQueueStatistics::getNumberOfMissedDeadlines() const
+	{
+		return mNumberOfMissedDeadlines.load(std::memory_order_relaxed);
+	}
+
+	inline uint32 WorkerQueueStatistics::getNumberOfExpiredTasks() const
+	{
+		return mNumberOfExpiredTasks.load(std::memory_order_relaxed);
+	}
+
+	inline Time WorkerQueueStatistics::getAverageWaitTime() const
+	{
+		const uint32 numberOfDequeuedTasks = mNumberOfDequeuedTasks.load(std::memory_order_relaxed);
+		return (numberOfDequeuedTasks > 0) ? Time::fromMicroseconds(mTotalWaitTime.load(std::memory_order_relaxed) / numberOfDequeuedTasks) : Time::ZERO;
+	}
+
+	inline Time WorkerQueueStatistics::getPeakWaitTime() const
+	{
+		return Time::fromMicroseconds(mPeakWaitTime.load(std::memory_order_relaxed));
+	}
+
+	inline Time WorkerQueueStatistics::getAverageRunTime() const
+	{
+		const uint32 numberOfExecutedTasks = mNumberOfExecutedTasks.load(std::memory_order_relaxed);
+		return (numberOfExecutedTasks > 0) ? Time::fromMicroseconds(mTotalRunTime.load(std::memory_order_relaxed) / numberOfExecutedTasks) : Time::ZERO;
+	}
+
+	inline Time WorkerQueueStatistics::getPeakRunTime() const
+	{
+		return Time::fromMicroseconds(mPeakRunTime.load(std::memory_order_relaxed));
+	}
+
+	inline Time WorkerQueueStatistics::getTotalRunTime() const
+	{
+		return Time::fromMicroseconds(mTotalRunTime.load(std::memory_order_relaxed));
+	}
+
+	inline void WorkerQueueStatistics::onTaskScheduled()
+	{
+		mNumberOfScheduledTasks.fetch_add(1, std::memory_order_relaxed);
+		updatePeak(mPeakQueueDepth, mQueueDepth.fetch_add(1, std::memory_order_relaxed) + 1);
+	}
+
+	inline void WorkerQueueStatistics::onTaskDequeued(const Time& waitTime, bool deadlineMissed, bool expired)
+	{
+		mQueueDepth.fetch_sub(1, std::memory_order_relaxed);
+		mNumberOfDequeuedTasks.fetch_add(1, std::memory_order_relaxed);
+		mTotalWaitTime.fetch_add(waitTime.getMicroseconds(), std::memory_order_relaxed);
+		updatePeak(mPeakWaitTime, waitTime.getMicroseconds());
+		if (deadlineMissed)
+		{
+			mNumberOfMissedDeadlines.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (expired)
+		{
+			mNumberOfExpiredTasks.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	inline void WorkerQueueStatistics::onTaskExecuted(const Time& runTime)
+	{
+		mNumberOfExecutedTasks.fetch_add(1, std::memory_order_relaxed);
+		mTotalRunTime.fetch_add(runTime.getMicroseconds(), std::memory_order_relaxed);
+		updatePeak(mPeakRunTime, runTime.getMicroseconds());
+	}
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	template <typename T>
+	void WorkerQueueStatistics::updatePeak(std::atomic<T>& peak, T value)
+	{
+		T currentPeak = peak.load(std::memory_order_relaxed);
+		while (value > currentPeak && !peak.compare_exchange_weak(currentPeak, value, std::memory_order_relaxed))
+		{
+			// "currentPeak" was updated by the failed compare-and-swap, try again
+		}
+	}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
@@ -0,0 +1,123 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf/time/Time.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+
+
+	//[-------------------------------------------------------]
+	//[ Classes                                               ]
+	//[-------------------------------------------------------]
+	/**
+	*  @brief
+	*    Statistics of a priority worker queue
+	*
+	*  @remarks
+	*    All values are updated lock-free by the threads scheduling and executing tasks, so reading several values
+	*    doesn't give a consistent snapshot, but each single value is exact.
+	*/
+	class WorkerQueueStatistics : public boost::noncopyable
+	{
+
+
+	//[-------------------------------------------------------]
+	//[ Public methods                                        ]
+	//[-------------------------------------------------------]
+	public:
+		inline WorkerQueueStatistics();
+		inline ~WorkerQueueStatistics();
+
+		/**
+		*  @brief
+		*    Reset all values except the current queue depth
+		*/
+		inline void reset();
+
+		//[-------------------------------------------------------]
+		//[ Queue depth                                           ]
+		//[-------------------------------------------------------]
+		inline uint32 getQueueDepth() const;
+		inline uint32 getPeakQueueDepth() const;
+
+		//[-------------------------------------------------------]
+		//[ Counters                                              ]
+		//[-------------------------------------------------------]
+		inline uint32 getNumberOfScheduledTasks() const;
+		inline uint32 getNumberOfExecutedTasks() const;
+		inline uint32 getNumberOfMissedDeadlines() const;	///< Including the expired tasks
+		inline uint32 getNumberOfExpiredTasks() const;		///< Tasks not executed because they missed their deadline
+
+		//[-------------------------------------------------------]
+		//[ Times                                                 ]
+		//[-------------------------------------------------------]
+		inline Time getAverageWaitTime() const;	///< Time between scheduling and the start of the execution
+		inline Time getPeakWaitTime() const;
+		inline Time getAverageRunTime() const;
+		inline Time getPeakRunTime() const;
+		inline Time getTotalRunTime() const;
+
+		//[-------------------------------------------------------]
+		//[ Internal, used by "qsf::PriorityWorkerQueue"          ]
+		//[-------------------------------------------------------]
+		inline void onTaskScheduled();
+		inline void onTaskDequeued(const Time& waitTime, bool deadlineMissed, bool expired);
+		inline void onTaskExecuted(const Time& runTime);
+
+
+	//[-------------------------------------------------------]
+	//[ Private static methods                                ]
+	//[-------------------------------------------------------]
+	private:
+		template <typename T>
+		static void updatePeak(std::atomic<T>& peak, T value);
+
+
+	//[-------------------------------------------------------]
+	//[ Private data                                          ]
+	//[-------------------------------------------------------]
+	private:
+		std::atomic<uint32> mQueueDepth;
+		std::atomic<uint32> mPeakQueueDepth;
+		std::atomic<uint32> mNumberOfScheduledTasks;
+		std::atomic<uint32> mNumberOfDequeuedTasks;		///< Executed and expired tasks, used for the average wait time
+		std::atomic<uint32> mNumberOfExecutedTasks;
+		std::atomic<uint32> mNumberOfMissedDeadlines;
+		std::atomic<uint32> mNumberOfExpiredTasks;
+		std::atomic<int64>  mTotalWaitTime;				///< In microseconds
+		std::atomic<int64>  mPeakWaitTime;				///< In microseconds
+		std::atomic<int64>  mTotalRunTime;				///< In microseconds
+		std::atomic<int64>  mPeakRunTime;				///< In microseconds
+
+
+	};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf/worker/WorkerQueueStatistics-inl.h"
@@ -0,0 +1,53 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+namespace qsf
+{
+	namespace ai
+	{
+		template <typename SearchState>
+		std::unique_ptr<AStarSearchArena<SearchState>> AStarSearchArena<SearchState>::acquire()
+		{
+			ArenaCache& cache = getThreadLocalCache();
+			if (cache.empty())
+				return std::unique_ptr<AStarSearchArena>(new AStarSearchArena());
+
+			std::unique_ptr<AStarSearchArena> arena(std::move(cache.back()));
+			cache.pop_back();
+			return arena;
+		}
+
+		template <typename SearchState>
+		void AStarSearchArena<SearchState>::release(std::unique_ptr<AStarSearchArena> arena)
+		{
+			if (!arena)
+				return;
+
+			ArenaCache& cache = getThreadLocalCache();
+			if (cache.size() < MAX_CACHED_ARENAS_PER_THREAD)
+			{
+				arena->clear();
+				cache.push_back(std::move(arena));
+			}
+		}
+
+		template <typename SearchState>
+		void AStarSearchArena<SearchState>::clear()
+		{
+			mOpenList.clear();
+			mFollowUps.clear();
+		}
+
+		template <typename SearchState>
+		typename AStarSearchArena<SearchState>::ArenaCache& AStarSearchArena<SearchState>::getThreadLocalCache()
+		{
+			static thread_local ArenaCache cache;
+			return cache;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/algorithm/WeightedState.h"
+#include "qsf_ai/algorithm/IndexedDaryHeap.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace qsf
+{
+	namespace ai
+	{
+		/** Reusable memory for an IndexedAStar search, consisting of the open list and the buffer for expanding search states.
+		* Searches are executed incrementally and several searches may be active on one thread, so each search owns an arena exclusively.
+		* Arenas are acquired from and released to a small per thread cache, so back to back searches on a thread don't allocate.
+		* An arena may be released on another thread than it was acquired on, e.g. when a search is destroyed by another thread.
+		*/
+		template <typename SearchState>
+		class AStarSearchArena : public boost::noncopyable
+		{
+		public:
+			typedef WeightedState<SearchState> WeightedSearchState;
+			typedef IndexedDaryHeap<WeightedSearchState, SearchStateCostLess<SearchState>> OpenList; // keyed by search state index
+
+			// Upper limit of idle arenas kept per thread, more are destroyed on release
+			static const std::size_t MAX_CACHED_ARENAS_PER_THREAD = 8;
+
+			// Returns a cleared arena from the cache of the calling thread or a new one if the cache is empty
+			static std::unique_ptr<AStarSearchArena> acquire();
+			// Clears the arena and puts it back into the cache of the calling thread
+			static void release(std::unique_ptr<AStarSearchArena> arena);
+
+			void clear();
+
+			OpenList mOpenList;
+			std::vector<WeightedSearchState> mFollowUps; // Temporary buffer for expanding a single search state
+
+		private:
+			typedef std::vector<std::unique_ptr<AStarSearchArena>> ArenaCache;
+
+			static ArenaCache& getThreadLocalCache();
+		};
+	}
+}
+
+#include "qsf_ai/algorithm/AStarSearchArena-inl.h"
@@ -0,0 +1,198 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/algorithm/OperationIndicator.h"
+
+#include <qsf/base/error/ErrorHandling.h>
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+
+namespace qsf
+{
+	namespace ai
+	{
+		template <typename SearchMechanics>
+		IndexedAStar<SearchMechanics>::IndexedAStar(SearchMechanics& mechanics) :
+			mSearchMechanics(mechanics),
+			mArena(SearchArena::acquire()),
+			mGoalFound(nullptr),
+			mHadSearchStep(false),
+			mUsesLateStarts(false)
+		{}
+
+		template <typename SearchMechanics>
+		IndexedAStar<SearchMechanics>::~IndexedAStar()
+		{
+			SearchArena::release(std::move(mArena));
+		}
+
+		template <typename SearchMechanics>
+		bool IndexedAStar<SearchMechanics>::isSuccess() const
+		{
+			return mGoalFound != nullptr;
+		}
+
+		template <typename SearchMechanics>
+		bool IndexedAStar<SearchMechanics>::isFailed() const
+		{
+			return mGoalFound == nullptr && mArena->mOpenList.empty();
+		}
+
+		template <typename SearchMechanics>
+		void IndexedAStar<SearchMechanics>::failSearch()
+		{
+			mGoalFound = nullptr;
+			mArena->mOpenList.clear(); // keeps the memory for the next search using the arena
+		}
+
+		template <typename SearchMechanics>
+		bool IndexedAStar<SearchMechanics>::isOpenListEmpty() const
+		{
+			return mArena->mOpenList.empty();
+		}
+
+		template <typename SearchMechanics>
+		const WeightedState<typename SearchMechanics::SearchState>* IndexedAStar<SearchMechanics>::tryPeakOpenList() const
+		{
+			if (mArena->mOpenList.empty())
+				return nullptr;
+
+			return &mArena->mOpenList.top();
+		}
+
+		template <typename SearchMechanics>
+		const typename SearchMechanics::SearchState& IndexedAStar<SearchMechanics>::getGoalFound() const
+		{
+			QSF_CHECK(mGoalFound, "Accessing nullpointer for goal state reached",
+				QSF_REACT_THROW);
+
+			return *mGoalFound;
+		}
+
+		template <typename SearchMechanics>
+		void IndexedAStar<SearchMechanics>::clearGoalFound()
+		{
+			mGoalFound = nullptr;
+		}
+
+		template <typename SearchMechanics>
+		bool IndexedAStar<SearchMechanics>::addStart(std::size_t newStartIndex, typename SearchState::Cost costsToStart)
+		{
+			SearchState& newStart = mSearchMechanics.getState(newStartIndex);
+
+			// Detect usage of late start feature
+			if (mHadSearchStep)
+				mUsesLateStarts = true;
+
+			const operation::Indicator necessaryReaction = newStart.onPathFound(boost::optional<std::size_t>(), costsToStart, mUsesLateStarts);
+			switch (necessaryReaction)
+			{
+			case operation::NO_OP:
+				return false;
+			case operation::ESTIMATE_AND_SCHEDULE:
+				newStart.setEstimatedCostsToTarget(mSearchMechanics.estimateCostsToGoal(newStart));
+				// fall through to EXPAND by design
+			case operation::SCHEDULE:
+				schedule(newStart);
+				return true;
+			default:
+				QSF_ERROR("unexpected operation indicator " << necessaryReaction, QSF_REACT_THROW);
+			}
+		}
+
+		template <typename SearchMechanics>
+		void IndexedAStar<SearchMechanics>::searchStep()
+		{
+			OpenList& openList = mArena->mOpenList;
+			if (openList.empty())
+				return;
+
+			mHadSearchStep = true;
+			SearchState& current = *openList.top().mState;
+			openList.pop();
+
+			if (mSearchMechanics.isGoal(current))
+			{
+				mGoalFound = &current;
+				return;
+			}
+
+			if (current.isExpanded())
+				return; // already expanded before
+
+			std::vector<WeightedSearchState>& followUps = mArena->mFollowUps;
+			followUps.clear();
+			mSearchMechanics.expand(current, followUps);
+
+			const std::size_t currentStateId = mSearchMechanics.getIndex(current);
+
+			for (std::size_t index = 0; index < followUps.size(); ++index)
+			{
+				const WeightedSearchState& next = followUps[index];
+				SearchState* nextState = next.mState;
+				QSF_CHECK(nextState, "found nullptr as search state", QSF_REACT_THROW);
+
+				const operation::Indicator reaction = nextState->onPathFound(currentStateId, next.mCosts, mUsesLateStarts);
+
+				switch (reaction)
+				{
+				case operation::NO_OP:
+					continue;
+				case operation::ESTIMATE_AND_SCHEDULE:
+					nextState->setEstimatedCostsToTarget(mSearchMechanics.estimateCostsToGoal(*nextState));
+					// fall through to expand by design
+				case operation::SCHEDULE:
+					schedule(*nextState);
+					break;
+				default:
+					QSF_ERROR("unexpected operation indicator " << reaction, QSF_REACT_THROW);
+				}
+			}
+
+			current.setExpanded();
+		}
+
+		template <typename SearchMechanics>
+		void IndexedAStar<SearchMechanics>::execute()
+		{
+			while (!isSuccess() && !isFailed())
+				searchStep();
+		}
+
+		template <typename SearchMechanics>
+		void IndexedAStar<SearchMechanics>::writePathFound(const SearchState& goal, std::vector<const SearchState*>& path) const
+		{
+			if (!goal.wasReached())
+				return;
+
+			const SearchState* current = &goal;
+			while (current)
+			{
+				path.push_back(current);
+				if (current->getPredecessorId())
+					current = &mSearchMechanics.getState(*current->getPredecessorId());
+				else
+					current = nullptr;
+			}
+
+			std::reverse(path.begin(), path.end());
+		}
+
+		template <typename SearchMechanics>
+		void IndexedAStar<SearchMechanics>::schedule(SearchState& state)
+		{
+			mArena->mOpenList.pushOrUpdate(mSearchMechanics.getIndex(state), WeightedSearchState(&state, state.getTotalCosts()));
+		}
+	}
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/algorithm/WeightedState.h"
+#include "qsf_ai/algorithm/SearchMechanics.h"
+#include "qsf_ai/algorithm/AStarSearchArena.h"
+
+#include <memory>
+#include <vector>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		/** A* implementation with the same interface and search semantics as AStar, but with an allocation free open list.
+		* The open list is an indexed heap keyed by the search state index, so finding a cheaper path to a scheduled state decreases its key instead of adding a duplicate.
+		* The open list and the expansion buffer are taken from a per thread arena cache, so back to back searches don't allocate once the arenas have grown.
+		* AStar itself is kept as it is because the engine embeds it by value inside its path search implementations.
+		* Use this one for searches owned by your own code, see TrafficLanePathSearchBenchmark for a comparison of both.
+		*/
+		template <typename SearchMechanics>
+		class IndexedAStar
+		{
+		public:
+			typedef typename SearchMechanics::SearchState SearchState;
+			typedef WeightedState<SearchState> WeightedSearchState;
+			typedef AStarSearchArena<SearchState> SearchArena;
+			typedef typename SearchArena::OpenList OpenList;
+
+			IndexedAStar(SearchMechanics& mechanics);
+			~IndexedAStar();
+
+			bool isSuccess() const;
+			bool isFailed() const;
+			void failSearch();
+
+			// Returns true if there is no search state on the open list
+			bool isOpenListEmpty() const;
+			const WeightedSearchState* tryPeakOpenList() const; // returns the top of the open list if it is not empty otherwise nullptr
+
+			// Can be called at any time adding an alternative start even during a search, see AStar::addStart
+			bool addStart(std::size_t newStartIndex, typename SearchState::Cost costsToStart);
+
+			// executes one search step by expanding the node on top of the open list
+			// does nothing if the open list is empty
+			void searchStep();
+			// searches until the search is failed or succeeded
+			void execute();
+
+			// Returns the found goal state and throws an exception if no goal was found yet.
+			const SearchState& getGoalFound() const;
+
+			// Sets the goal found to null, see AStar::clearGoalFound
+			void clearGoalFound();
+
+			// Writes the path leading up to a state as a chain of connected search states from the closest start state, see AStar::writePathFound
+			void writePathFound(const SearchState& goal, std::vector<const SearchState*>& path) const;
+
+		private:
+			// noncopyable
+			IndexedAStar(const IndexedAStar<SearchMechanics>&);
+			IndexedAStar& operator=(const IndexedAStar<SearchMechanics>&);
+
+			// Adds the state to the open list or decreases its costs if it is already scheduled
+			void schedule(SearchState& state);
+
+			SearchMechanics& mSearchMechanics;
+
+			std::unique_ptr<SearchArena> mArena; // Exclusively owned while the search exists, returned to the thread local cache on destruction
+
+			SearchState* mGoalFound;
+
+			// Helper flag tracking whether the expansion phase has already started to determine the more important uses late starts flag below.
+			bool mHadSearchStep;
+
+			// Set when start states are added after the expansion phase started, see AStar.
+			bool mUsesLateStarts;
+		};
+	}
+}
+
+#include "qsf_ai/algorithm/IndexedAStar-inl.h"
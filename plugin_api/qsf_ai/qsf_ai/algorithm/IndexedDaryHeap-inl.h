@@ -0,0 +1,179 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/base/error/ErrorHandling.h>
+
+namespace qsf
+{
+	namespace ai
+	{
+		template <typename Value, typename Less, std::size_t Arity>
+		const uint32 IndexedDaryHeap<Value, Less, Arity>::NOT_CONTAINED;
+
+		template <typename Value, typename Less, std::size_t Arity>
+		IndexedDaryHeap<Value, Less, Arity>::IndexedDaryHeap()
+		{}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		bool IndexedDaryHeap<Value, Less, Arity>::empty() const
+		{
+			return mNodes.empty();
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		std::size_t IndexedDaryHeap<Value, Less, Arity>::size() const
+		{
+			return mNodes.size();
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		bool IndexedDaryHeap<Value, Less, Arity>::contains(std::size_t key) const
+		{
+			return key < mPositions.size() && mPositions[key] != NOT_CONTAINED;
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		const Value& IndexedDaryHeap<Value, Less, Arity>::top() const
+		{
+			QSF_ASSERT(!mNodes.empty(), "Accessing the top of an empty heap", QSF_REACT_THROW);
+			return mNodes.front().mValue;
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		std::size_t IndexedDaryHeap<Value, Less, Arity>::topKey() const
+		{
+			QSF_ASSERT(!mNodes.empty(), "Accessing the top of an empty heap", QSF_REACT_THROW);
+			return mNodes.front().mKey;
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::push(std::size_t key, const Value& value)
+		{
+			QSF_ASSERT(!contains(key), "Key " << key << " is already contained in the heap", QSF_REACT_THROW);
+			if (key >= mPositions.size())
+				mPositions.resize(key + 1, NOT_CONTAINED);
+
+			const uint32 position = static_cast<uint32>(mNodes.size());
+			mNodes.push_back(Node(key, value));
+			mPositions[key] = position;
+			siftUp(position);
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::update(std::size_t key, const Value& value)
+		{
+			QSF_ASSERT(contains(key), "Key " << key << " is not contained in the heap", QSF_REACT_THROW);
+			const uint32 position = mPositions[key];
+			const bool decreased = mLess(value, mNodes[position].mValue);
+			mNodes[position].mValue = value;
+
+			if (decreased)
+				siftUp(position);
+			else
+				siftDown(position);
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		bool IndexedDaryHeap<Value, Less, Arity>::pushOrUpdate(std::size_t key, const Value& value)
+		{
+			if (contains(key))
+			{
+				update(key, value);
+				return false;
+			}
+
+			push(key, value);
+			return true;
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::pop()
+		{
+			QSF_ASSERT(!mNodes.empty(), "Popping from an empty heap", QSF_REACT_THROW);
+			mPositions[mNodes.front().mKey] = NOT_CONTAINED;
+
+			if (mNodes.size() > 1)
+			{
+				placeNode(0, mNodes.back());
+				mNodes.pop_back();
+				siftDown(0);
+			}
+			else
+			{
+				mNodes.pop_back();
+			}
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::clear()
+		{
+			// Only the contained keys have a valid position, all others are already reset
+			for (const Node& node : mNodes)
+				mPositions[node.mKey] = NOT_CONTAINED;
+
+			mNodes.clear();
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::siftUp(uint32 position)
+		{
+			// Move the parents down into the hole until the correct position is found, this saves swapping
+			const Node node = mNodes[position];
+			while (position > 0)
+			{
+				const uint32 parent = (position - 1) / Arity;
+				if (!mLess(node.mValue, mNodes[parent].mValue))
+					break;
+
+				placeNode(position, mNodes[parent]);
+				position = parent;
+			}
+			placeNode(position, node);
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::siftDown(uint32 position)
+		{
+			const Node node = mNodes[position];
+			const uint32 numNodes = static_cast<uint32>(mNodes.size());
+			for (;;)
+			{
+				const uint32 firstChild = position * Arity + 1;
+				if (firstChild >= numNodes)
+					break;
+
+				// Find the least child, the children of a node are adjacent in memory
+				const uint32 endChild = (firstChild + Arity < numNodes) ? firstChild + static_cast<uint32>(Arity) : numNodes;
+				uint32 leastChild = firstChild;
+				for (uint32 child = firstChild + 1; child < endChild; ++child)
+				{
+					if (mLess(mNodes[child].mValue, mNodes[leastChild].mValue))
+						leastChild = child;
+				}
+
+				if (!mLess(mNodes[leastChild].mValue, node.mValue))
+					break;
+
+				placeNode(position, mNodes[leastChild]);
+				position = leastChild;
+			}
+			placeNode(position, node);
+		}
+
+		template <typename Value, typename Less, std::size_t Arity>
+		void IndexedDaryHeap<Value, Less, Arity>::placeNode(uint32 position, const Node& node)
+		{
+			mNodes[position] = node;
+			mPositions[node.mKey] = position;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace qsf
+{
+	namespace ai
+	{
+		/** An indexed d-ary min heap that supports changing the priority of contained values.
+		* Each value is identified by a key, which is a small integer like the index of a search state, and each key may be contained only once.
+		* The heap position of each key is tracked in a table indexed by key, so lookup and decrease key are possible without searching.
+		* The Less predicate defines the ordering, the value for which no other value is less is on top.
+		* A higher arity makes the heap flatter, which means fewer cache misses during sift up at the cost of more comparisons during sift down.
+		* Clearing the heap only touches the contained keys and keeps all allocated memory, so a heap can be reused for many searches without allocating.
+		*/
+		template <typename Value, typename Less, std::size_t Arity = 4>
+		class IndexedDaryHeap
+		{
+		public:
+			static_assert(Arity >= 2, "The arity of a heap needs to be at least two");
+
+			IndexedDaryHeap();
+
+			bool empty() const;
+			std::size_t size() const;
+
+			// Returns whether a value with this key is currently contained
+			bool contains(std::size_t key) const;
+
+			// Access to the top value and its key, the heap must not be empty
+			const Value& top() const;
+			std::size_t topKey() const;
+
+			// Adds a value for a key that must not be contained yet
+			void push(std::size_t key, const Value& value);
+			// Replaces the value for a key that must be contained and restores the heap order
+			void update(std::size_t key, const Value& value);
+			// Adds the value if the key is not contained or updates it otherwise, returns true if it was added
+			bool pushOrUpdate(std::size_t key, const Value& value);
+			// Removes the top value, the heap must not be empty
+			void pop();
+
+			// Removes all values but keeps the allocated memory
+			void clear();
+
+		private:
+			struct Node
+			{
+				Node(std::size_t key, const Value& value) :
+					mValue(value),
+					mKey(key)
+				{}
+
+				Value mValue;
+				std::size_t mKey;
+			};
+
+			static const uint32 NOT_CONTAINED = static_cast<uint32>(-1);
+
+			void siftUp(uint32 position);
+			void siftDown(uint32 position);
+			// Writes a node to a heap position and updates the position table
+			void placeNode(uint32 position, const Node& node);
+
+			std::vector<Node> mNodes; // The heap itself in level order
+			std::vector<uint32> mPositions; // Heap position per key, NOT_CONTAINED if the key is not contained; only grows
+			Less mLess;
+		};
+	}
+}
+
+#include "qsf_ai/algorithm/IndexedDaryHeap-inl.h"
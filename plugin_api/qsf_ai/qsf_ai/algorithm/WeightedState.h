@@ -39,5 +39,15 @@ namespace qsf
 				return lhs.mCosts > rhs.mCosts;
 			}
 		};
+
+		// Predicate to create an ordering among weighted states ascending with costs, the inverse of SearchStateCostMore for use with min heaps
+		template <typename SearchState>
+		struct SearchStateCostLess
+		{
+			bool operator ()(const WeightedState<SearchState>& lhs, const WeightedState<SearchState>& rhs) const
+			{
+				return lhs.mCosts < rhs.mCosts;
+			}
+		};
 	}
 }
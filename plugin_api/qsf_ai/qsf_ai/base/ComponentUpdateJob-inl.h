@@ -0,0 +1,337 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/job/JobArguments.h>
+#include <qsf/log/LogSystem.h>
+#include <qsf/map/Map.h>
+#include <qsf/map/query/ComponentMapQuery.h>
+#include <qsf/time/HighResolutionStopwatch.h>
+#include <qsf/worker/WorkStealingThreadPool.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		template <typename ComponentType>
+		ComponentUpdateJob<ComponentType>::Statistics::Statistics() :
+			mNumUpdatedComponents(0),
+			mNumDeferredComponents(0),
+			mNumRegularEfforts(0),
+			mNumFailedUpdates(0)
+		{}
+
+		template <typename ComponentType>
+		ComponentUpdateJob<ComponentType>::ComponentUpdateJob(Map& map, const char* name, const UpdateFunction& updateFunction, const StringHash& jobManagerId) :
+			mMap(map),
+			mName(name),
+			mUpdateFunction(updateFunction),
+			mThreadPool(nullptr),
+			mEffortBudget(getUninitialized<uint32>()),
+			mBudgetCursor(0),
+			mRegularEffortShare(1.f)
+		{
+			mJobProxy.registerAt(jobManagerId, boost::bind(&ComponentUpdateJob::updateJob, this, _1));
+		}
+
+		template <typename ComponentType>
+		ComponentUpdateJob<ComponentType>::~ComponentUpdateJob()
+		{
+			mJobProxy.unregister();
+		}
+
+		template <typename ComponentType>
+		bool ComponentUpdateJob<ComponentType>::isParallelUpdate() const
+		{
+			return (nullptr != mThreadPool);
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::setParallelUpdate(WorkStealingThreadPool* threadPool)
+		{
+			mThreadPool = threadPool;
+		}
+
+		template <typename ComponentType>
+		uint32 ComponentUpdateJob<ComponentType>::getEffortBudget() const
+		{
+			return mEffortBudget;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::setEffortBudget(uint32 numberOfRegularUpdates)
+		{
+			mEffortBudget = numberOfRegularUpdates;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::setDeferrableFunction(const DeferrableFunction& deferrableFunction)
+		{
+			mDeferrableFunction = deferrableFunction;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::setDueFunction(const DueFunction& dueFunction)
+		{
+			mDueFunction = dueFunction;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::setDebugOutputFunction(const DebugOutputFunction& debugOutputFunction)
+		{
+			mDebugOutputFunction = debugOutputFunction;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::update(const JobArguments& jobArguments)
+		{
+			HighResolutionStopwatch stopwatch;
+			mStatistics = Statistics();
+
+			scheduleComponents(jobArguments);
+			updateScheduledComponents(jobArguments);
+
+			mStatistics.mUpdateTime = stopwatch.getElapsed();
+		}
+
+		template <typename ComponentType>
+		const typename ComponentUpdateJob<ComponentType>::Statistics& ComponentUpdateJob<ComponentType>::getStatistics() const
+		{
+			return mStatistics;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::deferSideEffect(const boost::function<void()>& sideEffect)
+		{
+			UpdateBuffer* buffer = getThreadLocalUpdateBuffer();
+			if (nullptr != buffer)
+				buffer->mSideEffects.push_back(sideEffect);
+			else
+				sideEffect();
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::updateJob(const JobArguments& jobArguments)
+		{
+			update(jobArguments);
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::scheduleComponents(const JobArguments& jobArguments)
+		{
+			mScheduledComponents.clear();
+			mNextMissedTimes.clear();
+
+			const bool hasBudget = isInitialized(mEffortBudget);
+			uint32 numDeferrable = 0;
+			for (ComponentType* c : ComponentMapQuery(mMap).getAllInstances<ComponentType>())
+			{
+				if (c->isActive() && c->isRunning())
+				{
+					const typename MissedTimeMap::const_iterator missedTime = mMissedTimes.find(c->getEntityId());
+
+					// The due function may replace the time passed by the time it accumulated itself, the time missed while deferred comes on top
+					ScheduledComponent scheduledComponent;
+					scheduledComponent.mComponent = c;
+					scheduledComponent.mTimePassed = jobArguments.getTimePassed();
+					if (!mDueFunction.empty() && !mDueFunction(*c, scheduledComponent.mTimePassed))
+					{
+						if (missedTime != mMissedTimes.end())
+							mNextMissedTimes.emplace(missedTime->first, missedTime->second);
+						continue;
+					}
+					if (missedTime != mMissedTimes.end())
+						scheduledComponent.mTimePassed += missedTime->second;
+
+					scheduledComponent.mDeferrable = (hasBudget && (mDeferrableFunction.empty() || mDeferrableFunction(*c)));
+					if (scheduledComponent.mDeferrable)
+						++numDeferrable;
+					mScheduledComponents.push_back(scheduledComponent);
+				}
+			}
+
+			if (0 == numDeferrable)
+			{
+				mMissedTimes.swap(mNextMissedTimes);
+				return;
+			}
+
+			// Estimate how many deferrable components fit into the budget from the share of regular efforts seen so far
+			const float regularEffortShare = std::max(mRegularEffortShare, 0.01f);
+			const float estimatedNumToUpdate = std::ceil(static_cast<float>(mEffortBudget) / regularEffortShare);
+			const uint32 numToUpdate = (estimatedNumToUpdate >= static_cast<float>(numDeferrable)) ? numDeferrable : static_cast<uint32>(estimatedNumToUpdate);
+
+			// Round robin window over the deferrable components, starting where the previous tick stopped
+			if (mBudgetCursor >= numDeferrable)
+				mBudgetCursor = 0;
+			const uint32 windowEnd = mBudgetCursor + numToUpdate;
+
+			// Compact the list in place, keeping the order of the components. The deferred ones keep their time for the next tick.
+			uint32 deferrableIndex = 0;
+			size_t numKept = 0;
+			for (size_t i = 0; i < mScheduledComponents.size(); ++i)
+			{
+				const ScheduledComponent& scheduledComponent = mScheduledComponents[i];
+				if (scheduledComponent.mDeferrable)
+				{
+					const uint32 index = deferrableIndex++;
+					if (!((index >= mBudgetCursor && index < windowEnd) || index + numDeferrable < windowEnd))
+					{
+						mNextMissedTimes.emplace(scheduledComponent.mComponent->getEntityId(), scheduledComponent.mTimePassed);
+						++mStatistics.mNumDeferredComponents;
+						continue;
+					}
+				}
+
+				mScheduledComponents[numKept++] = scheduledComponent;
+			}
+			mScheduledComponents.resize(numKept);
+			mMissedTimes.swap(mNextMissedTimes);
+
+			mBudgetCursor = windowEnd % numDeferrable;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::updateScheduledComponents(const JobArguments& jobArguments)
+		{
+			const uint32 numComponents = static_cast<uint32>(mScheduledComponents.size());
+			if (0 == numComponents)
+				return;
+
+			// Fixed chunks, so the side effects are committed in component order no matter which thread updated a chunk
+			const uint32 numChunks = isParallelUpdate() ? (numComponents + PARALLEL_UPDATE_CHUNK_SIZE - 1) / PARALLEL_UPDATE_CHUNK_SIZE : 1;
+			if (mUpdateBuffers.size() < numChunks)
+				mUpdateBuffers.resize(numChunks);
+			for (uint32 chunk = 0; chunk < numChunks; ++chunk)
+			{
+				UpdateBuffer& buffer = mUpdateBuffers[chunk];
+				buffer.mSideEffects.clear();
+				buffer.mDebugComponents.clear();
+				buffer.mErrors.clear();
+				buffer.mNumRegularEfforts = 0;
+			}
+
+			if (isParallelUpdate())
+			{
+				mThreadPool->parallelFor(0, numChunks, 1, [this, numComponents, &jobArguments](uint32 firstChunk, uint32 lastChunk)
+				{
+					for (uint32 chunk = firstChunk; chunk < lastChunk; ++chunk)
+					{
+						UpdateBuffer& buffer = mUpdateBuffers[chunk];
+
+						// Route deferSideEffect calls of this thread into the buffer of the chunk
+						UpdateBuffer*& threadLocalBuffer = getThreadLocalUpdateBuffer();
+						UpdateBuffer* previousBuffer = threadLocalBuffer;
+						threadLocalBuffer = &buffer;
+
+						const uint32 last = std::min(numComponents, (chunk + 1) * PARALLEL_UPDATE_CHUNK_SIZE);
+						for (uint32 i = chunk * PARALLEL_UPDATE_CHUNK_SIZE; i < last; ++i)
+						{
+							updateComponentIntoBuffer(mScheduledComponents[i], jobArguments, buffer);
+						}
+
+						threadLocalBuffer = previousBuffer;
+					}
+				});
+			}
+			else
+			{
+				// Side effects are executed at once, only debug output and errors are collected
+				for (const ScheduledComponent& scheduledComponent : mScheduledComponents)
+				{
+					updateComponentIntoBuffer(scheduledComponent, jobArguments, mUpdateBuffers[0]);
+				}
+			}
+
+			uint32 numRegularEfforts = 0;
+			for (uint32 chunk = 0; chunk < numChunks; ++chunk)
+			{
+				numRegularEfforts += mUpdateBuffers[chunk].mNumRegularEfforts;
+				commitUpdateBuffer(mUpdateBuffers[chunk]);
+			}
+
+			const uint32 numScheduledDeferrable = static_cast<uint32>(std::count_if(mScheduledComponents.begin(), mScheduledComponents.end(), [](const ScheduledComponent& scheduledComponent) { return scheduledComponent.mDeferrable; }));
+			if (numScheduledDeferrable > 0)
+			{
+				// Smooth the share a bit so a single expensive tick does not starve the deferrable components
+				mRegularEffortShare = 0.5f * mRegularEffortShare + 0.5f * static_cast<float>(numRegularEfforts) / static_cast<float>(numScheduledDeferrable);
+			}
+
+			mStatistics.mNumUpdatedComponents = numComponents - mStatistics.mNumFailedUpdates;
+			mStatistics.mNumRegularEfforts = numRegularEfforts;
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::updateComponentIntoBuffer(const ScheduledComponent& scheduledComponent, const JobArguments& jobArguments, UpdateBuffer& buffer)
+		{
+			ComponentType& component = *scheduledComponent.mComponent;
+			try
+			{
+				// A component that was deferred gets the time passed since its last update
+				const effort::Indicator effort = (scheduledComponent.mTimePassed == jobArguments.getTimePassed()) ?
+					mUpdateFunction(component, jobArguments) : mUpdateFunction(component, JobArguments(jobArguments, scheduledComponent.mTimePassed));
+
+				if (scheduledComponent.mDeferrable && effort == effort::REGULAR)
+					++buffer.mNumRegularEfforts;
+				if (component.isDebug())
+					buffer.mDebugComponents.push_back(&component);
+			}
+			catch (const std::exception& e)
+			{
+				// Exception firewall, the individual component updates should not interfere. Logging is left to the commit because the log is not meant to be written concurrently.
+				buffer.mErrors.push_back(e.what());
+			}
+		}
+
+		template <typename ComponentType>
+		void ComponentUpdateJob<ComponentType>::commitUpdateBuffer(UpdateBuffer& buffer)
+		{
+			for (const boost::function<void()>& sideEffect : buffer.mSideEffects)
+			{
+				try
+				{
+					sideEffect();
+				}
+				catch (const std::exception& e)
+				{
+					QSF_LOG_PRINTS(ERROR, "Committing an update of " << mName << " failed because of " << e.what());
+				}
+			}
+
+			if (!mDebugOutputFunction.empty())
+			{
+				for (ComponentType* c : buffer.mDebugComponents)
+				{
+					mDebugOutputFunction(*c);
+				}
+			}
+
+			for (const std::string& error : buffer.mErrors)
+			{
+				QSF_LOG_PRINTS(ERROR, "Updating " << mName << " failed because of " << error);
+			}
+			mStatistics.mNumFailedUpdates += static_cast<uint32>(buffer.mErrors.size());
+		}
+
+		template <typename ComponentType>
+		typename ComponentUpdateJob<ComponentType>::UpdateBuffer*& ComponentUpdateJob<ComponentType>::getThreadLocalUpdateBuffer()
+		{
+			static thread_local UpdateBuffer* threadLocalUpdateBuffer = nullptr;
+			return threadLocalUpdateBuffer;
+		}
+	}
+}
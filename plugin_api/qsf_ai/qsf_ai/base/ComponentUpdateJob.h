@@ -0,0 +1,168 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/plugin/Jobs.h"
+
+#include <qsf/base/GetUninitialized.h>
+#include <qsf/base/StringHash.h>
+#include <qsf/job/JobProxy.h>
+#include <qsf/logic/EffortIndicator.h>
+#include <qsf/time/Time.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+
+namespace qsf
+{
+	class Map;
+	class JobArguments;
+	class WorkStealingThreadPool;
+
+	namespace ai
+	{
+		/**
+		* Updates all active and running components of one type of a map once per update of a job manager, like a StandardSystem does for its registration.
+		* It's meant for component updates owned by a plugin, the AI systems of the engine keep their own update loop.
+		*
+		* There are two optional update modes, both disabled by default:
+		* - Parallel update: The components are updated in chunks on a work stealing thread pool, the one the plugin owns.
+		*   The update function may then only touch the component passed, anything else like sending messages or changing other entities has to go through deferSideEffect.
+		*   The deferred side effects, debug output and error logging are committed on the calling thread afterwards, in the order of the components.
+		* - Effort budget: Deferrable components, all by default, are updated round robin, only as many per tick as are expected to fit into the budget of regular effort updates.
+		*   The expectation is based on the effort indicators returned in the previous ticks.
+		*   A deferred component keeps the time it missed, it is passed on with its next update, also if a due function skips it in between.
+		*
+		* The job is registered on construction, so owning an instance is all that's needed.
+		* Usage, e.g. inside a plugin during the simulation:
+		* @code
+		*   mUpdateJob.reset(new qsf::ai::ComponentUpdateJob<MyComponent>(QSF_MAINMAP, "MyComponentUpdate", boost::bind(&MySystem::updateComponent, this, _1, _2)));
+		*   mUpdateJob->setParallelUpdate(mThreadPool.get());
+		*   mUpdateJob->setEffortBudget(50);
+		* @endcode
+		*/
+		template <typename ComponentType>
+		class ComponentUpdateJob : public boost::noncopyable
+		{
+		public:
+			typedef boost::function<effort::Indicator(ComponentType&, const JobArguments&)> UpdateFunction;
+			typedef boost::function<bool(const ComponentType&, Time& timePassed)> DueFunction;
+			typedef boost::function<bool(const ComponentType&)> DeferrableFunction;
+			typedef boost::function<void(ComponentType&)> DebugOutputFunction;
+
+			// Counters of the last update
+			struct Statistics
+			{
+				Statistics();
+
+				uint32 mNumUpdatedComponents;
+				uint32 mNumDeferredComponents; // Skipped because of the effort budget
+				uint32 mNumRegularEfforts; // Among the updated deferrable components
+				uint32 mNumFailedUpdates;
+				Time mUpdateTime;
+			};
+
+			// Number of components per chunk of a parallel update
+			static const uint32 PARALLEL_UPDATE_CHUNK_SIZE = 64;
+
+			// The map needs to outlive the job, the name is only used for logging. The job is registered at the job manager passed right away.
+			ComponentUpdateJob(Map& map, const char* name, const UpdateFunction& updateFunction, const StringHash& jobManagerId = Jobs::SIMULATION_AI);
+			~ComponentUpdateJob();
+
+			// Get / set whether the components are updated in parallel on the thread pool passed, a nullptr updates them on the calling thread.
+			// The thread pool is not owned and needs to outlive the job, see WorkStealingThreadPool::shutdown.
+			//@{
+			bool isParallelUpdate() const;
+			void setParallelUpdate(WorkStealingThreadPool* threadPool);
+			//@}
+
+			// Get / set the number of regular effort updates of deferrable components per tick, uninitialized means no budget (the default)
+			//@{
+			uint32 getEffortBudget() const;
+			void setEffortBudget(uint32 numberOfRegularUpdates);
+			//@}
+
+			// Decides which components are updated in this tick at all, e.g. AiLodScheduler::isUpdateDue; an empty function means all of them.
+			// It gets the time passed of the job and may replace it by the time passed since the previous update of the component.
+			void setDueFunction(const DueFunction& dueFunction);
+			// Decides which components may be deferred when a budget is set, an empty function means all of them
+			void setDeferrableFunction(const DeferrableFunction& deferrableFunction);
+			// Called on the calling thread for each updated component in debug mode
+			void setDebugOutputFunction(const DebugOutputFunction& debugOutputFunction);
+
+			// Update the components right away, this is what the job does
+			void update(const JobArguments& jobArguments);
+
+			const Statistics& getStatistics() const;
+
+			// Execute a side effect of a component update, e.g. sending a message.
+			// Inside a parallel update it is buffered and executed after all components are updated, otherwise it is executed at once.
+			static void deferSideEffect(const boost::function<void()>& sideEffect);
+
+		private:
+			struct ScheduledComponent
+			{
+				ComponentType* mComponent;
+				Time mTimePassed; // Including the time missed while deferred
+				bool mDeferrable;
+			};
+
+			// Collects everything a chunk of a parallel update must not do concurrently
+			struct UpdateBuffer
+			{
+				std::vector<boost::function<void()>> mSideEffects;
+				std::vector<ComponentType*> mDebugComponents;
+				std::vector<std::string> mErrors;
+				uint32 mNumRegularEfforts;
+			};
+
+			typedef std::unordered_map<uint64, Time> MissedTimeMap; // Entity id as key
+
+			void updateJob(const JobArguments& jobArguments);
+
+			// Collect the components to update in this tick into mScheduledComponents, respecting the effort budget
+			void scheduleComponents(const JobArguments& jobArguments);
+			// Update the scheduled components into the buffers, serially or in parallel
+			void updateScheduledComponents(const JobArguments& jobArguments);
+			void updateComponentIntoBuffer(const ScheduledComponent& scheduledComponent, const JobArguments& jobArguments, UpdateBuffer& buffer);
+			void commitUpdateBuffer(UpdateBuffer& buffer);
+
+			static UpdateBuffer*& getThreadLocalUpdateBuffer();
+
+			Map& mMap;
+			const std::string mName;
+			UpdateFunction mUpdateFunction;
+			DueFunction mDueFunction;
+			DeferrableFunction mDeferrableFunction;
+			DebugOutputFunction mDebugOutputFunction;
+
+			WorkStealingThreadPool* mThreadPool; // Parallel update if set, not owned
+			uint32 mEffortBudget;
+			uint32 mBudgetCursor; // Position in the sequence of deferrable components where the next tick continues
+			float mRegularEffortShare; // Smoothed share of deferrable updates reporting regular effort, used to estimate how many fit into the budget
+			MissedTimeMap mMissedTimes; // Deferred components and the time they missed, kept while their due function skips them
+			MissedTimeMap mNextMissedTimes; // Swapped with mMissedTimes each tick so vanished components are forgotten
+
+			std::vector<ScheduledComponent> mScheduledComponents; // Kept as member to reuse the allocated memory
+			std::vector<UpdateBuffer> mUpdateBuffers;
+			Statistics mStatistics;
+
+			JobProxy mJobProxy; // Regular job calling update
+		};
+	}
+}
+
+#include "qsf_ai/base/ComponentUpdateJob-inl.h"
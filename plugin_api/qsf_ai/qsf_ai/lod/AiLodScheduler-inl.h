@@ -0,0 +1,267 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/lod/AiLodComponent.h"
+
+#include <qsf/component/base/TransformComponent.h>
+#include <qsf/map/Map.h>
+#include <qsf/map/Entity.h>
+#include <qsf/map/query/ComponentMapQuery.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline AiLodScheduler::AiLodScheduler(Map& map, const StringHash& jobManagerId) :
+			mMap(map),
+			mCameraPosition(0.0f),
+			mCameraDirection(0.0f, 0.0f, -1.0f),
+			mCosHalfFieldOfView(-1.0f),
+			mUpdateRun(0)
+		{
+			setSystemRate(STEERING, 2.0f, 30.0f, false);
+			setSystemRate(PERCEPTION, 1.0f, 10.0f, true);
+			setSystemRate(REACTION, 2.0f, 15.0f, false);
+			setSystemRate(PATHFINDING, 5.0f, 30.0f, false);
+
+			mImportanceSettings.mNearDistance = 30.0f;
+			mImportanceSettings.mFarDistance = 300.0f;
+			mImportanceSettings.mOffscreenFactor = 0.25f;
+			mImportanceSettings.mSelectedImportance = 1.0f;
+			mImportanceSettings.mEventImportance = 0.75f;
+			mImportanceSettings.mAssignLod = false;
+
+			resetTelemetry();
+
+			mJobProxy.registerAt(jobManagerId, boost::bind(&AiLodScheduler::updateJob, this, _1));
+		}
+
+		inline AiLodScheduler::~AiLodScheduler()
+		{
+			mJobProxy.unregister();
+		}
+
+		inline const AiLodScheduler::SystemRate& AiLodScheduler::getSystemRate(SystemSlot slot) const
+		{
+			return mSystemRates[slot];
+		}
+
+		inline void AiLodScheduler::setSystemRate(SystemSlot slot, float minimumFrequency, float maximumFrequency, bool skipOffscreen)
+		{
+			SystemRate& systemRate = mSystemRates[slot];
+			systemRate.mMinimumFrequency = std::max(minimumFrequency, 0.01f);
+			systemRate.mMaximumFrequency = std::max(maximumFrequency, systemRate.mMinimumFrequency);
+			systemRate.mSkipOffscreen = skipOffscreen;
+		}
+
+		inline const AiLodScheduler::ImportanceSettings& AiLodScheduler::getImportanceSettings() const
+		{
+			return mImportanceSettings;
+		}
+
+		inline void AiLodScheduler::setImportanceSettings(const ImportanceSettings& settings)
+		{
+			mImportanceSettings = settings;
+		}
+
+		inline void AiLodScheduler::setCamera(const glm::vec3& position, const glm::vec3& viewDirection, float cosHalfFieldOfView)
+		{
+			mCameraPosition = position;
+			mCameraDirection = viewDirection;
+			mCosHalfFieldOfView = cosHalfFieldOfView;
+		}
+
+		inline bool AiLodScheduler::isSelected(uint64 entityId) const
+		{
+			return (mSelectedEntityIds.count(entityId) > 0);
+		}
+
+		inline void AiLodScheduler::setSelected(uint64 entityId, bool selected)
+		{
+			if (selected)
+				mSelectedEntityIds.insert(entityId);
+			else
+				mSelectedEntityIds.erase(entityId);
+		}
+
+		inline bool AiLodScheduler::isInvolvedInEvent(uint64 entityId) const
+		{
+			return (mEventEntityIds.count(entityId) > 0);
+		}
+
+		inline void AiLodScheduler::setInvolvedInEvent(uint64 entityId, bool involvedInEvent)
+		{
+			if (involvedInEvent)
+				mEventEntityIds.insert(entityId);
+			else
+				mEventEntityIds.erase(entityId);
+		}
+
+		inline void AiLodScheduler::updateImportances()
+		{
+			++mUpdateRun;
+
+			const float distanceRange = std::max(mImportanceSettings.mFarDistance - mImportanceSettings.mNearDistance, 0.001f);
+			for (AiLodComponent* lodComponent : ComponentMapQuery(mMap).getAllInstances<AiLodComponent>())
+			{
+				if (!lodComponent->isActive())
+					continue;
+
+				const TransformComponent* transformComponent = lodComponent->getEntity().getComponent<TransformComponent>();
+				if (nullptr == transformComponent)
+					continue;
+
+				const uint64 entityId = lodComponent->getEntityId();
+				EntityState& entityState = mEntityStates[entityId];
+				entityState.mUpdateRun = mUpdateRun;
+
+				// Entities very close to the camera count as visible even if they are slightly outside the view cone
+				const glm::vec3 offset = transformComponent->getPosition() - mCameraPosition;
+				const float distance = glm::length(offset);
+				entityState.mOnScreen = (distance <= mImportanceSettings.mNearDistance || glm::dot(offset, mCameraDirection) >= mCosHalfFieldOfView * distance);
+
+				float importance = 1.0f - glm::clamp((distance - mImportanceSettings.mNearDistance) / distanceRange, 0.0f, 1.0f);
+				if (!entityState.mOnScreen)
+					importance *= mImportanceSettings.mOffscreenFactor;
+				if (isSelected(entityId))
+					importance = std::max(importance, mImportanceSettings.mSelectedImportance);
+				if (isInvolvedInEvent(entityId))
+					importance = std::max(importance, mImportanceSettings.mEventImportance);
+				importance = glm::clamp(importance, 0.0f, 1.0f);
+
+				entityState.mImportance = importance;
+				entityState.mImportanceTier = std::min(static_cast<uint32>((1.0f - importance) * NUM_IMPORTANCE_TIERS), NUM_IMPORTANCE_TIERS - 1);
+
+				if (mImportanceSettings.mAssignLod)
+					lodComponent->setLOD(AiLodComponent::MIN_LOD + static_cast<uint32>(importance * static_cast<float>(AiLodComponent::MAX_LOD - AiLodComponent::MIN_LOD) + 0.5f));
+			}
+
+			// Forget entities which lost their AI LOD component
+			for (EntityStateMap::iterator iterator = mEntityStates.begin(); iterator != mEntityStates.end();)
+			{
+				if (iterator->second.mUpdateRun != mUpdateRun)
+					iterator = mEntityStates.erase(iterator);
+				else
+					++iterator;
+			}
+		}
+
+		inline float AiLodScheduler::getImportance(uint64 entityId) const
+		{
+			const EntityStateMap::const_iterator iterator = mEntityStates.find(entityId);
+			return (iterator != mEntityStates.end()) ? iterator->second.mImportance : 1.0f;
+		}
+
+		inline uint32 AiLodScheduler::getImportanceTier(uint64 entityId) const
+		{
+			const EntityStateMap::const_iterator iterator = mEntityStates.find(entityId);
+			return (iterator != mEntityStates.end()) ? iterator->second.mImportanceTier : 0;
+		}
+
+		inline bool AiLodScheduler::isOnScreen(uint64 entityId) const
+		{
+			const EntityStateMap::const_iterator iterator = mEntityStates.find(entityId);
+			return (iterator != mEntityStates.end()) ? iterator->second.mOnScreen : true;
+		}
+
+		inline bool AiLodScheduler::isUpdateDue(SystemSlot slot, uint64 entityId, Time& timePassed)
+		{
+			const EntityStateMap::iterator iterator = mEntityStates.find(entityId);
+			if (iterator == mEntityStates.end())
+				return true;
+
+			EntityState& entityState = iterator->second;
+			const uint32 tier = entityState.mImportanceTier;
+			float& secondsSinceUpdate = entityState.mSecondsSinceUpdate[slot];
+			if (secondsSinceUpdate < 0.0f)
+			{
+				// First update at once with the time passed of the job
+				secondsSinceUpdate = 0.0f;
+				++mNumUpdates[slot][tier];
+				return true;
+			}
+
+			secondsSinceUpdate += timePassed.getSeconds();
+			const bool skipOffscreen = (mSystemRates[slot].mSkipOffscreen && !entityState.mOnScreen && !isSelected(entityId) && !isInvolvedInEvent(entityId));
+			if (skipOffscreen || secondsSinceUpdate < getUpdateInterval(slot, entityState.mImportance, entityId))
+			{
+				++mNumSkippedUpdates[slot][tier];
+				return false;
+			}
+
+			timePassed = Time::fromSeconds(secondsSinceUpdate);
+			secondsSinceUpdate = 0.0f;
+			++mNumUpdates[slot][tier];
+			return true;
+		}
+
+		inline AiLodScheduler::TierTelemetry AiLodScheduler::getTelemetry(SystemSlot slot, uint32 tier) const
+		{
+			const TierTelemetry telemetry = { mNumUpdates[slot][tier], mNumSkippedUpdates[slot][tier] };
+			return telemetry;
+		}
+
+		inline void AiLodScheduler::resetTelemetry()
+		{
+			for (uint32 slot = 0; slot < NUM_SYSTEM_SLOTS; ++slot)
+			{
+				for (uint32 tier = 0; tier < NUM_IMPORTANCE_TIERS; ++tier)
+				{
+					mNumUpdates[slot][tier] = 0;
+					mNumSkippedUpdates[slot][tier] = 0;
+				}
+			}
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline AiLodScheduler::EntityState::EntityState() :
+			mImportance(1.0f),
+			mImportanceTier(0),
+			mOnScreen(true),
+			mUpdateRun(0)
+		{
+			std::fill_n(mSecondsSinceUpdate, static_cast<size_t>(NUM_SYSTEM_SLOTS), -1.0f);
+		}
+
+		inline void AiLodScheduler::updateJob(const JobArguments&)
+		{
+			updateImportances();
+		}
+
+		inline float AiLodScheduler::getUpdateInterval(SystemSlot slot, float importance, uint64 entityId) const
+		{
+			// Geometric interpolation, so the frequency changes by the same factor for each step in importance
+			const SystemRate& systemRate = mSystemRates[slot];
+			const float frequency = systemRate.mMinimumFrequency * std::pow(systemRate.mMaximumFrequency / systemRate.mMinimumFrequency, importance);
+
+			// Entities created in the same tick would otherwise keep updating in the same ticks, so each entity gets an interval up to 10% shorter or longer
+			const float jitter = static_cast<float>((entityId * 2654435761u) % 1024) / 1023.0f * 0.2f - 0.1f;
+			return (1.0f + jitter) / frequency;
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
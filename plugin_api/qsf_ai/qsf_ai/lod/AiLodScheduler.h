@@ -0,0 +1,198 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/plugin/Jobs.h"
+
+#include <qsf/base/StringHash.h>
+#include <qsf/job/JobProxy.h>
+#include <qsf/time/Time.h>
+
+#include <glm/glm.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <unordered_map>
+#include <unordered_set>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Map;
+	class JobArguments;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/** Continuous AI level of detail with update rate scaling for component updates owned by a plugin.
+		* Once per update of a job manager the importance of every entity with an AiLodComponent is derived from the camera distance, whether it is on screen,
+		* whether it is selected and whether it is involved in an event. The importance maps to an update frequency per kind of update,
+		* interpolated geometrically between the frequency of the least and the most important entities.
+		* The state of each entity is kept inside the scheduler, keyed by entity id; the AiLodComponent itself is not changed.
+		*
+		* A ComponentUpdateJob time slices its components by asking isUpdateDue from its due function, the components are then updated with the time passed since their previous update.
+		* Entities the scheduler doesn't know, e.g. without an AiLodComponent, are always due.
+		* Telemetry counts the updates done and skipped per kind of update and importance tier.
+		* The scheduler registers its job on construction, so owning an instance is all that's needed. Usage, e.g. inside a plugin during the simulation:
+		* @code
+		*   mLodScheduler.reset(new qsf::ai::AiLodScheduler(QSF_MAINMAP));
+		*   mUpdateJob->setDueFunction([this](const MyComponent& component, qsf::Time& timePassed)
+		*     { return mLodScheduler->isUpdateDue(qsf::ai::AiLodScheduler::STEERING, component.getEntityId(), timePassed); });
+		*   ...
+		*   mLodScheduler->setCamera(cameraPosition, cameraDirection, std::cos(halfFieldOfView)); // each frame
+		* @endcode
+		*/
+		class AiLodScheduler : public boost::noncopyable
+		{
+		public:
+			// Kinds of update the scheduler knows frequencies for, named after the AI systems with a similar update
+			enum SystemSlot
+			{
+				STEERING,
+				PERCEPTION,
+				REACTION,
+				PATHFINDING,
+				NUM_SYSTEM_SLOTS
+			};
+
+			static const uint32 NUM_IMPORTANCE_TIERS = 4;
+
+			struct SystemRate
+			{
+				float mMinimumFrequency; // Hz for the least important entities
+				float mMaximumFrequency; // Hz for the most important entities
+				bool mSkipOffscreen; // skip entities outside the camera view completely unless they are selected or involved in an event
+			};
+
+			struct ImportanceSettings
+			{
+				float mNearDistance; // full distance importance up to this camera distance
+				float mFarDistance; // no distance importance from this camera distance on
+				float mOffscreenFactor; // multiplied with the distance importance of entities outside the camera view
+				float mSelectedImportance; // minimum importance of selected entities
+				float mEventImportance; // minimum importance of entities involved in an event
+				bool mAssignLod; // also map the importance to AiLodComponent::setLOD, MAX_LOD being the most important
+			};
+
+			struct TierTelemetry
+			{
+				uint32 mNumUpdates;
+				uint32 mNumSkippedUpdates;
+			};
+
+		public:
+			// The map needs to outlive the scheduler, the job updating the importances is registered at the job manager passed right away
+			explicit AiLodScheduler(Map& map, const StringHash& jobManagerId = Jobs::SIMULATION_AI);
+			~AiLodScheduler();
+
+			// Configuration
+			//@{
+			const SystemRate& getSystemRate(SystemSlot slot) const;
+			void setSystemRate(SystemSlot slot, float minimumFrequency, float maximumFrequency, bool skipOffscreen);
+			const ImportanceSettings& getImportanceSettings() const;
+			void setImportanceSettings(const ImportanceSettings& settings);
+			//@}
+
+			// Camera used for the distance and the on screen test, usually set by the game each frame.
+			// The view is a cone given by the normalized view direction and the cosine of half the field of view.
+			void setCamera(const glm::vec3& position, const glm::vec3& viewDirection, float cosHalfFieldOfView);
+
+			// Importance inputs set by the game, e.g. from the selection or the event handling. Kept until reset, also for entities without an AiLodComponent.
+			//@{
+			bool isSelected(uint64 entityId) const;
+			void setSelected(uint64 entityId, bool selected);
+			bool isInvolvedInEvent(uint64 entityId) const;
+			void setInvolvedInEvent(uint64 entityId, bool involvedInEvent);
+			//@}
+
+			// Update the importance of all entities with an active AiLodComponent right away, this is what the job does. Entities which lost their component are forgotten.
+			void updateImportances();
+
+			// Results of the last importance update, an unknown entity has an importance of 1, tier 0 and is on screen
+			//@{
+			float getImportance(uint64 entityId) const;
+			uint32 getImportanceTier(uint64 entityId) const;
+			bool isOnScreen(uint64 entityId) const;
+			//@}
+
+			// Time slicing check, to be called once per tick and entity for each kind of update, e.g. by the due function of a ComponentUpdateJob.
+			// Returns true at the frequency derived from the importance and sets timePassed to the time since the previous update.
+			bool isUpdateDue(SystemSlot slot, uint64 entityId, Time& timePassed);
+
+			// Telemetry since the last reset
+			//@{
+			TierTelemetry getTelemetry(SystemSlot slot, uint32 tier) const;
+			void resetTelemetry();
+			//@}
+
+		private:
+			// Per entity state, only entities with an AiLodComponent have one
+			struct EntityState
+			{
+				EntityState();
+
+				float mImportance;
+				uint32 mImportanceTier;
+				bool mOnScreen;
+				uint32 mUpdateRun; // Run of the last importance update that found the entity
+				float mSecondsSinceUpdate[NUM_SYSTEM_SLOTS]; // negative if never updated
+			};
+
+			typedef std::unordered_map<uint64, EntityState> EntityStateMap;
+
+			void updateJob(const JobArguments& jobArguments);
+			float getUpdateInterval(SystemSlot slot, float importance, uint64 entityId) const;
+
+		private:
+			Map& mMap;
+			SystemRate mSystemRates[NUM_SYSTEM_SLOTS];
+			ImportanceSettings mImportanceSettings;
+			glm::vec3 mCameraPosition;
+			glm::vec3 mCameraDirection;
+			float mCosHalfFieldOfView;
+
+			EntityStateMap mEntityStates;
+			uint32 mUpdateRun;
+			std::unordered_set<uint64> mSelectedEntityIds;
+			std::unordered_set<uint64> mEventEntityIds;
+
+			uint32 mNumUpdates[NUM_SYSTEM_SLOTS][NUM_IMPORTANCE_TIERS];
+			uint32 mNumSkippedUpdates[NUM_SYSTEM_SLOTS][NUM_IMPORTANCE_TIERS];
+
+			JobProxy mJobProxy; // Regular job calling updateImportances
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf_ai/lod/AiLodScheduler-inl.h"
@@ -0,0 +1,654 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/pathfinding/PathSearch.h"
+#include "qsf_ai/navigation/pathfinding/PathSearchConfiguration.h"
+#include "qsf_ai/navigation/Path.h"
+#include "qsf_ai/worldModel/WorldModelManager.h"
+
+#include <qsf/base/error/ErrorHandling.h>
+#include <qsf/math/Transform.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline NavigationTaskScheduler::Entry::Entry(std::unique_ptr<NavigationTask> task, Priority priority, Access access, const std::vector<unsigned int>& mapIds) :
+			mTask(std::move(task)),
+			mPriority(priority),
+			mAccess(access),
+			mMapIds(mapIds),
+			mScheduledTime(Time::now()),
+			mWasExecuted(false),
+			mCanceled(false),
+			mIsPathCacheLeader(false)
+		{}
+
+		inline NavigationTaskScheduler::Access NavigationTaskScheduler::getDefaultAccess(NavigationTask::Type type)
+		{
+			return (type == NavigationTask::PATH_SEARCH || type == NavigationTask::DUMMY) ? SHARED_ACCESS : EXCLUSIVE_ACCESS;
+		}
+
+		inline NavigationTaskScheduler::Priority NavigationTaskScheduler::getDefaultPriority(NavigationTask& task)
+		{
+			if (task.getType() != NavigationTask::PATH_SEARCH)
+				return BACKGROUND_PRIORITY;
+
+			return static_cast<PathSearch&>(task).getSearchConfiguration().isPrioritySearch() ? PLAYER_COMMANDED_PRIORITY : AI_TRAFFIC_PRIORITY;
+		}
+
+		inline NavigationTaskScheduler::NavigationTaskScheduler(WorldModelManager* worldModelManager, uint32 numWorkers, const Time& backgroundAgingTime) :
+			mWorldModelManager(worldModelManager),
+			mNumWorkers(numWorkers),
+			mBackgroundAgingTime(backgroundAgingTime),
+			mNumRunningExclusiveTasks(0),
+			mPathCache(nullptr),
+			mStopRequested(false)
+		{}
+
+		inline NavigationTaskScheduler::~NavigationTaskScheduler()
+		{
+			stop();
+		}
+
+		inline void NavigationTaskScheduler::start()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopRequested = false;
+			startWorkers();
+		}
+
+		inline void NavigationTaskScheduler::stop()
+		{
+			std::vector<std::thread> workers;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStopRequested = true;
+				workers.swap(mWorkers);
+			}
+			mTaskStateChanged.notify_all();
+
+			for (std::thread& worker : workers)
+				worker.join();
+		}
+
+		inline bool NavigationTaskScheduler::isRunning() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return !mWorkers.empty();
+		}
+
+		inline uint32 NavigationTaskScheduler::getNumWorkers() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return static_cast<uint32>(mWorkers.size());
+		}
+
+		inline void NavigationTaskScheduler::schedule(std::unique_ptr<NavigationTask> task, Priority priority, Access access, const std::vector<unsigned int>& mapIds)
+		{
+			QSF_CHECK(task, "Trying to schedule a nullptr as navigation task", QSF_REACT_THROW);
+			QSF_CHECK(priority < NUM_PRIORITIES, "Invalid navigation task priority " << priority, QSF_REACT_THROW);
+			QSF_CHECK(mapIds.size() <= 2, "Navigation tasks may use at most two maps but " << mapIds.size() << " were passed", QSF_REACT_THROW);
+			QSF_CHECK(mapIds.empty() || mWorldModelManager, "The navigation task scheduler needs a world model manager to acquire the map access for tasks", QSF_REACT_THROW);
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (task->getType() == NavigationTask::PATH_SEARCH)
+					++mStatistics.mCurrentlyScheduledPathSearches;
+				else
+					++mStatistics.mCurrentlyScheduledMapChanges;
+
+				mPendingTasks[priority].emplace_back(new Entry(std::move(task), priority, access, mapIds));
+
+				if (!mStopRequested)
+					startWorkers();
+			}
+			mTaskStateChanged.notify_one();
+		}
+
+		inline void NavigationTaskScheduler::schedule(std::unique_ptr<NavigationTask> task)
+		{
+			QSF_CHECK(task, "Trying to schedule a nullptr as navigation task", QSF_REACT_THROW);
+
+			const Priority priority = getDefaultPriority(*task);
+			const Access access = getDefaultAccess(task->getType());
+			schedule(std::move(task), priority, access);
+		}
+
+		inline bool NavigationTaskScheduler::cancel(unsigned int requestId)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (!tryRemovePendingTask(requestId))
+				{
+					for (Entry* entry : mRunningTasks)
+					{
+						if (entry->mTask->getRequestId() == requestId && !entry->mCanceled)
+						{
+							// The worker destroys the task as soon as it returns
+							entry->mCanceled = true;
+							entry->mTask->interrupt();
+							onTaskRemoved(*entry->mTask);
+							return true;
+						}
+					}
+
+					return mFinishedTasks.erase(requestId) > 0 || tryRemovePathCacheRequest(requestId);
+				}
+			}
+
+			// Another task may be allowed to start now
+			mTaskStateChanged.notify_all();
+			return true;
+		}
+
+		inline void NavigationTaskScheduler::setPathCache(PathCache* pathCache)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mPathCache = pathCache;
+		}
+
+		inline void NavigationTaskScheduler::schedulePathSearch(std::unique_ptr<PathSearch> search, unsigned int movementModeId, uint64 worldVersion, const std::vector<unsigned int>& mapIds)
+		{
+			QSF_CHECK(search, "Trying to schedule a nullptr as path search", QSF_REACT_THROW);
+			QSF_CHECK(isInitialized(search->getRequestId()), "Path searches scheduled with a path cache need a request id", QSF_REACT_THROW);
+			QSF_CHECK(mapIds.size() <= 2, "Navigation tasks may use at most two maps but " << mapIds.size() << " were passed", QSF_REACT_THROW);
+			QSF_CHECK(mapIds.empty() || mWorldModelManager, "The navigation task scheduler needs a world model manager to acquire the map access for tasks", QSF_REACT_THROW);
+
+			const unsigned int requestId = search->getRequestId();
+			const Priority priority = getDefaultPriority(*search);
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				PathCache::Key key;
+				PathCache::LookupResult lookupResult = PathCache::SEARCH_REQUIRED;
+				const bool cacheable = (nullptr != mPathCache && mPathCache->tryCreateKey(search->getSearchConfiguration(), movementModeId, key));
+				if (cacheable)
+				{
+					std::deque<Waypoint> waypoints;
+					unsigned int leadingRequestId = getUninitialized<unsigned int>();
+					lookupResult = mPathCache->lookup(key, worldVersion, requestId, waypoints, leadingRequestId);
+					if (lookupResult == PathCache::CACHE_HIT)
+					{
+						// Nothing to execute
+						mSharedPaths[requestId].swap(waypoints);
+						return;
+					}
+				}
+
+				++mStatistics.mCurrentlyScheduledPathSearches;
+				std::unique_ptr<Entry> entry(new Entry(std::move(search), priority, SHARED_ACCESS, mapIds));
+				if (lookupResult == PathCache::COALESCED)
+				{
+					// Waits for the result of the leading search
+					mCoalescedSearches[requestId] = std::move(entry);
+					return;
+				}
+
+				entry->mIsPathCacheLeader = cacheable;
+				mPendingTasks[priority].push_back(std::move(entry));
+
+				if (!mStopRequested)
+					startWorkers();
+			}
+			mTaskStateChanged.notify_one();
+		}
+
+		inline process::State NavigationTaskScheduler::tryFetchPath(unsigned int requestId, const Transform& currentTransform, Path& path)
+		{
+			std::unique_ptr<NavigationTask> task;
+			std::deque<Waypoint> sharedWaypoints;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				const SharedPathMap::iterator shared = mSharedPaths.find(requestId);
+				if (shared != mSharedPaths.end())
+				{
+					sharedWaypoints.swap(shared->second);
+					mSharedPaths.erase(shared);
+				}
+				else
+				{
+					const FinishedEntryMap::iterator finished = mFinishedTasks.find(requestId);
+					if (finished == mFinishedTasks.end())
+						return getTaskStateInternal(requestId);
+
+					task = std::move(finished->second->mTask);
+					mFinishedTasks.erase(finished);
+				}
+			}
+
+			if (!task)
+			{
+				path.addNodes(sharedWaypoints);
+				return process::FINISHED;
+			}
+
+			QSF_CHECK(task->getType() == NavigationTask::PATH_SEARCH, "Navigation task " << requestId << " of type " << NavigationTask::getDebugOutputForType(task->getType()) << " is no path search",
+				QSF_REACT_THROW);
+
+			if (task->getState() != process::FINISHED)
+				return process::FAILED;
+
+			static_cast<const PathSearch&>(*task).writeResultingPath(currentTransform, path);
+			return process::FINISHED;
+		}
+
+		inline void NavigationTaskScheduler::interruptRunningTasks()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (Entry* entry : mRunningTasks)
+			{
+				if (entry->mAccess == SHARED_ACCESS)
+					entry->mTask->interrupt();
+			}
+		}
+
+		inline process::State NavigationTaskScheduler::getTaskState(unsigned int requestId) const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return getTaskStateInternal(requestId);
+		}
+
+		inline process::State NavigationTaskScheduler::getTaskStateInternal(unsigned int requestId) const
+		{
+			if (mSharedPaths.count(requestId) > 0)
+				return process::FINISHED;
+			if (mCoalescedSearches.count(requestId) > 0)
+				return process::WAITING;
+
+			const FinishedEntryMap::const_iterator finishedIterator = mFinishedTasks.find(requestId);
+			if (finishedIterator != mFinishedTasks.end())
+				return finishedIterator->second->mTask->getState();
+
+			for (const Entry* entry : mRunningTasks)
+			{
+				if (entry->mTask->getRequestId() == requestId)
+					return entry->mCanceled ? process::FAILED : process::RUNNING;
+			}
+
+			for (const EntryQueue& queue : mPendingTasks)
+			{
+				for (const std::unique_ptr<Entry>& entry : queue)
+				{
+					if (entry->mTask->getRequestId() == requestId)
+						return entry->mWasExecuted ? process::INTERRUPTED : process::WAITING;
+				}
+			}
+
+			return process::FAILED;
+		}
+
+		inline std::unique_ptr<NavigationTask> NavigationTaskScheduler::tryFetchFinishedTask(unsigned int requestId)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			const FinishedEntryMap::iterator iterator = mFinishedTasks.find(requestId);
+			if (iterator == mFinishedTasks.end())
+				return std::unique_ptr<NavigationTask>();
+
+			std::unique_ptr<NavigationTask> task = std::move(iterator->second->mTask);
+			mFinishedTasks.erase(iterator);
+			return task;
+		}
+
+		inline void NavigationTaskScheduler::clear()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				for (EntryQueue& queue : mPendingTasks)
+					queue.clear();
+				mFinishedTasks.clear();
+				mCoalescedSearches.clear();
+				mSharedPaths.clear();
+				if (nullptr != mPathCache)
+					mPathCache->clear();
+
+				for (Entry* entry : mRunningTasks)
+				{
+					entry->mCanceled = true;
+					entry->mTask->interrupt();
+				}
+
+				mStatistics.mCurrentlyScheduledPathSearches = 0;
+				mStatistics.mCurrentlyScheduledMapChanges = 0;
+			}
+			mTaskStateChanged.notify_all();
+		}
+
+		inline std::size_t NavigationTaskScheduler::getNumPendingTasks() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			std::size_t numPendingTasks = 0;
+			for (const EntryQueue& queue : mPendingTasks)
+				numPendingTasks += queue.size();
+
+			return numPendingTasks;
+		}
+
+		inline NavigationTaskStatistics NavigationTaskScheduler::getStatistics() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mStatistics;
+		}
+
+		inline TimeHistogram NavigationTaskScheduler::getQueueLatencyHistogram() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mQueueLatencyHistogram;
+		}
+
+		inline TimeHistogram NavigationTaskScheduler::getSearchTimeHistogram() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mSearchTimeHistogram;
+		}
+
+		inline bool NavigationTaskScheduler::tryRemovePendingTask(unsigned int requestId)
+		{
+			for (EntryQueue& queue : mPendingTasks)
+			{
+				for (EntryQueue::iterator iterator = queue.begin(); iterator != queue.end(); ++iterator)
+				{
+					if ((*iterator)->mTask->getRequestId() == requestId)
+					{
+						const bool isPathCacheLeader = (*iterator)->mIsPathCacheLeader;
+						onTaskRemoved(*(*iterator)->mTask);
+						queue.erase(iterator);
+
+						// The coalesced searches need to be searched on their own now
+						if (isPathCacheLeader)
+							onPathCacheLeaderDone(requestId, nullptr);
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		inline bool NavigationTaskScheduler::tryRemovePathCacheRequest(unsigned int requestId)
+		{
+			const FinishedEntryMap::iterator coalesced = mCoalescedSearches.find(requestId);
+			if (coalesced != mCoalescedSearches.end())
+			{
+				onTaskRemoved(*coalesced->second->mTask);
+				mCoalescedSearches.erase(coalesced);
+				if (nullptr != mPathCache)
+					mPathCache->removeCoalescedRequest(requestId);
+				return true;
+			}
+
+			return mSharedPaths.erase(requestId) > 0;
+		}
+
+		inline bool NavigationTaskScheduler::tryWriteWaypointsFound(PathSearch& search, std::deque<Waypoint>& waypoints)
+		{
+			// Shared paths are only handed to identical requests, so the search is smoothed for the start configuration
+			const PathSearchConfiguration& configuration = search.getSearchConfiguration();
+			Path path;
+			search.writeResultingPath(Transform(configuration.mStartPosition, configuration.mStartOrientation), path);
+			waypoints = path.getNodes();
+			return !waypoints.empty();
+		}
+
+		inline void NavigationTaskScheduler::onPathCacheLeaderDone(unsigned int requestId, const std::deque<Waypoint>* waypoints)
+		{
+			if (nullptr == mPathCache)
+				return;
+
+			std::vector<unsigned int> coalescedRequestIds;
+			mPathCache->onSearchFinished(requestId, waypoints, coalescedRequestIds);
+
+			for (unsigned int coalescedRequestId : coalescedRequestIds)
+			{
+				const FinishedEntryMap::iterator coalesced = mCoalescedSearches.find(coalescedRequestId);
+				if (coalesced == mCoalescedSearches.end())
+					continue;
+
+				std::unique_ptr<Entry> entry = std::move(coalesced->second);
+				mCoalescedSearches.erase(coalesced);
+
+				if (nullptr != waypoints)
+				{
+					onTaskRemoved(*entry->mTask);
+					mSharedPaths[coalescedRequestId] = *waypoints;
+				}
+				else
+				{
+					// Search on its own, keeping the original scheduling time so it isn't penalized for waiting
+					const Priority priority = entry->mPriority;
+					mPendingTasks[priority].push_back(std::move(entry));
+				}
+			}
+		}
+
+		inline void NavigationTaskScheduler::onTaskRemoved(const NavigationTask& task)
+		{
+			if (task.getType() == NavigationTask::PATH_SEARCH)
+				--mStatistics.mCurrentlyScheduledPathSearches;
+			else
+				--mStatistics.mCurrentlyScheduledMapChanges;
+		}
+
+		inline void NavigationTaskScheduler::startWorkers()
+		{
+			if (!mWorkers.empty())
+				return;
+
+			uint32 numWorkers = mNumWorkers;
+			if (numWorkers == 0)
+				numWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+			numWorkers = std::max<uint32>(numWorkers, 1);
+
+			for (uint32 index = 0; index < numWorkers; ++index)
+				mWorkers.emplace_back(&NavigationTaskScheduler::executeTasks, this);
+		}
+
+		inline void NavigationTaskScheduler::executeTasks()
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			for (;;)
+			{
+				// The queue is selected once under the lock, background aging depends on the current time and could select another queue when asked again
+				EntryQueue* queue = nullptr;
+				mTaskStateChanged.wait(lock, [this, &queue] { return mStopRequested || canStartNextTask(queue); });
+				if (mStopRequested)
+					return;
+
+				std::unique_ptr<Entry> entry = std::move(queue->front());
+				queue->pop_front();
+
+				if (!entry->mWasExecuted)
+				{
+					const Time latency = Time::now() - entry->mScheduledTime;
+					mQueueLatencyHistogram.add(latency);
+					mStatistics.mPeakWaitingTime = std::max(mStatistics.mPeakWaitingTime, latency);
+					entry->mWasExecuted = true;
+				}
+
+				if (entry->mAccess == EXCLUSIVE_ACCESS)
+					++mNumRunningExclusiveTasks;
+				mRunningTasks.push_back(entry.get());
+				mStatistics.mCurrentlyExecutedType = entry->mTask->getType();
+
+				// Execute without holding the lock
+				lock.unlock();
+				const Time startTime = Time::now();
+				process::State state = process::FAILED;
+				try
+				{
+					state = executeTask(*entry);
+				}
+				catch (const std::exception& exception)
+				{
+					QSF_ERROR("Navigation task " << entry->mTask->getRequestId() << " of type " << NavigationTask::getDebugOutputForType(entry->mTask->getType()) << " failed with exception " << exception.what(),
+						QSF_REACT_NONE);
+					entry->mTask->fail();
+				}
+				const Time executionTime = Time::now() - startTime;
+
+				// Smoothing the path for the cache is left out of the execution time
+				std::deque<Waypoint> waypointsFound;
+				const bool foundWaypoints = (entry->mIsPathCacheLeader && state == process::FINISHED && tryWriteWaypointsFound(static_cast<PathSearch&>(*entry->mTask), waypointsFound));
+				lock.lock();
+
+				mRunningTasks.erase(std::find(mRunningTasks.begin(), mRunningTasks.end(), entry.get()));
+				if (entry->mAccess == EXCLUSIVE_ACCESS)
+					--mNumRunningExclusiveTasks;
+				if (mRunningTasks.empty())
+					mStatistics.mCurrentlyExecutedType = NavigationTask::DUMMY;
+
+				updateStatistics(*entry, state, executionTime);
+				onTaskExecuted(std::move(entry), state, foundWaypoints ? &waypointsFound : nullptr);
+
+				// Finishing a task may allow an exclusive task to start and a requeued task is available for other workers
+				mTaskStateChanged.notify_all();
+			}
+		}
+
+		inline process::State NavigationTaskScheduler::executeTask(Entry& entry)
+		{
+			// The access objects are released when leaving this function, before the worker reports the task as executed
+			std::unique_ptr<ManagedNavigationMapReadAccess> readAccesses[2];
+			std::unique_ptr<ManagedNavigationMapWriteAccess> writeAccesses[2];
+			const std::vector<unsigned int>& mapIds = entry.mMapIds;
+			if (mapIds.size() == 2)
+			{
+				// Lock both maps as one operation to avoid deadlocks with others locking them in a different order
+				if (entry.mAccess == SHARED_ACCESS)
+					mWorldModelManager->acquireParallelReadAccess(mapIds[0], mapIds[1], readAccesses[0], readAccesses[1]);
+				else
+					mWorldModelManager->acquireParallelWriteAccess(mapIds[0], mapIds[1], writeAccesses[0], writeAccesses[1]);
+			}
+			else if (mapIds.size() == 1)
+			{
+				if (entry.mAccess == SHARED_ACCESS)
+					readAccesses[0] = mWorldModelManager->acquireReadAccess(mapIds[0]);
+				else
+					writeAccesses[0] = mWorldModelManager->acquireWriteAccess(mapIds[0]);
+			}
+
+			return entry.mTask->execute();
+		}
+
+		inline NavigationTaskScheduler::EntryQueue* NavigationTaskScheduler::getNextQueue()
+		{
+			EntryQueue& backgroundQueue = mPendingTasks[BACKGROUND_PRIORITY];
+			if (!backgroundQueue.empty() && Time::now() - backgroundQueue.front()->mScheduledTime > mBackgroundAgingTime)
+				return &backgroundQueue;
+
+			for (EntryQueue& queue : mPendingTasks)
+			{
+				if (!queue.empty())
+					return &queue;
+			}
+
+			return nullptr;
+		}
+
+		inline bool NavigationTaskScheduler::canStartNextTask(EntryQueue*& selectedQueue)
+		{
+			selectedQueue = getNextQueue();
+			if (!selectedQueue)
+				return false;
+
+			if (selectedQueue->front()->mAccess == EXCLUSIVE_ACCESS)
+				return mRunningTasks.empty();
+
+			return (mNumRunningExclusiveTasks == 0);
+		}
+
+		inline void NavigationTaskScheduler::updateStatistics(const Entry& entry, process::State state, const Time& executionTime)
+		{
+			const NavigationTask& task = *entry.mTask;
+			const bool finished = (state == process::FINISHED || state == process::FAILED || entry.mCanceled);
+
+			switch (task.getType())
+			{
+			case NavigationTask::PATH_SEARCH:
+				{
+					mStatistics.mSummedSearchTime += executionTime;
+					if (!finished)
+					{
+						++mStatistics.mNumInterruptedSearches;
+						break;
+					}
+
+					const std::size_t numExpandedSearchStates = static_cast<const PathSearch&>(task).getNumExpandedSearchStates();
+					mSearchTimeHistogram.add(executionTime);
+					mStatistics.mSummedExpandedSearchStates += numExpandedSearchStates;
+					mStatistics.mPeakExpandedSearchStates = std::max(mStatistics.mPeakExpandedSearchStates, numExpandedSearchStates);
+					if (state == process::FINISHED && !entry.mCanceled)
+					{
+						++mStatistics.mNumFinishedSearches;
+					}
+					else
+					{
+						++mStatistics.mNumFailedSearches;
+						mStatistics.mSummedFailedSearchTime += executionTime;
+						mStatistics.mSummedExpandedSearchStatesDuringFailures += numExpandedSearchStates;
+					}
+					break;
+				}
+
+			case NavigationTask::SIMPLE_COLLISION_UPDATE:
+				++mStatistics.mNumSimpleMapUpdates;
+				mStatistics.mSummedSimpleMapUpdateTime += executionTime;
+				mStatistics.mPeakSimpleMapUpdateTime = std::max(mStatistics.mPeakSimpleMapUpdateTime, executionTime);
+				break;
+
+			case NavigationTask::VORONOI_REINIT:
+			case NavigationTask::VORONOI_COLLISION_UPDATE:
+				++mStatistics.mNumVoronoiMapUpdates;
+				mStatistics.mSummedVoronoiMapUpdateTime += executionTime;
+				mStatistics.mPeakVoronoiMapUpdateTime = std::max(mStatistics.mPeakVoronoiMapUpdateTime, executionTime);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		inline void NavigationTaskScheduler::onTaskExecuted(std::unique_ptr<Entry> entry, process::State state, const std::deque<Waypoint>* waypointsFound)
+		{
+			if (entry->mIsPathCacheLeader && (entry->mCanceled || state == process::FINISHED || state == process::FAILED))
+				onPathCacheLeaderDone(entry->mTask->getRequestId(), entry->mCanceled ? nullptr : waypointsFound);
+
+			if (entry->mCanceled)
+			{
+				// Canceled tasks were already removed from the scheduled counters
+				entry->mTask->fail();
+				return;
+			}
+
+			if (state != process::FINISHED && state != process::FAILED)
+			{
+				// Interrupted, continue after the other tasks of the same priority
+				entry->mScheduledTime = Time::now();
+				const Priority priority = entry->mPriority;
+				mPendingTasks[priority].push_back(std::move(entry));
+				return;
+			}
+
+			onTaskRemoved(*entry->mTask);
+
+			const unsigned int requestId = entry->mTask->getRequestId();
+			if (isInitialized(requestId))
+				mFinishedTasks[requestId] = std::move(entry);
+		}
+	}
+}
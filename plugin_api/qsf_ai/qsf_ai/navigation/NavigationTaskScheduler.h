@@ -0,0 +1,218 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/NavigationTask.h"
+#include "qsf_ai/navigation/NavigationTaskStatistics.h"
+#include "qsf_ai/navigation/TimeHistogram.h"
+#include "qsf_ai/navigation/pathfinding/PathCache.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <deque>
+#include <map>
+
+namespace qsf
+{
+	class Transform;
+
+	namespace ai
+	{
+		class WorldModelManager;
+		class PathSearch;
+		class Path;
+
+
+		/**
+		* Executes navigation tasks on a pool of worker threads pulling from a shared priority queue.
+		* Tasks are ordered by priority class first and by the time they were scheduled second.
+		* Background tasks that waited longer than the aging time are preferred over all others so they can't starve.
+		*
+		* Tasks with shared access like path searches run concurrently, tasks with exclusive access like map updates are writers and run alone.
+		* Once an exclusive task is the next one to execute, no further tasks are started until the running ones are finished and the exclusive task is done.
+		* Tasks scheduled together with the ids of the navigation maps they use are executed while the scheduler holds the managed navigation map access for them,
+		* read access for shared and write access for exclusive tasks, so they are also synchronized with the game thread and other users of the maps.
+		* These tasks must not acquire the access to the same maps again, as a shared lock is not recursive while a writer is waiting.
+		* Tasks acquiring the access themselves, like the engine path searches and map updates, are scheduled without map ids.
+		*
+		* The workers are started with the first task scheduled, unless stop was called explicitly before.
+		*
+		* Path searches scheduled via schedulePathSearch consult an optional path cache first.
+		* Identical requests are answered from the cache or coalesced with a running search, their paths are fetched via tryFetchPath like the ones searched.
+		*
+		* A task that returns unfinished from execute, because it was interrupted, is put back to the end of its priority class to allow round robin scheduling of long searches.
+		* Finished tasks with a request id are kept until fetched, all others are destroyed immediately.
+		* All public functions are thread safe.
+		*/
+		class NavigationTaskScheduler : public boost::noncopyable
+		{
+		public:
+			// Priority classes in descending order
+			enum Priority
+			{
+				PLAYER_COMMANDED_PRIORITY, // Searches for units directly commanded by the player
+				AI_TRAFFIC_PRIORITY, // Searches for AI controlled units
+				BACKGROUND_PRIORITY, // Map updates and other tasks no one is directly waiting for
+				NUM_PRIORITIES
+			};
+
+			enum Access
+			{
+				SHARED_ACCESS, // Reads the navigation maps and may run concurrently with other shared tasks
+				EXCLUSIVE_ACCESS, // Changes the navigation maps and needs to run alone
+			};
+
+			// Priority searches are commanded by the player, other searches belong to the AI traffic and all other tasks are background tasks
+			static Priority getDefaultPriority(NavigationTask& task);
+			// Path searches read the maps while all other known task types change them
+			static Access getDefaultAccess(NavigationTask::Type type);
+
+			// The world model manager is needed for tasks scheduled with map ids, zero workers means using one worker less than the number of hardware threads but at least one
+			explicit NavigationTaskScheduler(WorldModelManager* worldModelManager = nullptr, uint32 numWorkers = 0, const Time& backgroundAgingTime = Time::fromSeconds(1.f));
+			~NavigationTaskScheduler(); // stops the workers and destroys all tasks
+
+			// Start the workers with the number passed in the constructor, does nothing if the workers are already running
+			void start();
+			// Stops and joins all workers after their current tasks are finished. Pending tasks are kept.
+			void stop();
+			bool isRunning() const;
+			uint32 getNumWorkers() const;
+
+			// Takes ownership of the task and schedules it for execution.
+			// The access to the maps with the ids passed is acquired while the task executes, at most two maps are supported like with the world model manager.
+			void schedule(std::unique_ptr<NavigationTask> task, Priority priority, Access access, const std::vector<unsigned int>& mapIds = std::vector<unsigned int>());
+			void schedule(std::unique_ptr<NavigationTask> task); // uses the default priority and access
+
+			/**
+			* Cancel the task with the request id passed, regardless of whether it is pending, running or finished.
+			* A running task is interrupted and failed and destroyed as soon as it returns.
+			* Returns false if there is no task with this id.
+			*/
+			bool cancel(unsigned int requestId);
+
+			// Path cache support
+			//@{
+			// The cache is not owned and needs to outlive the scheduler, a nullptr disables caching. Only exchange it while no path searches are scheduled
+			void setPathCache(PathCache* pathCache);
+
+			/**
+			* Schedules a path search with the default priority that may be answered from the path cache or coalesced with a running identical search.
+			* The world version is compared with the version the cached paths were found for, e.g. the snapshot version of WorldElementStateSnapshotPublisher for the primary map.
+			* Without a path cache or for searches that can't be cached this is the same as schedule with shared access.
+			* The search needs a request id since the path is only available via tryFetchPath.
+			*/
+			void schedulePathSearch(std::unique_ptr<PathSearch> search, unsigned int movementModeId, uint64 worldVersion, const std::vector<unsigned int>& mapIds = std::vector<unsigned int>());
+
+			/**
+			* Writes the path of a finished path search, regardless of whether it was searched, taken from the cache or shared by a coalesced search.
+			* Returns FINISHED if the path was written and the request is forgotten afterwards like with tryFetchFinishedTask.
+			* Returns FAILED if the search failed or the request is unknown and the current state in all other cases.
+			*/
+			process::State tryFetchPath(unsigned int requestId, const Transform& currentTransform, Path& path);
+			//@}
+
+			// Interrupt all running tasks with shared access so the workers continue with the next tasks in line, the interrupted tasks are put back into the queue
+			void interruptRunningTasks();
+
+			// Returns the state of the task with the request id passed or FAILED if there is no such task
+			process::State getTaskState(unsigned int requestId) const;
+			// Removes and returns the finished task with the request id passed, returns a nullptr if the task is unknown or not yet finished
+			std::unique_ptr<NavigationTask> tryFetchFinishedTask(unsigned int requestId);
+
+			// Destroys all pending and finished tasks, running tasks are canceled
+			void clear();
+
+			std::size_t getNumPendingTasks() const;
+			// Returns a copy of the statistics collected so far
+			NavigationTaskStatistics getStatistics() const;
+			// Returns copies of the distributions of the time tasks waited in the queue before being executed the first time and of the pure execution time of path searches
+			TimeHistogram getQueueLatencyHistogram() const;
+			TimeHistogram getSearchTimeHistogram() const;
+
+		private:
+			struct Entry
+			{
+				Entry(std::unique_ptr<NavigationTask> task, Priority priority, Access access, const std::vector<unsigned int>& mapIds);
+
+				std::unique_ptr<NavigationTask> mTask;
+				Priority mPriority;
+				Access mAccess;
+				std::vector<unsigned int> mMapIds; // Maps the scheduler acquires the access for while executing
+				Time mScheduledTime; // When the task was added to the queue the last time
+				bool mWasExecuted; // Whether the task was executed at least once, the queue latency is only tracked for the first execution
+				bool mCanceled; // Set while running, the worker destroys the task when it returns
+				bool mIsPathCacheLeader; // Whether the path cache waits for the result of this search
+			};
+
+			typedef std::deque<std::unique_ptr<Entry>> EntryQueue;
+			typedef std::map<unsigned int, std::unique_ptr<Entry>> FinishedEntryMap;
+			typedef std::map<unsigned int, std::deque<Waypoint>> SharedPathMap;
+
+			// Starts the workers if they are not running yet, mutex needs to be locked
+			void startWorkers();
+			// Main function of the worker threads
+			void executeTasks();
+			// Executes the task while holding the access to its maps, mutex must not be locked
+			process::State executeTask(Entry& entry);
+			// Removes a pending task and returns whether it was found, mutex needs to be locked
+			bool tryRemovePendingTask(unsigned int requestId);
+			// Removes a coalesced search or a shared path and returns whether it was found, mutex needs to be locked
+			bool tryRemovePathCacheRequest(unsigned int requestId);
+			// Returns the state of the task with the request id passed, mutex needs to be locked
+			process::State getTaskStateInternal(unsigned int requestId) const;
+			// Writes the waypoints found by a path search the cache waits for, returns false if there is no path. Mutex must not be locked
+			static bool tryWriteWaypointsFound(PathSearch& search, std::deque<Waypoint>& waypoints);
+			// Hands the result of a path search the cache waited for to the searches coalesced with it, pass a nullptr if it failed. Mutex needs to be locked
+			void onPathCacheLeaderDone(unsigned int requestId, const std::deque<Waypoint>* waypoints);
+			// Updates the scheduled counters when a task is finished or removed, mutex needs to be locked
+			void onTaskRemoved(const NavigationTask& task);
+			// Returns the queue containing the next task to execute or a nullptr if none is pending, mutex needs to be locked
+			EntryQueue* getNextQueue();
+			// Returns whether the next task may be started considering the access of the running tasks, mutex needs to be locked.
+			// Writes the queue the access was checked for, the task needs to be taken from exactly this queue.
+			bool canStartNextTask(EntryQueue*& selectedQueue);
+			// Updates the statistics after executing a task, mutex needs to be locked
+			void updateStatistics(const Entry& entry, process::State state, const Time& executionTime);
+			// Either requeues, stores or destroys the task after it was executed, mutex needs to be locked
+			void onTaskExecuted(std::unique_ptr<Entry> entry, process::State state, const std::deque<Waypoint>* waypointsFound);
+
+			WorldModelManager* mWorldModelManager;
+			const uint32 mNumWorkers;
+			const Time mBackgroundAgingTime;
+
+			EntryQueue mPendingTasks[NUM_PRIORITIES];
+			std::vector<Entry*> mRunningTasks; // Owned by the executing workers
+			FinishedEntryMap mFinishedTasks;
+			uint32 mNumRunningExclusiveTasks;
+
+			PathCache* mPathCache;
+			FinishedEntryMap mCoalescedSearches; // Waiting for the result of an identical search, request id acting as key
+			SharedPathMap mSharedPaths; // Taken from the cache or shared by a coalesced search, request id acting as key
+
+			NavigationTaskStatistics mStatistics;
+			TimeHistogram mQueueLatencyHistogram;
+			TimeHistogram mSearchTimeHistogram;
+
+			// Threading control
+			std::vector<std::thread> mWorkers;
+			mutable std::mutex mMutex; // Guards all data above
+			std::condition_variable mTaskStateChanged; // Signaled whenever a task may be started
+			bool mStopRequested; // Also keeps the workers from being started with the next task after an explicit stop
+		};
+	}
+}
+
+#include "qsf_ai/navigation/NavigationTaskScheduler-inl.h"
@@ -0,0 +1,77 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <algorithm>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline TimeHistogram::TimeHistogram()
+		{
+			clear();
+		}
+
+		inline void TimeHistogram::add(const Time& duration)
+		{
+			const int64 milliseconds = duration.getMilliseconds();
+			std::size_t bucket = 0;
+			while (bucket + 1 < NUM_BUCKETS && milliseconds >= (static_cast<int64>(1) << bucket))
+				++bucket;
+
+			++mCounts[bucket];
+		}
+
+		inline void TimeHistogram::clear()
+		{
+			std::fill(mCounts, mCounts + NUM_BUCKETS, 0);
+		}
+
+		inline uint32 TimeHistogram::getCount(std::size_t bucket) const
+		{
+			return mCounts[bucket];
+		}
+
+		inline uint32 TimeHistogram::getTotalCount() const
+		{
+			uint32 totalCount = 0;
+			for (std::size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+				totalCount += mCounts[bucket];
+
+			return totalCount;
+		}
+
+		inline Time TimeHistogram::getUpperBound(std::size_t bucket)
+		{
+			return Time::fromMilliseconds(static_cast<int64>(1) << bucket);
+		}
+
+		inline Time TimeHistogram::estimatePercentile(float percentile) const
+		{
+			const uint32 totalCount = getTotalCount();
+			if (totalCount == 0)
+				return Time::ZERO;
+
+			const uint32 requiredCount = std::max<uint32>(1, static_cast<uint32>(percentile * totalCount + 0.5f));
+			uint32 count = 0;
+			for (std::size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+			{
+				count += mCounts[bucket];
+				if (count >= requiredCount)
+					return getUpperBound(bucket);
+			}
+
+			return getUpperBound(NUM_BUCKETS - 1);
+		}
+	}
+}
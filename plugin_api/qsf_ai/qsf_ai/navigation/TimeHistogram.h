@@ -0,0 +1,50 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+#include <qsf/time/Time.h>
+
+#include <cstddef>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		/**
+		* Histogram of durations with logarithmic buckets.
+		* Bucket i counts the durations shorter than 2^i milliseconds that don't fit into a lower bucket, the last bucket counts all longer durations.
+		*/
+		class TimeHistogram
+		{
+		public:
+			static const std::size_t NUM_BUCKETS = 16;
+
+			TimeHistogram();
+
+			void add(const Time& duration);
+			void clear();
+
+			uint32 getCount(std::size_t bucket) const;
+			uint32 getTotalCount() const;
+			// Upper bound of the durations counted in a bucket, the last bucket has no real upper bound
+			static Time getUpperBound(std::size_t bucket);
+			// Returns the upper bound of the bucket containing the percentile passed, in range [0, 1]
+			Time estimatePercentile(float percentile) const;
+
+		private:
+			uint32 mCounts[NUM_BUCKETS];
+		};
+	}
+}
+
+#include "qsf_ai/navigation/TimeHistogram-inl.h"
@@ -0,0 +1,220 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/NavigationTask.h"
+#include "qsf_ai/navigation/pathfinding/PathSearchConfiguration.h"
+
+#include <qsf/base/GetUninitialized.h>
+
+#include <algorithm>
+#include <tuple>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline PathCache::Key::Key() :
+			mGoalTolerance(0.f),
+			mMoverType(getUninitialized<unsigned int>()),
+			mMovementModeId(getUninitialized<unsigned int>()),
+			mPrimaryMapId(getUninitialized<unsigned int>()),
+			mSecondaryMapId(getUninitialized<unsigned int>()),
+			mTurningRadius(0.f),
+			mLateralFreeSpace(0.f),
+			mMovementOptions(0)
+		{}
+
+		inline bool PathCache::Key::operator <(const Key& other) const
+		{
+			// Exact comparison by design, only identical requests may share their paths
+			return std::tie(mStartPosition.x, mStartPosition.y, mStartPosition.z, mStartOrientation.x, mStartOrientation.y, mStartOrientation.z, mStartOrientation.w,
+					mGoalPosition.x, mGoalPosition.y, mGoalPosition.z, mGoalTolerance, mMoverType, mMovementModeId, mPrimaryMapId, mSecondaryMapId, mTurningRadius, mLateralFreeSpace, mMovementOptions)
+				< std::tie(other.mStartPosition.x, other.mStartPosition.y, other.mStartPosition.z, other.mStartOrientation.x, other.mStartOrientation.y, other.mStartOrientation.z, other.mStartOrientation.w,
+					other.mGoalPosition.x, other.mGoalPosition.y, other.mGoalPosition.z, other.mGoalTolerance, other.mMoverType, other.mMovementModeId, other.mPrimaryMapId, other.mSecondaryMapId, other.mTurningRadius, other.mLateralFreeSpace, other.mMovementOptions);
+		}
+
+		inline PathCache::Statistics::Statistics() :
+			mNumHits(0),
+			mNumMisses(0),
+			mNumCoalescedRequests(0)
+		{}
+
+		inline float PathCache::Statistics::getHitRate() const
+		{
+			const uint32 numSharedResults = mNumHits + mNumCoalescedRequests;
+			const uint32 numLookups = numSharedResults + mNumMisses;
+			return (numLookups > 0) ? static_cast<float>(numSharedResults) / numLookups : 0.f;
+		}
+
+		inline PathCache::PathCache(std::size_t maxCachedPaths) :
+			mMaxCachedPaths(maxCachedPaths)
+		{}
+
+		inline bool PathCache::tryCreateKey(const PathSearchConfiguration& configuration, unsigned int movementModeId, Key& key) const
+		{
+			const NavigationGoal& goal = *configuration.mGoal;
+			if (goal.isTargetDynamic() || goal.getGoalConfigurations().size() != 1 || !configuration.mSearchStepsToIgnore.empty())
+				return false;
+
+			if (goal.getType() != NavigationGoal::ARRIVE_AT_STATIC_POSITION && goal.getType() != NavigationGoal::ARRIVE_AT_OBJECT_TARGET_POINT)
+				return false;
+
+			const logic::TargetPoint& target = goal.getGoalConfigurations().front().mTargetPoint;
+			key.mStartPosition = configuration.mStartPosition;
+			key.mStartOrientation = configuration.mStartOrientation;
+			key.mGoalPosition = target.mPosition;
+			key.mGoalTolerance = target.mTolerance;
+			key.mMoverType = configuration.mMoverType;
+			key.mMovementModeId = movementModeId;
+			key.mPrimaryMapId = configuration.mPrimaryMapId;
+			key.mSecondaryMapId = configuration.mSecondaryMapId;
+			key.mTurningRadius = configuration.mTurningConstraint.mTurningRadiusRequired;
+			key.mLateralFreeSpace = configuration.mTurningConstraint.mLateralFreeSpaceRequired;
+			key.mMovementOptions = configuration.mMovementOptions;
+			return true;
+		}
+
+		inline PathCache::LookupResult PathCache::lookup(const Key& key, uint64 worldVersion, unsigned int requestId, std::deque<Waypoint>& waypoints, unsigned int& leadingRequestId)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			const CachedPathMap::iterator cached = mCachedPathsByKey.find(key);
+			if (cached != mCachedPathsByKey.end())
+			{
+				if (cached->second->mWorldVersion == worldVersion)
+				{
+					// Move to the front to mark it as the most recently used
+					mCachedPaths.splice(mCachedPaths.begin(), mCachedPaths, cached->second);
+					waypoints = cached->second->mWaypoints;
+					++mStatistics.mNumHits;
+					return CACHE_HIT;
+				}
+
+				// Outdated
+				mCachedPaths.erase(cached->second);
+				mCachedPathsByKey.erase(cached);
+			}
+
+			const std::map<Key, unsigned int>::iterator leading = mLeadingRequestIds.find(key);
+			if (leading != mLeadingRequestIds.end())
+			{
+				RunningSearch& runningSearch = mRunningSearches.at(leading->second);
+				if (runningSearch.mWorldVersion == worldVersion)
+				{
+					runningSearch.mCoalescedRequestIds.push_back(requestId);
+					leadingRequestId = leading->second;
+					++mStatistics.mNumCoalescedRequests;
+					return COALESCED;
+				}
+			}
+
+			// Register as the new leading search, an older search for the same key is still finished but nothing is coalesced with it anymore
+			RunningSearch& runningSearch = mRunningSearches[requestId];
+			runningSearch.mKey = key;
+			runningSearch.mWorldVersion = worldVersion;
+			mLeadingRequestIds[key] = requestId;
+			++mStatistics.mNumMisses;
+			return SEARCH_REQUIRED;
+		}
+
+		inline void PathCache::onSearchFinished(unsigned int requestId, const std::deque<Waypoint>* waypoints, std::vector<unsigned int>& coalescedRequestIds)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			const RunningSearchMap::iterator runningSearch = mRunningSearches.find(requestId);
+			if (runningSearch == mRunningSearches.end())
+				return;
+
+			const Key& key = runningSearch->second.mKey;
+			const std::map<Key, unsigned int>::iterator leading = mLeadingRequestIds.find(key);
+			if (leading != mLeadingRequestIds.end() && leading->second == requestId)
+				mLeadingRequestIds.erase(leading);
+
+			if (nullptr != waypoints)
+				storePath(key, runningSearch->second.mWorldVersion, *waypoints);
+
+			coalescedRequestIds.insert(coalescedRequestIds.end(), runningSearch->second.mCoalescedRequestIds.begin(), runningSearch->second.mCoalescedRequestIds.end());
+			mRunningSearches.erase(runningSearch);
+		}
+
+		inline void PathCache::removeCoalescedRequest(unsigned int requestId)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			for (RunningSearchMap::value_type& runningSearch : mRunningSearches)
+			{
+				std::vector<unsigned int>& requestIds = runningSearch.second.mCoalescedRequestIds;
+				const std::vector<unsigned int>::iterator coalesced = std::find(requestIds.begin(), requestIds.end(), requestId);
+				if (coalesced != requestIds.end())
+				{
+					requestIds.erase(coalesced);
+					return;
+				}
+			}
+		}
+
+		inline void PathCache::invalidate()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mCachedPaths.clear();
+			mCachedPathsByKey.clear();
+		}
+
+		inline void PathCache::clear()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mCachedPaths.clear();
+			mCachedPathsByKey.clear();
+			mRunningSearches.clear();
+			mLeadingRequestIds.clear();
+		}
+
+		inline std::size_t PathCache::getNumCachedPaths() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mCachedPaths.size();
+		}
+
+		inline PathCache::Statistics PathCache::getStatistics() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mStatistics;
+		}
+
+		inline void PathCache::storePath(const Key& key, uint64 worldVersion, const std::deque<Waypoint>& waypoints)
+		{
+			if (mMaxCachedPaths == 0)
+				return;
+
+			const CachedPathMap::iterator cached = mCachedPathsByKey.find(key);
+			if (cached != mCachedPathsByKey.end())
+			{
+				mCachedPaths.erase(cached->second);
+				mCachedPathsByKey.erase(cached);
+			}
+			else if (mCachedPaths.size() >= mMaxCachedPaths)
+			{
+				// Evict the least recently used path
+				mCachedPathsByKey.erase(mCachedPaths.back().mKey);
+				mCachedPaths.pop_back();
+			}
+
+			mCachedPaths.emplace_front();
+			CachedPath& cachedPath = mCachedPaths.front();
+			cachedPath.mKey = key;
+			cachedPath.mWorldVersion = worldVersion;
+			cachedPath.mWaypoints = waypoints;
+			mCachedPathsByKey.emplace(key, mCachedPaths.begin());
+		}
+	}
+}
@@ -0,0 +1,160 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/Waypoint.h"
+
+#include <qsf/platform/PlatformTypes.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		class PathSearchConfiguration;
+
+		/**
+		* Cache for the results of path searches and registry of the searches currently running, to share the work between requests that are identical.
+		* This is typical when a group of entities waiting at the same spot is sent to the same target at the same time, or when a search is repeated unchanged.
+		*
+		* Requests are identified by a key containing the exact start position and orientation, the exact goal as well as all the mover specific options.
+		* A shared path therefore always starts and ends exactly where the request does, no waypoints need to be corrected.
+		* Only searches towards a single static target are considered.
+		* Each cached path is tagged with the world version it was found for and is discarded when looked up with a different version,
+		* e.g. the snapshot version of WorldElementStateSnapshotPublisher for the primary map.
+		*
+		* A search for a key that is already being searched for with the same world version is coalesced with the running search.
+		* It doesn't need to be executed and receives a copy of the result of the leading search instead.
+		* All functions are thread safe. See NavigationTaskScheduler::schedulePathSearch for the scheduling side.
+		*/
+		class PathCache : public boost::noncopyable
+		{
+		public:
+			static const std::size_t DEFAULT_MAX_CACHED_PATHS = 256;
+
+			// Identifies identical path search requests
+			struct Key
+			{
+				Key();
+
+				bool operator <(const Key& other) const;
+
+				glm::vec3 mStartPosition;
+				glm::quat mStartOrientation;
+				glm::vec3 mGoalPosition;
+				float mGoalTolerance;
+				unsigned int mMoverType;
+				unsigned int mMovementModeId;
+				unsigned int mPrimaryMapId;
+				unsigned int mSecondaryMapId;
+				float mTurningRadius;
+				float mLateralFreeSpace;
+				short mMovementOptions;
+			};
+
+			// Counters collected since the construction
+			struct Statistics
+			{
+				Statistics();
+
+				// Share of the cacheable requests that didn't need a search of their own, in range [0, 1]
+				float getHitRate() const;
+
+				uint32 mNumHits;
+				uint32 mNumMisses;
+				uint32 mNumCoalescedRequests; // Requests that shared the result of a running identical search
+			};
+
+			enum LookupResult
+			{
+				CACHE_HIT, // A cached path was written
+				COALESCED, // An identical search is running and the result will be shared
+				SEARCH_REQUIRED, // The request needs to be searched and is registered as the leading search for its key
+			};
+
+			explicit PathCache(std::size_t maxCachedPaths = DEFAULT_MAX_CACHED_PATHS);
+
+			// Returns false if the search can't be cached because its goal is dynamic or ambiguous or it uses search specific options like steps to ignore
+			bool tryCreateKey(const PathSearchConfiguration& configuration, unsigned int movementModeId, Key& key) const;
+
+			/**
+			* Look up a path for the request passed, either from the cache or from a running identical search.
+			* The waypoints are written in case of a cache hit and the leading request id in case of a coalesced request.
+			* Otherwise the request is expected to be searched and the client needs to call onSearchFinished when it is done.
+			*/
+			LookupResult lookup(const Key& key, uint64 worldVersion, unsigned int requestId, std::deque<Waypoint>& waypoints, unsigned int& leadingRequestId);
+
+			/**
+			* Report the end of a search that was registered during lookup.
+			* The waypoints are cached if a path was found, pass a nullptr if the search failed or was canceled.
+			* The requests coalesced with this search are written, in case of a failure they still need to be searched on their own.
+			*/
+			void onSearchFinished(unsigned int requestId, const std::deque<Waypoint>* waypoints, std::vector<unsigned int>& coalescedRequestIds);
+
+			// Stop waiting for a leading search, to be called when a coalesced request is canceled
+			void removeCoalescedRequest(unsigned int requestId);
+
+			// Discard all cached paths, for example after a navigation map was exchanged
+			void invalidate();
+			// Discard all cached paths and forget all running searches
+			void clear();
+
+			std::size_t getNumCachedPaths() const;
+			Statistics getStatistics() const;
+
+		private:
+			struct CachedPath
+			{
+				Key mKey;
+				uint64 mWorldVersion;
+				std::deque<Waypoint> mWaypoints;
+			};
+
+			struct RunningSearch
+			{
+				Key mKey;
+				uint64 mWorldVersion;
+				std::vector<unsigned int> mCoalescedRequestIds;
+			};
+
+			typedef std::list<CachedPath> CachedPathList; // Most recently used first
+			typedef std::map<Key, CachedPathList::iterator> CachedPathMap;
+			typedef std::map<unsigned int, RunningSearch> RunningSearchMap; // Request id of the leading search acting as key
+
+			// Mutex needs to be locked
+			void storePath(const Key& key, uint64 worldVersion, const std::deque<Waypoint>& waypoints);
+
+			const std::size_t mMaxCachedPaths;
+
+			CachedPathList mCachedPaths;
+			CachedPathMap mCachedPathsByKey;
+			RunningSearchMap mRunningSearches;
+			std::map<Key, unsigned int> mLeadingRequestIds; // Latest leading search for each key
+
+			Statistics mStatistics;
+
+			mutable std::mutex mMutex; // Guards all data above
+		};
+	}
+}
+
+#include "qsf_ai/navigation/pathfinding/PathCache-inl.h"
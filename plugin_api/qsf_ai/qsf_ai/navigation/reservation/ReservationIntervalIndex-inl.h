@@ -0,0 +1,185 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/log/LogSystem.h>
+
+#include <algorithm>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline ReservationIntervalIndex::ReservationIntervalIndex() :
+			mRootLevel(-1)
+		{}
+
+		inline void ReservationIntervalIndex::build(const ContainerType& reservations)
+		{
+			// A stable sort, so equal reservations keep their order
+			mReservations = reservations;
+			std::stable_sort(mReservations.begin(), mReservations.end(),
+				[](const Reservation& lhs, const Reservation& rhs) { return lhs.mBegin < rhs.mBegin; });
+			mRootLevel = calculateSubtreeEnds(mReservations, mSubtreeEnd);
+		}
+
+		inline void ReservationIntervalIndex::clear()
+		{
+			mReservations.clear();
+			mSubtreeEnd.clear();
+			mRootLevel = -1;
+		}
+
+		inline bool ReservationIntervalIndex::empty() const
+		{
+			return mReservations.empty();
+		}
+
+		inline size_t ReservationIntervalIndex::size() const
+		{
+			return mReservations.size();
+		}
+
+		inline ReservationIntervalIndex::const_iterator ReservationIntervalIndex::begin() const
+		{
+			return mReservations.begin();
+		}
+
+		inline ReservationIntervalIndex::const_iterator ReservationIntervalIndex::end() const
+		{
+			return mReservations.end();
+		}
+
+		inline const ReservationIntervalIndex::ContainerType& ReservationIntervalIndex::getReservations() const
+		{
+			return mReservations;
+		}
+
+		template <typename Function>
+		void ReservationIntervalIndex::forAllOverlapping(Time begin, Time end, Function function) const
+		{
+			if (mRootLevel < 0)
+				return;
+
+			struct StackEntry
+			{
+				size_t mNode;
+				int mLevel;
+				bool mLeftDone;
+			};
+
+			// Each level adds at most two entries, so this is enough for far more reservations than fit into memory
+			StackEntry stack[128];
+			int stackSize = 0;
+			const size_t numReservations = mReservations.size();
+
+			const StackEntry root = { (size_t(1) << mRootLevel) - 1, mRootLevel, false };
+			stack[stackSize++] = root;
+			while (stackSize > 0)
+			{
+				const StackEntry entry = stack[--stackSize];
+				if (entry.mLevel <= LINEAR_SCAN_LEVEL)
+				{
+					// Small subtree, scan its reservations in order until they begin after the query
+					const size_t first = entry.mNode >> entry.mLevel << entry.mLevel;
+					const size_t last = std::min(first + (size_t(1) << (entry.mLevel + 1)) - 1, numReservations);
+					for (size_t i = first; i < last && mReservations[i].mBegin <= end; ++i)
+					{
+						if (mReservations[i].mEnd >= begin)
+							function(mReservations.begin() + i);
+					}
+				}
+				else if (!entry.mLeftDone)
+				{
+					// Revisit this node after its left subtree, which is skipped if everything in there ends before the query
+					const StackEntry revisit = { entry.mNode, entry.mLevel, true };
+					stack[stackSize++] = revisit;
+
+					const size_t leftChild = entry.mNode - (size_t(1) << (entry.mLevel - 1));
+					if (leftChild >= numReservations || mSubtreeEnd[leftChild] >= begin)
+					{
+						const StackEntry left = { leftChild, entry.mLevel - 1, false };
+						stack[stackSize++] = left;
+					}
+				}
+				else if (entry.mNode < numReservations && mReservations[entry.mNode].mBegin <= end)
+				{
+					// The right subtree only begins later, so it is only worth a look if this node does not begin after the query
+					if (mReservations[entry.mNode].mEnd >= begin)
+						function(mReservations.begin() + entry.mNode);
+
+					const StackEntry right = { entry.mNode + (size_t(1) << (entry.mLevel - 1)), entry.mLevel - 1, false };
+					stack[stackSize++] = right;
+				}
+			}
+		}
+
+		inline bool ReservationIntervalIndex::verifyOrdering() const
+		{
+			for (size_t i = 1; i < mReservations.size(); ++i)
+			{
+				if (mReservations[i].mBegin < mReservations[i - 1].mBegin)
+					return false;
+			}
+
+			std::vector<Time> subtreeEnd;
+			return (calculateSubtreeEnds(mReservations, subtreeEnd) == mRootLevel && subtreeEnd == mSubtreeEnd);
+		}
+
+		inline size_t ReservationIntervalIndex::getMemoryConsumption() const
+		{
+			return mReservations.capacity() * sizeof(Reservation) + mSubtreeEnd.capacity() * sizeof(Time);
+		}
+
+		inline void ReservationIntervalIndex::logMemoryConsumption() const
+		{
+			QSF_LOG_PRINTS(INFO, "Reservation interval index with " << mReservations.size() << " reservations uses " << getMemoryConsumption() << " bytes, "
+				<< mSubtreeEnd.capacity() * sizeof(Time) << " of them for the subtree end times");
+		}
+
+		inline int ReservationIntervalIndex::calculateSubtreeEnds(const ContainerType& reservations, std::vector<Time>& subtreeEnd)
+		{
+			const size_t numReservations = reservations.size();
+			subtreeEnd.resize(numReservations);
+			if (numReservations == 0)
+				return -1;
+
+			// Leaves are the even indices. The last node may be missing children beyond the end of the array,
+			// those are substituted by the latest end time found so far along the right border of the tree.
+			size_t lastNode = 0;
+			Time lastEnd;
+			for (size_t i = 0; i < numReservations; i += 2)
+			{
+				lastNode = i;
+				subtreeEnd[i] = lastEnd = reservations[i].mEnd;
+			}
+
+			int level = 1;
+			for (; (size_t(1) << level) <= numReservations; ++level)
+			{
+				const size_t childOffset = size_t(1) << (level - 1);
+				for (size_t i = (childOffset << 1) - 1; i < numReservations; i += childOffset << 2)
+				{
+					const Time& leftEnd = subtreeEnd[i - childOffset];
+					const Time& rightEnd = (i + childOffset < numReservations) ? subtreeEnd[i + childOffset] : lastEnd;
+					subtreeEnd[i] = std::max(reservations[i].mEnd, std::max(leftEnd, rightEnd));
+				}
+
+				// Move up to the parent of the last node
+				lastNode = ((lastNode >> level) & 1) ? lastNode - childOffset : lastNode + childOffset;
+				if (lastNode < numReservations && subtreeEnd[lastNode] > lastEnd)
+					lastEnd = subtreeEnd[lastNode];
+			}
+			return level - 1;
+		}
+	}
+}
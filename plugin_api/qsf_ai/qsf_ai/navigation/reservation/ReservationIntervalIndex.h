@@ -0,0 +1,79 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/reservation/Reservation.h"
+
+#include <vector>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		/** Interval tree over the time spans of the reservations of a single area, built from a copy of them.
+		* The index doesn't replace the storage of ReservationContainer, which the engine keeps as plain vector per area.
+		* It's meant for code that tests many reservations against the same area, e.g. long lanes with many vehicles, and builds it once from the reservations it has at hand.
+		* The reservations are copied into a vector sorted by begin time. The vector itself is the tree:
+		* the element at index i with k trailing one bits is a node on level k whose children are at i - 2^(k-1) and i + 2^(k-1),
+		* a parallel array stores the latest end time inside the subtree of each node.
+		* An overlap query thereby only descends into subtrees that may contain a match and takes O(log n + number of matches)
+		* instead of testing every reservation of the area. Building the index sorts the copy and calculates the subtree end times in a single pass.
+		*/
+		class ReservationIntervalIndex
+		{
+		public:
+			typedef std::vector<Reservation> ContainerType; // Same as ReservationContainer::SingleAreaReservations
+			typedef ContainerType::const_iterator const_iterator;
+
+			ReservationIntervalIndex();
+
+			// Replace the indexed reservations by a copy of the ones passed, e.g. the reservations of one area of a ReservationContainer
+			void build(const ContainerType& reservations);
+			void clear();
+
+			// Access to the indexed reservations, ordered by begin time
+			//@{
+			bool empty() const;
+			size_t size() const;
+			const_iterator begin() const;
+			const_iterator end() const;
+			const ContainerType& getReservations() const;
+			//@}
+
+			// Calls function(const_iterator) for each reservation intersecting [begin, end] in the sense of Reservation::intersect, ordered by begin time
+			template <typename Function>
+			void forAllOverlapping(Time begin, Time end, Function function) const;
+
+			// Sanity check - verifies the ordering and the subtree end times
+			bool verifyOrdering() const;
+
+			// Heap memory used by the reservations and the index in bytes
+			size_t getMemoryConsumption() const;
+			// logs memory consumption, the owner of the index calls it next to ReservationSystem::logMemoryConsumption which doesn't know about the index
+			void logMemoryConsumption() const;
+
+		private:
+			// Subtrees up to this level are scanned linearly, they hold at most 15 reservations
+			static const int LINEAR_SCAN_LEVEL = 3;
+
+			// Calculates the latest end time per subtree for reservations sorted by begin time and returns the level of the root node
+			static int calculateSubtreeEnds(const ContainerType& reservations, std::vector<Time>& subtreeEnd);
+
+			ContainerType mReservations;
+			std::vector<Time> mSubtreeEnd; // latest end time inside the subtree of the node at the same index
+			int mRootLevel; // level of the root node, -1 if there are no reservations
+		};
+	}
+}
+
+//inline implementations
+#include "qsf_ai/navigation/reservation/ReservationIntervalIndex-inl.h"
@@ -0,0 +1,143 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <algorithm>
+#include <cmath>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			inline KinematicNeighbourGrid::KinematicNeighbourGrid(float cellSize, uint32 maximumCellsPerAxis) :
+				mConfiguredCellSize(std::max(cellSize, 0.1f)),
+				mMaximumCellsPerAxis(std::max(maximumCellsPerAxis, 1u)),
+				mGridOrigin(0.f, 0.f),
+				mCellSize(mConfiguredCellSize),
+				mNumCellsX(0),
+				mNumCellsZ(0),
+				mMaximumFootprintRadius(0.f)
+			{}
+
+			inline void KinematicNeighbourGrid::clear()
+			{
+				mAddedAgents.clear();
+				mAgents.clear();
+				mCellStart.clear();
+				mNumCellsX = 0;
+				mNumCellsZ = 0;
+				mMaximumFootprintRadius = 0.f;
+			}
+
+			inline void KinematicNeighbourGrid::addAgent(uint64 entityId, const glm::vec3& position, const glm::vec3& velocity, float footprintRadius, short collisionMask, const MovableComponent* movable)
+			{
+				const Agent agent = { entityId, position, velocity, footprintRadius, collisionMask, movable };
+				mAddedAgents.push_back(agent);
+				mMaximumFootprintRadius = std::max(mMaximumFootprintRadius, footprintRadius);
+			}
+
+			inline void KinematicNeighbourGrid::build()
+			{
+				const uint32 numAgents = static_cast<uint32>(mAddedAgents.size());
+
+				// Grid covering the bounds of all agents
+				glm::vec2 minimum(0.f, 0.f);
+				glm::vec2 maximum(0.f, 0.f);
+				if (numAgents > 0)
+				{
+					minimum = maximum = glm::vec2(mAddedAgents[0].mPosition.x, mAddedAgents[0].mPosition.z);
+					for (const Agent& agent : mAddedAgents)
+					{
+						minimum = glm::min(minimum, glm::vec2(agent.mPosition.x, agent.mPosition.z));
+						maximum = glm::max(maximum, glm::vec2(agent.mPosition.x, agent.mPosition.z));
+					}
+				}
+				const glm::vec2 extent = maximum - minimum;
+				mGridOrigin = minimum;
+
+				// Cells smaller than an agent would only make the queries visit more cells
+				mCellSize = std::max(std::max(mConfiguredCellSize, 2.f * mMaximumFootprintRadius), std::max(extent.x, extent.y) / static_cast<float>(mMaximumCellsPerAxis));
+				mNumCellsX = std::min(static_cast<uint32>(extent.x / mCellSize) + 1, mMaximumCellsPerAxis);
+				mNumCellsZ = std::min(static_cast<uint32>(extent.y / mCellSize) + 1, mMaximumCellsPerAxis);
+
+				// Counting sort by cell
+				const uint32 numCells = mNumCellsX * mNumCellsZ;
+				mCellStart.assign(numCells + 1, 0);
+				mCellOfAgent.resize(numAgents);
+				for (uint32 i = 0; i < numAgents; ++i)
+				{
+					const glm::vec3& position = mAddedAgents[i].mPosition;
+					mCellOfAgent[i] = getCellCoordinate(position.z, mGridOrigin.y, mNumCellsZ) * mNumCellsX + getCellCoordinate(position.x, mGridOrigin.x, mNumCellsX);
+					++mCellStart[mCellOfAgent[i] + 1];
+				}
+				for (uint32 cell = 0; cell < numCells; ++cell)
+					mCellStart[cell + 1] += mCellStart[cell];
+
+				mAgents.resize(numAgents);
+				for (uint32 i = 0; i < numAgents; ++i)
+				{
+					// mCellStart[cell] is used as insert position and restored afterwards by shifting
+					mAgents[mCellStart[mCellOfAgent[i]]++] = mAddedAgents[i];
+				}
+				for (uint32 cell = numCells; cell > 0; --cell)
+					mCellStart[cell] = mCellStart[cell - 1];
+				mCellStart[0] = 0;
+			}
+
+			inline uint32 KinematicNeighbourGrid::getNumAgents() const
+			{
+				return static_cast<uint32>(mAgents.size());
+			}
+
+			inline float KinematicNeighbourGrid::getMaximumFootprintRadius() const
+			{
+				return mMaximumFootprintRadius;
+			}
+
+			template <typename Function>
+			void KinematicNeighbourGrid::forAllAgentsInRange(const glm::vec3& position, float range, Function function) const
+			{
+				if (mAgents.empty())
+					return;
+
+				// Agents are binned by their center, so the footprint of the largest agent widens the covered area
+				const float reach = range + mMaximumFootprintRadius;
+				const float minimumX = std::floor((position.x - reach - mGridOrigin.x) / mCellSize);
+				const float maximumX = std::floor((position.x + reach - mGridOrigin.x) / mCellSize);
+				const float minimumZ = std::floor((position.z - reach - mGridOrigin.y) / mCellSize);
+				const float maximumZ = std::floor((position.z + reach - mGridOrigin.y) / mCellSize);
+				if (maximumX < 0.f || maximumZ < 0.f || minimumX >= static_cast<float>(mNumCellsX) || minimumZ >= static_cast<float>(mNumCellsZ))
+					return;
+
+				const uint32 firstX = static_cast<uint32>(std::max(minimumX, 0.f));
+				const uint32 lastX = static_cast<uint32>(std::min(maximumX, static_cast<float>(mNumCellsX - 1)));
+				const uint32 firstZ = static_cast<uint32>(std::max(minimumZ, 0.f));
+				const uint32 lastZ = static_cast<uint32>(std::min(maximumZ, static_cast<float>(mNumCellsZ - 1)));
+				for (uint32 cellZ = firstZ; cellZ <= lastZ; ++cellZ)
+				{
+					// The cells of a row are contiguous, so the covered part of the row is a single range of agents
+					const uint32 rowStart = cellZ * mNumCellsX;
+					const uint32 last = mCellStart[rowStart + lastX + 1];
+					for (uint32 i = mCellStart[rowStart + firstX]; i < last; ++i)
+						function(mAgents[i]);
+				}
+			}
+
+			inline uint32 KinematicNeighbourGrid::getCellCoordinate(float coordinate, float origin, uint32 numCells) const
+			{
+				return std::min(static_cast<uint32>(std::max(coordinate - origin, 0.f) / mCellSize), numCells - 1);
+			}
+		}
+	}
+}
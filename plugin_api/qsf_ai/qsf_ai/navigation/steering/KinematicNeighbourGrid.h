@@ -0,0 +1,98 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <glm/glm.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class MovableComponent;
+}
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			/**
+			* Per tick snapshot of all moving agents, binned into a uniform grid on the xz-plane.
+			* Built once per tick from the movable components with their positions, velocities and footprint radii, usually by the NeighbourGridAvoidance job,
+			* so agent versus agent collision tests become a grid lookup instead of one Bullet ghost object and convex sweep per agent.
+			* Usage per tick: clear, addAgent for each agent, build, then any number of forAllAgentsInRange queries.
+			* The agents of a cell are stored contiguously, a query visits only the cells overlapping its range.
+			*/
+			class KinematicNeighbourGrid : public boost::noncopyable
+			{
+			public:
+				struct Agent
+				{
+					uint64 mEntityId;
+					glm::vec3 mPosition;
+					glm::vec3 mVelocity;
+					float mFootprintRadius;
+					short mCollisionMask;
+					const MovableComponent* mMovable; // valid during the tick the grid was built in
+				};
+
+				// The cell size is raised automatically to the largest footprint diameter and to keep at most maximumCellsPerAxis cells along an axis.
+				explicit KinematicNeighbourGrid(float cellSize = 10.f, uint32 maximumCellsPerAxis = 512);
+
+				// Remove all agents, the allocated memory is kept
+				void clear();
+
+				// Call build after adding all agents and before the queries
+				//@{
+				void addAgent(uint64 entityId, const glm::vec3& position, const glm::vec3& velocity, float footprintRadius, short collisionMask, const MovableComponent* movable);
+				void build();
+				//@}
+
+				uint32 getNumAgents() const;
+				float getMaximumFootprintRadius() const;
+
+				// Calls function(const Agent&) for each agent whose footprint may reach into the circle on the xz-plane around position.
+				// This is a grid cell test only, the caller does the exact test.
+				template <typename Function>
+				void forAllAgentsInRange(const glm::vec3& position, float range, Function function) const;
+
+			private:
+				uint32 getCellCoordinate(float coordinate, float origin, uint32 numCells) const;
+
+				float mConfiguredCellSize;
+				uint32 mMaximumCellsPerAxis;
+
+				std::vector<Agent> mAddedAgents;
+				std::vector<Agent> mAgents; // sorted by cell
+				std::vector<uint32> mCellStart; // first sorted agent of each cell, one more entry than cells
+				std::vector<uint32> mCellOfAgent; // only used inside build, kept to avoid reallocations
+
+				glm::vec2 mGridOrigin;
+				float mCellSize;
+				uint32 mNumCellsX;
+				uint32 mNumCellsZ;
+				float mMaximumFootprintRadius;
+			};
+		}
+	}
+}
+
+#include "qsf_ai/navigation/steering/KinematicNeighbourGrid-inl.h"
@@ -0,0 +1,185 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/MovementMode.h"
+#include "qsf_ai/navigation/NavigationComponent.h"
+
+#include <qsf/base/error/ErrorHandling.h>
+#include <qsf/component/move/MovableComponent.h>
+#include <qsf/map/Map.h>
+#include <qsf/map/query/ComponentMapQuery.h>
+#include <qsf/serialization/binary/BinarySerializer.h>
+#include <qsf/serialization/binary/BoostTypeSerialization.h>
+
+#include <glm/glm.hpp>
+
+#include <boost/bind.hpp>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			inline NeighbourGridAvoidance::NeighbourGridAvoidance(Map& map, const SpeedLimitFunctor* wrappedSpeedLimitFunctor, const StringHash& jobManagerId, float cellSize) :
+				mMap(map),
+				mWrappedSpeedLimitFunctor(wrappedSpeedLimitFunctor),
+				mQueryRange(15.f),
+				mDistanceToKeepBetween(.5f),
+				mNeighbourGrid(cellSize)
+			{
+				mJobProxy.registerAt(jobManagerId, boost::bind(&NeighbourGridAvoidance::updateJob, this, _1));
+			}
+
+			inline NeighbourGridAvoidance::~NeighbourGridAvoidance()
+			{
+				mJobProxy.unregister();
+			}
+
+			inline bool NeighbourGridAvoidance::isUsedForMovementMode(unsigned int movementModeId) const
+			{
+				return (mMovementModeIds.count(movementModeId) > 0);
+			}
+
+			inline void NeighbourGridAvoidance::setUsedForMovementMode(unsigned int movementModeId, bool used)
+			{
+				if (used)
+					mMovementModeIds.insert(movementModeId);
+				else
+					mMovementModeIds.erase(movementModeId);
+			}
+
+			inline bool NeighbourGridAvoidance::isSelectedFor(const NavigationComponent& navi) const
+			{
+				const MovementMode* movementMode = navi.tryGetMovementMode();
+				return (nullptr != movementMode && isUsedForMovementMode(movementMode->mId));
+			}
+
+			inline UnsignedFloat NeighbourGridAvoidance::getQueryRange() const
+			{
+				return mQueryRange;
+			}
+
+			inline void NeighbourGridAvoidance::setQueryRange(UnsignedFloat range)
+			{
+				mQueryRange = range;
+			}
+
+			inline UnsignedFloat NeighbourGridAvoidance::getDistanceToKeepBetween() const
+			{
+				return mDistanceToKeepBetween;
+			}
+
+			inline void NeighbourGridAvoidance::setDistanceToKeepBetween(UnsignedFloat distance)
+			{
+				mDistanceToKeepBetween = distance;
+			}
+
+			inline void NeighbourGridAvoidance::rebuild()
+			{
+				mNeighbourGrid.clear();
+				if (mMovementModeIds.empty())
+					return;
+
+				// Skip the snapshot completely while no agent uses a selected movement mode
+				const ComponentCollection::ComponentList<NavigationComponent>& navis = ComponentMapQuery(mMap).getAllInstances<NavigationComponent>();
+				bool isUsed = false;
+				for (const NavigationComponent* navi : navis)
+				{
+					if (navi->isActive() && isSelectedFor(*navi))
+					{
+						isUsed = true;
+						break;
+					}
+				}
+				if (!isUsed)
+					return;
+
+				for (const NavigationComponent* navi : navis)
+				{
+					const MovableComponent* movable = navi->tryGetMovableComponent();
+					if (nullptr != movable && navi->isActive())
+					{
+						mNeighbourGrid.addAgent(navi->getEntityId(), movable->getPosition(), movable->getVelocity(),
+							NeighbourGridCollisionAggregator::getFootprintRadius(*navi), navi->getCollisionMask(), movable);
+					}
+				}
+				mNeighbourGrid.build();
+			}
+
+			inline const KinematicNeighbourGrid& NeighbourGridAvoidance::getNeighbourGrid() const
+			{
+				return mNeighbourGrid;
+			}
+
+			inline boost::optional<NeighbourGridCollisionAggregator::ProjectedCollision> NeighbourGridAvoidance::findMostCriticalCollision(const NavigationComponent& navi) const
+			{
+				const MovableComponent* movable = navi.tryGetMovableComponent();
+				if (nullptr == movable || 0 == mNeighbourGrid.getNumAgents())
+					return boost::none;
+
+				NeighbourGridCollisionAggregator aggregator(mNeighbourGrid, *movable, navi, NeighbourGridCollisionAggregator::getFootprintRadius(navi), mQueryRange, mDistanceToKeepBetween);
+				aggregator.processCollisions();
+				return aggregator.getMostCriticalCollision();
+			}
+
+			inline void NeighbourGridAvoidance::serialize(BinarySerializer& serializer)
+			{
+				uint32 formatVersion = FORMAT_VERSION;
+				serializer & formatVersion;
+				QSF_CHECK(formatVersion == FORMAT_VERSION, "Unsupported neighbour grid avoidance format version " << formatVersion << ", expected " << static_cast<uint32>(FORMAT_VERSION),
+					QSF_REACT_THROW);
+
+				serializer & mMovementModeIds;
+				serializer & mQueryRange;
+				serializer & mDistanceToKeepBetween;
+			}
+
+			inline float NeighbourGridAvoidance::getMinimumBrakingFactor()
+			{
+				return 0.1f;
+			}
+
+			inline float NeighbourGridAvoidance::getBrakingFactor(Time timeToCollide)
+			{
+				// Slow down linearly the closer the collision is in time, down to a crawl once it is imminent.
+				// Never down to standing still, the other agent might be just as stuck otherwise.
+				const float brakingFactor = timeToCollide.getSeconds() / NeighbourGridCollisionAggregator::getLookaheadWhileStandingStill().getSeconds();
+				return glm::clamp(brakingFactor, getMinimumBrakingFactor(), 1.f);
+			}
+
+			inline UnsignedFloat NeighbourGridAvoidance::getSpeedFor(const NavigationComponent& navi, UnsignedFloat speedLimit) const
+			{
+				const UnsignedFloat wrappedSpeedLimit = (nullptr != mWrappedSpeedLimitFunctor) ? mWrappedSpeedLimitFunctor->getSpeedFor(navi, speedLimit) : speedLimit;
+				if (!isSelectedFor(navi))
+					return wrappedSpeedLimit;
+
+				const boost::optional<NeighbourGridCollisionAggregator::ProjectedCollision> collision = findMostCriticalCollision(navi);
+				if (!collision)
+					return wrappedSpeedLimit;
+
+				return UnsignedFloat(static_cast<float>(wrappedSpeedLimit) * getBrakingFactor(collision->mTimeToCollide));
+			}
+
+			inline UnsignedFloat NeighbourGridAvoidance::getHaltingDistanceBefore(const NavigationComponent& navi, Entity& other, UnsignedFloat defaultDistance) const
+			{
+				return (nullptr != mWrappedSpeedLimitFunctor) ? mWrappedSpeedLimitFunctor->getHaltingDistanceBefore(navi, other, defaultDistance) : defaultDistance;
+			}
+
+			inline void NeighbourGridAvoidance::updateJob(const JobArguments&)
+			{
+				rebuild();
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/base/UnsignedFloat.h"
+#include "qsf_ai/navigation/steering/KinematicNeighbourGrid.h"
+#include "qsf_ai/navigation/steering/NeighbourGridCollisionAggregator.h"
+#include "qsf_ai/navigation/steering/SpeedLimitFunctor.h"
+#include "qsf_ai/plugin/Jobs.h"
+
+#include <qsf/base/StringHash.h>
+#include <qsf/job/JobProxy.h>
+
+#include <boost/container/flat_set.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Map;
+	class JobArguments;
+	class BinarySerializer;
+}
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			/**
+			* Agent versus agent avoidance through a shared KinematicNeighbourGrid, owned by a plugin and selected per movement mode.
+			* Once per update of a job manager the grid is rebuilt from the movable components of all active navigation components, as long as at least one of them
+			* uses a selected movement mode. Agents on such a mode brake in front of the most critical projected collision the NeighbourGridCollisionAggregator finds in the grid.
+			*
+			* The steering system takes it as its speed limit functor, any speed limit functor set before is wrapped and asked first.
+			* Agents on other movement modes only get the speed of the wrapped functor, as does the halting distance for all agents.
+			* The movement modes selected are kept here by id and serialized with a format version of their own, the movement modes themselves are not changed.
+			* The collision checks of the steering system itself including its Bullet queries are left as they are.
+			* Usage, e.g. inside a plugin during the simulation:
+			* @code
+			*   mNeighbourGridAvoidance.reset(new qsf::ai::steering::NeighbourGridAvoidance(QSF_MAINMAP, gameSpeedLimitFunctor));
+			*   mNeighbourGridAvoidance->setUsedForMovementMode(crowdMovementModeId, true);
+			*   qsf::ai::SteeringSystem::getInstance(QSF_MAINMAP).setSpeedLimitFunctor(mNeighbourGridAvoidance.get());
+			* @endcode
+			*/
+			class NeighbourGridAvoidance : public SpeedLimitFunctor, public boost::noncopyable
+			{
+			public:
+				// Increase this every time the serialized data changes
+				static const uint32 FORMAT_VERSION = 1;
+
+				// Share of the speed limit an agent keeps even in front of an imminent collision, so agents which got too close can still crawl apart
+				static float getMinimumBrakingFactor();
+				// Share of the speed limit left in front of a collision in the time given, linear over the lookahead while standing still
+				static float getBrakingFactor(Time timeToCollide);
+
+				// The map needs to outlive the instance, the job rebuilding the grid is registered at the job manager passed right away.
+				// The wrapped speed limit functor may be a nullptr and is not owned.
+				NeighbourGridAvoidance(Map& map, const SpeedLimitFunctor* wrappedSpeedLimitFunctor = nullptr, const StringHash& jobManagerId = Jobs::SIMULATION_AI, float cellSize = 10.f);
+				virtual ~NeighbourGridAvoidance();
+
+				// Selection of the movement modes by id
+				//@{
+				bool isUsedForMovementMode(unsigned int movementModeId) const;
+				void setUsedForMovementMode(unsigned int movementModeId, bool used);
+				// Returns whether the current movement mode of the navigation component is selected
+				bool isSelectedFor(const NavigationComponent& navi) const;
+				//@}
+
+				// Get / set the distance in front of an agent looked at for collisions and the gap kept in addition to the footprints
+				//@{
+				UnsignedFloat getQueryRange() const;
+				void setQueryRange(UnsignedFloat range);
+				UnsignedFloat getDistanceToKeepBetween() const;
+				void setDistanceToKeepBetween(UnsignedFloat distance);
+				//@}
+
+				// Refill the grid right away, this is what the job does. The grid stays empty as long as no active agent uses a selected movement mode.
+				void rebuild();
+				const KinematicNeighbourGrid& getNeighbourGrid() const;
+
+				// Most critical projected collision of the agent with other agents in the grid, regardless of its movement mode
+				boost::optional<NeighbourGridCollisionAggregator::ProjectedCollision> findMostCriticalCollision(const NavigationComponent& navi) const;
+
+				// Serializes the movement mode selection and the settings
+				void serialize(BinarySerializer& serializer);
+
+				// Public virtual qsf::ai::SpeedLimitFunctor methods
+				//@{
+				virtual UnsignedFloat getSpeedFor(const NavigationComponent& navi, UnsignedFloat speedLimit) const override;
+				virtual UnsignedFloat getHaltingDistanceBefore(const NavigationComponent& navi, Entity& other, UnsignedFloat defaultDistance) const override;
+				//@}
+
+			private:
+				void updateJob(const JobArguments& jobArguments);
+
+				Map& mMap;
+				const SpeedLimitFunctor* mWrappedSpeedLimitFunctor; // optional, may be a nullptr
+				boost::container::flat_set<unsigned int> mMovementModeIds;
+				UnsignedFloat mQueryRange;
+				UnsignedFloat mDistanceToKeepBetween;
+				KinematicNeighbourGrid mNeighbourGrid;
+
+				JobProxy mJobProxy; // Regular job calling rebuild
+			};
+		}
+	}
+}
+
+#include "qsf_ai/navigation/steering/NeighbourGridAvoidance-inl.h"
@@ -0,0 +1,63 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			inline bool NeighbourGridAvoidanceTest::Result::isSuccess() const
+			{
+				return (mStationaryOverlappingIgnored && mStationaryFacingCrawls && mParallelIgnored && mMovingApartIgnored && mClosingInDetected);
+			}
+
+			inline NeighbourGridAvoidanceTest::Result NeighbourGridAvoidanceTest::run()
+			{
+				// Two agents with a footprint radius of 0.5 and a gap of 0.5 to keep, one meter apart on the x-axis
+				const float combinedRadius = 1.5f;
+				const float lookaheadSeconds = NeighbourGridCollisionAggregator::getLookaheadWhileStandingStill().getSeconds();
+				const glm::vec2 towardsOther(1.f, 0.f);
+				const glm::vec2 standingStill(0.f, 0.f);
+				const glm::vec2 facingSideways(0.f, 1.f);
+				float timeToCollide = -1.f;
+
+				Result result;
+
+				// Both standing still, facing sideways respectively away from each other
+				result.mStationaryOverlappingIgnored =
+					!NeighbourGridCollisionAggregator::calculateTimeToCollide(towardsOther, standingStill, standingStill, facingSideways, combinedRadius, lookaheadSeconds, timeToCollide) &&
+					!NeighbourGridCollisionAggregator::calculateTimeToCollide(-towardsOther, standingStill, standingStill, towardsOther, combinedRadius, lookaheadSeconds, timeToCollide);
+
+				// Standing still facing the other agent is a collision right away, but the agent is still allowed to crawl
+				timeToCollide = -1.f;
+				result.mStationaryFacingCrawls =
+					NeighbourGridCollisionAggregator::calculateTimeToCollide(towardsOther, standingStill, standingStill, towardsOther, combinedRadius, lookaheadSeconds, timeToCollide) &&
+					timeToCollide == 0.f && NeighbourGridAvoidance::getBrakingFactor(Time::fromSeconds(timeToCollide)) > 0.f;
+
+				// Side by side, both moving along the z-axis at the same speed
+				const glm::vec2 forwardVelocity(0.f, 2.f);
+				result.mParallelIgnored =
+					!NeighbourGridCollisionAggregator::calculateTimeToCollide(towardsOther, standingStill, forwardVelocity, facingSideways, combinedRadius, lookaheadSeconds, timeToCollide) &&
+					!NeighbourGridCollisionAggregator::calculateTimeToCollide(-towardsOther, standingStill, forwardVelocity, facingSideways, combinedRadius, lookaheadSeconds, timeToCollide);
+
+				// The own agent standing still facing sideways while the other one walks away
+				result.mMovingApartIgnored = !NeighbourGridCollisionAggregator::calculateTimeToCollide(towardsOther, towardsOther, standingStill, facingSideways, combinedRadius, lookaheadSeconds, timeToCollide);
+
+				// The other agent walks towards the own one
+				timeToCollide = -1.f;
+				result.mClosingInDetected =
+					NeighbourGridCollisionAggregator::calculateTimeToCollide(towardsOther, -towardsOther, standingStill, facingSideways, combinedRadius, lookaheadSeconds, timeToCollide) &&
+					timeToCollide == 0.f;
+
+				return result;
+			}
+		}
+	}
+}
@@ -0,0 +1,50 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/navigation/steering/NeighbourGridAvoidance.h"
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			/**
+			* Self test of the collision prediction and braking of the NeighbourGridAvoidance for agents which are already closer than their footprints and the gap to keep.
+			* Only the math on the xz-plane is tested, no map or components are needed. Usage, e.g. from a debug command of a plugin:
+			* @code
+			*   const qsf::ai::steering::NeighbourGridAvoidanceTest::Result result = qsf::ai::steering::NeighbourGridAvoidanceTest::run();
+			*   QSF_LOG_PRINTS(INFO, "Neighbour grid avoidance test " << (result.isSuccess() ? "passed" : "failed"));
+			* @endcode
+			*/
+			class NeighbourGridAvoidanceTest
+			{
+			public:
+				struct Result
+				{
+					bool mStationaryOverlappingIgnored; // two agents standing around overlapping and facing away from each other don't block each other
+					bool mStationaryFacingCrawls; // an agent standing overlapping and facing the other one brakes but keeps a crawl speed
+					bool mParallelIgnored; // two agents side by side with the same velocity don't block each other
+					bool mMovingApartIgnored; // two overlapping agents moving apart don't block each other
+					bool mClosingInDetected; // two overlapping agents closing in further collide right away
+
+					bool isSuccess() const;
+				};
+
+				static Result run();
+			};
+		}
+	}
+}
+
+#include "qsf_ai/navigation/steering/NeighbourGridAvoidanceTest-inl.h"
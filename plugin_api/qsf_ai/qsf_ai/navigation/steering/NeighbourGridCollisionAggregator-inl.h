@@ -0,0 +1,167 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/base/Math.h"
+
+#include <qsf/physics/collision/CollisionComponent.h>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			inline NeighbourGridCollisionAggregator::NeighbourGridCollisionAggregator(const KinematicNeighbourGrid& neighbourGrid, const MovableComponent& queryMovable,
+				const NavigationComponent& queryNavi, float queryFootprintRadius, UnsignedFloat queryRange, UnsignedFloat distanceToKeepBetween) :
+				mNeighbourGrid(neighbourGrid),
+				mQueryMovableComponent(queryMovable),
+				mQueryNavigationComponent(queryNavi),
+				mQueryFootprintRadius(queryFootprintRadius),
+				mQueryRange(queryRange),
+				mDistanceToKeepBetween(distanceToKeepBetween)
+			{}
+
+			inline void NeighbourGridCollisionAggregator::processCollisions()
+			{
+				mMostCriticalCollision.reset();
+
+				// Look ahead as far as the query range reaches at the current speed
+				const float ownSpeed = glm::length(mQueryMovableComponent.getVelocity());
+				const Time lookahead = (ownSpeed > 0.01f) ? Time::fromSeconds(static_cast<float>(mQueryRange) / ownSpeed) : getLookaheadWhileStandingStill();
+
+				const uint64 ownEntityId = mQueryNavigationComponent.getEntityId();
+				const short typesToAvoid = mQueryNavigationComponent.getCollisionTypesToAvoid();
+				mNeighbourGrid.forAllAgentsInRange(mQueryMovableComponent.getPosition(), static_cast<float>(mQueryRange) + static_cast<float>(mDistanceToKeepBetween) + mQueryFootprintRadius,
+					[&](const KinematicNeighbourGrid::Agent& other)
+				{
+					if (other.mEntityId == ownEntityId || (other.mCollisionMask & typesToAvoid) == 0 || nullptr == other.mMovable)
+						return;
+
+					considerCollision(other, lookahead);
+				});
+			}
+
+			inline const boost::optional<NeighbourGridCollisionAggregator::ProjectedCollision>& NeighbourGridCollisionAggregator::getMostCriticalCollision() const
+			{
+				return mMostCriticalCollision;
+			}
+
+			inline float NeighbourGridCollisionAggregator::getFootprintRadius(const NavigationComponent& navi, float fallbackRadius)
+			{
+				const CollisionComponent* collisionComponent = navi.tryGetCollisionComponent();
+				if (nullptr == collisionComponent)
+					return fallbackRadius;
+
+				// The extensions are full side lengths, the footprint circle encloses the ground rectangle
+				glm::vec3 anchorPoint;
+				glm::quat rotation;
+				glm::vec3 extensions;
+				if (collisionComponent->getAsOrientedBoundingBox(anchorPoint, rotation, extensions))
+					return 0.5f * glm::length(glm::vec2(extensions.x, extensions.z));
+
+				glm::vec3 center;
+				float radius = 0.f;
+				if (collisionComponent->getAsSphere(center, radius))
+					return radius;
+
+				return fallbackRadius;
+			}
+
+			inline bool NeighbourGridCollisionAggregator::calculateTimeToCollide(const glm::vec2& relativePosition, const glm::vec2& relativeVelocity, const glm::vec2& ownVelocity,
+				const glm::vec2& ownHeading, float combinedRadius, float lookaheadSeconds, float& timeToCollide)
+			{
+				// Agents completely behind are their own problem while they move towards us, like with the forward sweep of Bullet
+				if (glm::dot(relativePosition, ownVelocity) < -combinedRadius * glm::length(ownVelocity))
+					return false;
+
+				const float b = glm::dot(relativePosition, relativeVelocity);
+				const float c = glm::dot(relativePosition, relativePosition) - combinedRadius * combinedRadius;
+				if (c <= 0.f)
+				{
+					// Already too close, this is only a collision while closing in further or heading right at the other agent.
+					// Agents side by side, moving apart or standing around close to each other must not block each other.
+					const float headingAtOtherCosine = 0.7071f; // other agent within 45 degrees of the own heading
+					const float distance = std::sqrt(glm::dot(relativePosition, relativePosition));
+					const bool isClosingIn = (b < 0.f);
+					const bool isHeadingAtOther = (distance > 1e-4f && glm::dot(relativePosition, ownHeading) > headingAtOtherCosine * distance);
+					if (!isClosingIn && !isHeadingAtOther)
+						return false;
+
+					timeToCollide = 0.f;
+					return true;
+				}
+
+				// Relative motion on the xz-plane, solve |relativePosition + relativeVelocity * t| = combinedRadius for the earliest t
+				const float a = glm::dot(relativeVelocity, relativeVelocity);
+				if (a < 1e-6f || b >= 0.f)
+					return false; // not closing in
+
+				const float discriminant = b * b - a * c;
+				if (discriminant < 0.f)
+					return false; // passing each other without coming closer than the combined radius
+
+				timeToCollide = (-b - std::sqrt(discriminant)) / a;
+				return (timeToCollide <= lookaheadSeconds);
+			}
+
+			inline Time NeighbourGridCollisionAggregator::getLookaheadWhileStandingStill()
+			{
+				return Time::fromSeconds(2.f);
+			}
+
+			inline void NeighbourGridCollisionAggregator::considerCollision(const KinematicNeighbourGrid::Agent& other, Time lookahead)
+			{
+				const glm::vec3& ownPosition = mQueryMovableComponent.getPosition();
+				const glm::vec3& ownVelocity = mQueryMovableComponent.getVelocity();
+				if (std::abs(other.mPosition.y - ownPosition.y) > static_cast<float>(MAXIMUM_VERTICAL_DISTANCE))
+					return;
+
+				// Heading along the velocity while moving, else the facing of the agent
+				const glm::vec2 ownPlanarVelocity(ownVelocity.x, ownVelocity.z);
+				glm::vec2 ownHeading = ownPlanarVelocity;
+				if (glm::length(ownHeading) < 0.01f)
+				{
+					const glm::vec3 facing = convertQuaternionToDirectionVector(mQueryMovableComponent.getRotation());
+					ownHeading = glm::vec2(facing.x, facing.z);
+				}
+				const float headingLength = glm::length(ownHeading);
+				ownHeading = (headingLength > 1e-4f) ? ownHeading / headingLength : glm::vec2(0.f, 0.f);
+
+				const glm::vec2 relativePosition(other.mPosition.x - ownPosition.x, other.mPosition.z - ownPosition.z);
+				const glm::vec2 relativeVelocity(other.mVelocity.x - ownVelocity.x, other.mVelocity.z - ownVelocity.z);
+				const float combinedRadius = mQueryFootprintRadius + other.mFootprintRadius + static_cast<float>(mDistanceToKeepBetween);
+				float timeToCollide = 0.f;
+				if (!calculateTimeToCollide(relativePosition, relativeVelocity, ownPlanarVelocity, ownHeading, combinedRadius, lookahead.getSeconds(), timeToCollide))
+					return;
+
+				if (mMostCriticalCollision && mMostCriticalCollision->mTimeToCollide.getSeconds() <= timeToCollide)
+					return;
+
+				// Collision position on our own footprint at the time of the collision
+				const glm::vec3 ownPositionAtCollision = ownPosition + ownVelocity * timeToCollide;
+				const glm::vec3 otherPositionAtCollision = other.mPosition + other.mVelocity * timeToCollide;
+				glm::vec3 towardsOther = otherPositionAtCollision - ownPositionAtCollision;
+				towardsOther.y = 0.f;
+				const float distance = glm::length(towardsOther);
+				const glm::vec3 collisionPosition = (distance > 1e-4f) ? ownPositionAtCollision + towardsOther * (mQueryFootprintRadius / distance) : ownPositionAtCollision;
+
+				const ProjectedCollision collision = { other.mEntityId, other.mMovable, Time::fromSeconds(timeToCollide), collisionPosition };
+				mMostCriticalCollision = collision;
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/base/UnsignedFloat.h"
+#include "qsf_ai/navigation/NavigationComponent.h"
+#include "qsf_ai/navigation/steering/KinematicNeighbourGrid.h"
+
+#include <qsf/component/move/MovableComponent.h>
+#include <qsf/time/Time.h>
+
+#include <boost/optional.hpp>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		namespace steering
+		{
+			/**
+			* Provides functions to iterate over all agents close by in the KinematicNeighbourGrid and keep track of the most critical projected collision among them.
+			* Grid counterpart of the BulletCollisionAggregator for agent versus agent collisions, used by the NeighbourGridAvoidance.
+			* Both agents are treated as discs with their footprint radius moving linearly with their current velocity,
+			* the earliest time their distance falls below the sum of the radii and the distance to keep is the projected collision.
+			* The velocity already carries the direction, so moving backwards needs no special handling here.
+			* Static geometry is not part of the grid and stays the job of Bullet.
+			*/
+			class NeighbourGridCollisionAggregator
+			{
+			public:
+				struct ProjectedCollision
+				{
+					uint64 mEntityId;
+					const MovableComponent* mMovable; // valid during the tick the grid was built in
+					Time mTimeToCollide; // relative to the time the grid was built, zero if the agents already overlap and close in further or one heads at the other
+					glm::vec3 mCollisionPosition; // on the own footprint at the time of the collision
+				};
+
+				NeighbourGridCollisionAggregator(const KinematicNeighbourGrid& neighbourGrid, const MovableComponent& queryMovable, const NavigationComponent& queryNavi,
+					float queryFootprintRadius, UnsignedFloat queryRange, UnsignedFloat distanceToKeepBetween);
+
+				// Main function doing the real work, the result is available via getMostCriticalCollision afterwards
+				void processCollisions();
+
+				// The earliest projected collision found by processCollisions, if any
+				const boost::optional<ProjectedCollision>& getMostCriticalCollision() const;
+
+				// Footprint radius on the xz-plane as used for the grid, derived from the oriented bounding box of the collision or a fallback value
+				static float getFootprintRadius(const NavigationComponent& navi, float fallbackRadius = 0.5f);
+
+				// Core test on the xz-plane with positions and velocities of the other agent relative to the own ones, the own heading is normalized.
+				// Returns whether the agents collide within the lookahead and writes the time to collide, zero if they are already too close.
+				// Agents already closer than the combined radius only collide while closing in further or while the own heading points at the other agent.
+				static bool calculateTimeToCollide(const glm::vec2& relativePosition, const glm::vec2& relativeVelocity, const glm::vec2& ownVelocity, const glm::vec2& ownHeading,
+					float combinedRadius, float lookaheadSeconds, float& timeToCollide);
+
+				// Time to look ahead while standing still
+				static Time getLookaheadWhileStandingStill();
+
+			private:
+				// Keep a single agent as most critical collision if it collides earlier within the lookahead time
+				void considerCollision(const KinematicNeighbourGrid::Agent& other, Time lookahead);
+
+				// Agents further apart vertically are on different levels, e.g. on a bridge above
+				static const int MAXIMUM_VERTICAL_DISTANCE = 3;
+
+				const KinematicNeighbourGrid& mNeighbourGrid;
+				const MovableComponent& mQueryMovableComponent;
+				const NavigationComponent& mQueryNavigationComponent;
+				const float mQueryFootprintRadius;
+				const UnsignedFloat mQueryRange;
+				const UnsignedFloat mDistanceToKeepBetween;
+				boost::optional<ProjectedCollision> mMostCriticalCollision;
+			};
+		}
+	}
+}
+
+#include "qsf_ai/navigation/steering/NeighbourGridCollisionAggregator-inl.h"
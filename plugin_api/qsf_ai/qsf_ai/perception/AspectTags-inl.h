@@ -34,6 +34,11 @@ namespace qsf
 			return mTagHashs.size();
 		}
 
+		inline const UsuallySmallArray<uint32,size_t,4>& AspectTags::getTagHashs() const
+		{
+			return mTagHashs;
+		}
+
 //[-------------------------------------------------------]
 //[ Namespace                                             ]
 //[-------------------------------------------------------]
@@ -85,6 +85,15 @@ namespace qsf
 			void setTags(const std::string& tags);
 			//@}
 
+			/**
+			*  @brief
+			*    Return the string hashes of the tags, sorted in ascending order
+			*
+			*  @remarks
+			*    Direct access for code that needs the tags as numbers, e.g. to map them to bit masks for a broadphase
+			*/
+			const UsuallySmallArray<uint32,size_t,4>& getTagHashs() const;
+
 
 		//[-------------------------------------------------------]
 		//[ Private data                                          ]
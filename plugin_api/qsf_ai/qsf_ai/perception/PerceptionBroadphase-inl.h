@@ -0,0 +1,326 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <algorithm>
+#include <cmath>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline PerceptionBroadphase::PerceptionBroadphase(float cellSize, uint32 maximumCellsPerAxis) :
+			mConfiguredCellSize(std::max(cellSize, 0.01f)),
+			mMaximumCellsPerAxis(std::max<uint32>(maximumCellsPerAxis, 1)),
+			mGridOrigin(0.0f, 0.0f),
+			mCellSize(mConfiguredCellSize),
+			mNumCellsX(1),
+			mNumCellsZ(1),
+			mCellStart(2, 0),
+			mNumExecutedQueries(0)
+		{
+		}
+
+		inline void PerceptionBroadphase::clear()
+		{
+			mAddedEntityIds.clear();
+			mAddedPositions.clear();
+			mAddedTagMasks.clear();
+			mAddedTagRanges.clear();
+			mAddedTagHashs.clear();
+			mQueries.clear();
+			mNumExecutedQueries = 0;
+			mResults.clear();
+		}
+
+		inline void PerceptionBroadphase::addAspect(uint64 entityId, const glm::vec3& position, const AspectTags& aspectTags)
+		{
+			mAddedEntityIds.push_back(entityId);
+			mAddedPositions.push_back(position);
+			mAddedTagMasks.push_back(getTagMask(aspectTags));
+
+			const UsuallySmallArray<uint32,size_t,4>& tagHashs = aspectTags.getTagHashs();
+			const TagRange tagRange = { static_cast<uint32>(mAddedTagHashs.size()), static_cast<uint32>(tagHashs.size()) };
+			mAddedTagRanges.push_back(tagRange);
+			for (size_t i = 0; i < tagHashs.size(); ++i)
+			{
+				mAddedTagHashs.push_back(tagHashs[i]);
+			}
+		}
+
+		inline void PerceptionBroadphase::build()
+		{
+			const uint32 numAspects = static_cast<uint32>(mAddedEntityIds.size());
+
+			// Grid covering the bounds of all aspects
+			glm::vec2 minimum(0.0f, 0.0f);
+			glm::vec2 maximum(0.0f, 0.0f);
+			if (numAspects > 0)
+			{
+				minimum = maximum = glm::vec2(mAddedPositions[0].x, mAddedPositions[0].z);
+				for (const glm::vec3& position : mAddedPositions)
+				{
+					minimum = glm::min(minimum, glm::vec2(position.x, position.z));
+					maximum = glm::max(maximum, glm::vec2(position.x, position.z));
+				}
+			}
+			const glm::vec2 extent = maximum - minimum;
+			mGridOrigin = minimum;
+			mCellSize = std::max(mConfiguredCellSize, std::max(extent.x, extent.y) / static_cast<float>(mMaximumCellsPerAxis));
+			mNumCellsX = std::min(static_cast<uint32>(extent.x / mCellSize) + 1, mMaximumCellsPerAxis);
+			mNumCellsZ = std::min(static_cast<uint32>(extent.y / mCellSize) + 1, mMaximumCellsPerAxis);
+
+			// Counting sort by cell, cells are ordered row by row so the cells of a row are contiguous
+			const uint32 numCells = mNumCellsX * mNumCellsZ;
+			mCellStart.assign(numCells + 1, 0);
+			mCellOfAspect.resize(numAspects);
+			for (uint32 i = 0; i < numAspects; ++i)
+			{
+				const glm::vec3& position = mAddedPositions[i];
+				const uint32 cellX = std::min(static_cast<uint32>((position.x - mGridOrigin.x) / mCellSize), mNumCellsX - 1);
+				const uint32 cellZ = std::min(static_cast<uint32>((position.z - mGridOrigin.y) / mCellSize), mNumCellsZ - 1);
+				mCellOfAspect[i] = cellZ * mNumCellsX + cellX;
+				++mCellStart[mCellOfAspect[i] + 1];
+			}
+			for (uint32 cell = 0; cell < numCells; ++cell)
+			{
+				mCellStart[cell + 1] += mCellStart[cell];
+			}
+
+			mX.resize(numAspects);
+			mY.resize(numAspects);
+			mZ.resize(numAspects);
+			mEntityIds.resize(numAspects);
+			mTagMasks.resize(numAspects);
+			mTagRanges.resize(numAspects);
+			mInsertPosition.assign(mCellStart.begin(), mCellStart.end() - 1);
+			for (uint32 i = 0; i < numAspects; ++i)
+			{
+				const uint32 sortedIndex = mInsertPosition[mCellOfAspect[i]]++;
+				mX[sortedIndex] = mAddedPositions[i].x;
+				mY[sortedIndex] = mAddedPositions[i].y;
+				mZ[sortedIndex] = mAddedPositions[i].z;
+				mEntityIds[sortedIndex] = mAddedEntityIds[i];
+				mTagMasks[sortedIndex] = mAddedTagMasks[i];
+				mTagRanges[sortedIndex] = mAddedTagRanges[i];
+			}
+		}
+
+		inline uint32 PerceptionBroadphase::getNumAspects() const
+		{
+			return static_cast<uint32>(mEntityIds.size());
+		}
+
+		inline uint32 PerceptionBroadphase::addQuery(uint64 perceiverId, const glm::vec3& position, float radius, const AspectTags& sensorTags, const glm::vec3& direction, float cosHalfAngle)
+		{
+			Query query;
+			query.mPosition = position;
+			query.mRadius = radius;
+			query.mDirection = direction;
+			query.mCosHalfAngle = cosHalfAngle;
+			query.mPerceiverId = perceiverId;
+			query.mTagMask = getTagMask(sensorTags);
+			query.mSensorTags = &sensorTags;
+			query.mFirstResult = 0;
+			query.mNumResults = 0;
+			mQueries.push_back(query);
+			return static_cast<uint32>(mQueries.size() - 1);
+		}
+
+		inline void PerceptionBroadphase::executeQueries()
+		{
+			for (; mNumExecutedQueries < mQueries.size(); ++mNumExecutedQueries)
+			{
+				executeQuery(mQueries[mNumExecutedQueries]);
+			}
+		}
+
+		inline uint32 PerceptionBroadphase::getNumQueries() const
+		{
+			return static_cast<uint32>(mQueries.size());
+		}
+
+		inline void PerceptionBroadphase::getResults(uint32 queryIndex, const Candidate*& begin, const Candidate*& end) const
+		{
+			const Query& query = mQueries[queryIndex];
+			begin = mResults.data() + query.mFirstResult;
+			end = begin + query.mNumResults;
+		}
+
+		inline bool PerceptionBroadphase::matches(const AspectTags& sensorTags, const AspectTags& aspectTags)
+		{
+			if (0 == sensorTags.getNumTags())
+				return true;
+
+			const UsuallySmallArray<uint32,size_t,4>& aspectTagHashs = aspectTags.getTagHashs();
+			return (aspectTagHashs.size() > 0 && sharesTagHash(sensorTags.getTagHashs(), &aspectTagHashs[0], static_cast<uint32>(aspectTagHashs.size())));
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline uint64 PerceptionBroadphase::getTagMask(const AspectTags& aspectTags)
+		{
+			const UsuallySmallArray<uint32,size_t,4>& tagHashs = aspectTags.getTagHashs();
+			uint64 tagMask = 0;
+			for (size_t i = 0; i < tagHashs.size(); ++i)
+			{
+				uint32 bit = static_cast<uint32>(mTagBits.size());
+				const auto iterator = mTagBits.find(tagHashs[i]);
+				if (iterator != mTagBits.end())
+				{
+					bit = iterator->second;
+				}
+				else
+				{
+					if (bit > OVERFLOW_TAG_BIT)
+						bit = OVERFLOW_TAG_BIT;
+					mTagBits.emplace(tagHashs[i], bit);
+				}
+				tagMask |= (uint64(1) << bit);
+			}
+			return tagMask;
+		}
+
+		inline void PerceptionBroadphase::executeQuery(Query& query)
+		{
+			query.mFirstResult = static_cast<uint32>(mResults.size());
+			query.mNumResults = 0;
+			if (mEntityIds.empty() || query.mRadius < 0.0f)
+				return;
+
+			// Covered cells, skip queries completely outside of the grid
+			const float gridSizeX = static_cast<float>(mNumCellsX) * mCellSize;
+			const float gridSizeZ = static_cast<float>(mNumCellsZ) * mCellSize;
+			const float minimumX = query.mPosition.x - query.mRadius - mGridOrigin.x;
+			const float maximumX = query.mPosition.x + query.mRadius - mGridOrigin.x;
+			const float minimumZ = query.mPosition.z - query.mRadius - mGridOrigin.y;
+			const float maximumZ = query.mPosition.z + query.mRadius - mGridOrigin.y;
+			if (maximumX < 0.0f || maximumZ < 0.0f || minimumX > gridSizeX || minimumZ > gridSizeZ)
+				return;
+
+			const uint32 firstCellX = static_cast<uint32>(std::max(minimumX, 0.0f) / mCellSize);
+			const uint32 lastCellX = std::min(static_cast<uint32>(std::min(maximumX, gridSizeX) / mCellSize), mNumCellsX - 1);
+			const uint32 firstCellZ = static_cast<uint32>(std::max(minimumZ, 0.0f) / mCellSize);
+			const uint32 lastCellZ = std::min(static_cast<uint32>(std::min(maximumZ, gridSizeZ) / mCellSize), mNumCellsZ - 1);
+			for (uint32 cellZ = firstCellZ; cellZ <= lastCellZ; ++cellZ)
+			{
+				const uint32 rowStart = cellZ * mNumCellsX;
+				testRange(query, mCellStart[rowStart + firstCellX], mCellStart[rowStart + lastCellX + 1]);
+			}
+
+			query.mNumResults = static_cast<uint32>(mResults.size()) - query.mFirstResult;
+			std::sort(mResults.begin() + query.mFirstResult, mResults.end(), [](const Candidate& left, const Candidate& right) { return left.mEntityId < right.mEntityId; });
+		}
+
+		inline void PerceptionBroadphase::testRange(const Query& query, uint32 first, uint32 last)
+		{
+			const float radiusSquared = query.mRadius * query.mRadius;
+			const bool useCone = (query.mCosHalfAngle > -1.0f);
+			uint32 i = first;
+
+			#ifdef QSF_AI_PERCEPTION_BROADPHASE_SSE2
+				const __m128 positionX = _mm_set1_ps(query.mPosition.x);
+				const __m128 positionY = _mm_set1_ps(query.mPosition.y);
+				const __m128 positionZ = _mm_set1_ps(query.mPosition.z);
+				const __m128 directionX = _mm_set1_ps(query.mDirection.x);
+				const __m128 directionY = _mm_set1_ps(query.mDirection.y);
+				const __m128 directionZ = _mm_set1_ps(query.mDirection.z);
+				const __m128 cosHalfAngle = _mm_set1_ps(query.mCosHalfAngle);
+				const __m128 radiusSquared4 = _mm_set1_ps(radiusSquared);
+				for (; i + 4 <= last; i += 4)
+				{
+					const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&mX[i]), positionX);
+					const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&mY[i]), positionY);
+					const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&mZ[i]), positionZ);
+					const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+					__m128 inside = _mm_cmple_ps(distanceSquared, radiusSquared4);
+					if (useCone)
+					{
+						// dot(offset, direction) >= cos(halfAngle) * |offset|
+						const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, directionX), _mm_mul_ps(dy, directionY)), _mm_mul_ps(dz, directionZ));
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(dot, _mm_mul_ps(cosHalfAngle, _mm_sqrt_ps(distanceSquared))));
+					}
+
+					int mask = _mm_movemask_ps(inside);
+					if (0 != mask)
+					{
+						float distancesSquared[4];
+						_mm_storeu_ps(distancesSquared, distanceSquared);
+						for (uint32 lane = 0; mask != 0; ++lane, mask >>= 1)
+						{
+							if (mask & 1)
+								testAspect(query, i + lane, distancesSquared[lane]);
+						}
+					}
+				}
+			#endif
+
+			// Remaining aspects, or all of them without SSE2
+			for (; i < last; ++i)
+			{
+				const glm::vec3 offset(mX[i] - query.mPosition.x, mY[i] - query.mPosition.y, mZ[i] - query.mPosition.z);
+				const float distanceSquared = glm::dot(offset, offset);
+				if (distanceSquared <= radiusSquared && (!useCone || glm::dot(offset, query.mDirection) >= query.mCosHalfAngle * std::sqrt(distanceSquared)))
+				{
+					testAspect(query, i, distanceSquared);
+				}
+			}
+		}
+
+		inline void PerceptionBroadphase::testAspect(const Query& query, uint32 aspectIndex, float distanceSquared)
+		{
+			if (mEntityIds[aspectIndex] == query.mPerceiverId)
+				return;
+
+			if (0 != query.mTagMask)
+			{
+				const uint64 sharedTags = (query.mTagMask & mTagMasks[aspectIndex]);
+				if (0 == sharedTags)
+					return;
+
+				// A match only through the shared overflow bit may be a false one
+				const TagRange& tagRange = mTagRanges[aspectIndex];
+				if (sharedTags == (uint64(1) << OVERFLOW_TAG_BIT) && !sharesTagHash(query.mSensorTags->getTagHashs(), mAddedTagHashs.data() + tagRange.mFirst, tagRange.mCount))
+					return;
+			}
+
+			const Candidate candidate = { mEntityIds[aspectIndex], distanceSquared };
+			mResults.push_back(candidate);
+		}
+
+		inline bool PerceptionBroadphase::sharesTagHash(const UsuallySmallArray<uint32,size_t,4>& sensorTagHashs, const uint32* aspectTagHashs, uint32 numAspectTagHashs)
+		{
+			// Both lists are sorted, so walk them in parallel
+			size_t sensorIndex = 0;
+			uint32 aspectIndex = 0;
+			while (sensorIndex < sensorTagHashs.size() && aspectIndex < numAspectTagHashs)
+			{
+				if (sensorTagHashs[sensorIndex] < aspectTagHashs[aspectIndex])
+					++sensorIndex;
+				else if (aspectTagHashs[aspectIndex] < sensorTagHashs[sensorIndex])
+					++aspectIndex;
+				else
+					return true;
+			}
+			return false;
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
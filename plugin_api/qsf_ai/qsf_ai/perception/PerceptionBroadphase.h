@@ -0,0 +1,200 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/AspectTags.h"
+
+#include <qsf/platform/PlatformTypes.h>
+
+#include <glm/glm.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define QSF_AI_PERCEPTION_BROADPHASE_SSE2
+#endif
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Per tick broadphase answering the range queries of many sensors against all aspects at once.
+		*
+		*    Usage per tick:
+		*    - clear, addAspect for each AspectComponent, build
+		*    - addQuery for each sensor configuration, executeQueries
+		*    - read the candidates per query with getResults
+		*    The PerceptionBroadphaseUpdater does the first step once per tick for all AspectComponents of a map.
+		*
+		*    The aspects are binned into a uniform grid on the xz-plane, sorted by cell and stored as structure of arrays,
+		*    so the cells of one grid row covered by a query are a single contiguous range which is tested four aspects at a time.
+		*    Each distinct aspect tag gets a bit, so the tag test is a single mask test; from the 64th distinct tag on
+		*    all tags share the last bit and matches through this bit are confirmed with the tag hashes of both sides.
+		*    The candidates per query are sorted by entity ID, which makes the results independent of the insertion order.
+		*
+		*    Line of sight is not checked, this stays the job of the sensor configuration for the candidates found here.
+		*/
+		class PerceptionBroadphase : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			struct Candidate
+			{
+				uint64 mEntityId;
+				float mDistanceSquared;
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			// The cell size is raised automatically if the aspects cover more than maximumCellsPerAxis cells along an axis.
+			explicit PerceptionBroadphase(float cellSize = 20.0f, uint32 maximumCellsPerAxis = 256);
+
+			// Remove all aspects and queries, the tag bits and the allocated memory are kept.
+			void clear();
+
+			// Aspects, call build after adding all of them and before executing queries.
+			// The tag hashes of the aspects are copied, so the aspect tags don't need to outlive the call.
+			//@{
+			void addAspect(uint64 entityId, const glm::vec3& position, const AspectTags& aspectTags);
+			void build();
+			uint32 getNumAspects() const;
+			//@}
+
+			// Queries, addQuery returns the index of the query to access its results after executeQueries.
+			// executeQueries only executes the queries added since its last call, so queries can be answered in one batch
+			// or one at a time, e.g. from within the update of a single sensor.
+			// Sensors with an empty tag list match every aspect, like AspectTags::matches does.
+			// The optional cone is given by a normalized direction and the cosine of its half angle, a cosine of -1 means a full sphere.
+			// The perceiver itself is never part of its results.
+			//@{
+			uint32 addQuery(uint64 perceiverId, const glm::vec3& position, float radius, const AspectTags& sensorTags, const glm::vec3& direction = glm::vec3(0.0f, 0.0f, 1.0f), float cosHalfAngle = -1.0f);
+			void executeQueries();
+			uint32 getNumQueries() const;
+			void getResults(uint32 queryIndex, const Candidate*& begin, const Candidate*& end) const;
+			//@}
+
+			// Same result as AspectTags::matches called on the sensor tags, but compiled inline
+			static bool matches(const AspectTags& sensorTags, const AspectTags& aspectTags);
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			static const uint32 OVERFLOW_TAG_BIT = 63;
+
+			// Range of the tag hashes of an aspect inside mAddedTagHashs
+			struct TagRange
+			{
+				uint32 mFirst;
+				uint32 mCount;
+			};
+
+			struct Query
+			{
+				glm::vec3 mPosition;
+				float mRadius;
+				glm::vec3 mDirection;
+				float mCosHalfAngle;
+				uint64 mPerceiverId;
+				uint64 mTagMask; // 0 means the sensor matches all aspects
+				const AspectTags* mSensorTags; // only used to confirm matches through the overflow bit, valid until executeQueries
+				uint32 mFirstResult;
+				uint32 mNumResults;
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			uint64 getTagMask(const AspectTags& aspectTags);
+			void executeQuery(Query& query);
+
+			// Test the aspects [first, last) of the sorted arrays and append the matching ones to mResults
+			void testRange(const Query& query, uint32 first, uint32 last);
+			void testAspect(const Query& query, uint32 aspectIndex, float distanceSquared);
+
+			// Whether both sorted hash lists share at least one hash
+			static bool sharesTagHash(const UsuallySmallArray<uint32,size_t,4>& sensorTagHashs, const uint32* aspectTagHashs, uint32 numAspectTagHashs);
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			float mConfiguredCellSize;
+			uint32 mMaximumCellsPerAxis;
+			std::unordered_map<uint32, uint32> mTagBits; // tag hash -> bit index
+
+			// Aspects as added
+			std::vector<uint64> mAddedEntityIds;
+			std::vector<glm::vec3> mAddedPositions;
+			std::vector<uint64> mAddedTagMasks;
+			std::vector<TagRange> mAddedTagRanges;
+			std::vector<uint32> mAddedTagHashs; // only needed to confirm matches through the overflow bit
+
+			// Aspects sorted by grid cell, structure of arrays for the range tests
+			std::vector<float> mX;
+			std::vector<float> mY;
+			std::vector<float> mZ;
+			std::vector<uint64> mEntityIds;
+			std::vector<uint64> mTagMasks;
+			std::vector<TagRange> mTagRanges;
+
+			// Grid
+			glm::vec2 mGridOrigin;
+			float mCellSize;
+			uint32 mNumCellsX;
+			uint32 mNumCellsZ;
+			std::vector<uint32> mCellStart; // first sorted aspect of each cell, one more entry than cells
+			std::vector<uint32> mCellOfAspect; // only used inside build, kept to avoid reallocations
+			std::vector<uint32> mInsertPosition; // only used inside build, kept to avoid reallocations
+
+			std::vector<Query> mQueries;
+			uint32 mNumExecutedQueries;
+			std::vector<Candidate> mResults;
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/PerceptionBroadphase-inl.h"
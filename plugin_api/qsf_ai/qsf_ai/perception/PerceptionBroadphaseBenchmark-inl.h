@@ -0,0 +1,141 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/time/HighResolutionStopwatch.h>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline PerceptionBroadphaseBenchmark::Settings::Settings() :
+			mNumberOfAgents(1000),
+			mNumberOfRounds(10),
+			mAreaSize(1000.0f),
+			mSensorRadius(30.0f),
+			mCellSize(20.0f),
+			mSeed(1)
+		{
+		}
+
+		inline PerceptionBroadphaseBenchmark::Result PerceptionBroadphaseBenchmark::run(const Settings& settings, const AspectTags& aspectTags, const AspectTags& sensorTags)
+		{
+			std::vector<glm::vec3> positions;
+			createAgents(settings, positions);
+
+			Result result;
+			result.mNumberOfAgents = settings.mNumberOfAgents;
+			result.mNumberOfCandidates = 0;
+			result.mResultsMatch = true;
+
+			// The candidates of the last round of each variant, concatenated per agent in agent order
+			std::vector<uint64> broadphaseCandidates;
+			std::vector<uint64> bruteForceCandidates;
+
+			{ // Broadphase
+				PerceptionBroadphase broadphase(settings.mCellSize);
+				HighResolutionStopwatch stopwatch;
+				for (uint32 round = 0; round < settings.mNumberOfRounds; ++round)
+				{
+					broadphase.clear();
+					for (uint32 agent = 0; agent < settings.mNumberOfAgents; ++agent)
+					{
+						broadphase.addAspect(agent, positions[agent], aspectTags);
+					}
+					broadphase.build();
+
+					for (uint32 agent = 0; agent < settings.mNumberOfAgents; ++agent)
+					{
+						broadphase.addQuery(agent, positions[agent], settings.mSensorRadius, sensorTags);
+					}
+					broadphase.executeQueries();
+				}
+				result.mBroadphaseTime = stopwatch.getElapsed();
+
+				for (uint32 query = 0; query < broadphase.getNumQueries(); ++query)
+				{
+					const PerceptionBroadphase::Candidate* begin = nullptr;
+					const PerceptionBroadphase::Candidate* end = nullptr;
+					broadphase.getResults(query, begin, end);
+					for (const PerceptionBroadphase::Candidate* candidate = begin; candidate != end; ++candidate)
+					{
+						broadphaseCandidates.push_back(candidate->mEntityId);
+					}
+				}
+			}
+
+			{ // Brute force, all agents share the same tags so the match is the same for every pair
+				const bool tagsMatch = PerceptionBroadphase::matches(sensorTags, aspectTags);
+				const float radiusSquared = settings.mSensorRadius * settings.mSensorRadius;
+				HighResolutionStopwatch stopwatch;
+				for (uint32 round = 0; round < settings.mNumberOfRounds; ++round)
+				{
+					bruteForceCandidates.clear();
+					for (uint32 perceiver = 0; perceiver < settings.mNumberOfAgents && tagsMatch; ++perceiver)
+					{
+						for (uint32 agent = 0; agent < settings.mNumberOfAgents; ++agent)
+						{
+							const glm::vec3 offset = positions[agent] - positions[perceiver];
+							if (agent != perceiver && glm::dot(offset, offset) <= radiusSquared)
+								bruteForceCandidates.push_back(agent);
+						}
+					}
+				}
+				result.mBruteForceTime = stopwatch.getElapsed();
+			}
+
+			// Both variants list the candidates per agent ascending, so the concatenated lists are equal if all results are
+			result.mNumberOfCandidates = broadphaseCandidates.size();
+			result.mResultsMatch = (broadphaseCandidates == bruteForceCandidates);
+			return result;
+		}
+
+		inline void PerceptionBroadphaseBenchmark::runDefaultSeries(const AspectTags& aspectTags, const AspectTags& sensorTags, std::vector<Result>& results)
+		{
+			static const uint32 NUMBERS_OF_AGENTS[] = { 1000, 5000, 10000 };
+
+			results.clear();
+			for (uint32 numberOfAgents : NUMBERS_OF_AGENTS)
+			{
+				Settings settings;
+				settings.mNumberOfAgents = numberOfAgents;
+				results.push_back(run(settings, aspectTags, sensorTags));
+			}
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline void PerceptionBroadphaseBenchmark::createAgents(const Settings& settings, std::vector<glm::vec3>& positions)
+		{
+			// Linear congruential generator, so the agents are the same on all platforms
+			uint32 randomState = settings.mSeed;
+			positions.resize(settings.mNumberOfAgents);
+			for (glm::vec3& position : positions)
+			{
+				randomState = randomState * 1664525u + 1013904223u;
+				position.x = static_cast<float>(randomState >> 8) / static_cast<float>(1 << 24) * settings.mAreaSize;
+				randomState = randomState * 1664525u + 1013904223u;
+				position.z = static_cast<float>(randomState >> 8) / static_cast<float>(1 << 24) * settings.mAreaSize;
+				position.y = 0.0f;
+			}
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
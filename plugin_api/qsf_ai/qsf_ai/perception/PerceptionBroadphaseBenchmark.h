@@ -0,0 +1,108 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/PerceptionBroadphase.h"
+
+#include <qsf/time/Time.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Benchmark of the perception broadphase against testing every aspect, the way a sensor configuration does without it.
+		*
+		*    Agents are spread randomly on a square with a fixed seed, each of them is an aspect and has one sensor.
+		*    Per round the broadphase is rebuilt and one query per agent is answered, the brute force variant tests each agent against all others.
+		*    Line of sight is not part of either variant.
+		*    The tags are passed in since AspectTags are parsed by the engine, e.g. take them from an AspectComponent and a sensor configuration.
+		*    Usage, e.g. from a debug command of a plugin:
+		*    @code
+		*      std::vector<qsf::ai::PerceptionBroadphaseBenchmark::Result> results;
+		*      qsf::ai::PerceptionBroadphaseBenchmark::runDefaultSeries(aspectComponent.getAspectTags(), sensorConfiguration.getAspectTags(), results);
+		*      for (const qsf::ai::PerceptionBroadphaseBenchmark::Result& result : results)
+		*        QSF_LOG_PRINTS(INFO, result.mNumberOfAgents << " agents: broadphase " << result.mBroadphaseTime.getMilliseconds() << " ms, brute force " << result.mBruteForceTime.getMilliseconds() << " ms");
+		*    @endcode
+		*/
+		class PerceptionBroadphaseBenchmark
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			struct Settings
+			{
+				Settings();
+
+				uint32 mNumberOfAgents;
+				uint32 mNumberOfRounds;
+				float mAreaSize; // Edge length of the square the agents are spread on
+				float mSensorRadius;
+				float mCellSize; // Configured cell size of the broadphase
+				uint32 mSeed;
+			};
+
+			struct Result
+			{
+				uint32 mNumberOfAgents;
+				Time mBroadphaseTime; // Rebuild and queries of all rounds
+				Time mBruteForceTime; // Testing every aspect in all rounds
+				uint64 mNumberOfCandidates; // Found per round
+				bool mResultsMatch; // Whether both variants found the same candidates for each agent
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public static methods                                 ]
+		//[-------------------------------------------------------]
+		public:
+			static Result run(const Settings& settings, const AspectTags& aspectTags, const AspectTags& sensorTags);
+
+			// Runs the default settings with 1000, 5000 and 10000 agents
+			static void runDefaultSeries(const AspectTags& aspectTags, const AspectTags& sensorTags, std::vector<Result>& results);
+
+
+		//[-------------------------------------------------------]
+		//[ Private static methods                                ]
+		//[-------------------------------------------------------]
+		private:
+			static void createAgents(const Settings& settings, std::vector<glm::vec3>& positions);
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/PerceptionBroadphaseBenchmark-inl.h"
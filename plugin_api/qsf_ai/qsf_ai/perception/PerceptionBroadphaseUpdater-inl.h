@@ -0,0 +1,85 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/AspectComponent.h"
+
+#include <qsf/component/base/TransformComponent.h>
+#include <qsf/map/Map.h>
+#include <qsf/map/Entity.h>
+#include <qsf/map/query/ComponentMapQuery.h>
+#include <qsf/time/HighResolutionStopwatch.h>
+
+#include <boost/bind.hpp>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline PerceptionBroadphaseUpdater::PerceptionBroadphaseUpdater(Map& map, const StringHash& jobManagerId, float cellSize) :
+			mMap(map),
+			mBroadphase(cellSize)
+		{
+			mJobProxy.registerAt(jobManagerId, boost::bind(&PerceptionBroadphaseUpdater::updateJob, this, _1));
+		}
+
+		inline PerceptionBroadphaseUpdater::~PerceptionBroadphaseUpdater()
+		{
+			mJobProxy.unregister();
+		}
+
+		inline void PerceptionBroadphaseUpdater::rebuild()
+		{
+			HighResolutionStopwatch stopwatch;
+
+			mBroadphase.clear();
+			for (const AspectComponent* aspectComponent : ComponentMapQuery(mMap).getAllInstances<AspectComponent>())
+			{
+				if (aspectComponent->isActive())
+				{
+					const TransformComponent* transformComponent = aspectComponent->getEntity().getComponent<TransformComponent>();
+					if (nullptr != transformComponent)
+						mBroadphase.addAspect(aspectComponent->getEntityId(), transformComponent->getPosition(), aspectComponent->getAspectTags());
+				}
+			}
+			mBroadphase.build();
+
+			mBuildTime = stopwatch.getElapsed();
+		}
+
+		inline PerceptionBroadphase& PerceptionBroadphaseUpdater::getBroadphase()
+		{
+			return mBroadphase;
+		}
+
+		inline const Time& PerceptionBroadphaseUpdater::getBuildTime() const
+		{
+			return mBuildTime;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline void PerceptionBroadphaseUpdater::updateJob(const JobArguments&)
+		{
+			rebuild();
+		}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
@@ -0,0 +1,112 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/PerceptionBroadphase.h"
+#include "qsf_ai/plugin/Jobs.h"
+
+#include <qsf/base/StringHash.h>
+#include <qsf/job/JobProxy.h>
+#include <qsf/time/Time.h>
+
+#include <boost/noncopyable.hpp>
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	class Map;
+	class JobArguments;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace ai
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Keeps a perception broadphase with all active AspectComponents of a map, rebuilt once per update of a job manager.
+		*
+		*    The updater registers its job on construction, so owning an instance is all that's needed.
+		*    Plugin code doing its own perception queries, e.g. in the update of its components, adds them to the broadphase afterwards.
+		*    The sensor configurations of the engine keep testing the aspects themselves, they don't use the broadphase.
+		*    Usage, e.g. inside a plugin during the simulation:
+		*    @code
+		*      mBroadphaseUpdater.reset(new qsf::ai::PerceptionBroadphaseUpdater(QSF_MAINMAP));
+		*      ...
+		*      qsf::ai::PerceptionBroadphase& broadphase = mBroadphaseUpdater->getBroadphase();
+		*      const uint32 queryIndex = broadphase.addQuery(entityId, position, radius, sensorTags);
+		*      broadphase.executeQueries();
+		*      broadphase.getResults(queryIndex, begin, end);
+		*    @endcode
+		*/
+		class PerceptionBroadphaseUpdater : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			// The map needs to outlive the updater, the job is registered at the job manager passed right away
+			explicit PerceptionBroadphaseUpdater(Map& map, const StringHash& jobManagerId = Jobs::SIMULATION_AI, float cellSize = 20.0f);
+			~PerceptionBroadphaseUpdater();
+
+			// Rebuild the broadphase right away, this is what the job does. The queries of the previous build are dropped.
+			void rebuild();
+
+			// The aspects are the ones of the last rebuild, queries added are answered against them
+			PerceptionBroadphase& getBroadphase();
+
+			// Time needed by the last rebuild
+			const Time& getBuildTime() const;
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			void updateJob(const JobArguments& jobArguments);
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			Map& mMap;
+			PerceptionBroadphase mBroadphase;
+			Time mBuildTime;
+			JobProxy mJobProxy; // Regular job calling rebuild
+		};
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+	} // ai
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf_ai/perception/PerceptionBroadphaseUpdater-inl.h"
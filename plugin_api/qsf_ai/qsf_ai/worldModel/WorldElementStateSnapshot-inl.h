@@ -0,0 +1,75 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/base/error/ErrorHandling.h>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline WorldElementStateSnapshot::WorldElementStateSnapshot(uint64 version, unsigned int numAreas, unsigned int numNodes, const ChunkVector& areaChunks, const ChunkVector& nodeChunks) :
+			mVersion(version),
+			mNumAreas(numAreas),
+			mNumNodes(numNodes),
+			mAreaChunks(areaChunks),
+			mNodeChunks(nodeChunks)
+		{}
+
+		inline uint64 WorldElementStateSnapshot::getVersion() const
+		{
+			return mVersion;
+		}
+
+		inline unsigned int WorldElementStateSnapshot::getNumAreas() const
+		{
+			return mNumAreas;
+		}
+
+		inline unsigned int WorldElementStateSnapshot::getNumNodes() const
+		{
+			return mNumNodes;
+		}
+
+		inline const worldElement::State& WorldElementStateSnapshot::getAreaState(unsigned int area) const
+		{
+			QSF_CHECK(area < mNumAreas, "index " << area << " out of bounds when getting world area status from snapshot " << mVersion,
+				QSF_REACT_THROW);
+
+			return (*mAreaChunks[area / CHUNK_SIZE])[area % CHUNK_SIZE];
+		}
+
+		inline const worldElement::State& WorldElementStateSnapshot::getNodeState(unsigned int node) const
+		{
+			QSF_CHECK(node < mNumNodes, "index " << node << " out of bounds when accessing world node status from snapshot " << mVersion,
+				QSF_REACT_THROW);
+
+			return (*mNodeChunks[node / CHUNK_SIZE])[node % CHUNK_SIZE];
+		}
+
+		inline bool WorldElementStateSnapshot::sharesAreaChunk(const WorldElementStateSnapshot& other, std::size_t chunkIndex) const
+		{
+			return chunkIndex < mAreaChunks.size() && chunkIndex < other.mAreaChunks.size() && mAreaChunks[chunkIndex] == other.mAreaChunks[chunkIndex];
+		}
+
+		inline bool WorldElementStateSnapshot::sharesNodeChunk(const WorldElementStateSnapshot& other, std::size_t chunkIndex) const
+		{
+			return chunkIndex < mNodeChunks.size() && chunkIndex < other.mNodeChunks.size() && mNodeChunks[chunkIndex] == other.mNodeChunks[chunkIndex];
+		}
+
+		inline std::size_t WorldElementStateSnapshot::calculateMemoryConsumption() const
+		{
+			return sizeof(WorldElementStateSnapshot) + (mAreaChunks.capacity() + mNodeChunks.capacity()) * sizeof(ChunkVector::value_type)
+				+ (mAreaChunks.size() + mNodeChunks.size()) * sizeof(Chunk);
+		}
+	}
+}
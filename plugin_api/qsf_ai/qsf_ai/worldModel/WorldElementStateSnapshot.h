@@ -0,0 +1,70 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/WorldElementState.h"
+
+#include <qsf/platform/PlatformTypes.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		/**
+		* An immutable version of the area and node states of a WorldElementStateCollection, see WorldElementStateSnapshotPublisher.
+		* The states are stored in fixed size chunks that are shared between consecutive versions.
+		* Publishing a new version only copies the chunks that were changed since the last one, all others are referenced.
+		*
+		* Readers keep the version they started with alive by holding the shared pointer and may read it without any locking.
+		* All functions are const and thread safe.
+		*/
+		class WorldElementStateSnapshot : public boost::noncopyable
+		{
+		public:
+			static const unsigned int CHUNK_SIZE = 256; // Number of states per chunk
+
+			typedef std::array<worldElement::State, CHUNK_SIZE> Chunk;
+			typedef std::vector<std::shared_ptr<const Chunk>> ChunkVector;
+
+			WorldElementStateSnapshot(uint64 version, unsigned int numAreas, unsigned int numNodes, const ChunkVector& areaChunks, const ChunkVector& nodeChunks);
+
+			// The version increases with each state published
+			uint64 getVersion() const;
+
+			unsigned int getNumAreas() const;
+			unsigned int getNumNodes() const;
+			const worldElement::State& getAreaState(unsigned int area) const;
+			const worldElement::State& getNodeState(unsigned int node) const;
+
+			// Returns whether this version shares the chunk with the other version
+			bool sharesAreaChunk(const WorldElementStateSnapshot& other, std::size_t chunkIndex) const;
+			bool sharesNodeChunk(const WorldElementStateSnapshot& other, std::size_t chunkIndex) const;
+
+			std::size_t calculateMemoryConsumption() const; // counts the chunks fully even if they are shared
+
+		private:
+			const uint64 mVersion;
+			const unsigned int mNumAreas;
+			const unsigned int mNumNodes;
+			const ChunkVector mAreaChunks;
+			const ChunkVector mNodeChunks;
+		};
+	}
+}
+
+#include "qsf_ai/worldModel/WorldElementStateSnapshot-inl.h"
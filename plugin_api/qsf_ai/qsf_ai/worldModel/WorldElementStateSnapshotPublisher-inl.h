@@ -0,0 +1,155 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/WorldModelManager.h"
+#include "qsf_ai/worldModel/ManagedNavigationMap.h"
+#include "qsf_ai/worldModel/WorldElementStateCollection.h"
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneWorld.h"
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline WorldElementStateSnapshotPublisher::MapEntry::MapEntry() :
+			mVersion(0)
+		{}
+
+		inline WorldElementStateSnapshotPublisher::WorldElementStateSnapshotPublisher(WorldModelManager& worldModelManager, const StringHash& jobManagerId) :
+			mWorldModelManager(worldModelManager)
+		{
+			startAutomaticPublishing(jobManagerId);
+		}
+
+		inline WorldElementStateSnapshotPublisher::~WorldElementStateSnapshotPublisher()
+		{
+			mPublishJobProxy.unregister();
+		}
+
+		inline void WorldElementStateSnapshotPublisher::startAutomaticPublishing(const StringHash& jobManagerId)
+		{
+			mPublishJobProxy.unregister();
+			mPublishJobProxy.registerAt(jobManagerId, boost::bind(&WorldElementStateSnapshotPublisher::updatePublishJob, this, _1));
+		}
+
+		inline void WorldElementStateSnapshotPublisher::stopAutomaticPublishing()
+		{
+			mPublishJobProxy.unregister();
+		}
+
+		inline void WorldElementStateSnapshotPublisher::publishAll()
+		{
+			const WorldModelManager::Maps& worlds = mWorldModelManager.getWorlds();
+
+			// Forget the maps that were removed
+			for (std::map<unsigned int, MapEntry>::iterator iterator = mMapEntries.begin(); iterator != mMapEntries.end(); )
+			{
+				if (worlds.count(iterator->first) == 0)
+				{
+					{
+						std::lock_guard<std::mutex> lock(mPublishedSnapshotsMutex);
+						mPublishedSnapshots.erase(iterator->first);
+					}
+					iterator = mMapEntries.erase(iterator);
+				}
+				else
+				{
+					++iterator;
+				}
+			}
+
+			for (const WorldModelManager::Maps::value_type& world : worlds)
+			{
+				// Don't stall the publishing thread while a map update is running, the states are published in one of the next rounds
+				const std::unique_ptr<ManagedNavigationMapReadAccess> readAccess = world.second->acquireReadAccess(ManagedNavigationMapReadAccess::TryLock());
+				if (!readAccess->wasLocked())
+					continue;
+
+				const TrafficLaneWorld* trafficLaneWorld = dynamic_cast<const TrafficLaneWorld*>(&readAccess->get());
+				if (nullptr == trafficLaneWorld)
+					continue;
+
+				publish(world.first, mMapEntries[world.first], trafficLaneWorld->getWorldElementsState(),
+					trafficLaneWorld->getLanes().getNumLanes(), static_cast<unsigned int>(trafficLaneWorld->getNumNodes()));
+			}
+		}
+
+		inline std::shared_ptr<const WorldElementStateSnapshot> WorldElementStateSnapshotPublisher::acquireSnapshot(unsigned int mapId) const
+		{
+			std::lock_guard<std::mutex> lock(mPublishedSnapshotsMutex);
+
+			const std::map<unsigned int, std::shared_ptr<const WorldElementStateSnapshot>>::const_iterator iterator = mPublishedSnapshots.find(mapId);
+			return (iterator != mPublishedSnapshots.end()) ? iterator->second : std::shared_ptr<const WorldElementStateSnapshot>();
+		}
+
+		inline void WorldElementStateSnapshotPublisher::updatePublishJob(const JobArguments&)
+		{
+			publishAll();
+		}
+
+		inline void WorldElementStateSnapshotPublisher::publish(unsigned int mapId, MapEntry& entry, const WorldElementStateCollection& states, unsigned int numAreas, unsigned int numNodes)
+		{
+			mStateBuffer.clear();
+			for (unsigned int area = 0; area < numAreas; ++area)
+				mStateBuffer.push_back(states.getAreaState(area));
+			bool changed = updateChunks(mStateBuffer, entry.mAreaChunks);
+
+			mStateBuffer.clear();
+			for (unsigned int node = 0; node < numNodes; ++node)
+				mStateBuffer.push_back(states.getNodeState(node));
+			changed = updateChunks(mStateBuffer, entry.mNodeChunks) || changed;
+
+			if (!changed && entry.mVersion > 0)
+				return;
+
+			const std::shared_ptr<const WorldElementStateSnapshot> snapshot = std::make_shared<const WorldElementStateSnapshot>(++entry.mVersion, numAreas, numNodes, entry.mAreaChunks, entry.mNodeChunks);
+
+			std::lock_guard<std::mutex> lock(mPublishedSnapshotsMutex);
+			mPublishedSnapshots[mapId] = snapshot;
+		}
+
+		inline bool WorldElementStateSnapshotPublisher::updateChunks(const StateVector& states, WorldElementStateSnapshot::ChunkVector& chunks)
+		{
+			const std::size_t numChunks = (states.size() + WorldElementStateSnapshot::CHUNK_SIZE - 1) / WorldElementStateSnapshot::CHUNK_SIZE;
+			bool changed = (chunks.size() != numChunks);
+			chunks.resize(numChunks);
+
+			for (std::size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+			{
+				const std::size_t begin = chunkIndex * WorldElementStateSnapshot::CHUNK_SIZE;
+				const std::size_t end = std::min<std::size_t>(begin + WorldElementStateSnapshot::CHUNK_SIZE, states.size());
+
+				// A partially filled last chunk keeps default states behind the used ones, so comparing the used range is enough
+				const std::shared_ptr<const WorldElementStateSnapshot::Chunk>& publishedChunk = chunks[chunkIndex];
+				if (publishedChunk && std::equal(states.begin() + begin, states.begin() + end, publishedChunk->begin(), &WorldElementStateSnapshotPublisher::isEqual))
+					continue;
+
+				// The chunks published before are immutable and may still be read, create a copy
+				const std::shared_ptr<WorldElementStateSnapshot::Chunk> chunk = std::make_shared<WorldElementStateSnapshot::Chunk>();
+				std::copy(states.begin() + begin, states.begin() + end, chunk->begin());
+				chunks[chunkIndex] = chunk;
+				changed = true;
+			}
+
+			return changed;
+		}
+
+		inline bool WorldElementStateSnapshotPublisher::isEqual(const worldElement::State& left, const worldElement::State& right)
+		{
+			return left.mType == right.mType && left.mPhysicalRestriction == right.mPhysicalRestriction;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/WorldElementStateSnapshot.h"
+#include "qsf_ai/plugin/Jobs.h"
+
+#include <qsf/job/JobProxy.h>
+#include <qsf/base/StringHash.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <map>
+
+
+namespace qsf
+{
+	class JobArguments;
+
+	namespace ai
+	{
+		class WorldModelManager;
+		class WorldElementStateCollection;
+
+		/**
+		* Publishes immutable snapshots of the area and node states of all navigation maps registered at a world model manager.
+		* Path searches and other worker threads may read a snapshot without holding the read access to the navigation map so they are not stalled by dynamic updates.
+		*
+		* Publishing compares the current states with the last snapshot chunk by chunk and only copies the chunks that changed, all others are shared.
+		* The version of a map's snapshot only increases if any state changed, so it may be used to tag data derived from the states.
+		* A map is skipped for one publishing round if it is currently locked for writing, publishing never waits for the access.
+		* Currently only traffic lane worlds are supported since the element counts are taken from the lanes and nodes of the world.
+		*
+		* The publisher registers a job on construction that publishes the states once per update of the job manager, so owning an instance is all that's needed.
+		* Acquiring a snapshot is thread safe, all other functions need to be called from the thread updating the job manager.
+		* Usage, e.g. inside a plugin owning the publisher during the simulation:
+		* @code
+		*   mSnapshotPublisher.reset(new qsf::ai::WorldElementStateSnapshotPublisher(qsf::ai::WorldModelManager::getInstance()));
+		*   ...
+		*   // From any thread, e.g. inside a navigation task
+		*   std::shared_ptr<const qsf::ai::WorldElementStateSnapshot> snapshot = mSnapshotPublisher->acquireSnapshot(mapId);
+		* @endcode
+		*/
+		class WorldElementStateSnapshotPublisher : public boost::noncopyable
+		{
+		public:
+			// The world model manager needs to outlive the publisher, the publishing job is registered at the job manager passed right away
+			explicit WorldElementStateSnapshotPublisher(WorldModelManager& worldModelManager, const StringHash& jobManagerId = Jobs::SIMULATION_AI);
+			~WorldElementStateSnapshotPublisher();
+
+			// Registers the publishing job at another job manager or again after it was stopped
+			void startAutomaticPublishing(const StringHash& jobManagerId);
+			void stopAutomaticPublishing();
+
+			// Publishes the current states of all maps that are not locked for writing at the moment and drops the snapshots of removed maps
+			void publishAll();
+
+			// Returns the latest published states of a map, thread safe. The snapshot stays valid and unchanged as long as the pointer is kept.
+			// Returns a nullptr if nothing was published for this map yet.
+			std::shared_ptr<const WorldElementStateSnapshot> acquireSnapshot(unsigned int mapId) const;
+
+		private:
+			// Publishing state per map, only accessed by the publishing thread
+			struct MapEntry
+			{
+				MapEntry();
+
+				WorldElementStateSnapshot::ChunkVector mAreaChunks;
+				WorldElementStateSnapshot::ChunkVector mNodeChunks;
+				uint64 mVersion;
+			};
+
+			typedef std::vector<worldElement::State> StateVector;
+
+			void updatePublishJob(const JobArguments& jobArguments);
+			// Publishes a new snapshot if any state differs from the last one
+			void publish(unsigned int mapId, MapEntry& entry, const WorldElementStateCollection& states, unsigned int numAreas, unsigned int numNodes);
+
+			// Copies the chunks of the states that differ from the published ones and returns whether any chunk was replaced
+			static bool updateChunks(const StateVector& states, WorldElementStateSnapshot::ChunkVector& chunks);
+			static bool isEqual(const worldElement::State& left, const worldElement::State& right);
+
+			WorldModelManager& mWorldModelManager;
+			std::map<unsigned int, MapEntry> mMapEntries;
+			StateVector mStateBuffer; // Reused buffer for gathering the states of one map
+
+			std::map<unsigned int, std::shared_ptr<const WorldElementStateSnapshot>> mPublishedSnapshots;
+			mutable std::mutex mPublishedSnapshotsMutex; // Guards mPublishedSnapshots
+
+			JobProxy mPublishJobProxy; // Regular job calling publishAll
+		};
+	}
+}
+
+#include "qsf_ai/worldModel/WorldElementStateSnapshotPublisher-inl.h"
@@ -0,0 +1,652 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/WorldElementStateCollection.h"
+#include "qsf_ai/serialization/SerializationHelper.h"
+
+#include <qsf/base/error/ErrorHandling.h>
+#include <qsf/serialization/binary/BasicTypeSerialization.h>
+#include <qsf/serialization/binary/GlmTypeSerialization.h>
+#include <qsf/serialization/binary/StlTypeSerialization.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline TrafficLaneHierarchy::Edge::Edge() :
+			mSourceNodeId(getUninitialized<uint32>()),
+			mTargetNodeId(getUninitialized<uint32>()),
+			mLaneId(getUninitialized<uint32>()),
+			mCosts(0.f)
+		{}
+
+		inline TrafficLaneHierarchy::Edge::Edge(uint32 sourceNodeId, uint32 targetNodeId, uint32 laneId, float costs) :
+			mSourceNodeId(sourceNodeId),
+			mTargetNodeId(targetNodeId),
+			mLaneId(laneId),
+			mCosts(costs)
+		{}
+
+		inline TrafficLaneHierarchy::Endpoint::Endpoint(uint32 nodeId, float costs) :
+			mNodeId(nodeId),
+			mCosts(costs)
+		{}
+
+		inline TrafficLaneHierarchy::PathStep::PathStep(uint32 nodeId, uint32 laneId) :
+			mNodeId(nodeId),
+			mLaneId(laneId)
+		{}
+
+		inline TrafficLaneHierarchy::Cluster::Cluster() :
+			mDirty(true)
+		{}
+
+		inline TrafficLaneHierarchy::TrafficLaneHierarchy(unsigned int moverType) :
+			mMoverType(moverType),
+			mClusterSize(static_cast<float>(DEFAULT_CLUSTER_SIZE)),
+			mHeuristicFactor(0.f),
+			mNumDirtyClusters(0)
+		{}
+
+		inline unsigned int TrafficLaneHierarchy::getMoverType() const
+		{
+			return mMoverType;
+		}
+
+		inline float TrafficLaneHierarchy::getClusterSize() const
+		{
+			return mClusterSize;
+		}
+
+		inline std::size_t TrafficLaneHierarchy::getNumNodes() const
+		{
+			return mNodePositions.size();
+		}
+
+		inline std::size_t TrafficLaneHierarchy::getNumClusters() const
+		{
+			return mClusters.size();
+		}
+
+		inline std::size_t TrafficLaneHierarchy::getNumEntrances() const
+		{
+			std::size_t numEntrances = 0;
+			for (const Cluster& cluster : mClusters)
+				numEntrances += cluster.mEntranceNodeIds.size();
+
+			return numEntrances;
+		}
+
+		inline void TrafficLaneHierarchy::build(const std::vector<glm::vec3>& nodePositions, const std::vector<Edge>& edges, float clusterSize)
+		{
+			QSF_CHECK(clusterSize > 0.f, "Invalid cluster size " << clusterSize << " for a traffic lane hierarchy",
+				QSF_REACT_THROW);
+
+			const uint32 numNodes = static_cast<uint32>(nodePositions.size());
+			mClusterSize = clusterSize;
+			mNodePositions = nodePositions;
+			mBlockedNodes.assign(numNodes, false);
+
+			// Store the edges sorted by source node to be able to iterate all outgoing edges of a node
+			mEdges = edges;
+			for (const Edge& edge : mEdges)
+			{
+				QSF_CHECK(edge.mSourceNodeId < numNodes && edge.mTargetNodeId < numNodes, "Lane " << edge.mLaneId << " connects unknown nodes " << edge.mSourceNodeId << " and " << edge.mTargetNodeId,
+					QSF_REACT_THROW);
+			}
+			std::stable_sort(mEdges.begin(), mEdges.end(), [](const Edge& lhs, const Edge& rhs) { return lhs.mSourceNodeId < rhs.mSourceNodeId; });
+
+			mFirstEdgeIndices.assign(numNodes + 1, 0);
+			for (const Edge& edge : mEdges)
+				++mFirstEdgeIndices[edge.mSourceNodeId + 1];
+			for (uint32 nodeId = 0; nodeId < numNodes; ++nodeId)
+				mFirstEdgeIndices[nodeId + 1] += mFirstEdgeIndices[nodeId];
+
+			// The lanes are never shorter than the straight distance between their end nodes, so the smallest ratio of costs to distance keeps the estimate admissible
+			mHeuristicFactor = std::numeric_limits<float>::max();
+			for (const Edge& edge : mEdges)
+			{
+				const float distance = glm::distance(mNodePositions[edge.mSourceNodeId], mNodePositions[edge.mTargetNodeId]);
+				if (distance > std::numeric_limits<float>::epsilon())
+					mHeuristicFactor = std::min(mHeuristicFactor, edge.mCosts / distance);
+			}
+			if (mHeuristicFactor == std::numeric_limits<float>::max())
+				mHeuristicFactor = 0.f;
+
+			// Partition the nodes by a regular grid on the ground plane
+			mClusters.clear();
+			std::vector<uint32> clusterIds(numNodes);
+			std::map<std::pair<int, int>, uint32> clusterIdsByCell;
+			for (uint32 nodeId = 0; nodeId < numNodes; ++nodeId)
+			{
+				const glm::vec3& position = mNodePositions[nodeId];
+				const std::pair<int, int> cell(static_cast<int>(glm::floor(position.x / clusterSize)), static_cast<int>(glm::floor(position.z / clusterSize)));
+				const auto insertResult = clusterIdsByCell.emplace(cell, static_cast<uint32>(mClusters.size()));
+				if (insertResult.second)
+					mClusters.push_back(Cluster());
+
+				clusterIds[nodeId] = insertResult.first->second;
+				mClusters[clusterIds[nodeId]].mNodeIds.push_back(nodeId);
+			}
+
+			// Nodes with a lane to or from another cluster are entrances
+			std::vector<bool> isEntrance(numNodes, false);
+			for (const Edge& edge : mEdges)
+			{
+				if (clusterIds[edge.mSourceNodeId] != clusterIds[edge.mTargetNodeId])
+				{
+					isEntrance[edge.mSourceNodeId] = true;
+					isEntrance[edge.mTargetNodeId] = true;
+				}
+			}
+			for (Cluster& cluster : mClusters)
+			{
+				for (uint32 nodeId : cluster.mNodeIds)
+				{
+					if (isEntrance[nodeId])
+						cluster.mEntranceNodeIds.push_back(nodeId);
+				}
+			}
+
+			updateDerivedData();
+
+			// All clusters start dirty and get clean by computing their entrance costs
+			mNumDirtyClusters = static_cast<uint32>(mClusters.size());
+			SearchContext& context = getThreadLocalSearchContext();
+			for (uint32 clusterId = 0; clusterId < mClusters.size(); ++clusterId)
+				computeEntranceCosts(clusterId, context);
+		}
+
+		inline void TrafficLaneHierarchy::setNodeBlocked(uint32 nodeId, bool blocked)
+		{
+			QSF_CHECK(nodeId < mBlockedNodes.size(), "Node index " << nodeId << " out of bounds when blocking traffic lane hierarchy node",
+				QSF_REACT_THROW);
+
+			if (mBlockedNodes[nodeId] == blocked)
+				return;
+
+			mBlockedNodes[nodeId] = blocked;
+			Cluster& cluster = mClusters[mClusterIds[nodeId]];
+			if (!cluster.mDirty)
+			{
+				cluster.mDirty = true;
+				++mNumDirtyClusters;
+			}
+		}
+
+		inline bool TrafficLaneHierarchy::isNodeBlocked(uint32 nodeId) const
+		{
+			return mBlockedNodes[nodeId];
+		}
+
+		inline uint32 TrafficLaneHierarchy::synchronizeNodeStates(const WorldElementStateCollection& worldElementStates)
+		{
+			uint32 numChangedNodes = 0;
+			for (uint32 nodeId = 0; nodeId < mBlockedNodes.size(); ++nodeId)
+			{
+				const bool blocked = (worldElementStates.getNodeState(nodeId).mType == worldElement::LONG_TERM_BLOCKED);
+				if (blocked == mBlockedNodes[nodeId])
+					continue;
+
+				setNodeBlocked(nodeId, blocked);
+				++numChangedNodes;
+			}
+
+			return numChangedNodes;
+		}
+
+		inline bool TrafficLaneHierarchy::hasDirtyClusters() const
+		{
+			return mNumDirtyClusters > 0;
+		}
+
+		inline uint32 TrafficLaneHierarchy::repairDirtyClusters()
+		{
+			if (mNumDirtyClusters == 0)
+				return 0;
+
+			SearchContext& context = getThreadLocalSearchContext();
+			uint32 numRepairedClusters = 0;
+			for (uint32 clusterId = 0; clusterId < mClusters.size(); ++clusterId)
+			{
+				if (!mClusters[clusterId].mDirty)
+					continue;
+
+				computeEntranceCosts(clusterId, context);
+				++numRepairedClusters;
+			}
+
+			return numRepairedClusters;
+		}
+
+		inline bool TrafficLaneHierarchy::findPath(const std::vector<Endpoint>& starts, const std::vector<Endpoint>& goals, std::vector<PathStep>& path, float* costs) const
+		{
+			path.clear();
+			if (starts.empty() || goals.empty() || mClusters.empty())
+				return false;
+
+			// The entrance costs of dirty clusters may lead through nodes that are blocked by now
+			QSF_CHECK(mNumDirtyClusters == 0, "Traffic lane hierarchy has " << mNumDirtyClusters << " dirty clusters, repair it before searching",
+				return false);
+
+			const float infinity = std::numeric_limits<float>::infinity();
+			const uint32 numNodes = static_cast<uint32>(mNodePositions.size());
+			SearchContext& context = getThreadLocalSearchContext();
+
+			std::vector<uint32> startClusterIds;
+			std::vector<uint32> goalClusterIds;
+			writeClusterIds(starts, startClusterIds);
+			writeClusterIds(goals, goalClusterIds);
+
+			// Costs from the entrances of the goal clusters to the goals
+			std::vector<Endpoint> goalEntrances;
+			searchLocally(goalClusterIds, true, goals, context);
+			for (uint32 clusterId : goalClusterIds)
+			{
+				for (uint32 nodeId : mClusters[clusterId].mEntranceNodeIds)
+				{
+					if (context.mCosts[nodeId] < infinity)
+						goalEntrances.push_back(Endpoint(nodeId, context.mCosts[nodeId]));
+				}
+			}
+
+			// Costs from the starts to the entrances of the start clusters and to goals which are reachable without leaving the start clusters
+			std::vector<Endpoint> startEntrances;
+			searchLocally(startClusterIds, false, starts, context);
+			for (uint32 clusterId : startClusterIds)
+			{
+				for (uint32 nodeId : mClusters[clusterId].mEntranceNodeIds)
+				{
+					if (context.mCosts[nodeId] < infinity)
+						startEntrances.push_back(Endpoint(nodeId, context.mCosts[nodeId]));
+				}
+			}
+
+			float directCosts = infinity;
+			uint32 directGoalNodeId = getUninitialized<uint32>();
+			for (const Endpoint& goal : goals)
+			{
+				if (goal.mNodeId < numNodes && context.mCosts[goal.mNodeId] + goal.mCosts < directCosts)
+				{
+					directCosts = context.mCosts[goal.mNodeId] + goal.mCosts;
+					directGoalNodeId = goal.mNodeId;
+				}
+			}
+
+			// A* on the graph of entrances, reaching the goals is modeled by a virtual node with an id one past the last real node
+			const uint32 virtualGoalNodeId = numNodes;
+			context.reset(numNodes + 1);
+			if (directCosts < infinity)
+				context.tryImprove(virtualGoalNodeId, directCosts, directCosts, getUninitialized<uint32>());
+
+			for (const Endpoint& entrance : startEntrances)
+				context.tryImprove(entrance.mNodeId, entrance.mCosts, entrance.mCosts + estimateCostsToGoals(entrance.mNodeId, goals), getUninitialized<uint32>());
+
+			while (!context.mOpenList.empty())
+			{
+				const uint32 nodeId = static_cast<uint32>(context.mOpenList.topKey());
+				context.mOpenList.pop();
+				if (nodeId == virtualGoalNodeId)
+					break;
+
+				const float nodeCosts = context.mCosts[nodeId];
+				for (const Endpoint& exit : goalEntrances)
+				{
+					if (exit.mNodeId == nodeId)
+						context.tryImprove(virtualGoalNodeId, nodeCosts + exit.mCosts, nodeCosts + exit.mCosts, nodeId);
+				}
+
+				// Move to another entrance of the same cluster using the precomputed costs
+				const Cluster& cluster = mClusters[mClusterIds[nodeId]];
+				const std::size_t numEntrances = cluster.mEntranceNodeIds.size();
+				const float* entranceCosts = &cluster.mEntranceCosts[mEntranceIndices[nodeId] * numEntrances];
+				for (std::size_t entranceIndex = 0; entranceIndex < numEntrances; ++entranceIndex)
+				{
+					const uint32 nextNodeId = cluster.mEntranceNodeIds[entranceIndex];
+					if (nextNodeId == nodeId || entranceCosts[entranceIndex] == infinity)
+						continue;
+
+					const float nextCosts = nodeCosts + entranceCosts[entranceIndex];
+					context.tryImprove(nextNodeId, nextCosts, nextCosts + estimateCostsToGoals(nextNodeId, goals), nodeId);
+				}
+
+				// Move along a lane into another cluster
+				for (uint32 edgeIndex = mFirstEdgeIndices[nodeId]; edgeIndex < mFirstEdgeIndices[nodeId + 1]; ++edgeIndex)
+				{
+					const Edge& edge = mEdges[edgeIndex];
+					if (mClusterIds[edge.mTargetNodeId] == mClusterIds[nodeId] || mBlockedNodes[edge.mTargetNodeId])
+						continue;
+
+					const float nextCosts = nodeCosts + edge.mCosts;
+					context.tryImprove(edge.mTargetNodeId, nextCosts, nextCosts + estimateCostsToGoals(edge.mTargetNodeId, goals), nodeId);
+				}
+			}
+
+			const float totalCosts = context.mCosts[virtualGoalNodeId];
+			if (totalCosts == infinity)
+				return false;
+
+			std::vector<uint32> entranceNodeIds;
+			for (uint32 nodeId = context.mPredecessors[virtualGoalNodeId]; isInitialized(nodeId); nodeId = context.mPredecessors[nodeId])
+				entranceNodeIds.push_back(nodeId);
+			std::reverse(entranceNodeIds.begin(), entranceNodeIds.end());
+
+			// Refine the abstract path to lane end nodes, this only searches the clusters along the path
+			searchLocally(startClusterIds, false, starts, context);
+			if (entranceNodeIds.empty())
+			{
+				appendForwardPath(context, directGoalNodeId, path);
+			}
+			else
+			{
+				appendForwardPath(context, entranceNodeIds.front(), path);
+
+				std::vector<uint32> clusterIds(1);
+				std::vector<Endpoint> sources(1, Endpoint(getUninitialized<uint32>(), 0.f));
+				for (std::size_t index = 1; index < entranceNodeIds.size(); ++index)
+				{
+					const uint32 fromNodeId = entranceNodeIds[index - 1];
+					const uint32 toNodeId = entranceNodeIds[index];
+					if (mClusterIds[fromNodeId] == mClusterIds[toNodeId])
+					{
+						clusterIds[0] = mClusterIds[fromNodeId];
+						sources[0].mNodeId = fromNodeId;
+						searchLocally(clusterIds, false, sources, context);
+						appendForwardPath(context, toNodeId, path);
+					}
+					else
+					{
+						// Use the cheapest lane between the two entrances
+						const Edge* bestEdge = nullptr;
+						for (uint32 edgeIndex = mFirstEdgeIndices[fromNodeId]; edgeIndex < mFirstEdgeIndices[fromNodeId + 1]; ++edgeIndex)
+						{
+							const Edge& edge = mEdges[edgeIndex];
+							if (edge.mTargetNodeId == toNodeId && (!bestEdge || edge.mCosts < bestEdge->mCosts))
+								bestEdge = &edge;
+						}
+						QSF_CHECK(bestEdge, "Missing lane between traffic lane hierarchy entrances " << fromNodeId << " and " << toNodeId,
+							QSF_REACT_THROW);
+
+						path.push_back(PathStep(toNodeId, bestEdge->mLaneId));
+					}
+				}
+
+				searchLocally(goalClusterIds, true, goals, context);
+				appendBackwardPath(context, entranceNodeIds.back(), path);
+			}
+
+			if (costs)
+				*costs = totalCosts;
+
+			return true;
+		}
+
+		inline std::size_t TrafficLaneHierarchy::calculateMemoryConsumption() const
+		{
+			std::size_t memoryConsumption = sizeof(TrafficLaneHierarchy);
+			memoryConsumption += mNodePositions.capacity() * sizeof(glm::vec3);
+			memoryConsumption += mEdges.capacity() * sizeof(Edge);
+			memoryConsumption += (mFirstEdgeIndices.capacity() + mFirstIncomingEdgeIndices.capacity() + mIncomingEdgeIndices.capacity()) * sizeof(uint32);
+			memoryConsumption += (mClusterIds.capacity() + mEntranceIndices.capacity()) * sizeof(uint32);
+			memoryConsumption += mBlockedNodes.capacity() / 8;
+			for (const Cluster& cluster : mClusters)
+			{
+				memoryConsumption += sizeof(Cluster);
+				memoryConsumption += (cluster.mNodeIds.capacity() + cluster.mEntranceNodeIds.capacity()) * sizeof(uint32);
+				memoryConsumption += cluster.mEntranceCosts.capacity() * sizeof(float);
+			}
+
+			return memoryConsumption;
+		}
+
+		inline void TrafficLaneHierarchy::SearchContext::reset(std::size_t numNodes)
+		{
+			mOpenList.clear();
+			for (uint32 nodeId : mReachedNodeIds)
+			{
+				mCosts[nodeId] = std::numeric_limits<float>::infinity();
+				mPredecessors[nodeId] = getUninitialized<uint32>();
+			}
+			mReachedNodeIds.clear();
+
+			if (mCosts.size() < numNodes)
+			{
+				mCosts.resize(numNodes, std::numeric_limits<float>::infinity());
+				mPredecessors.resize(numNodes, getUninitialized<uint32>());
+			}
+		}
+
+		inline bool TrafficLaneHierarchy::SearchContext::tryImprove(uint32 nodeId, float costs, float priority, uint32 predecessor)
+		{
+			if (!(costs < mCosts[nodeId]))
+				return false;
+
+			if (mCosts[nodeId] == std::numeric_limits<float>::infinity())
+				mReachedNodeIds.push_back(nodeId);
+
+			mCosts[nodeId] = costs;
+			mPredecessors[nodeId] = predecessor;
+			mOpenList.pushOrUpdate(nodeId, priority);
+			return true;
+		}
+
+		inline TrafficLaneHierarchy::SearchContext& TrafficLaneHierarchy::getThreadLocalSearchContext()
+		{
+			static thread_local SearchContext context;
+			return context;
+		}
+
+		inline void TrafficLaneHierarchy::searchLocally(const std::vector<uint32>& allowedClusters, bool backwards, const std::vector<Endpoint>& sources, SearchContext& context) const
+		{
+			const uint32 numNodes = static_cast<uint32>(mNodePositions.size());
+			context.reset(numNodes);
+
+			for (const Endpoint& source : sources)
+			{
+				if (source.mNodeId < numNodes && !mBlockedNodes[source.mNodeId])
+					context.tryImprove(source.mNodeId, source.mCosts, source.mCosts, getUninitialized<uint32>());
+			}
+
+			while (!context.mOpenList.empty())
+			{
+				const uint32 nodeId = static_cast<uint32>(context.mOpenList.topKey());
+				context.mOpenList.pop();
+
+				const float nodeCosts = context.mCosts[nodeId];
+				const uint32 firstIndex = backwards ? mFirstIncomingEdgeIndices[nodeId] : mFirstEdgeIndices[nodeId];
+				const uint32 endIndex = backwards ? mFirstIncomingEdgeIndices[nodeId + 1] : mFirstEdgeIndices[nodeId + 1];
+				for (uint32 index = firstIndex; index < endIndex; ++index)
+				{
+					const uint32 edgeIndex = backwards ? mIncomingEdgeIndices[index] : index;
+					const Edge& edge = mEdges[edgeIndex];
+					const uint32 nextNodeId = backwards ? edge.mSourceNodeId : edge.mTargetNodeId;
+					if (mBlockedNodes[nextNodeId] || std::find(allowedClusters.begin(), allowedClusters.end(), mClusterIds[nextNodeId]) == allowedClusters.end())
+						continue;
+
+					const float nextCosts = nodeCosts + edge.mCosts;
+					context.tryImprove(nextNodeId, nextCosts, nextCosts, edgeIndex);
+				}
+			}
+		}
+
+		inline void TrafficLaneHierarchy::computeEntranceCosts(uint32 clusterId, SearchContext& context)
+		{
+			Cluster& cluster = mClusters[clusterId];
+			const std::size_t numEntrances = cluster.mEntranceNodeIds.size();
+			cluster.mEntranceCosts.assign(numEntrances * numEntrances, std::numeric_limits<float>::infinity());
+
+			const std::vector<uint32> clusterIds(1, clusterId);
+			std::vector<Endpoint> sources(1, Endpoint(getUninitialized<uint32>(), 0.f));
+			for (std::size_t fromIndex = 0; fromIndex < numEntrances; ++fromIndex)
+			{
+				sources[0].mNodeId = cluster.mEntranceNodeIds[fromIndex];
+				searchLocally(clusterIds, false, sources, context);
+
+				for (std::size_t toIndex = 0; toIndex < numEntrances; ++toIndex)
+					cluster.mEntranceCosts[fromIndex * numEntrances + toIndex] = context.mCosts[cluster.mEntranceNodeIds[toIndex]];
+			}
+
+			if (cluster.mDirty)
+			{
+				cluster.mDirty = false;
+				--mNumDirtyClusters;
+			}
+		}
+
+		inline float TrafficLaneHierarchy::estimateCostsToGoals(uint32 nodeId, const std::vector<Endpoint>& goals) const
+		{
+			float minimumDistance = std::numeric_limits<float>::max();
+			for (const Endpoint& goal : goals)
+			{
+				if (goal.mNodeId < mNodePositions.size())
+					minimumDistance = std::min(minimumDistance, glm::distance(mNodePositions[nodeId], mNodePositions[goal.mNodeId]));
+			}
+
+			return minimumDistance * mHeuristicFactor;
+		}
+
+		inline void TrafficLaneHierarchy::appendForwardPath(const SearchContext& context, uint32 lastNodeId, std::vector<PathStep>& path) const
+		{
+			const std::size_t firstNewIndex = path.size();
+			uint32 nodeId = lastNodeId;
+			for (;;)
+			{
+				const uint32 edgeIndex = context.mPredecessors[nodeId];
+				if (!isInitialized(edgeIndex))
+				{
+					// Reached a source, which is already contained unless this is the start of the complete path
+					if (firstNewIndex == 0)
+						path.push_back(PathStep(nodeId, getUninitialized<uint32>()));
+					break;
+				}
+
+				path.push_back(PathStep(nodeId, mEdges[edgeIndex].mLaneId));
+				nodeId = mEdges[edgeIndex].mSourceNodeId;
+			}
+
+			std::reverse(path.begin() + firstNewIndex, path.end());
+		}
+
+		inline void TrafficLaneHierarchy::appendBackwardPath(const SearchContext& context, uint32 firstNodeId, std::vector<PathStep>& path) const
+		{
+			for (uint32 edgeIndex = context.mPredecessors[firstNodeId]; isInitialized(edgeIndex); )
+			{
+				const Edge& edge = mEdges[edgeIndex];
+				path.push_back(PathStep(edge.mTargetNodeId, edge.mLaneId));
+				edgeIndex = context.mPredecessors[edge.mTargetNodeId];
+			}
+		}
+
+		inline void TrafficLaneHierarchy::writeClusterIds(const std::vector<Endpoint>& endpoints, std::vector<uint32>& clusterIds) const
+		{
+			clusterIds.clear();
+			for (const Endpoint& endpoint : endpoints)
+			{
+				if (endpoint.mNodeId >= mClusterIds.size())
+					continue;
+
+				const uint32 clusterId = mClusterIds[endpoint.mNodeId];
+				if (std::find(clusterIds.begin(), clusterIds.end(), clusterId) == clusterIds.end())
+					clusterIds.push_back(clusterId);
+			}
+		}
+
+		inline void TrafficLaneHierarchy::updateDerivedData()
+		{
+			const uint32 numNodes = static_cast<uint32>(mNodePositions.size());
+
+			mClusterIds.assign(numNodes, getUninitialized<uint32>());
+			mEntranceIndices.assign(numNodes, getUninitialized<uint32>());
+			for (uint32 clusterId = 0; clusterId < mClusters.size(); ++clusterId)
+			{
+				const Cluster& cluster = mClusters[clusterId];
+				for (uint32 nodeId : cluster.mNodeIds)
+					mClusterIds[nodeId] = clusterId;
+				for (uint32 entranceIndex = 0; entranceIndex < cluster.mEntranceNodeIds.size(); ++entranceIndex)
+					mEntranceIndices[cluster.mEntranceNodeIds[entranceIndex]] = entranceIndex;
+			}
+
+			// Incoming edges sorted by target node by counting sort
+			mFirstIncomingEdgeIndices.assign(numNodes + 1, 0);
+			for (const Edge& edge : mEdges)
+				++mFirstIncomingEdgeIndices[edge.mTargetNodeId + 1];
+			for (uint32 nodeId = 0; nodeId < numNodes; ++nodeId)
+				mFirstIncomingEdgeIndices[nodeId + 1] += mFirstIncomingEdgeIndices[nodeId];
+
+			mIncomingEdgeIndices.resize(mEdges.size());
+			std::vector<uint32> nextIndices(mFirstIncomingEdgeIndices.begin(), mFirstIncomingEdgeIndices.end() - 1);
+			for (uint32 edgeIndex = 0; edgeIndex < mEdges.size(); ++edgeIndex)
+				mIncomingEdgeIndices[nextIndices[mEdges[edgeIndex].mTargetNodeId]++] = edgeIndex;
+		}
+	}
+
+	namespace serialization
+	{
+		template <>
+		struct serializer<ai::TrafficLaneHierarchy::Edge>
+		{
+			inline static void serialize(BinarySerializer& serializer, ai::TrafficLaneHierarchy::Edge& edge)
+			{
+				serializer & edge.mSourceNodeId;
+				serializer & edge.mTargetNodeId;
+				serializer & edge.mLaneId;
+				serializer & edge.mCosts;
+			}
+		};
+
+		template <>
+		struct serializer<ai::TrafficLaneHierarchy>
+		{
+			inline static void serialize(BinarySerializer& serializer, ai::TrafficLaneHierarchy& hierarchy)
+			{
+				// Only consistent entrance costs are written
+				if (serializer.isWriting())
+					hierarchy.repairDirtyClusters();
+
+				uint32 formatVersion = ai::TrafficLaneHierarchy::FORMAT_VERSION;
+				serializer & formatVersion;
+				QSF_CHECK(formatVersion == ai::TrafficLaneHierarchy::FORMAT_VERSION, "Unsupported traffic lane hierarchy format version " << formatVersion << ", expected " << ai::TrafficLaneHierarchy::FORMAT_VERSION,
+					QSF_REACT_THROW);
+
+				serializer & hierarchy.mMoverType;
+				serializer & hierarchy.mClusterSize;
+				serializer & hierarchy.mHeuristicFactor;
+				serializer & hierarchy.mNodePositions;
+				serializer & hierarchy.mEdges;
+				serializer & hierarchy.mFirstEdgeIndices;
+
+				uint32 numClusters = static_cast<uint32>(hierarchy.mClusters.size());
+				serializer & numClusters;
+				if (serializer.isReading())
+					hierarchy.mClusters.resize(numClusters);
+
+				for (ai::TrafficLaneHierarchy::Cluster& cluster : hierarchy.mClusters)
+				{
+					serializer & cluster.mNodeIds;
+					serializer & cluster.mEntranceNodeIds;
+					serializer & cluster.mEntranceCosts;
+					cluster.mDirty = false;
+				}
+				hierarchy.mNumDirtyClusters = 0;
+
+				serializeVectorOfBools(serializer, hierarchy.mBlockedNodes);
+
+				if (serializer.isReading())
+					hierarchy.updateDerivedData();
+			}
+		};
+	}
+}
@@ -0,0 +1,181 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/algorithm/IndexedDaryHeap.h"
+
+#include <qsf/base/GetUninitialized.h>
+#include <qsf/platform/PlatformTypes.h>
+#include <qsf/serialization/binary/BinarySerializer.h>
+
+#include <glm/glm.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace qsf
+{
+	namespace ai
+	{
+		class WorldElementStateCollection;
+
+		/** A precomputed hierarchical abstraction of the lane graph of a traffic lane world for one mover type, following the clustered HPA* approach.
+		* The lane end nodes are partitioned into square clusters on the ground plane.
+		* Nodes that are connected by a lane to a node in another cluster are the entrances of their cluster.
+		* For each cluster the cheapest costs between all pairs of its entrances are precomputed by searches restricted to the cluster.
+		*
+		* A query searches the lane graph only inside the start and goal clusters and the small graph of entrances otherwise.
+		* The abstract path found is refined to lane end nodes cluster by cluster, so long queries only touch the nodes of the clusters along the route.
+		* The path is optimal with regard to the lane costs used to build the hierarchy but doesn't consider the turning constraints of the single entities.
+		* It is meant to be used as a corridor or a heuristic for the detailed search.
+		*
+		* Long term blocked nodes are excluded from all paths.
+		* Blocking or unblocking nodes marks their clusters as dirty and only the dirty clusters are recomputed during the next repair.
+		* Queries are const and may run concurrently, but not concurrently with building or repairing the hierarchy.
+		*/
+		class TrafficLaneHierarchy : public boost::noncopyable
+		{
+		public:
+			friend struct qsf::serialization::serializer<ai::TrafficLaneHierarchy>; // to allow serializing the data
+
+			static const unsigned int DEFAULT_CLUSTER_SIZE = 200; // Default edge length of a cluster in world units
+			// Increase this every time the serialized data changes, data of other versions is rejected and needs to be rebuilt
+			static const uint32 FORMAT_VERSION = 1;
+
+			// A directed connection between two lane end nodes along one lane, the costs are the length weighted by the area type cost factor
+			struct Edge
+			{
+				Edge();
+				Edge(uint32 sourceNodeId, uint32 targetNodeId, uint32 laneId, float costs);
+
+				uint32 mSourceNodeId;
+				uint32 mTargetNodeId;
+				uint32 mLaneId;
+				float mCosts;
+			};
+
+			// A start or goal node for a query with the costs to reach it from the start or to reach the goal from it respectively
+			struct Endpoint
+			{
+				Endpoint(uint32 nodeId, float costs);
+
+				uint32 mNodeId;
+				float mCosts;
+			};
+
+			// One node along a path found and the lane used to arrive there, uninitialized for the first node
+			struct PathStep
+			{
+				PathStep(uint32 nodeId, uint32 laneId);
+
+				uint32 mNodeId;
+				uint32 mLaneId;
+			};
+
+			explicit TrafficLaneHierarchy(unsigned int moverType = getUninitialized<unsigned int>());
+
+			unsigned int getMoverType() const;
+			float getClusterSize() const;
+			std::size_t getNumNodes() const;
+			std::size_t getNumClusters() const;
+			std::size_t getNumEntrances() const;
+
+			/** Build the complete hierarchy from the lane graph.
+			* The node ids are the indices into the node positions and the edges may be passed in any order.
+			* All nodes start unblocked.
+			*/
+			void build(const std::vector<glm::vec3>& nodePositions, const std::vector<Edge>& edges, float clusterSize);
+
+			// Mark a node as long term blocked or free, this marks the cluster as dirty if the state changed
+			void setNodeBlocked(uint32 nodeId, bool blocked);
+			bool isNodeBlocked(uint32 nodeId) const;
+			// Takes over the long term blocked flags from the node states of the world, returns the number of nodes that changed
+			uint32 synchronizeNodeStates(const WorldElementStateCollection& worldElementStates);
+			// Returns whether nodes changed since the affected clusters were computed, queries fail until the hierarchy is repaired
+			bool hasDirtyClusters() const;
+			// Recompute the entrance costs of all dirty clusters, returns the number of clusters repaired
+			uint32 repairDirtyClusters();
+
+			/** Find the cheapest path from any of the start nodes to any of the goal nodes.
+			* Returns false if no goal can be reached or if there are dirty clusters, call repairDirtyClusters first.
+			* Otherwise the path is written starting with the start node used and ending with the goal node reached, and the optional costs pointer receives the total costs including those of the endpoints.
+			*/
+			bool findPath(const std::vector<Endpoint>& starts, const std::vector<Endpoint>& goals, std::vector<PathStep>& path, float* costs = nullptr) const;
+
+			std::size_t calculateMemoryConsumption() const;
+
+		private:
+			// All nodes belonging to one cluster together with the precomputed costs between its entrances
+			struct Cluster
+			{
+				std::vector<uint32> mNodeIds;
+				std::vector<uint32> mEntranceNodeIds;
+				std::vector<float> mEntranceCosts; // Square matrix with one row for each start entrance, infinity if unreachable inside the cluster
+				bool mDirty;
+
+				Cluster();
+			};
+
+			// Temporary data for searching, kept per thread to avoid allocating for every query
+			struct SearchContext
+			{
+				IndexedDaryHeap<float, std::less<float>> mOpenList; // Keyed by node id
+				std::vector<float> mCosts; // Costs to reach each node, infinity if not reached
+				std::vector<uint32> mPredecessors; // Edge used to reach the node during local searches, previous entrance during abstract searches, uninitialized for sources
+				std::vector<uint32> mReachedNodeIds; // Only these need to be reset before the next search
+
+				void reset(std::size_t numNodes);
+				// Updates the costs and the open list priority if the costs are lower than known before, returns whether this was the case
+					bool tryImprove(uint32 nodeId, float costs, float priority, uint32 predecessor);
+			};
+
+			static SearchContext& getThreadLocalSearchContext();
+
+			// Dijkstra search from the sources restricted to the nodes of the allowed clusters, against the edge direction if searching backwards.
+			// The results are left in the context.
+			void searchLocally(const std::vector<uint32>& allowedClusters, bool backwards, const std::vector<Endpoint>& sources, SearchContext& context) const;
+			void computeEntranceCosts(uint32 clusterId, SearchContext& context);
+			// Returns the costs between two entrances of the same cluster
+			float getEntranceCosts(uint32 fromNodeId, uint32 toNodeId) const;
+			float estimateCostsToGoals(uint32 nodeId, const std::vector<Endpoint>& goals) const;
+			// Appends the path of a finished forward local search up to the node passed, excluding the nodes already contained
+			void appendForwardPath(const SearchContext& context, uint32 lastNodeId, std::vector<PathStep>& path) const;
+			// Appends the path of a finished backward local search from the node passed towards the goal
+			void appendBackwardPath(const SearchContext& context, uint32 firstNodeId, std::vector<PathStep>& path) const;
+			void writeClusterIds(const std::vector<Endpoint>& endpoints, std::vector<uint32>& clusterIds) const;
+			// Derives the per node lookups and the reverse adjacency from the edges and clusters
+			void updateDerivedData();
+
+			unsigned int mMoverType;
+			float mClusterSize;
+			float mHeuristicFactor; // Lower bound of the costs per distance over all edges, keeps the distance heuristic admissible
+
+			std::vector<glm::vec3> mNodePositions;
+			std::vector<Edge> mEdges; // Sorted by source node
+			std::vector<uint32> mFirstEdgeIndices; // Index of the first outgoing edge per node, with one additional entry at the end
+			std::vector<Cluster> mClusters;
+			std::vector<bool> mBlockedNodes;
+			uint32 mNumDirtyClusters; // Number of clusters whose entrance costs need to be recomputed
+
+			// Derived data that is not serialized
+			//@{
+			std::vector<uint32> mFirstIncomingEdgeIndices; // Index into the incoming edges per node, with one additional entry at the end
+			std::vector<uint32> mIncomingEdgeIndices; // Indices into mEdges sorted by target node
+			std::vector<uint32> mClusterIds; // Cluster per node
+			std::vector<uint32> mEntranceIndices; // Index of the node among the entrances of its cluster, uninitialized if the node is no entrance
+			//@}
+		};
+	}
+}
+
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneHierarchy-inl.h"
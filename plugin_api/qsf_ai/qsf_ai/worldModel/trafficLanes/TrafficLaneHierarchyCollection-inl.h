@@ -0,0 +1,203 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneWorld.h"
+#include "qsf_ai/worldModel/AreaType.h"
+
+#include <qsf/base/error/ErrorHandling.h>
+#include <qsf/log/LogSystem.h>
+#include <qsf/serialization/binary/BasicTypeSerialization.h>
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline TrafficLaneHierarchy& TrafficLaneHierarchyCollection::build(const TrafficLaneWorld& world, unsigned int moverType, const std::vector<AreaType>& areaTypes, float clusterSize)
+		{
+			std::vector<glm::vec3> nodePositions;
+			std::vector<TrafficLaneHierarchy::Edge> edges;
+			gatherGraph(world, moverType, areaTypes, nodePositions, edges);
+
+			std::size_t index = 0;
+			while (index < mHierarchies.size() && mHierarchies[index]->getMoverType() != moverType)
+				++index;
+			if (index == mHierarchies.size())
+			{
+				mHierarchies.emplace_back(new TrafficLaneHierarchy(moverType));
+				mChecksums.push_back(0);
+			}
+
+			TrafficLaneHierarchy& hierarchy = *mHierarchies[index];
+			hierarchy.build(nodePositions, edges, clusterSize);
+			if (hierarchy.synchronizeNodeStates(world.getWorldElementsState()) > 0)
+				hierarchy.repairDirtyClusters();
+			mChecksums[index] = calculateChecksum(nodePositions, edges);
+
+			return hierarchy;
+		}
+
+		inline TrafficLaneHierarchy* TrafficLaneHierarchyCollection::tryGet(unsigned int moverType)
+		{
+			for (const std::unique_ptr<TrafficLaneHierarchy>& hierarchy : mHierarchies)
+			{
+				if (hierarchy->getMoverType() == moverType)
+					return hierarchy.get();
+			}
+
+			return nullptr;
+		}
+
+		inline const TrafficLaneHierarchy* TrafficLaneHierarchyCollection::tryGet(unsigned int moverType) const
+		{
+			for (const std::unique_ptr<TrafficLaneHierarchy>& hierarchy : mHierarchies)
+			{
+				if (hierarchy->getMoverType() == moverType)
+					return hierarchy.get();
+			}
+
+			return nullptr;
+		}
+
+		inline uint32 TrafficLaneHierarchyCollection::repair(const TrafficLaneWorld& world)
+		{
+			uint32 numRepairedClusters = 0;
+			for (const std::unique_ptr<TrafficLaneHierarchy>& hierarchy : mHierarchies)
+			{
+				hierarchy->synchronizeNodeStates(world.getWorldElementsState());
+				numRepairedClusters += hierarchy->repairDirtyClusters();
+			}
+
+			return numRepairedClusters;
+		}
+
+		inline void TrafficLaneHierarchyCollection::clear()
+		{
+			mHierarchies.clear();
+			mChecksums.clear();
+		}
+
+		inline bool TrafficLaneHierarchyCollection::isEmpty() const
+		{
+			return mHierarchies.empty();
+		}
+
+		inline void TrafficLaneHierarchyCollection::serialize(BinarySerializer& serializer, const TrafficLaneWorld& world, const std::vector<AreaType>& areaTypes)
+		{
+			uint32 formatVersion = FORMAT_VERSION;
+			serializer & formatVersion;
+			QSF_CHECK(formatVersion == FORMAT_VERSION, "Unsupported traffic lane hierarchy collection format version " << formatVersion << ", expected " << static_cast<uint32>(FORMAT_VERSION),
+				QSF_REACT_THROW);
+
+			uint32 numHierarchies = static_cast<uint32>(mHierarchies.size());
+			serializer & numHierarchies;
+
+			if (serializer.isReading())
+			{
+				clear();
+				std::vector<glm::vec3> nodePositions;
+				std::vector<TrafficLaneHierarchy::Edge> edges;
+				for (uint32 index = 0; index < numHierarchies; ++index)
+				{
+					uint64 checksum = 0;
+					serializer & checksum;
+					std::unique_ptr<TrafficLaneHierarchy> hierarchy(new TrafficLaneHierarchy());
+					serializer & *hierarchy;
+
+					// The lanes, their area types or the cost factors may have changed since the data was written
+					gatherGraph(world, hierarchy->getMoverType(), areaTypes, nodePositions, edges);
+					const uint64 currentChecksum = calculateChecksum(nodePositions, edges);
+					if (checksum != currentChecksum)
+					{
+						QSF_WARN("Rebuilding the outdated traffic lane hierarchy for mover type " << hierarchy->getMoverType() << ", the lanes or costs of the world changed since it was written",
+							QSF_REACT_NONE);
+						hierarchy->build(nodePositions, edges, hierarchy->getClusterSize());
+					}
+
+					mHierarchies.push_back(std::move(hierarchy));
+					mChecksums.push_back(currentChecksum);
+				}
+
+				repair(world);
+			}
+			else
+			{
+				for (std::size_t index = 0; index < mHierarchies.size(); ++index)
+				{
+					serializer & mChecksums[index];
+					serializer & *mHierarchies[index];
+				}
+			}
+		}
+
+		inline void TrafficLaneHierarchyCollection::gatherGraph(const TrafficLaneWorld& world, unsigned int moverType, const std::vector<AreaType>& areaTypes, std::vector<glm::vec3>& nodePositions, std::vector<TrafficLaneHierarchy::Edge>& edges)
+		{
+			const unsigned int numNodes = static_cast<unsigned int>(world.getNumNodes());
+			nodePositions.clear();
+			nodePositions.reserve(numNodes);
+			for (unsigned int nodeId = 0; nodeId < numNodes; ++nodeId)
+				nodePositions.push_back(world.getLaneEndNode(nodeId).getPosition());
+
+			// Each lane may be used in both directions, depending on the cost factors of its area type
+			const LaneCollection& lanes = world.getLanes();
+			edges.clear();
+			for (unsigned int laneId = 0; laneId < lanes.getNumLanes(); ++laneId)
+			{
+				const Lane& lane = lanes.getLane(laneId);
+				if (!isInitialized(lane.getTypeId()) || lane.getTypeId() >= areaTypes.size())
+					continue; // erased lane
+
+				const AreaType& areaType = areaTypes[lane.getTypeId()];
+				const float length = lane.getLength().getValue();
+				if (const UnsignedFloat* costFactor = areaType.tryGetCostFactorFor(moverType, true))
+					edges.push_back(TrafficLaneHierarchy::Edge(lane.getStartNodeId(), lane.getEndNodeId(), laneId, length * costFactor->getValue()));
+				if (const UnsignedFloat* costFactor = areaType.tryGetCostFactorFor(moverType, false))
+					edges.push_back(TrafficLaneHierarchy::Edge(lane.getEndNodeId(), lane.getStartNodeId(), laneId, length * costFactor->getValue()));
+			}
+		}
+
+		inline uint64 TrafficLaneHierarchyCollection::calculateChecksum(const std::vector<glm::vec3>& nodePositions, const std::vector<TrafficLaneHierarchy::Edge>& edges)
+		{
+			uint64 checksum = 14695981039346656037ull;
+			const auto addBytes = [&checksum](const void* data, std::size_t numBytes)
+			{
+				const uint8* bytes = static_cast<const uint8*>(data);
+				for (std::size_t index = 0; index < numBytes; ++index)
+				{
+					checksum ^= bytes[index];
+					checksum *= 1099511628211ull;
+				}
+			};
+
+			// Add the members one by one, the padding of the structures is not initialized
+			const uint32 numNodes = static_cast<uint32>(nodePositions.size());
+			addBytes(&numNodes, sizeof(numNodes));
+			for (const glm::vec3& position : nodePositions)
+			{
+				addBytes(&position.x, sizeof(float));
+				addBytes(&position.y, sizeof(float));
+				addBytes(&position.z, sizeof(float));
+			}
+
+			const uint32 numEdges = static_cast<uint32>(edges.size());
+			addBytes(&numEdges, sizeof(numEdges));
+			for (const TrafficLaneHierarchy::Edge& edge : edges)
+			{
+				addBytes(&edge.mSourceNodeId, sizeof(edge.mSourceNodeId));
+				addBytes(&edge.mTargetNodeId, sizeof(edge.mTargetNodeId));
+				addBytes(&edge.mLaneId, sizeof(edge.mLaneId));
+				addBytes(&edge.mCosts, sizeof(edge.mCosts));
+			}
+
+			return checksum;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneHierarchy.h"
+
+#include <qsf/serialization/binary/BinarySerializer.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace qsf
+{
+	namespace ai
+	{
+		class TrafficLaneWorld;
+		class AreaType;
+
+		/** The search hierarchies of one traffic lane world, at most one per mover type.
+		* This is owned by the code using the hierarchies and kept next to the world, the world itself doesn't know about it.
+		* The owner is responsible for keeping it in sync:
+		* - build again after the lanes of the world changed, e.g. after a map adaptation
+		* - repair after node states changed, e.g. after the world's updateNodeStates or resetNodeStates; queries of a hierarchy fail while it has dirty clusters
+		* The serialized data is meant to be stored in a file of its own next to the binary traffic lane world data.
+		* It has a format version of its own, outdated data is rejected and needs to be rebuilt.
+		* Each hierarchy is stored with a checksum of the node positions, lanes and costs it was built from, to detect changes of the world or the area types in between.
+		*/
+		class TrafficLaneHierarchyCollection : public boost::noncopyable
+		{
+		public:
+			// Increase this every time the serialized collection data changes, see TrafficLaneHierarchy::FORMAT_VERSION for the data of the single hierarchies
+			static const uint32 FORMAT_VERSION = 2;
+
+			// Builds or rebuilds the hierarchy for the mover type from the current lanes and node states of the world
+			TrafficLaneHierarchy& build(const TrafficLaneWorld& world, unsigned int moverType, const std::vector<AreaType>& areaTypes, float clusterSize = static_cast<float>(TrafficLaneHierarchy::DEFAULT_CLUSTER_SIZE));
+
+			// Returns a nullptr if there is no hierarchy for this mover type
+			//@{
+			TrafficLaneHierarchy* tryGet(unsigned int moverType);
+			const TrafficLaneHierarchy* tryGet(unsigned int moverType) const;
+			//@}
+
+			// Takes over the current node states of the world into all hierarchies and recomputes the affected clusters, returns the number of clusters repaired
+			uint32 repair(const TrafficLaneWorld& world);
+
+			void clear();
+			bool isEmpty() const;
+
+			/** Reads or writes all hierarchies.
+			* When reading, hierarchies whose checksum doesn't match the world and the area types passed anymore are rebuilt with their cluster size and a warning.
+			* The node states of the world are taken over, so the hierarchies read are ready to be used.
+			* Throws an exception in case of unsupported format versions.
+			*/
+			void serialize(BinarySerializer& serializer, const TrafficLaneWorld& world, const std::vector<AreaType>& areaTypes);
+
+		private:
+			// Collects the node positions and the edges with their costs for the mover type from the current lanes of the world
+			static void gatherGraph(const TrafficLaneWorld& world, unsigned int moverType, const std::vector<AreaType>& areaTypes, std::vector<glm::vec3>& nodePositions, std::vector<TrafficLaneHierarchy::Edge>& edges);
+			// FNV-1a over the node positions and the edges including their costs
+			static uint64 calculateChecksum(const std::vector<glm::vec3>& nodePositions, const std::vector<TrafficLaneHierarchy::Edge>& edges);
+
+			std::vector<std::unique_ptr<TrafficLaneHierarchy>> mHierarchies;
+			std::vector<uint64> mChecksums; // Checksum of the graph each hierarchy was built from, same order as mHierarchies
+		};
+	}
+}
+
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneHierarchyCollection-inl.h"
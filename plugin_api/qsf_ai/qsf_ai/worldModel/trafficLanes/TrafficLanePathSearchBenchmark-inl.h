@@ -0,0 +1,132 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/algorithm/AStar.h"
+#include "qsf_ai/algorithm/IndexedAStar.h"
+#include "qsf_ai/worldModel/trafficLanes/LaneCollection.h"
+#include "qsf_ai/worldModel/trafficLanes/LaneEndNode.h"
+#include "qsf_ai/worldModel/trafficLanes/Lane.h"
+
+#include <qsf/time/HighResolutionStopwatch.h>
+
+#include <cmath>
+
+namespace qsf
+{
+	namespace ai
+	{
+		inline TrafficLanePathSearchBenchmark::Result TrafficLanePathSearchBenchmark::run(const TrafficLaneWorld& world, uint32 numberOfSearches, uint32 seed)
+		{
+			Result result;
+			result.mNumberOfSearches = numberOfSearches;
+			result.mNumberOfPathsFound = 0;
+			result.mResultsMatch = true;
+
+			const unsigned int numberOfNodes = static_cast<unsigned int>(world.getNumNodes());
+			if (numberOfNodes == 0 || numberOfSearches == 0)
+				return result;
+
+			// Simple linear congruential generator, only needs to be deterministic
+			std::vector<std::pair<unsigned int, unsigned int> > startGoalPairs;
+			startGoalPairs.reserve(numberOfSearches);
+			uint32 randomState = seed;
+			for (uint32 searchIndex = 0; searchIndex < numberOfSearches; ++searchIndex)
+			{
+				randomState = randomState * 1664525u + 1013904223u;
+				const unsigned int startNodeId = (randomState >> 8) % numberOfNodes;
+				randomState = randomState * 1664525u + 1013904223u;
+				const unsigned int goalNodeId = (randomState >> 8) % numberOfNodes;
+				startGoalPairs.push_back(std::make_pair(startNodeId, goalNodeId));
+			}
+
+			std::vector<float> aStarPathCosts;
+			std::vector<float> indexedAStarPathCosts;
+			runSearches<AStar>(world, startGoalPairs, aStarPathCosts, result.mAStarTime);
+			runSearches<IndexedAStar>(world, startGoalPairs, indexedAStarPathCosts, result.mIndexedAStarTime);
+
+			for (uint32 searchIndex = 0; searchIndex < numberOfSearches; ++searchIndex)
+			{
+				const float aStarCosts = aStarPathCosts[searchIndex];
+				const float indexedAStarCosts = indexedAStarPathCosts[searchIndex];
+				if (aStarCosts >= 0.0f)
+					++result.mNumberOfPathsFound;
+
+				// Both have to find a path of the same costs, the paths themselves may differ between equally cheap alternatives
+				if ((aStarCosts < 0.0f) != (indexedAStarCosts < 0.0f) || std::abs(aStarCosts - indexedAStarCosts) > 0.001f * std::max(1.0f, aStarCosts))
+					result.mResultsMatch = false;
+			}
+
+			return result;
+		}
+
+		template <template <typename> class Search>
+		void TrafficLanePathSearchBenchmark::runSearches(const TrafficLaneWorld& world, const std::vector<std::pair<unsigned int, unsigned int> >& startGoalPairs, std::vector<float>& outPathCosts, Time& outTime)
+		{
+			outPathCosts.clear();
+			outPathCosts.reserve(startGoalPairs.size());
+
+			HighResolutionStopwatch stopwatch;
+			for (std::size_t searchIndex = 0; searchIndex < startGoalPairs.size(); ++searchIndex)
+			{
+				// The search states carry the search progress, so each search needs a fresh search space, the same for both implementations
+				LaneGraphMechanics mechanics(world, startGoalPairs[searchIndex].second);
+				Search<LaneGraphMechanics> search(mechanics);
+				search.addStart(startGoalPairs[searchIndex].first, UnsignedFloatCosts());
+				search.execute();
+
+				outPathCosts.push_back(search.isSuccess() ? *(*search.getGoalFound().getCostsToGetHere()) : -1.0f);
+			}
+			outTime = stopwatch.getElapsed();
+		}
+
+		inline TrafficLanePathSearchBenchmark::LaneGraphMechanics::LaneGraphMechanics(const TrafficLaneWorld& world, unsigned int goalNodeId) :
+			mWorld(world),
+			mSearchSpace(world.getNumNodes()),
+			mGoalNodeId(goalNodeId),
+			mGoalPosition(world.getLaneEndNode(goalNodeId).getPosition())
+		{}
+
+		inline TrafficLanePathSearchBenchmark::SearchState& TrafficLanePathSearchBenchmark::LaneGraphMechanics::getState(std::size_t index)
+		{
+			return mSearchSpace.getState(index);
+		}
+
+		inline std::size_t TrafficLanePathSearchBenchmark::LaneGraphMechanics::getIndex(const SearchState& state)
+		{
+			return mSearchSpace.getIndex(state);
+		}
+
+		inline UnsignedFloatCosts TrafficLanePathSearchBenchmark::LaneGraphMechanics::estimateCostsToGoal(const SearchState& state) const
+		{
+			// Lanes are never shorter than the straight distance between their end nodes, so this never overestimates
+			const unsigned int nodeId = static_cast<unsigned int>(mSearchSpace.getIndex(state));
+			return UnsignedFloatCosts::fromDistance(glm::distance(mWorld.getLaneEndNode(nodeId).getPosition(), mGoalPosition));
+		}
+
+		inline bool TrafficLanePathSearchBenchmark::LaneGraphMechanics::isGoal(const SearchState& state) const
+		{
+			return mSearchSpace.getIndex(state) == mGoalNodeId;
+		}
+
+		inline void TrafficLanePathSearchBenchmark::LaneGraphMechanics::expand(SearchState& current, std::vector<WeightedState<SearchState> >& followUpStates)
+		{
+			const unsigned int nodeId = static_cast<unsigned int>(mSearchSpace.getIndex(current));
+			const TrafficLaneWorld::IDRange connections = mWorld.getAllConnectionsForNode(nodeId);
+			for (std::multimap<unsigned int, unsigned int>::const_iterator iterator = connections.first; iterator != connections.second; ++iterator)
+			{
+				const Lane& lane = mWorld.getLanes().getLane(iterator->second);
+				const unsigned int nextNodeId = lane.getOtherEndNodeId(nodeId);
+				followUpStates.push_back(WeightedState<SearchState>(&mSearchSpace.getState(nextNodeId), current.getCostsToGetHere() + UnsignedFloatCosts::fromDistance(lane.getLength())));
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneWorld.h"
+#include "qsf_ai/algorithm/SimpleSearchState.h"
+#include "qsf_ai/algorithm/StaticSearchSpace.h"
+#include "qsf_ai/algorithm/UnsignedFloatCosts.h"
+#include "qsf_ai/algorithm/WeightedState.h"
+
+#include <qsf/time/Time.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		/** Benchmark of IndexedAStar against AStar on the lane graph of a traffic lane world, e.g. one loaded by loadTrafficLaneWorldMemoryMapped.
+		* Both searches get the same start and goal pairs, driven by a fixed random seed.
+		* The search runs over the lane end nodes with the lane lengths as costs and the straight distance as heuristic.
+		* Lane directions and mover types are ignored since this is about the costs of the open list handling and not about the routing rules.
+		* Usage, e.g. from a debug command of a plugin:
+		* @code
+		*   const qsf::ai::TrafficLanePathSearchBenchmark::Result result = qsf::ai::TrafficLanePathSearchBenchmark::run(world, 1000);
+		*   QSF_LOG_PRINTS(INFO, "AStar: " << result.mAStarTime.getMilliseconds() << " ms, IndexedAStar: " << result.mIndexedAStarTime.getMilliseconds() << " ms");
+		* @endcode
+		*/
+		class TrafficLanePathSearchBenchmark
+		{
+		public:
+			struct Result
+			{
+				Time mAStarTime; // Time needed by AStar for all searches
+				Time mIndexedAStarTime; // Time needed by IndexedAStar for all searches
+				uint32 mNumberOfSearches;
+				uint32 mNumberOfPathsFound; // Number of searches that reached their goal
+				bool mResultsMatch; // true if both found paths of the same costs for all searches
+			};
+
+			// Runs the given number of searches with each search implementation
+			inline static Result run(const TrafficLaneWorld& world, uint32 numberOfSearches, uint32 seed = 1);
+
+		private:
+			typedef SimpleSearchState<UnsignedFloatCosts> SearchState;
+
+			// Search mechanics over the lane end nodes, see SearchMechanics
+			class LaneGraphMechanics
+			{
+			public:
+				typedef TrafficLanePathSearchBenchmark::SearchState SearchState;
+
+				inline LaneGraphMechanics(const TrafficLaneWorld& world, unsigned int goalNodeId);
+
+				inline SearchState& getState(std::size_t index);
+				inline std::size_t getIndex(const SearchState& state);
+				inline UnsignedFloatCosts estimateCostsToGoal(const SearchState& state) const;
+				inline bool isGoal(const SearchState& state) const;
+				inline void expand(SearchState& current, std::vector<WeightedState<SearchState> >& followUpStates);
+
+			private:
+				const TrafficLaneWorld& mWorld;
+				StaticSearchSpace<SearchState> mSearchSpace;
+				unsigned int mGoalNodeId;
+				glm::vec3 mGoalPosition;
+			};
+
+			// Runs all searches with the given search implementation, writes the costs of the path found per search or a negative value if the search failed
+			template <template <typename> class Search>
+			static void runSearches(const TrafficLaneWorld& world, const std::vector<std::pair<unsigned int, unsigned int> >& startGoalPairs, std::vector<float>& outPathCosts, Time& outTime);
+		};
+	}
+}
+
+#include "qsf_ai/worldModel/trafficLanes/TrafficLanePathSearchBenchmark-inl.h"
@@ -0,0 +1,38 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneWorldBinarySerializer.h"
+#include "qsf_ai/worldModel/trafficLanes/TrafficLaneWorld.h"
+
+#include <qsf/serialization/binary/MemoryMappedBinaryInput.h>
+
+#include <string>
+
+
+namespace qsf
+{
+	namespace ai
+	{
+		// Loads a binary traffic lane world from a memory mapped file instead of a file stream.
+		// The binary serializer reads the header while opening the file, which is what TrafficLaneWorldBinarySerializer::deserialize expects.
+		// Returns an empty pointer if the file can't be mapped, use the file stream then, e.g. for files inside of mounted archives.
+		// Throws in case the content is invalid, the same as reading it from a file stream.
+		inline std::auto_ptr<TrafficLaneWorld> loadTrafficLaneWorldMemoryMapped(const std::string& absoluteFilename)
+		{
+			MemoryMappedBinaryInput memoryMappedBinaryInput;
+			if (!memoryMappedBinaryInput.open(absoluteFilename))
+				return std::auto_ptr<TrafficLaneWorld>();
+
+			return TrafficLaneWorldBinarySerializer::deserialize(memoryMappedBinaryInput.getSerializer());
+		}
+	}
+}
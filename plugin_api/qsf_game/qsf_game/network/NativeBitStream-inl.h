@@ -0,0 +1,461 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_game/network/BitStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace game
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		inline NativeBitStream::NativeBitStream() :
+			mAccumulator(0),
+			mNumberOfAccumulatedBits(0),
+			mReadPosition(0)
+		{
+			// Nothing to do in here
+		}
+
+		inline void NativeBitStream::reset()
+		{
+			mWords.clear();
+			mAccumulator = 0;
+			mNumberOfAccumulatedBits = 0;
+			mReadPosition = 0;
+		}
+
+		inline void NativeBitStream::reserve(size_t numberOfBits)
+		{
+			mWords.reserve(numberOfBits / 64 + 1);
+		}
+
+		inline size_t NativeBitStream::getBitLength() const
+		{
+			return mWords.size() * 64 + mNumberOfAccumulatedBits;
+		}
+
+		inline size_t NativeBitStream::getReadPosition() const
+		{
+			return mReadPosition;
+		}
+
+		inline void NativeBitStream::setReadPosition(size_t position) const
+		{
+			mReadPosition = std::min(position, getBitLength());
+		}
+
+		inline void NativeBitStream::write(bool value)
+		{
+			writeBits(value ? 1 : 0, 1);
+		}
+
+		inline void NativeBitStream::writeBits(uint64 value, uint32 numberOfBits)
+		{
+			value &= getMask(numberOfBits);
+			mAccumulator |= value << mNumberOfAccumulatedBits;
+
+			const uint32 numberOfBitsTotal = mNumberOfAccumulatedBits + numberOfBits;
+			if (numberOfBitsTotal < 64)
+			{
+				mNumberOfAccumulatedBits = numberOfBitsTotal;
+			}
+			else
+			{
+				// Accumulator is full, keep the bits which didn't fit
+				mWords.push_back(mAccumulator);
+				mAccumulator = (0 == mNumberOfAccumulatedBits) ? 0 : (value >> (64 - mNumberOfAccumulatedBits));
+				mNumberOfAccumulatedBits = numberOfBitsTotal - 64;
+			}
+		}
+
+		inline void NativeBitStream::write(uint8 value, uint32 numberOfBits)
+		{
+			writeBits(value, numberOfBits);
+		}
+
+		inline void NativeBitStream::write(uint16 value, uint32 numberOfBits)
+		{
+			writeBits(value, numberOfBits);
+		}
+
+		inline void NativeBitStream::write(uint32 value, uint32 numberOfBits)
+		{
+			writeBits(value, numberOfBits);
+		}
+
+		inline void NativeBitStream::write(uint64 value, uint32 numberOfBits)
+		{
+			writeBits(value, numberOfBits);
+		}
+
+		inline void NativeBitStream::write(int8 value, uint32 numberOfBits)
+		{
+			writeBits(static_cast<uint8>(value), numberOfBits);
+		}
+
+		inline void NativeBitStream::write(int16 value, uint32 numberOfBits)
+		{
+			writeBits(static_cast<uint16>(value), numberOfBits);
+		}
+
+		inline void NativeBitStream::write(int32 value, uint32 numberOfBits)
+		{
+			writeBits(static_cast<uint32>(value), numberOfBits);
+		}
+
+		inline void NativeBitStream::write(int64 value, uint32 numberOfBits)
+		{
+			writeBits(static_cast<uint64>(value), numberOfBits);
+		}
+
+		inline void NativeBitStream::write(float value)
+		{
+			uint32 bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			writeBits(bits, 32);
+		}
+
+		inline void NativeBitStream::write(double value)
+		{
+			uint64 bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			writeBits(bits, 64);
+		}
+
+		inline void NativeBitStream::alignToByte()
+		{
+			const uint32 numberOfPaddingBits = (8 - (mNumberOfAccumulatedBits & 7)) & 7;
+			if (numberOfPaddingBits > 0)
+			{
+				writeBits(0, numberOfPaddingBits);
+			}
+		}
+
+		inline void NativeBitStream::writeBytes(const uint8* bytes, size_t numberOfBytes)
+		{
+			alignToByte();
+
+			// Fill up the accumulator byte-wise, then copy whole words
+			for (; numberOfBytes > 0 && 0 != mNumberOfAccumulatedBits; ++bytes, --numberOfBytes)
+			{
+				writeBits(*bytes, 8);
+			}
+			if (numberOfBytes >= 8)
+			{
+				const size_t numberOfWords = numberOfBytes / 8;
+				const size_t firstWord = mWords.size();
+				mWords.resize(firstWord + numberOfWords);
+				std::memcpy(&mWords[firstWord], bytes, numberOfWords * 8);
+				bytes += numberOfWords * 8;
+				numberOfBytes -= numberOfWords * 8;
+			}
+			for (; numberOfBytes > 0; ++bytes, --numberOfBytes)
+			{
+				writeBits(*bytes, 8);
+			}
+		}
+
+		inline void NativeBitStream::writeQuantizedFloats(const float* values, size_t numberOfValues, float minimum, float maximum, uint32 numberOfBits)
+		{
+			const double maximumValue = static_cast<double>(getMask(numberOfBits));
+			const double range = std::max(static_cast<double>(maximum) - minimum, 1e-30);
+			size_t index = 0;
+
+			#ifdef QSF_GAME_NATIVE_BIT_STREAM_SSE2
+				// The float pipeline is exact enough for up to 24 bits, and the conversion to signed 32 bit integers can't overflow
+				if (numberOfBits <= 24)
+				{
+					const __m128 minimumVector = _mm_set1_ps(minimum);
+					const __m128 maximumVector = _mm_set1_ps(maximum);
+					const __m128 scale = _mm_set1_ps(static_cast<float>(maximumValue / range));
+					const __m128 half = _mm_set1_ps(0.5f);
+					const __m128 maximumQuantizedValue = _mm_set1_ps(static_cast<float>(maximumValue));
+					uint32 quantizedValues[4];
+					for (; index + 4 <= numberOfValues; index += 4)
+					{
+						const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + index), minimumVector), maximumVector);
+						const __m128 scaled = _mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(clamped, minimumVector), scale), half), maximumQuantizedValue);
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(quantizedValues), _mm_cvttps_epi32(scaled));
+
+						// Pack two values per call, the sum of both never exceeds 48 bits
+						writeBits(static_cast<uint64>(quantizedValues[0]) | (static_cast<uint64>(quantizedValues[1]) << numberOfBits), numberOfBits * 2);
+						writeBits(static_cast<uint64>(quantizedValues[2]) | (static_cast<uint64>(quantizedValues[3]) << numberOfBits), numberOfBits * 2);
+					}
+				}
+			#endif
+
+			// Remaining values
+			for (; index < numberOfValues; ++index)
+			{
+				const double clamped = std::min(std::max(static_cast<double>(values[index]), static_cast<double>(minimum)), static_cast<double>(maximum));
+				const double scaled = std::min((clamped - minimum) * maximumValue / range + 0.5, maximumValue);
+				writeBits(static_cast<uint64>(scaled), numberOfBits);
+			}
+		}
+
+		inline bool NativeBitStream::read(bool& value) const
+		{
+			uint64 bits = 0;
+			if (!readBits(bits, 1))
+			{
+				return false;
+			}
+			value = (0 != bits);
+			return true;
+		}
+
+		inline bool NativeBitStream::readBits(uint64& value, uint32 numberOfBits) const
+		{
+			if (mReadPosition + numberOfBits > getBitLength())
+			{
+				return false;
+			}
+
+			const size_t wordIndex = mReadPosition >> 6;
+			const uint32 bitOffset = static_cast<uint32>(mReadPosition & 63);
+			uint64 bits = getWord(wordIndex) >> bitOffset;
+			if (bitOffset + numberOfBits > 64)
+			{
+				bits |= getWord(wordIndex + 1) << (64 - bitOffset);
+			}
+			value = bits & getMask(numberOfBits);
+			mReadPosition += numberOfBits;
+			return true;
+		}
+
+		inline bool NativeBitStream::read(uint8& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = static_cast<uint8>(bits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(uint16& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = static_cast<uint16>(bits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(uint32& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = static_cast<uint32>(bits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(uint64& value, uint32 numberOfBits) const
+		{
+			return readBits(value, numberOfBits);
+		}
+
+		inline bool NativeBitStream::read(int8& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = signExtend<int8>(bits, numberOfBits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(int16& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = signExtend<int16>(bits, numberOfBits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(int32& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = signExtend<int32>(bits, numberOfBits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(int64& value, uint32 numberOfBits) const
+		{
+			uint64 bits = 0;
+			const bool result = readBits(bits, numberOfBits);
+			value = signExtend<int64>(bits, numberOfBits);
+			return result;
+		}
+
+		inline bool NativeBitStream::read(float& value) const
+		{
+			uint64 bits = 0;
+			if (!readBits(bits, 32))
+			{
+				return false;
+			}
+			const uint32 bits32 = static_cast<uint32>(bits);
+			std::memcpy(&value, &bits32, sizeof(value));
+			return true;
+		}
+
+		inline bool NativeBitStream::read(double& value) const
+		{
+			uint64 bits = 0;
+			if (!readBits(bits, 64))
+			{
+				return false;
+			}
+			std::memcpy(&value, &bits, sizeof(value));
+			return true;
+		}
+
+		inline bool NativeBitStream::skipToByte() const
+		{
+			const size_t position = (mReadPosition + 7) & ~static_cast<size_t>(7);
+			if (position > getBitLength())
+			{
+				return false;
+			}
+			mReadPosition = position;
+			return true;
+		}
+
+		inline bool NativeBitStream::readBytes(uint8* bytes, size_t numberOfBytes) const
+		{
+			if (!skipToByte() || mReadPosition + numberOfBytes * 8 > getBitLength())
+			{
+				return false;
+			}
+
+			// Same split as in "writeBytes()": byte-wise up to a word boundary, then whole words
+			uint64 bits = 0;
+			for (; numberOfBytes > 0 && 0 != (mReadPosition & 63); ++bytes, --numberOfBytes)
+			{
+				readBits(bits, 8);
+				*bytes = static_cast<uint8>(bits);
+			}
+			if (numberOfBytes >= 8 && (mReadPosition >> 6) + numberOfBytes / 8 <= mWords.size())
+			{
+				const size_t numberOfWords = numberOfBytes / 8;
+				std::memcpy(bytes, &mWords[mReadPosition >> 6], numberOfWords * 8);
+				mReadPosition += numberOfWords * 64;
+				bytes += numberOfWords * 8;
+				numberOfBytes -= numberOfWords * 8;
+			}
+			for (; numberOfBytes > 0; ++bytes, --numberOfBytes)
+			{
+				readBits(bits, 8);
+				*bytes = static_cast<uint8>(bits);
+			}
+			return true;
+		}
+
+		inline bool NativeBitStream::readQuantizedFloats(float* values, size_t numberOfValues, float minimum, float maximum, uint32 numberOfBits) const
+		{
+			if (mReadPosition + numberOfValues * numberOfBits > getBitLength())
+			{
+				return false;
+			}
+
+			const double step = (static_cast<double>(maximum) - minimum) / static_cast<double>(getMask(numberOfBits));
+			uint64 bits = 0;
+			for (size_t index = 0; index < numberOfValues; ++index)
+			{
+				readBits(bits, numberOfBits);
+				values[index] = static_cast<float>(minimum + static_cast<double>(bits) * step);
+			}
+			return true;
+		}
+
+		inline void NativeBitStream::writeToBitStream(BitStream& bitStream) const
+		{
+			bitStream.write(static_cast<uint32>(getBitLength()));
+			for (uint64 word : mWords)
+			{
+				bitStream.write(word);
+			}
+			if (mNumberOfAccumulatedBits > 0)
+			{
+				bitStream.write(mAccumulator, mNumberOfAccumulatedBits);
+			}
+		}
+
+		inline bool NativeBitStream::readFromBitStream(const BitStream& bitStream)
+		{
+			reset();
+
+			uint32 numberOfBits = 0;
+			if (!bitStream.read(numberOfBits))
+			{
+				return false;
+			}
+
+			// The length comes from the network, never allocate more than the source stream can deliver
+			const size_t bitLength = bitStream.getBitLength();
+			const size_t readPosition = bitStream.getReadPosition();
+			if (readPosition > bitLength || numberOfBits > bitLength - readPosition)
+			{
+				return false;
+			}
+
+			mWords.resize(numberOfBits / 64);
+			for (uint64& word : mWords)
+			{
+				if (!bitStream.read(word))
+				{
+					reset();
+					return false;
+				}
+			}
+
+			mNumberOfAccumulatedBits = numberOfBits % 64;
+			if (mNumberOfAccumulatedBits > 0 && !bitStream.read(mAccumulator, mNumberOfAccumulatedBits))
+			{
+				reset();
+				return false;
+			}
+			return true;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline uint64 NativeBitStream::getMask(uint32 numberOfBits)
+		{
+			return (numberOfBits >= 64) ? ~uint64(0) : ((uint64(1) << numberOfBits) - 1);
+		}
+
+		inline uint64 NativeBitStream::getWord(size_t index) const
+		{
+			return (index < mWords.size()) ? mWords[index] : mAccumulator;
+		}
+
+		template<typename T>
+		inline T NativeBitStream::signExtend(uint64 value, uint32 numberOfBits)
+		{
+			if (numberOfBits > 0 && numberOfBits < 64 && 0 != (value & (uint64(1) << (numberOfBits - 1))))
+			{
+				value |= ~getMask(numberOfBits);
+			}
+			return static_cast<T>(static_cast<int64>(value));
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // game
+} // qsf
@@ -0,0 +1,229 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <qsf/platform/PlatformTypes.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define QSF_GAME_NATIVE_BIT_STREAM_SSE2
+#endif
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace game
+	{
+		class BitStream;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace game
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Header-only bit stream without the linnet virtual interface, for writing and reading many small fields
+		*
+		*  @remarks
+		*    Bits are collected in a 64 bit accumulator which is appended to a word buffer when full, values are stored least significant bit first.
+		*    All calls are inlined, so a field costs a few shifts instead of a call through "IBitStream".
+		*
+		*    Besides single values there are bulk methods: "writeQuantizedFloats()" quantizes four floats at once using SSE2 and packs the results,
+		*    "writeBytes()" aligns to a byte boundary and copies whole words where possible.
+		*
+		*    The data is moved into a "qsf::game::BitStream" message with "writeToBitStream()" in 64 bit chunks,
+		*    the receiving side restores it with "readFromBitStream()". Both calls go through the linnet interface only once per 64 bits.
+		*
+		*  @note
+		*    - The bit layout differs from "qsf::game::BitStream", use "writeToBitStream()"/"readFromBitStream()" to embed it, don't mix single values
+		*    - Like "qsf::game::BitStream" reading is const and only moves the read position
+		*/
+		class NativeBitStream : public boost::noncopyable
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public methods                                        ]
+		//[-------------------------------------------------------]
+		public:
+			inline NativeBitStream();
+
+			/**
+			*  @brief
+			*    Remove all data and reset the read position, the memory is kept for reuse
+			*/
+			inline void reset();
+
+			/**
+			*  @brief
+			*    Reserve memory for the given number of bits
+			*/
+			inline void reserve(size_t numberOfBits);
+
+			inline size_t getBitLength() const;
+			inline size_t getReadPosition() const;
+			inline void setReadPosition(size_t position) const;
+
+			//[-------------------------------------------------------]
+			//[ Write                                                 ]
+			//[-------------------------------------------------------]
+			inline void write(bool value);
+
+			/**
+			*  @brief
+			*    Write the lower "numberOfBits" bits of the value, 1 to 64 bits
+			*/
+			inline void writeBits(uint64 value, uint32 numberOfBits);
+
+			inline void write(uint8 value, uint32 numberOfBits = 8);
+			inline void write(uint16 value, uint32 numberOfBits = 16);
+			inline void write(uint32 value, uint32 numberOfBits = 32);
+			inline void write(uint64 value, uint32 numberOfBits = 64);
+			inline void write(int8 value, uint32 numberOfBits = 8);
+			inline void write(int16 value, uint32 numberOfBits = 16);
+			inline void write(int32 value, uint32 numberOfBits = 32);
+			inline void write(int64 value, uint32 numberOfBits = 64);
+			inline void write(float value);
+			inline void write(double value);
+
+			/**
+			*  @brief
+			*    Pad with zero bits up to the next byte boundary
+			*/
+			inline void alignToByte();
+
+			/**
+			*  @brief
+			*    Write raw bytes starting at the next byte boundary
+			*/
+			inline void writeBytes(const uint8* bytes, size_t numberOfBytes);
+
+			/**
+			*  @brief
+			*    Write an array of floats, each quantized to "numberOfBits" bits inside [minimum, maximum]
+			*
+			*  @param[in] numberOfBits
+			*    Bits per value, 1 to 32
+			*
+			*  @note
+			*    - Values outside the range are clamped
+			*/
+			inline void writeQuantizedFloats(const float* values, size_t numberOfValues, float minimum, float maximum, uint32 numberOfBits);
+
+			//[-------------------------------------------------------]
+			//[ Read                                                  ]
+			//[-------------------------------------------------------]
+			inline bool read(bool& value) const;
+
+			/**
+			*  @brief
+			*    Read "numberOfBits" bits, 1 to 64 bits
+			*
+			*  @return
+			*    "false" if there are not enough bits left, the read position is unchanged in this case
+			*/
+			inline bool readBits(uint64& value, uint32 numberOfBits) const;
+
+			inline bool read(uint8& value, uint32 numberOfBits = 8) const;
+			inline bool read(uint16& value, uint32 numberOfBits = 16) const;
+			inline bool read(uint32& value, uint32 numberOfBits = 32) const;
+			inline bool read(uint64& value, uint32 numberOfBits = 64) const;
+			inline bool read(int8& value, uint32 numberOfBits = 8) const;
+			inline bool read(int16& value, uint32 numberOfBits = 16) const;
+			inline bool read(int32& value, uint32 numberOfBits = 32) const;
+			inline bool read(int64& value, uint32 numberOfBits = 64) const;
+			inline bool read(float& value) const;
+			inline bool read(double& value) const;
+
+			/**
+			*  @brief
+			*    Skip to the next byte boundary, counterpart of "alignToByte()"
+			*/
+			inline bool skipToByte() const;
+
+			inline bool readBytes(uint8* bytes, size_t numberOfBytes) const;
+
+			inline bool readQuantizedFloats(float* values, size_t numberOfValues, float minimum, float maximum, uint32 numberOfBits) const;
+
+			//[-------------------------------------------------------]
+			//[ Transfer                                              ]
+			//[-------------------------------------------------------]
+			/**
+			*  @brief
+			*    Append the content to a bit stream as a 32 bit length followed by 64 bit chunks
+			*/
+			inline void writeToBitStream(BitStream& bitStream) const;
+
+			/**
+			*  @brief
+			*    Replace the content with data written by "writeToBitStream()"
+			*
+			*  @return
+			*    "true" on success, "false" if the bit stream ends too early, e.g. because the length read is more than the bits left; the content is empty then
+			*/
+			inline bool readFromBitStream(const BitStream& bitStream);
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		private:
+			inline static uint64 getMask(uint32 numberOfBits);
+
+			// Return the word at the given index, including the accumulator as last word
+			inline uint64 getWord(size_t index) const;
+
+			template<typename T>
+			inline static T signExtend(uint64 value, uint32 numberOfBits);
+
+
+		//[-------------------------------------------------------]
+		//[ Private data                                          ]
+		//[-------------------------------------------------------]
+		private:
+			std::vector<uint64>	mWords;						///< Full 64 bit words
+			uint64				mAccumulator;				///< Bits not yet appended to "mWords"
+			uint32				mNumberOfAccumulatedBits;	///< Always below 64
+			mutable size_t		mReadPosition;				///< In bits
+
+
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // game
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf_game/network/NativeBitStream-inl.h"
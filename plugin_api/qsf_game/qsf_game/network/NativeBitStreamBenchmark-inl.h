@@ -0,0 +1,150 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_game/network/BitStream.h"
+
+#include <qsf/time/HighResolutionStopwatch.h>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace game
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Public static methods                                 ]
+		//[-------------------------------------------------------]
+		inline NativeBitStreamBenchmark::Result NativeBitStreamBenchmark::run(uint32 numberOfEntities, uint32 numberOfRepetitions)
+		{
+			EntitySnapshots input(numberOfEntities);
+			for (uint32 i = 0; i < numberOfEntities; ++i)
+			{
+				EntitySnapshot& snapshot = input[i];
+				snapshot.mEntityId = 100000 + i * 7;
+				snapshot.mPosition[0] = static_cast<uint16>(i * 37);
+				snapshot.mPosition[1] = static_cast<uint16>(i % 50);
+				snapshot.mPosition[2] = static_cast<uint16>(65535 - i * 13);
+				snapshot.mHeading = static_cast<uint8>(i * 5);
+				snapshot.mState = static_cast<uint8>(i % 16);
+				snapshot.mIsMoving = (i % 3 != 0);
+				snapshot.mIsSelected = (i % 17 == 0);
+			}
+			EntitySnapshots bitStreamOutput(numberOfEntities);
+			EntitySnapshots nativeBitStreamOutput(numberOfEntities);
+
+			Result result;
+			result.mResultsMatch = true;
+
+			{ // Current bit stream
+				BitStream bitStream;
+				{
+					HighResolutionStopwatch stopwatch;
+					for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+					{
+						bitStream.reset();
+						writeSnapshots(bitStream, input);
+					}
+					result.mBitStreamWriteTime = stopwatch.getElapsed();
+				}
+				result.mNumberOfBitsPerSnapshot = static_cast<uint32>(bitStream.getBitLength());
+
+				HighResolutionStopwatch stopwatch;
+				for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+				{
+					bitStream.setReadPosition(0);
+					result.mResultsMatch &= readSnapshots(bitStream, bitStreamOutput);
+				}
+				result.mBitStreamReadTime = stopwatch.getElapsed();
+			}
+
+			{ // Native bit stream, moved into a bit stream message like for sending
+				NativeBitStream nativeBitStream;
+				BitStream message;
+				{
+					HighResolutionStopwatch stopwatch;
+					for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+					{
+						nativeBitStream.reset();
+						writeSnapshots(nativeBitStream, input);
+						message.reset();
+						nativeBitStream.writeToBitStream(message);
+					}
+					result.mNativeBitStreamWriteTime = stopwatch.getElapsed();
+				}
+
+				NativeBitStream receivedBitStream;
+				HighResolutionStopwatch stopwatch;
+				for (uint32 repetition = 0; repetition < numberOfRepetitions; ++repetition)
+				{
+					message.setReadPosition(0);
+					result.mResultsMatch &= receivedBitStream.readFromBitStream(message);
+					result.mResultsMatch &= readSnapshots(receivedBitStream, nativeBitStreamOutput);
+				}
+				result.mNativeBitStreamReadTime = stopwatch.getElapsed();
+			}
+
+			result.mResultsMatch &= (bitStreamOutput == input && nativeBitStreamOutput == input);
+			return result;
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private methods                                       ]
+		//[-------------------------------------------------------]
+		inline bool NativeBitStreamBenchmark::EntitySnapshot::operator==(const EntitySnapshot& other) const
+		{
+			return (mEntityId == other.mEntityId && mPosition[0] == other.mPosition[0] && mPosition[1] == other.mPosition[1] && mPosition[2] == other.mPosition[2] &&
+					mHeading == other.mHeading && mState == other.mState && mIsMoving == other.mIsMoving && mIsSelected == other.mIsSelected);
+		}
+
+
+		//[-------------------------------------------------------]
+		//[ Private static methods                                ]
+		//[-------------------------------------------------------]
+		template <typename Stream>
+		void NativeBitStreamBenchmark::writeSnapshots(Stream& stream, const EntitySnapshots& snapshots)
+		{
+			for (const EntitySnapshot& snapshot : snapshots)
+			{
+				stream.write(snapshot.mEntityId);
+				stream.write(snapshot.mPosition[0]);
+				stream.write(snapshot.mPosition[1]);
+				stream.write(snapshot.mPosition[2]);
+				stream.write(snapshot.mHeading);
+				stream.write(snapshot.mState, 4);
+				stream.write(snapshot.mIsMoving);
+				stream.write(snapshot.mIsSelected);
+			}
+		}
+
+		template <typename Stream>
+		bool NativeBitStreamBenchmark::readSnapshots(const Stream& stream, EntitySnapshots& snapshots)
+		{
+			bool success = true;
+			for (EntitySnapshot& snapshot : snapshots)
+			{
+				success &= stream.read(snapshot.mEntityId);
+				success &= stream.read(snapshot.mPosition[0]);
+				success &= stream.read(snapshot.mPosition[1]);
+				success &= stream.read(snapshot.mPosition[2]);
+				success &= stream.read(snapshot.mHeading);
+				success &= stream.read(snapshot.mState, 4);
+				success &= stream.read(snapshot.mIsMoving);
+				success &= stream.read(snapshot.mIsSelected);
+			}
+			return success;
+		}
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // game
+} // qsf
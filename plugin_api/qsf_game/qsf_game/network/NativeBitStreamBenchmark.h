@@ -0,0 +1,127 @@
+// Copyright (C) 2012-2018 Promotion Software GmbH
+
+
+//[-------------------------------------------------------]
+//[ Header guard                                          ]
+//[-------------------------------------------------------]
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include "qsf_game/network/NativeBitStream.h"
+
+#include <qsf/time/Time.h>
+
+#include <vector>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace qsf
+{
+	namespace game
+	{
+
+
+		//[-------------------------------------------------------]
+		//[ Classes                                               ]
+		//[-------------------------------------------------------]
+		/**
+		*  @brief
+		*    Microbenchmark of "qsf::game::NativeBitStream" against "qsf::game::BitStream" for many small fields
+		*
+		*  @remarks
+		*    Both streams write and read the same entity snapshots field by field, like a replication message does:
+		*    an entity ID, a quantized position, a heading, a state and a few flags per entity.
+		*    The native stream is moved into and restored from a "qsf::game::BitStream" as part of the measured time, since this is needed to send it.
+		*    Usage, e.g. from a debug command of a plugin:
+		*    @code
+		*      const qsf::game::NativeBitStreamBenchmark::Result result = qsf::game::NativeBitStreamBenchmark::run(1000, 100);
+		*      QSF_LOG_PRINTS(INFO, "BitStream: " << result.mBitStreamWriteTime.getMilliseconds() << " ms, native: " << result.mNativeBitStreamWriteTime.getMilliseconds() << " ms");
+		*    @endcode
+		*/
+		class NativeBitStreamBenchmark
+		{
+
+
+		//[-------------------------------------------------------]
+		//[ Public definitions                                    ]
+		//[-------------------------------------------------------]
+		public:
+			struct Result
+			{
+				Time   mBitStreamWriteTime;			///< Time needed by "qsf::game::BitStream" for writing all repetitions
+				Time   mBitStreamReadTime;			///< Time needed by "qsf::game::BitStream" for reading all repetitions
+				Time   mNativeBitStreamWriteTime;	///< Time needed by "qsf::game::NativeBitStream" for writing all repetitions, including "qsf::game::NativeBitStream::writeToBitStream()"
+				Time   mNativeBitStreamReadTime;	///< Time needed by "qsf::game::NativeBitStream" for reading all repetitions, including "qsf::game::NativeBitStream::readFromBitStream()"
+				uint32 mNumberOfBitsPerSnapshot;	///< Number of payload bits of one snapshot of all entities
+				bool   mResultsMatch;				///< "true" if both streams read back the snapshots written, else "false"
+			};
+
+
+		//[-------------------------------------------------------]
+		//[ Public static methods                                 ]
+		//[-------------------------------------------------------]
+		public:
+			/**
+			*  @brief
+			*    Run the benchmark
+			*
+			*  @param[in] numberOfEntities
+			*    Number of entities per snapshot
+			*  @param[in] numberOfRepetitions
+			*    Number of snapshots written and read per stream
+			*
+			*  @return
+			*    The measured times
+			*/
+			inline static Result run(uint32 numberOfEntities, uint32 numberOfRepetitions);
+
+
+		//[-------------------------------------------------------]
+		//[ Private definitions                                   ]
+		//[-------------------------------------------------------]
+		private:
+			struct EntitySnapshot
+			{
+				uint32 mEntityId;
+				uint16 mPosition[3];	///< Quantized to 16 bit per axis
+				uint8  mHeading;		///< Quantized to 8 bit
+				uint8  mState;			///< 4 bit
+				bool   mIsMoving;
+				bool   mIsSelected;
+
+				inline bool operator==(const EntitySnapshot& other) const;
+			};
+
+			typedef std::vector<EntitySnapshot> EntitySnapshots;
+
+
+		//[-------------------------------------------------------]
+		//[ Private static methods                                ]
+		//[-------------------------------------------------------]
+		private:
+			template <typename Stream>
+			static void writeSnapshots(Stream& stream, const EntitySnapshots& snapshots);
+
+			template <typename Stream>
+			static bool readSnapshots(const Stream& stream, EntitySnapshots& snapshots);
+
+
+		};
+
+
+	//[-------------------------------------------------------]
+	//[ Namespace                                             ]
+	//[-------------------------------------------------------]
+	} // game
+} // qsf
+
+
+//[-------------------------------------------------------]
+//[ Implementation                                        ]
+//[-------------------------------------------------------]
+#include "qsf_game/network/NativeBitStreamBenchmark-inl.h"